@@ -0,0 +1,130 @@
+/* Benchmark: moving tokens through FIFO channels with either token layout.
+ * A writer thread writes a number of items to a channel with a single writer and
+ * reader, from which a reader thread reads them.  The channel keeps its token
+ * descriptors either in an array of their own or, with VFTASKS_CHAN_FLAT, in the
+ * FIFO buffer next to the contents of the tokens.  Every item fills a whole
+ * token, of which the first word is checked.  The channel has the default hooks,
+ * so a thread that finds the channel full or empty keeps polling it; the results
+ * are only meaningful with a core per thread.
+ *
+ * Usage: measure_flat [token_size [num_items]]
+ */
+
+#include <vftasks.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_TOKENS 4096
+#define DEFAULT_TOKEN_SIZE 16
+#define DEFAULT_NUM_ITEMS 10000000
+
+int num_items;
+size_t token_size;
+vftasks_malloc_t mem_mgr;
+
+/* pack function arguments in a struct */
+typedef struct
+{
+  vftasks_wport_t *wport;  /* the port to write through, or NULL */
+  vftasks_rport_t *rport;  /* the port to read through, or NULL */
+  int64_t sum;             /* sum of the items read */
+} task_t;
+
+/* write num_items items, or read as many */
+void task(void *raw_args)
+{
+  task_t *args = (task_t *)raw_args;
+  vftasks_token_t *token;
+  int32_t item;
+  int k;
+
+  if (args->wport != NULL)
+    for (k = 0; k < num_items; k++)
+    {
+      token = vftasks_acquire_room(args->wport);
+      memset(vftasks_get_memaddr(token), 0, token_size);
+      vftasks_put_int32(token, 0, k);
+      vftasks_release_data(args->wport, token);
+    }
+  else
+    for (k = 0; k < num_items; k++)
+    {
+      token = vftasks_acquire_data(args->rport);
+      memcpy(&item, vftasks_get_memaddr(token), sizeof(int32_t));
+      args->sum += item;
+      vftasks_release_room(args->rport, token);
+    }
+}
+
+/* pass the items from a writer to a reader through a channel of a given kind, and
+   return the time taken; the sum of the items read is stored in sum */
+uint64_t run(vftasks_pool_t *pool, int kind, int64_t *sum)
+{
+  vftasks_chan_t *chan;
+  task_t writer, reader;
+  uint64_t time;
+
+  chan = vftasks_create_chan_with_kind(NUM_TOKENS, token_size, kind,
+                                       &mem_mgr, &mem_mgr);
+  writer.wport = vftasks_create_write_port(chan, &mem_mgr);
+  writer.rport = NULL;
+  reader.wport = NULL;
+  reader.rport = vftasks_create_read_port(chan, &mem_mgr);
+  reader.sum = 0;
+
+  vftasks_timer_start(&time);
+
+  /* the reader is executed by the main thread */
+  vftasks_submit(pool, task, &writer, 0);
+  task(&reader);
+  vftasks_get(pool);
+
+  time = vftasks_timer_stop(&time);
+
+  *sum = reader.sum;
+  vftasks_destroy_write_port(writer.wport, &mem_mgr);
+  vftasks_destroy_read_port(reader.rport, &mem_mgr);
+  vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
+
+  return time;
+}
+
+int main(int argc, char *argv[])
+{
+  vftasks_pool_t *pool;
+  int64_t expected, separate_sum, flat_sum;
+  uint64_t separate, flat;
+
+  token_size = argc > 1 ? (size_t)atoi(argv[1]) : DEFAULT_TOKEN_SIZE;
+  num_items = argc > 2 ? atoi(argv[2]) : DEFAULT_NUM_ITEMS;
+  if (token_size < sizeof(int32_t) || num_items < 1)
+  {
+    fprintf(stderr, "usage: %s [token_size >= %d [num_items >= 1]]\n",
+            argv[0], (int)sizeof(int32_t));
+    return 1;
+  }
+
+  mem_mgr.malloc = malloc;
+  mem_mgr.free = free;
+
+  pool = vftasks_create_pool(1, 0);
+
+  separate = run(pool, VFTASKS_CHAN_SPSC, &separate_sum);
+  flat = run(pool, VFTASKS_CHAN_SPSC | VFTASKS_CHAN_FLAT, &flat_sum);
+
+  printf(" size     items  separate (items/s)  flat (items/s)  ratio\n");
+  printf("%5d  %8d  %18.0f  %14.0f  %5.2f\n",
+         (int)token_size,
+         num_items,
+         1e9 * num_items / separate,
+         1e9 * num_items / flat,
+         (double)separate / flat);
+
+  vftasks_destroy_pool(pool);
+
+  /* every item must have been read exactly once */
+  expected = (int64_t)num_items * (num_items - 1) / 2;
+  return separate_sum == expected && flat_sum == expected ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/* Benchmark: publishing the tail of a FIFO channel per token or once per interval.
+ * A writer thread writes a number of items to a channel with a single writer and
+ * reader, from which a reader thread reads them, filling and reading every token
+ * completely.  The writer publishes the tokens that it releases either one by
+ * one, or once per publication interval (vftasks_set_publication_interval), which
+ * makes the cache line holding the tail move to the reader less often.  This is
+ * repeated for several token sizes.  The channel has the default hooks, so a thread
+ * that finds the channel full or empty keeps polling it; the results are only
+ * meaningful with a core per thread.
+ *
+ * The head and the tail of a channel are kept on separate cache lines; to compare
+ * with a layout in which they share one, build this benchmark against an earlier
+ * revision of the library with an interval of 1.
+ *
+ * Usage: measure_publication [interval [num_items]]
+ */
+
+#include <vftasks.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_TOKENS 1024
+#define MAX_TOKEN_SIZE 256
+#define DEFAULT_INTERVAL 32
+#define DEFAULT_NUM_ITEMS 1000000
+
+int num_items;
+vftasks_malloc_t mem_mgr;
+
+/* pack function arguments in a struct */
+typedef struct
+{
+  vftasks_wport_t *wport;  /* the port to write through, or NULL */
+  vftasks_rport_t *rport;  /* the port to read through, or NULL */
+  size_t token_size;       /* number of bytes written to or read from a token */
+  int64_t sum;             /* sum of the items read */
+} task_t;
+
+/* write num_items items, or read as many */
+void task(void *raw_args)
+{
+  task_t *args = (task_t *)raw_args;
+  char buf[MAX_TOKEN_SIZE];
+  vftasks_token_t *token;
+  int32_t item;
+  int k;
+
+  memset(buf, 0, sizeof(buf));
+
+  if (args->wport != NULL)
+  {
+    for (k = 0; k < num_items; k++)
+    {
+      token = vftasks_acquire_room(args->wport);
+      item = k;
+      memcpy(buf, &item, sizeof(item));
+      memcpy(vftasks_get_memaddr(token), buf, args->token_size);
+      vftasks_release_data(args->wport, token);
+    }
+    vftasks_flush_data(args->wport);
+  }
+  else
+  {
+    for (k = 0; k < num_items; k++)
+    {
+      token = vftasks_acquire_data(args->rport);
+      memcpy(buf, vftasks_get_memaddr(token), args->token_size);
+      vftasks_release_room(args->rport, token);
+      memcpy(&item, buf, sizeof(item));
+      args->sum += item;
+    }
+  }
+}
+
+/* pass the items from a writer to a reader through tokens of a given size, with a
+   given publication interval, and return the time taken; the sum of the items
+   read is stored in sum */
+uint64_t run(vftasks_pool_t *pool, size_t token_size, int interval, int64_t *sum)
+{
+  vftasks_chan_t *chan;
+  task_t writer, reader;
+  uint64_t time;
+
+  chan = vftasks_create_chan(NUM_TOKENS, token_size, &mem_mgr, &mem_mgr);
+  vftasks_set_publication_interval(chan, interval);
+  writer.wport = vftasks_create_write_port(chan, &mem_mgr);
+  writer.rport = NULL;
+  writer.token_size = token_size;
+  reader.wport = NULL;
+  reader.rport = vftasks_create_read_port(chan, &mem_mgr);
+  reader.token_size = token_size;
+  reader.sum = 0;
+
+  vftasks_timer_start(&time);
+
+  /* the reader is executed by the main thread */
+  vftasks_submit(pool, task, &writer, 0);
+  task(&reader);
+  vftasks_get(pool);
+
+  time = vftasks_timer_stop(&time);
+
+  *sum = reader.sum;
+  vftasks_destroy_write_port(writer.wport, &mem_mgr);
+  vftasks_destroy_read_port(reader.rport, &mem_mgr);
+  vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
+
+  return time;
+}
+
+int main(int argc, char *argv[])
+{
+  static const size_t token_sizes[] = {4, 16, 64, MAX_TOKEN_SIZE};
+  vftasks_pool_t *pool;
+  int interval;
+  int64_t expected, single_sum, deferred_sum;
+  uint64_t single, deferred;
+  int failed;
+  int k;
+
+  interval = argc > 1 ? atoi(argv[1]) : DEFAULT_INTERVAL;
+  num_items = argc > 2 ? atoi(argv[2]) : DEFAULT_NUM_ITEMS;
+  if (interval < 1 || interval > NUM_TOKENS || num_items < 1)
+  {
+    fprintf(stderr, "usage: %s [1 <= interval <= %d [num_items >= 1]]\n",
+            argv[0], NUM_TOKENS);
+    return 1;
+  }
+
+  mem_mgr.malloc = malloc;
+  mem_mgr.free = free;
+
+  pool = vftasks_create_pool(1, 0);
+
+  /* every item must be read exactly once */
+  expected = (int64_t)num_items * (num_items - 1) / 2;
+  failed = 0;
+
+  printf("token size  interval     items  per token (items/s)  "
+         "per interval (items/s)  ratio\n");
+  for (k = 0; k < (int)(sizeof(token_sizes) / sizeof(token_sizes[0])); k++)
+  {
+    single = run(pool, token_sizes[k], 1, &single_sum);
+    deferred = run(pool, token_sizes[k], interval, &deferred_sum);
+
+    printf("%10d  %8d  %8d  %19.0f  %22.0f  %5.2f\n",
+           (int)token_sizes[k],
+           interval,
+           num_items,
+           1e9 * num_items / single,
+           1e9 * num_items / deferred,
+           (double)single / deferred);
+
+    if (single_sum != expected || deferred_sum != expected) failed = 1;
+  }
+
+  vftasks_destroy_pool(pool);
+
+  return failed;
+}
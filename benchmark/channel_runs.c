@@ -0,0 +1,149 @@
+/* Benchmark: moving tokens through a FIFO channel one at a time or in runs.
+ * A writer thread writes a number of items to a channel with a single writer and
+ * reader, from which a reader thread reads them.  The items are passed either one
+ * token at a time, publishing the channel state per token, or in runs of
+ * consecutive tokens (vftasks_acquire_room_n and so on), publishing it once per
+ * run.  The channel has the default hooks, so a thread that finds the channel full
+ * or empty keeps polling it; the results are only meaningful with a core per
+ * thread.
+ *
+ * Usage: measure_runs [run [num_items]]
+ */
+
+#include <vftasks.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_TOKENS 1024
+#define DEFAULT_RUN 32
+#define DEFAULT_NUM_ITEMS 10000000
+
+int num_items;
+int run_length;
+vftasks_malloc_t mem_mgr;
+
+/* pack function arguments in a struct */
+typedef struct
+{
+  vftasks_wport_t *wport;  /* the port to write through, or NULL */
+  vftasks_rport_t *rport;  /* the port to read through, or NULL */
+  int in_runs;             /* nonzero to move the items in runs */
+  int64_t sum;             /* sum of the items read */
+} task_t;
+
+/* write num_items items, or read as many */
+void task(void *raw_args)
+{
+  task_t *args = (task_t *)raw_args;
+  vftasks_chan_t *chan;
+  vftasks_token_t *token;
+  int count, k, i;
+
+  if (!args->in_runs)
+  {
+    if (args->wport != NULL)
+      for (k = 0; k < num_items; k++) vftasks_write_int32(args->wport, k);
+    else
+      for (k = 0; k < num_items; k++) args->sum += vftasks_read_int32(args->rport);
+    return;
+  }
+
+  if (args->wport != NULL)
+  {
+    chan = vftasks_chan_of_wport(args->wport);
+    for (k = 0; k < num_items; k += count)
+    {
+      token = vftasks_acquire_room_n(args->wport,
+                                     num_items - k < run_length ? num_items - k
+                                                                : run_length,
+                                     &count);
+      for (i = 0; i < count; i++)
+        vftasks_put_int32(vftasks_token_in_run(chan, token, i), 0, k + i);
+      vftasks_release_data_n(args->wport, token, count);
+    }
+  }
+  else
+  {
+    chan = vftasks_chan_of_rport(args->rport);
+    for (k = 0; k < num_items; k += count)
+    {
+      token = vftasks_acquire_data_n(args->rport, run_length, &count);
+      for (i = 0; i < count; i++)
+        args->sum += vftasks_get_int32(vftasks_token_in_run(chan, token, i), 0);
+      vftasks_release_room_n(args->rport, token, count);
+    }
+  }
+}
+
+/* pass the items from a writer to a reader, one at a time or in runs, and return
+   the time taken; the sum of the items read is stored in sum */
+uint64_t run(vftasks_pool_t *pool, int in_runs, int64_t *sum)
+{
+  vftasks_chan_t *chan;
+  task_t writer, reader;
+  uint64_t time;
+
+  chan = vftasks_create_chan(NUM_TOKENS, sizeof(int32_t), &mem_mgr, &mem_mgr);
+  writer.wport = vftasks_create_write_port(chan, &mem_mgr);
+  writer.rport = NULL;
+  writer.in_runs = in_runs;
+  reader.wport = NULL;
+  reader.rport = vftasks_create_read_port(chan, &mem_mgr);
+  reader.in_runs = in_runs;
+  reader.sum = 0;
+
+  vftasks_timer_start(&time);
+
+  /* the reader is executed by the main thread */
+  vftasks_submit(pool, task, &writer, 0);
+  task(&reader);
+  vftasks_get(pool);
+
+  time = vftasks_timer_stop(&time);
+
+  *sum = reader.sum;
+  vftasks_destroy_write_port(writer.wport, &mem_mgr);
+  vftasks_destroy_read_port(reader.rport, &mem_mgr);
+  vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
+
+  return time;
+}
+
+int main(int argc, char *argv[])
+{
+  vftasks_pool_t *pool;
+  int64_t expected, single_sum, runs_sum;
+  uint64_t single, runs;
+
+  run_length = argc > 1 ? atoi(argv[1]) : DEFAULT_RUN;
+  num_items = argc > 2 ? atoi(argv[2]) : DEFAULT_NUM_ITEMS;
+  if (run_length < 1 || run_length > NUM_TOKENS || num_items < 1)
+  {
+    fprintf(stderr, "usage: %s [1 <= run <= %d [num_items >= 1]]\n",
+            argv[0], NUM_TOKENS);
+    return 1;
+  }
+
+  mem_mgr.malloc = malloc;
+  mem_mgr.free = free;
+
+  pool = vftasks_create_pool(1, 0);
+
+  single = run(pool, 0, &single_sum);
+  runs = run(pool, 1, &runs_sum);
+
+  printf("  run     items  single (items/s)  runs (items/s)  ratio\n");
+  printf("%5d  %8d  %16.0f  %14.0f  %5.2f\n",
+         run_length,
+         num_items,
+         1e9 * num_items / single,
+         1e9 * num_items / runs,
+         (double)single / runs);
+
+  vftasks_destroy_pool(pool);
+
+  /* every item must have been read exactly once */
+  expected = (int64_t)num_items * (num_items - 1) / 2;
+  return single_sum == expected && runs_sum == expected ? 0 : 1;
+}
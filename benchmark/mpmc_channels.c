@@ -0,0 +1,137 @@
+/* Benchmark: sharing one FIFO channel between several writers and readers.
+ * A number of writer threads each write a number of items, which a same number of
+ * reader threads read.  The items are passed either through a separate channel
+ * with a single writer and reader per pair of threads, or through one channel
+ * that all writers and readers share (VFTASKS_CHAN_MPMC), from which every reader
+ * reads as many items as a writer writes, whichever writer they came from.  The
+ * channels have the default hooks, so threads that find a channel full or empty
+ * keep polling it; the results are only meaningful with a core per thread.
+ *
+ * Usage: measure_mpmc [num_pairs [num_items]]
+ */
+
+#include <vftasks.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_TOKENS 64
+#define MAX_PAIRS 8
+#define DEFAULT_NUM_PAIRS 2
+#define DEFAULT_NUM_ITEMS 100000
+
+int num_items;
+vftasks_pool_t *pool;
+vftasks_malloc_t mem_mgr;
+
+/* pack function arguments in a struct */
+typedef struct
+{
+  vftasks_wport_t *wport;  /* the port to write through, or NULL */
+  vftasks_rport_t *rport;  /* the port to read through, or NULL */
+  int64_t sum;             /* sum of the items read */
+} task_t;
+
+/* write num_items items, or read as many */
+void task(void *raw_args)
+{
+  task_t *args = (task_t *)raw_args;
+  int k;
+
+  if (args->wport != NULL)
+    for (k = 0; k < num_items; k++) vftasks_write_int32(args->wport, k);
+  else
+    for (k = 0; k < num_items; k++) args->sum += vftasks_read_int32(args->rport);
+}
+
+/* pass the items of num_pairs writers to num_pairs readers, through a channel per
+   pair or a shared one, and return the time taken; the sum of the items read is
+   stored in sum */
+uint64_t run(int num_pairs, int shared, int64_t *sum)
+{
+  vftasks_chan_t *chans[MAX_PAIRS];
+  task_t args[2 * MAX_PAIRS];
+  uint64_t time;
+  int num_chans, k;
+
+  /* create the channels and connect a writer and a reader per pair */
+  num_chans = shared ? 1 : num_pairs;
+  for (k = 0; k < num_chans; k++)
+    chans[k] = vftasks_create_chan_with_kind(NUM_TOKENS,
+                                             sizeof(int32_t),
+                                             shared ? VFTASKS_CHAN_MPMC
+                                                    : VFTASKS_CHAN_SPSC,
+                                             &mem_mgr,
+                                             &mem_mgr);
+  for (k = 0; k < num_pairs; k++)
+  {
+    args[2 * k].wport = vftasks_create_write_port(chans[shared ? 0 : k], &mem_mgr);
+    args[2 * k].rport = NULL;
+    args[2 * k + 1].wport = NULL;
+    args[2 * k + 1].rport = vftasks_create_read_port(chans[shared ? 0 : k], &mem_mgr);
+    args[2 * k + 1].sum = 0;
+  }
+
+  vftasks_timer_start(&time);
+
+  for (k = 0; k < 2 * num_pairs - 1; k++)
+    vftasks_submit(pool, task, &args[k], 0);
+
+  /* the last reader is executed by the main thread */
+  task(&args[k]);
+
+  for (k = 0; k < 2 * num_pairs - 1; k++)
+    vftasks_get(pool);
+
+  time = vftasks_timer_stop(&time);
+
+  *sum = 0;
+  for (k = 0; k < num_pairs; k++)
+  {
+    *sum += args[2 * k + 1].sum;
+    vftasks_destroy_write_port(args[2 * k].wport, &mem_mgr);
+    vftasks_destroy_read_port(args[2 * k + 1].rport, &mem_mgr);
+  }
+  for (k = 0; k < num_chans; k++)
+    vftasks_destroy_chan(chans[k], &mem_mgr, &mem_mgr);
+
+  return time;
+}
+
+int main(int argc, char *argv[])
+{
+  int num_pairs = argc > 1 ? atoi(argv[1]) : DEFAULT_NUM_PAIRS;
+  int64_t expected, separate_sum, shared_sum;
+  uint64_t separate, shared;
+
+  num_items = argc > 2 ? atoi(argv[2]) : DEFAULT_NUM_ITEMS;
+  if (num_pairs < 1 || num_pairs > MAX_PAIRS || num_items < 1)
+  {
+    fprintf(stderr, "usage: %s [1 <= num_pairs <= %d [num_items >= 1]]\n",
+            argv[0], MAX_PAIRS);
+    return 1;
+  }
+
+  mem_mgr.malloc = malloc;
+  mem_mgr.free = free;
+
+  /* one reader is executed by the main thread */
+  pool = vftasks_create_pool(2 * num_pairs - 1, 0);
+
+  separate = run(num_pairs, 0, &separate_sum);
+  shared = run(num_pairs, 1, &shared_sum);
+
+  printf("pairs    items  separate SPSC (items/s)  shared MPMC (items/s)  ratio\n");
+  printf("%5d  %7d  %23.0f  %21.0f  %5.2f\n",
+         num_pairs,
+         num_items,
+         1e9 * num_pairs * num_items / separate,
+         1e9 * num_pairs * num_items / shared,
+         (double)separate / shared);
+
+  vftasks_destroy_pool(pool);
+
+  /* every item must have been read exactly once */
+  expected = (int64_t)num_pairs * num_items * (num_items - 1) / 2;
+  return separate_sum == expected && shared_sum == expected ? 0 : 1;
+}
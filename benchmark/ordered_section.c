@@ -0,0 +1,152 @@
+/* Benchmark: an ordered section in a partitioned loop.
+ * Every iteration of a loop partitioned in a round-robin fashion over two threads
+ * does a little work and then appends its result to an output array in iteration
+ * order.  The appends are ordered either through a 1D-synchronization manager with
+ * a dependency distance of 1, or through an ordered section.
+ *
+ * Usage: measure_ordered [num_runs]
+ */
+
+#include <vftasks.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define N 4096
+#define WORK 256
+#define NUM_THREADS 2
+#define DEFAULT_NUM_RUNS 100
+
+int output[N];
+int length;
+vftasks_pool_t *pool;
+vftasks_1d_sync_mgr_t *sync_mgr;
+vftasks_ordered_t *ordered;
+
+/* pack function arguments in a struct */
+typedef struct
+{
+  int start;
+  int use_ordered;
+} task_t;
+
+/* a little work per iteration */
+int compute(int i)
+{
+  int k, r = i;
+
+  for (k = 0; k < WORK; k++) r = r * 1103515245 + 12345;
+
+  return r;
+}
+
+/* The original loop looked like this:
+ * for (i = 0; i < N; i++)
+ *   output[length++] = compute(i);
+ */
+void task(void *raw_args)
+{
+  task_t *args = (task_t *)raw_args;
+  int i, r;
+
+  for (i = args->start; i < N; i += NUM_THREADS)
+  {
+    r = compute(i);
+
+    if (args->use_ordered)
+    {
+      vftasks_ordered_begin(ordered, i);
+      output[length++] = r;
+      vftasks_ordered_end(ordered, i);
+    }
+    else
+    {
+      vftasks_wait_1d(sync_mgr, i);
+      output[length++] = r;
+      vftasks_signal_1d(sync_mgr, i);
+    }
+  }
+}
+
+/* execute the loop a number of times and return the average time per execution */
+uint64_t run(int num_runs, int use_ordered)
+{
+  task_t args[NUM_THREADS];
+  uint64_t time;
+  int r, k;
+
+  vftasks_timer_start(&time);
+
+  for (r = 0; r < num_runs; r++)
+  {
+    if (use_ordered)
+      vftasks_reset_ordered(ordered);
+    else
+      vftasks_reset_1d_sync_mgr(sync_mgr);
+    length = 0;
+
+    for (k = 0; k < NUM_THREADS - 1; k++)
+    {
+      args[k].start = k;
+      args[k].use_ordered = use_ordered;
+      vftasks_submit(pool, task, &args[k], 0);
+    }
+
+    /* the last partition is executed by the main thread */
+    args[k].start = k;
+    args[k].use_ordered = use_ordered;
+    task(&args[k]);
+
+    for (k = 0; k < NUM_THREADS - 1; k++)
+      vftasks_get(pool);
+  }
+
+  return vftasks_timer_stop(&time) / num_runs;
+}
+
+/* check that the output is in iteration order */
+int check()
+{
+  int i;
+
+  if (length != N) return 1;
+  for (i = 0; i < N; i++)
+    if (output[i] != compute(i)) return 1;
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  int num_runs = argc > 1 ? atoi(argv[1]) : DEFAULT_NUM_RUNS;
+  uint64_t manager, section;
+  int rc;
+
+  if (num_runs < 1)
+  {
+    fprintf(stderr, "usage: %s [num_runs >= 1]\n", argv[0]);
+    return 1;
+  }
+
+  /* one partition is executed by the main thread */
+  pool = vftasks_create_pool(NUM_THREADS - 1, 0);
+  sync_mgr = vftasks_create_1d_sync_mgr(NUM_THREADS, 1);
+  ordered = vftasks_create_ordered();
+
+  manager = run(num_runs, 0);
+  rc = check();
+  section = run(num_runs, 1);
+  rc |= check();
+
+  printf("1d manager (ns/run)  ordered section (ns/run)  speedup\n");
+  printf("%19lu  %24lu  %7.2f\n",
+         (unsigned long)manager,
+         (unsigned long)section,
+         (double)manager / section);
+
+  vftasks_destroy_ordered(ordered);
+  vftasks_destroy_1d_sync_mgr(sync_mgr);
+  vftasks_destroy_pool(pool);
+
+  return rc;
+}
@@ -0,0 +1,147 @@
+/* Benchmark: reusing a 2D-synchronization manager across executions of a loop nest.
+ * A small loop nest with a dependency on the previous row is executed repeatedly
+ * on two threads, synchronized per row.  Per execution, the manager is either
+ * created and destroyed, or reset through vftasks_reset_2d_sync_mgr; both are
+ * measured with the semaphores of the manager and with a ring of progress
+ * counters (spin mode), and both with and without executing the loop nest, the
+ * latter isolating the cost of preparing the manager.  In spin mode, waiting
+ * threads block after a few polls, so that the results do not depend on having a
+ * core per thread.
+ *
+ * Usage: measure_sync_reset [num_runs]
+ */
+
+#include <vftasks.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define M 1024
+#define N 64
+#define NUM_THREADS 2
+#define DEFAULT_NUM_RUNS 1000
+
+int a[M][N];
+vftasks_pool_t *pool;
+vftasks_2d_sync_mgr_t *sync_mgr;
+
+/* pack function arguments in a struct */
+typedef struct
+{
+  int start;
+  int stride;
+} task_t;
+
+/* The original loop looked like this:
+ * for (i = 0; i < M; i++)
+ *   for (j = 0; j < N; j++)
+ *     a[i][j] = (i > 0 && j + 1 < N) ? a[i - 1][j + 1] + 1 : 0;
+ */
+void task(void *raw_args)
+{
+  task_t *args = (task_t *)raw_args;
+  int i, j;
+
+  for (i = args->start; i < M; i += args->stride)
+  {
+    vftasks_wait_2d_range(sync_mgr, i, 0, N);
+    for (j = 0; j < N; j++)
+      a[i][j] = (i > 0 && j + 1 < N) ? a[i - 1][j + 1] + 1 : 0;
+    vftasks_signal_2d_range(sync_mgr, i, 0, N);
+  }
+}
+
+/* execute the loop nest once */
+void execute()
+{
+  task_t args[NUM_THREADS];
+  int k;
+
+  for (k = 0; k < NUM_THREADS - 1; k++)
+  {
+    args[k].start = k;
+    args[k].stride = NUM_THREADS;
+    vftasks_submit(pool, task, &args[k], 0);
+  }
+
+  /* the last partition is executed by the main thread */
+  args[k].start = k;
+  args[k].stride = NUM_THREADS;
+  task(&args[k]);
+
+  for (k = 0; k < NUM_THREADS - 1; k++)
+    vftasks_get(pool);
+}
+
+/* prepare a manager for a number of executions of the loop nest, creating a
+   manager per execution or resetting a single one, and return the average time per
+   execution */
+uint64_t run(int num_runs, int mode, int reset, int with_loop)
+{
+  vftasks_2d_sync_attr_t attr;
+  uint64_t time;
+  int r;
+
+  vftasks_init_2d_sync_attr(&attr);
+  attr.mode = mode;
+  attr.num_threads = NUM_THREADS;
+  attr.spin_limit = 16;
+
+  vftasks_timer_start(&time);
+
+  if (reset) sync_mgr = vftasks_create_2d_sync_mgr_with_attr(M, N, 1, -1, &attr);
+
+  for (r = 0; r < num_runs; r++)
+  {
+    if (reset)
+      vftasks_reset_2d_sync_mgr(sync_mgr);
+    else
+      sync_mgr = vftasks_create_2d_sync_mgr_with_attr(M, N, 1, -1, &attr);
+
+    if (with_loop) execute();
+
+    if (!reset) vftasks_destroy_2d_sync_mgr(sync_mgr);
+  }
+
+  if (reset) vftasks_destroy_2d_sync_mgr(sync_mgr);
+
+  return vftasks_timer_stop(&time) / num_runs;
+}
+
+int main(int argc, char *argv[])
+{
+  int num_runs = argc > 1 ? atoi(argv[1]) : DEFAULT_NUM_RUNS;
+  uint64_t create, reset, create_loop, reset_loop;
+  int mode;
+
+  if (num_runs < 1)
+  {
+    fprintf(stderr, "usage: %s [num_runs >= 1]\n", argv[0]);
+    return 1;
+  }
+
+  /* one partition is executed by the main thread */
+  pool = vftasks_create_pool(NUM_THREADS - 1, 0);
+
+  printf("                 manager only (ns/run)       with loop nest (ns/run)\n");
+  printf("mode          create     reset  speedup      create     reset  speedup\n");
+  for (mode = VFTASKS_SYNC_SEMAPHORE; mode <= VFTASKS_SYNC_SPIN; mode++)
+  {
+    create = run(num_runs, mode, 0, 0);
+    reset = run(num_runs, mode, 1, 0);
+    create_loop = run(num_runs, mode, 0, 1);
+    reset_loop = run(num_runs, mode, 1, 1);
+    printf("%-9s  %9lu %9lu  %7.2f   %9lu %9lu  %7.2f\n",
+           mode == VFTASKS_SYNC_SPIN ? "spin" : "semaphore",
+           (unsigned long)create,
+           (unsigned long)reset,
+           (double)create / (reset > 0 ? reset : 1),
+           (unsigned long)create_loop,
+           (unsigned long)reset_loop,
+           (double)create_loop / reset_loop);
+  }
+
+  vftasks_destroy_pool(pool);
+
+  return a[M - 1][0] == N - 1 ? 0 : 1;
+}
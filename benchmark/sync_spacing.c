@@ -0,0 +1,138 @@
+/* Benchmark: false sharing between the semaphores of a 2D-synchronization manager.
+ * A loop nest with a dependency on the previous row is partitioned cyclically over
+ * a growing number of threads, so that adjacent rows, and thus adjacent
+ * semaphores, are used by different threads.  The loop body is trivial, so the
+ * measured time is dominated by synchronization; it is measured with the
+ * semaphores packed and with one semaphore per cache line.
+ *
+ * Usage: measure_sync_spacing [max_threads]
+ */
+
+#include <vftasks.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define M 256
+#define N 1024
+#define NUM_RUNS 5
+#define DEFAULT_MAX_THREADS 8
+
+int a[M][N];
+vftasks_pool_t *pool;
+vftasks_2d_sync_mgr_t *sync_mgr;
+
+/* pack function arguments in a struct */
+typedef struct
+{
+  int start;
+  int stride;
+} task_t;
+
+/* The original loop looked like this:
+ * for (i = 0; i < M; i++)
+ *   for (j = 0; j < N; j++)
+ *     a[i][j] = (i > 0 && j + 1 < N) ? a[i - 1][j + 1] + 1 : 0;
+ */
+void task(void *raw_args)
+{
+  task_t *args = (task_t *)raw_args;
+  int i, j;
+
+  for (i = args->start; i < M; i += args->stride)
+  {
+    for (j = 0; j < N; j++)
+    {
+      vftasks_wait_2d(sync_mgr, i, j);
+      a[i][j] = (i > 0 && j + 1 < N) ? a[i - 1][j + 1] + 1 : 0;
+      vftasks_signal_2d(sync_mgr, i, j);
+    }
+  }
+}
+
+/* run the loop nest on a given number of threads and return the elapsed time */
+uint64_t run(int num_threads, size_t spacing)
+{
+  vftasks_2d_sync_attr_t attr;
+  task_t *args;
+  uint64_t time;
+  int k;
+
+  vftasks_init_2d_sync_attr(&attr);
+  attr.spacing = spacing;
+  sync_mgr = vftasks_create_2d_sync_mgr_with_attr(M, N, 1, -1, &attr);
+
+  /* put the arguments on the heap so the worker threads can access them */
+  args = calloc(num_threads, sizeof(task_t));
+
+  vftasks_timer_start(&time);
+
+  for (k = 0; k < num_threads - 1; k++)
+  {
+    args[k].start = k;
+    args[k].stride = num_threads;
+    vftasks_submit(pool, task, &args[k], 0);
+  }
+
+  /* the last partition is executed by the main thread */
+  args[k].start = k;
+  args[k].stride = num_threads;
+  task(&args[k]);
+
+  for (k = 0; k < num_threads - 1; k++)
+    vftasks_get(pool);
+
+  time = vftasks_timer_stop(&time);
+
+  free(args);
+  vftasks_destroy_2d_sync_mgr(sync_mgr);
+
+  return time;
+}
+
+/* the best time out of a number of runs */
+uint64_t best_of(int num_threads, size_t spacing)
+{
+  uint64_t best = 0, time;
+  int r;
+
+  for (r = 0; r < NUM_RUNS; r++)
+  {
+    time = run(num_threads, spacing);
+    if (r == 0 || time < best) best = time;
+  }
+
+  return best;
+}
+
+int main(int argc, char *argv[])
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : DEFAULT_MAX_THREADS;
+  int num_threads;
+  uint64_t packed, padded;
+
+  if (max_threads < 2)
+  {
+    fprintf(stderr, "usage: %s [max_threads >= 2]\n", argv[0]);
+    return 1;
+  }
+
+  /* one partition is executed by the main thread */
+  pool = vftasks_create_pool(max_threads - 1, 0);
+
+  printf("threads  packed (ns)  padded (ns)  speedup\n");
+  for (num_threads = 2; num_threads <= max_threads; num_threads++)
+  {
+    packed = best_of(num_threads, 0);
+    padded = best_of(num_threads, VFTASKS_SYNC_SPACING);
+    printf("%7d  %11lu  %11lu  %7.2f\n",
+           num_threads,
+           (unsigned long)packed,
+           (unsigned long)padded,
+           (double)packed / padded);
+  }
+
+  vftasks_destroy_pool(pool);
+
+  return a[M - 1][0] == M - 1 ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+/* Benchmark: wavefront execution of a 2D loop nest against hand-written
+ * 2D-synchronization.
+ * The loop nest of the 2dsync example is executed on a growing number of threads,
+ * once partitioned cyclically by hand and synchronized per tile of TILE inner
+ * iterations through a 2D-synchronization manager, as in the example, and once
+ * through vftasks_wavefront_2d with tiles of TILE by TILE iterations.
+ *
+ * Usage: measure_wavefront [max_threads]
+ */
+
+#include <vftasks.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define M 1024
+#define N 1024
+#define TILE 64
+#define NUM_RUNS 5
+#define DEFAULT_MAX_THREADS 8
+
+int a[M][N];
+vftasks_pool_t *pool;
+vftasks_2d_sync_mgr_t *sync_mgr;
+
+/* pack function arguments in a struct */
+typedef struct
+{
+  int start;
+  int stride;
+} task_t;
+
+/* The original loop looked like this:
+ * for (i = 0; i < M; i++)
+ *   for (j = 0; j < N; j++)
+ *     a[i][j] = (i > 0 && j + 1 < N) ? i * j + a[i - 1][j + 1] : i * j;
+ */
+void tile(void *ctx, int x_begin, int x_end, int y_begin, int y_end)
+{
+  int (*b)[N] = (int (*)[N])ctx;
+  int i, j;
+
+  for (i = x_begin; i < x_end; i++)
+    for (j = y_begin; j < y_end; j++)
+      b[i][j] = (i > 0 && j + 1 < N) ? i * j + b[i - 1][j + 1] : i * j;
+}
+
+/* a partition of the hand-written version */
+void task(void *raw_args)
+{
+  task_t *args = (task_t *)raw_args;
+  int i, k;
+
+  for (i = args->start; i < M; i += args->stride)
+  {
+    for (k = 0; k < N; k += TILE)
+    {
+      vftasks_wait_2d_range(sync_mgr, i, k, k + TILE);
+      tile(a, i, i + 1, k, k + TILE);
+      vftasks_signal_2d_range(sync_mgr, i, k, k + TILE);
+    }
+  }
+}
+
+/* run the hand-written version on a given number of threads and return the elapsed
+   time */
+uint64_t run_by_hand(int num_threads)
+{
+  task_t *args;
+  uint64_t time;
+  int k;
+
+  sync_mgr = vftasks_create_2d_sync_mgr(M, N, 1, -1);
+
+  /* put the arguments on the heap so the worker threads can access them */
+  args = calloc(num_threads, sizeof(task_t));
+
+  vftasks_timer_start(&time);
+
+  for (k = 0; k < num_threads - 1; k++)
+  {
+    args[k].start = k;
+    args[k].stride = num_threads;
+    vftasks_submit(pool, task, &args[k], 0);
+  }
+
+  /* the last partition is executed by the main thread */
+  args[k].start = k;
+  args[k].stride = num_threads;
+  task(&args[k]);
+
+  for (k = 0; k < num_threads - 1; k++)
+    vftasks_get(pool);
+
+  time = vftasks_timer_stop(&time);
+
+  free(args);
+  vftasks_destroy_2d_sync_mgr(sync_mgr);
+
+  return time;
+}
+
+/* run the wavefront version on all threads of the pool and return the elapsed
+   time */
+uint64_t run_wavefront(int num_threads)
+{
+  uint64_t time;
+
+  /* the pool has been created with num_threads - 1 workers, all of which take
+     part along with the calling thread */
+  (void)num_threads;
+
+  vftasks_timer_start(&time);
+  vftasks_wavefront_2d(pool, M, N, 1, -1, TILE, TILE, tile, a);
+
+  return vftasks_timer_stop(&time);
+}
+
+/* check the result against that of the 2dsync example */
+int check()
+{
+  int i, j;
+  int acc = 0;
+
+  for (i = 0; i < M; i++)
+    for (j = 0; j < N; j++)
+      acc += a[i][j];
+
+  return acc == 438488320;
+}
+
+/* the best time out of a number of runs */
+uint64_t best_of(uint64_t (*run)(int), int num_threads)
+{
+  uint64_t best = 0, time;
+  int r;
+
+  for (r = 0; r < NUM_RUNS; r++)
+  {
+    time = run(num_threads);
+    if (r == 0 || time < best) best = time;
+  }
+
+  return best;
+}
+
+int main(int argc, char *argv[])
+{
+  int max_threads = argc > 1 ? atoi(argv[1]) : DEFAULT_MAX_THREADS;
+  int num_threads;
+  uint64_t by_hand, wavefront;
+
+  if (max_threads < 2)
+  {
+    fprintf(stderr, "usage: %s [max_threads >= 2]\n", argv[0]);
+    return 1;
+  }
+
+  printf("threads  by hand (ns)  wavefront (ns)  speedup\n");
+  for (num_threads = 2; num_threads <= max_threads; num_threads++)
+  {
+    /* one partition is executed by the main thread */
+    pool = vftasks_create_pool(num_threads - 1, 0);
+
+    by_hand = best_of(run_by_hand, num_threads);
+    wavefront = best_of(run_wavefront, num_threads);
+    printf("%7d  %12lu  %14lu  %7.2f\n",
+           num_threads,
+           (unsigned long)by_hand,
+           (unsigned long)wavefront,
+           (double)by_hand / wavefront);
+
+    vftasks_destroy_pool(pool);
+  }
+
+  return check() ? 0 : 1;
+}
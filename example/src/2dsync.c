@@ -13,6 +13,7 @@
 #define M 1024
 #define N 1024
 #define N_PARTITIONS 4
+#define TILE 64
 
 volatile int a[M][N];
 vftasks_pool_t *pool;
@@ -29,26 +30,30 @@ void task(void *raw_args)
 {
   task_t *args = (task_t *)raw_args;
 
-  int i, j;
+  int i, j, k;
 
   for (i = args->start; i < M; i += args->stride)
   {
-    for (j = 0; j < N; j++)
+    /* synchronize per tile of TILE inner iterations rather than per iteration */
+    for (k = 0; k < N; k += TILE)
     {
       /* synchronize with other partition */
-      vftasks_wait_2d(sync_mgr, i, j);
+      vftasks_wait_2d_range(sync_mgr, i, k, k + TILE);
 
-      if (i > 0 && j + 1 < N) /* this causes an inter-task dependency */
-      {
-        a[i][j] = i * j + a[i - 1][j + 1];
-      }
-      else
+      for (j = k; j < k + TILE; j++)
       {
-        a[i][j] = i * j;
+        if (i > 0 && j + 1 < N) /* this causes an inter-task dependency */
+        {
+          a[i][j] = i * j + a[i - 1][j + 1];
+        }
+        else
+        {
+          a[i][j] = i * j;
+        }
       }
 
       /* signal other waiting partitions */
-      vftasks_signal_2d(sync_mgr, i, j);
+      vftasks_signal_2d_range(sync_mgr, i, k, k + TILE);
     }
   }
 }
@@ -24,8 +24,8 @@
  */
 typedef struct info_s
 {
-  pthread_mutex_t mutex;   /* mutex                     */
-  pthread_cond_t cond;     /* resume-condition variable */
+  vftasks_eventcount_t *room;  /* signalled when room becomes available */
+  vftasks_eventcount_t *data;  /* signalled when data becomes available */
 }
 info_t;
 
@@ -90,27 +90,21 @@ void *writer(void *arg)
  */
 void suspend_writer(vftasks_wport_t *wport)
 {
-  info_t *info;  /* application data */
+  info_t *info;      /* application data */
+  unsigned int key;  /* key for waiting  */
 
   /* retrieve application data */
   info = vftasks_get_chan_info(vftasks_chan_of_wport(wport));
 
-  /* lock */
-  pthread_mutex_lock(&info->mutex);
+  /* prepare to wait */
+  key = vftasks_prepare_wait(info->room);
 
   /* check whether suspend condition still applies */
-  if (!vftasks_room_available(wport))
+  if (vftasks_room_available(wport))
+    vftasks_cancel_wait(info->room, key);
+  else
     /* condition still applies; suspend */
-    if (pthread_cond_wait(&info->cond, &info->mutex))
-    {
-      fprintf(stderr, "writer: waiting for resume condition failed\n");
-      pthread_mutex_unlock(&info->mutex);
-      vftasks_flush_data(wport);
-      pthread_exit(NULL);
-    }
-
-  /* unlock */
-  pthread_mutex_unlock(&info->mutex);
+    vftasks_commit_wait(info->room, key);
 }
 
 /* called when the writer is prompted to resume
@@ -122,20 +116,8 @@ void resume_writer(vftasks_wport_t *wport)
   /* retrieve application data */
   info = vftasks_get_chan_info(vftasks_chan_of_wport(wport));
 
-  /* lock */
-  pthread_mutex_lock(&info->mutex);
-
-  /* broadcast resume condition */
-  if (pthread_cond_broadcast(&info->cond))
-  {
-    fprintf(stderr, "writer: broadcasting resume condition failed\n");
-    pthread_mutex_unlock(&info->mutex);
-    vftasks_flush_data(wport);
-    pthread_exit(NULL);
-  }
-
-  /* unlock */
-  pthread_mutex_unlock(&info->mutex);
+  /* notify writer */
+  vftasks_notify(info->room);
 }
 
 /* reader routine
@@ -162,27 +144,21 @@ void *reader(void *arg)
  */
 void suspend_reader(vftasks_rport_t *rport)
 {
-  info_t *info;  /* application data */
+  info_t *info;      /* application data */
+  unsigned int key;  /* key for waiting  */
 
   /* retrieve application data */
   info = vftasks_get_chan_info(vftasks_chan_of_rport(rport));
 
-  /* lock */
-  pthread_mutex_lock(&info->mutex);
+  /* prepare to wait */
+  key = vftasks_prepare_wait(info->data);
 
   /* check whether suspend condition still applies */
-  if (!vftasks_data_available(rport))
+  if (vftasks_data_available(rport))
+    vftasks_cancel_wait(info->data, key);
+  else
     /* condition still applies; suspend */
-    if (pthread_cond_wait(&info->cond, &info->mutex))
-    {
-      fprintf(stderr, "reader: waiting for resume condition failed\n");
-      pthread_mutex_unlock(&info->mutex);
-      vftasks_flush_room(rport);
-      pthread_exit(NULL);
-    }
-
-  /* unlock */
-  pthread_mutex_unlock(&info->mutex);
+    vftasks_commit_wait(info->data, key);
 }
 
 /* called when the reader is prompted to resume
@@ -194,20 +170,8 @@ void resume_reader(vftasks_rport_t *rport)
   /* retrieve application data */
   info = vftasks_get_chan_info(vftasks_chan_of_rport(rport));
 
-  /* lock */
-  pthread_mutex_lock(&info->mutex);
-
-  /* broadcast resume condition */
-  if (pthread_cond_broadcast(&info->cond))
-  {
-    fprintf(stderr, "reader: broadcasting resume condition failed\n");
-    pthread_mutex_unlock(&info->mutex);
-    vftasks_flush_room(rport);
-    pthread_exit(NULL);
-  }
-
-  /* unlock */
-  pthread_mutex_unlock(&info->mutex);
+  /* notify reader */
+  vftasks_notify(info->data);
 }
 
 /* entry point
@@ -271,23 +235,14 @@ int main()
   vftasks_set_min_room(chan, LOW_WATER_MARK);
   vftasks_set_min_data(chan, HIGH_WATER_MARK);
 
-  /* initialize mutex */
-  rc = pthread_mutex_init(&info.mutex, NULL);
-  if (rc)
-  {
-    fprintf(stderr, "mutex initialization failed\n");
-    vftasks_destroy_write_port(wport, &mem_mgr);
-    vftasks_destroy_read_port(rport, &mem_mgr);
-    vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
-    return 1;
-  }
-
-  /* initialize condition variable */
-  rc = pthread_cond_init(&info.cond, NULL);
-  if (rc)
+  /* create eventcounts */
+  info.room = vftasks_create_eventcount();
+  info.data = vftasks_create_eventcount();
+  if (info.room == NULL || info.data == NULL)
   {
-    fprintf(stderr, "condition-variable initialization failed\n");
-    pthread_mutex_destroy(&info.mutex);
+    fprintf(stderr, "eventcount creation failed\n");
+    vftasks_destroy_eventcount(info.room);
+    vftasks_destroy_eventcount(info.data);
     vftasks_destroy_write_port(wport, &mem_mgr);
     vftasks_destroy_read_port(rport, &mem_mgr);
     vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
@@ -302,8 +257,8 @@ int main()
   if (rc)
   {
     fprintf(stderr, "writer-thread creation failed\n");
-    pthread_cond_destroy(&info.cond);
-    pthread_mutex_destroy(&info.mutex);
+    vftasks_destroy_eventcount(info.room);
+    vftasks_destroy_eventcount(info.data);
     vftasks_destroy_write_port(wport, &mem_mgr);
     vftasks_destroy_read_port(rport, &mem_mgr);
     vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
@@ -316,8 +271,8 @@ int main()
   {
     fprintf(stderr, "reader-thread creation failed\n");
     pthread_cancel(writer_thread);
-    pthread_cond_destroy(&info.cond);
-    pthread_mutex_destroy(&info.mutex);
+    vftasks_destroy_eventcount(info.room);
+    vftasks_destroy_eventcount(info.data);
     vftasks_destroy_write_port(wport, &mem_mgr);
     vftasks_destroy_read_port(rport, &mem_mgr);
     vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
@@ -331,8 +286,8 @@ int main()
     fprintf(stderr, "join of writer thread failed\n");
     pthread_cancel(writer_thread);
     pthread_cancel(reader_thread);
-    pthread_cond_destroy(&info.cond);
-    pthread_mutex_destroy(&info.mutex);
+    vftasks_destroy_eventcount(info.room);
+    vftasks_destroy_eventcount(info.data);
     vftasks_destroy_write_port(wport, &mem_mgr);
     vftasks_destroy_read_port(rport, &mem_mgr);
     vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
@@ -345,17 +300,17 @@ int main()
   {
     fprintf(stderr, "join of reader thread failed\n");
     pthread_cancel(reader_thread);
-    pthread_cond_destroy(&info.cond);
-    pthread_mutex_destroy(&info.mutex);
+    vftasks_destroy_eventcount(info.room);
+    vftasks_destroy_eventcount(info.data);
     vftasks_destroy_write_port(wport, &mem_mgr);
     vftasks_destroy_read_port(rport, &mem_mgr);
     vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
     return 1;
   }
 
-  /* destroy condition variable, mutex, ports, and channel */
-  pthread_cond_destroy(&info.cond);
-  pthread_mutex_destroy(&info.mutex);
+  /* destroy eventcounts, ports, and channel */
+  vftasks_destroy_eventcount(info.room);
+  vftasks_destroy_eventcount(info.data);
   vftasks_destroy_write_port(wport, &mem_mgr);
   vftasks_destroy_read_port(rport, &mem_mgr);
   vftasks_destroy_chan(chan, &mem_mgr, &mem_mgr);
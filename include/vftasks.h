@@ -94,6 +94,11 @@
  * Reader/writer watermarks are set using the functions vftasks_set_min_data() and
  * vftasks_set_min_room().
  *
+ * Along the same lines, the writer can be told to make the tokens it releases
+ * visible to the reader only once per number of tokens, which is set using the
+ * function vftasks_set_publication_interval(), so that the channel state moves
+ * between the writer's and the reader's caches less often.
+ *
  * \section sec_block_spin Blocking or spinning
  * vfTasks allows the programmer to specify the behavior of reader/writer
  * threads when the FIFO is empty/full. The default behavior is to let
@@ -106,6 +111,13 @@
  * means of hooks. The hooks can be set using the function
  * vftasks_install_chan_hooks().
  *
+ * For the common case, vftasks_install_default_blocking_hooks() installs
+ * hooks that let a thread poll the channel a given number of times and then
+ * block on an eventcount of the channel until the low- or high-water mark is
+ * passed.  A thread that acquires tokens without having to wait does not
+ * touch the eventcounts, and a thread that releases tokens only makes a
+ * system call if the other side has actually blocked.
+ *
  * \section sec_tokens_stuff Tokens, channels and ports
  * Tokens are the basic unit of information that can be communicated
  * between readers and writers. Tokens are associated with buffers
@@ -119,6 +131,12 @@
  *    - the reader consumes the data and when done, releases the token
  *      by calling vftasks_release_room().
  *
+ * To move many small tokens, the writer and reader can instead acquire
+ * runs of consecutive tokens by calling vftasks_acquire_room_n() and
+ * vftasks_acquire_data_n(), and release them by calling
+ * vftasks_release_data_n() and vftasks_release_room_n(), so that the
+ * channel state is updated once per run rather than once per token.
+ *
  * In order to use a vfTasks FIFO channel, the program must create:
  *    - a channel, by means of vftasks_create_chan()
  *    - a read port, by means of vftasks_create_read_port()
@@ -127,6 +145,26 @@
  * When creating a channel, the program must specify the amount of
  * tokens it can contain, and the size of each token.
  *
+ * \section sec_mpmc Multiple writers and readers
+ * A channel created by vftasks_create_chan() connects a single writer to a single
+ * reader.  A channel created by vftasks_create_chan_with_kind() can instead accept
+ * multiple write ports (VFTASKS_CHAN_MPSC), multiple read ports
+ * (VFTASKS_CHAN_SPMC), or both (VFTASKS_CHAN_MPMC), so that, for instance, the
+ * workers of a pool can all drain the same queue.  Every token then carries a
+ * sequence number that tells for which position in the FIFO it has been released
+ * to which side, and the ports on a side with multiple ports claim positions with
+ * an atomic compare-and-swap.  Tokens, watermarks and hooks are used as on any
+ * other channel.
+ *
+ * \section sec_flat Flat token layout
+ * By default, a channel keeps its token descriptors in an array of their own,
+ * allocated from the control space, and each descriptor points to the token's
+ * contents in the FIFO buffer.  A kind that includes VFTASKS_CHAN_FLAT instead
+ * places every descriptor in the FIFO buffer, right before the contents it
+ * describes, so that acquiring a token and accessing its contents touch the same
+ * cache line and the control space holds no per-token data.  The layout does not
+ * change how tokens are acquired, accessed, or released.
+ *
  * \section sec_memory Custom memory management
  * Channel and channel port functions take additional arguments
  * for memory allocation and deallocation. In most common cases,
@@ -226,6 +264,18 @@
  * vftasks_destroy_1d_sync_mgr(sync_mgr);
  * \endcode
  *
+ * By default, every wait and signal is a semaphore operation.  In a loop like this
+ * one, where the dependency distance is large compared to the number of threads,
+ * most waits are satisfied already; a manager created in spin mode then makes each
+ * such wait a single load:
+ * \code
+ * vftasks_1d_sync_attr_t attr;
+ *
+ * vftasks_init_1d_sync_attr(&attr);
+ * attr.mode = VFTASKS_SYNC_SPIN;
+ * sync_mgr = vftasks_create_1d_sync_mgr_with_attr(4, 32, &attr);
+ * \endcode
+ *
  * \section sec_1d_sync_example_nz Example: 1D-synchronization (nonzero-based indexing)
  *
  * Now assume that the loop from the previous example was written as
@@ -252,6 +302,37 @@
  * vftasks_destroy_1d_sync_mgr(sync_mgr);
  * \endcode
  *
+ * \section sec_cross_sync_example Example: synchronization between two loops
+ * When one loop consumes what another produces,
+ * \code
+ * for (i = 0; i < 1024; i++)
+ *   a[i] = f(i);
+ * for (j = 4; j < 1024; j++)
+ *   b[j] = g(a[j - 4]);
+ * \endcode
+ * the second loop does not have to wait for the first to finish: with both loops
+ * partitioned over threads of their own, the first one in a round-robin fashion
+ * over four threads, a cross-loop synchronization manager lets every iteration of
+ * the second loop wait for just the iteration of the first loop it consumes from:
+ * \code
+ * vftasks_cross_sync_mgr_t *sync_mgr = vftasks_create_cross_sync_mgr(4, 4, NULL);
+ *
+ * for (i = 0; i < 1024; i++)
+ * {
+ *   a[i] = f(i);
+ *   vftasks_signal_cross(sync_mgr, i);
+ * }
+ *
+ * for (j = 4; j < 1024; j++)
+ * {
+ *   vftasks_wait_cross(sync_mgr, j);
+ *   b[j] = g(a[j - 4]);
+ * }
+ *
+ * vftasks_destroy_cross_sync_mgr(sync_mgr);
+ * \endcode
+ * The iterations of the second loop may be distributed over its threads in any way.
+ *
  * \section sec_2d_sync_example Example: 2D-synchronization
  * Consider the following program fragment:
  * \code
@@ -293,6 +374,109 @@
  * vftasks_destroy_2d_sync_mgr(sync_mgr);
  * \endcode
  *
+ * \section sec_nd_sync_example Example: ND-synchronization
+ * Loop nests of any depth, with any number of dependencies, are synchronized through
+ * an ND-synchronization manager, which is given a distance vector per dependency.
+ * For the stencil
+ * \code
+ * for (i = 1; i < 64; i++)
+ *   for (j = 1; j < 64; j++)
+ *     for (k = 1; k < 64; k++)
+ *       a[i][j][k] = a[i - 1][j][k] + a[i][j - 1][k] + a[i - 1][j][k - 1];
+ * \endcode
+ * one writes:
+ * \code
+ * int dims[3] = {64, 64, 64};
+ * int dists[3][3] = {{1, 0, 0}, {0, 1, 0}, {1, 0, 1}};
+ * int index[3];
+ * vftasks_nd_sync_mgr_t *sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 3, &dists[0][0]);
+ *
+ * for (index[0] = 0; index[0] < 64; index[0]++)
+ *   for (index[1] = 0; index[1] < 64; index[1]++)
+ *     for (index[2] = 0; index[2] < 64; index[2]++)
+ *     {
+ *       vftasks_wait_nd(sync_mgr, index);
+ *       if (index[0] > 0 && index[1] > 0 && index[2] > 0)
+ *       {
+ *         ...
+ *       }
+ *       vftasks_signal_nd(sync_mgr, index);
+ *     }
+ * vftasks_destroy_nd_sync_mgr(sync_mgr);
+ * \endcode
+ * The iterations that the stencil skips are visited all the same: the manager counts
+ * the signals from index 0 onwards, so an iteration that is never signalled blocks
+ * the ones that depend on it.  Here, the outer loop is partitioned over the threads.  The dependency within an
+ * outer iteration, (0, 1, 0), is satisfied by the order of execution and the one on
+ * (1, 0, 1) by waiting for (1, 0, 0), so that a single wait remains per iteration.
+ *
+ * \section sec_doacross_example Example: doacross synchronization
+ * When the dependency distances of a loop are only known at run time, and may differ
+ * from iteration to iteration, as in
+ * \code
+ * for (i = 1; i < 1024; i++)
+ *   a[i] += a[i - k[i]] + a[i - m[i]];
+ * \endcode
+ * with k[i] and m[i] between 1 and i, every iteration names the iterations it waits
+ * for through a doacross-synchronization manager:
+ * \code
+ * vftasks_doacross_mgr_t *sync_mgr = vftasks_create_doacross_mgr(1024);
+ *
+ * for (i = 0; i < 1024; i++)
+ * {
+ *   if (i > 0)
+ *   {
+ *     vftasks_wait_doacross(sync_mgr, i - k[i]);
+ *     vftasks_wait_doacross(sync_mgr, i - m[i]);
+ *     a[i] += a[i - k[i]] + a[i - m[i]];
+ *   }
+ *   vftasks_signal_doacross(sync_mgr, i);
+ * }
+ * vftasks_destroy_doacross_mgr(sync_mgr);
+ * \endcode
+ * Iteration 0 has nothing to compute, but is signalled all the same, as the later
+ * iterations may wait for it.  The iterations may be distributed over the threads in
+ * any way, statically or dynamically, as long as every thread executes its
+ * iterations in increasing order.
+ *
+ * \section sec_ordered_example Example: ordered sections
+ * A partitioned loop that appends its results to an output stream must do so in
+ * iteration order, while the rest of the loop body runs concurrently:
+ * \code
+ * vftasks_ordered_t *ordered = vftasks_create_ordered();
+ *
+ * for (i = 0; i < 1024; i++)
+ * {
+ *   r = compute(i);
+ *   vftasks_ordered_begin(ordered, i);
+ *   fwrite(&r, sizeof(r), 1, out);
+ *   vftasks_ordered_end(ordered, i);
+ * }
+ * vftasks_destroy_ordered(ordered);
+ * \endcode
+ *
+ * \section sec_wavefront_example Example: wavefront execution
+ * The loop nest of the 2D-synchronization example can also be handed to the pool as
+ * a whole, in which case it needs no synchronization calls at all:
+ * \code
+ * void body(void *ctx, int x_begin, int x_end, int y_begin, int y_end)
+ * {
+ *   int (*a)[16] = (int (*)[16])ctx;
+ *
+ *   for (i = x_begin; i < x_end; i++)
+ *     for (j = y_begin; j < y_end; j++)
+ *       if (i >= 2 && j < 15)
+ *         a[i][j] += a[i - 2][j + 1];
+ * }
+ *
+ * ...
+ *
+ * vftasks_wavefront_2d(pool, 1024, 16, 2, -1, 64, 8, body, a);
+ * \endcode
+ * The iteration space is cut into tiles of 64 by 8 iterations, and each tile is
+ * executed, by the calling thread or one of the workers available to it, as soon as
+ * the tiles it depends on have been executed.
+ *
  */
 
 
@@ -313,96 +497,1372 @@ typedef struct vftasks_pool_s vftasks_pool_t;
 
 /** Represents a task that is to be executed in the worker-thread pool.
  */
-typedef void (vftasks_task_t)(void *);
+typedef void (vftasks_task_t)(void *);
+
+/** Represents a worker's arena of scratch memory.
+ */
+typedef struct vftasks_arena_s vftasks_arena_t;
+
+/** Represents a task that is handed the scratch arena of the worker that executes it.
+ */
+typedef void (vftasks_arena_task_t)(void *, vftasks_arena_t *);
+
+/** Represents a task that is executed in the worker-thread pool after a delay,
+ *  either once or periodically.
+ */
+typedef struct vftasks_timed_task_s vftasks_timed_task_t;
+
+/** Holds attributes that control the creation of a worker-thread pool.
+ *
+ *  Attributes should be initialized through vftasks_init_pool_attr() before any
+ *  of them are set.
+ */
+typedef struct vftasks_pool_attr_s
+{
+  size_t stack_size;        /**< stack size of the worker threads; 0 selects the
+                                 platform default */
+  size_t guard_size;        /**< size of the guard area below the stack of each
+                                 worker thread; 0 selects the platform default */
+  const char *name;         /**< prefix for the names of the worker threads, as
+                                 shown by debuggers and profilers; NULL leaves the
+                                 threads unnamed */
+  size_t arena_block_size;  /**< size of the blocks that the scratch arenas of the
+                                 workers reserve */
+  uint64_t coalesce_ns;     /**< if nonzero, the pool measures the execution time
+                                 of tasks and executes task functions that were
+                                 observed to take less than this many nanoseconds
+                                 inline in vftasks_submit_independent(); 0
+                                 disables this adaptive mode.  An inlined task
+                                 runs to completion before the submitter
+                                 continues, so a task that waits for the
+                                 submitter would deadlock; vftasks_submit() never
+                                 inlines */
+  uint64_t timer_tick_ns;   /**< resolution of the timers of the pool; timed tasks
+                                 are executed at tick boundaries */
+}
+vftasks_pool_attr_t;
+
+/** Holds statistics on a worker-thread pool.
+ */
+typedef struct vftasks_pool_stats_s
+{
+  int num_workers;          /**< number of worker threads in the pool */
+  size_t worker_memory;     /**< number of bytes allocated for the pool and the
+                                 records of its workers */
+  size_t stack_memory;      /**< number of bytes reserved for the stacks of the
+                                 worker threads */
+  size_t arena_high_water;  /**< largest number of scratch bytes that any worker had
+                                 in use at the same time */
+  size_t arena_reserved;    /**< total number of bytes held by the workers' arenas */
+  unsigned long tasks_submitted;  /**< number of tasks submitted to the pool */
+  unsigned long tasks_inlined;    /**< number of submitted tasks that were executed
+                                       inline rather than dispatched to a worker;
+                                       tasks_inlined / tasks_submitted is the
+                                       coalescing ratio */
+}
+vftasks_pool_stats_t;
+
+/** States of a worker, as reported by vftasks_get_pool_snapshot().
+ */
+#define VFTASKS_WORKER_PARKED   0  /**< blocked, waiting for work */
+#define VFTASKS_WORKER_SPINNING 1  /**< busy-waiting for work */
+#define VFTASKS_WORKER_BUSY     2  /**< executing a task or a timed task */
+
+/** Number of distinct worker states.
+ */
+#define VFTASKS_NUM_WORKER_STATES 3
+
+/** Holds the state of a single worker at the moment the pool was inspected.
+ */
+typedef struct vftasks_worker_snapshot_s
+{
+  int state;             /**< VFTASKS_WORKER_PARKED, VFTASKS_WORKER_SPINNING or
+                              VFTASKS_WORKER_BUSY */
+  vftasks_task_t *task;  /**< the task function the worker is executing, if known;
+                              NULL if the worker is not busy, or is executing timed
+                              tasks or a task that takes an arena */
+  vftasks_arena_task_t *arena_task;  /**< the task function the worker is
+                                          executing, if it takes an arena; NULL
+                                          otherwise */
+}
+vftasks_worker_snapshot_t;
+
+/** Accumulates snapshots of a worker-thread pool into utilization histograms.
+ */
+typedef struct vftasks_sampler_s vftasks_sampler_t;
+
+
+__BEGIN_DECLS
+
+/* ***************************************************************************
+ * Creation and destruction of worker-thread pools
+ * ***************************************************************************/
+
+/** Creates a worker-thread pool of a given size.
+ *
+ *  @param  num_workers  The number of worker threads in the pool.
+ *  @param  busy_wait    When set to non-zero, the workers will be in a busy-wait loop
+ *                       until work is submitted; otherwise they wait
+ *                       without consuming resources.
+ *
+ *  @return
+ *    On success, a pointer to the pool.
+ *    On failure, NULL.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+vftasks_pool_t *vftasks_create_pool(int num_workers, int busy_wait);
+
+/** Initializes a set of pool attributes with the default values.
+ *
+ *  @param  attr  A pointer to the attributes.
+ */
+void vftasks_init_pool_attr(vftasks_pool_attr_t *attr);
+
+/** Creates a worker-thread pool of a given size with given attributes.
+ *
+ *  @param  num_workers  The number of worker threads in the pool.
+ *  @param  busy_wait    When set to non-zero, the workers will be in a busy-wait loop
+ *                       until work is submitted; otherwise they wait
+ *                       without consuming resources.
+ *  @param  attr         A pointer to the attributes; if NULL, the default
+ *                       attributes are used.
+ *
+ *  @return
+ *    On success, a pointer to the pool.
+ *    On failure, NULL.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+vftasks_pool_t *vftasks_create_pool_with_attr(int num_workers,
+                                              int busy_wait,
+                                              const vftasks_pool_attr_t *attr);
+
+/** Destroys a given worker-thread pool.
+ *
+ *  @param  pool  A pointer to the pool.
+ */
+void vftasks_destroy_pool(vftasks_pool_t *pool);
+
+/* ***************************************************************************
+ * Execution of parallel tasks
+ * ***************************************************************************/
+
+/** Submits a specified instance of a task to a given worker-thread pool.
+ *
+ *  Executes the task in parallel on a thread from the pool.
+ *
+ *  @param  pool         A pointer to the pool.
+ *  @param  task         A pointer to the task.
+ *  @param  args         A pointer to the arguments for the instance.
+ *  @param  num_workers  The number of additional worker threads that will be required
+ *                       for the execution of the task.
+ *
+ *  @return
+ *    On success, 0
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_submit(vftasks_pool_t *pool,
+                   vftasks_task_t *task,
+                   void *args,
+                   int num_workers);
+
+/** Submits a specified instance of a task that is independent of the submitting
+ *  thread to a given worker-thread pool.
+ *
+ *  Behaves like vftasks_submit() for a task that requires no additional workers,
+ *  but if the pool was created with a nonzero coalesce_ns attribute and the task
+ *  function was observed to take less time than that, the task is executed inline,
+ *  before the function returns.  The task must therefore never wait for the
+ *  submitting thread, nor for tasks that the submitting thread has yet to submit;
+ *  an inlined task has no workers at its disposal.  The task is still paired up
+ *  with a call to vftasks_get().
+ *
+ *  @param  pool  A pointer to the pool.
+ *  @param  task  A pointer to the task.
+ *  @param  args  A pointer to the arguments for the instance.
+ *
+ *  @return
+ *    On success, 0
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_submit_independent(vftasks_pool_t *pool,
+                               vftasks_task_t *task,
+                               void *args);
+
+/** Blocks until the most recent submitted task is finished.
+ *
+ *  @param  pool    A pointer to the pool.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_get(vftasks_pool_t *pool);
+
+/** Retrieves the number of workers in a given worker-thread pool to which the
+ *  calling thread can submit tasks that require no additional workers.
+ *
+ *  @param  pool  A pointer to the pool.
+ *
+ *  @return
+ *    The number of workers; 0 if the calling thread has no workers at its disposal.
+ */
+int vftasks_get_num_available_workers(vftasks_pool_t *pool);
+
+/* ***************************************************************************
+ * Per-worker scratch arenas
+ * ***************************************************************************/
+
+/** Submits a specified instance of a task that uses scratch memory to a given
+ *  worker-thread pool.
+ *
+ *  Behaves like vftasks_submit(), but the task is passed a pointer to the scratch
+ *  arena of the worker that executes it.  Allocating from the arena through
+ *  vftasks_worker_alloc() does not contend with other workers.  Unless the arena is in
+ *  persistent mode, all memory allocated from it is released when the task finishes.
+ *
+ *  @param  pool         A pointer to the pool.
+ *  @param  task         A pointer to the task.
+ *  @param  args         A pointer to the arguments for the instance.
+ *  @param  num_workers  The number of additional worker threads that will be required
+ *                       for the execution of the task.
+ *
+ *  @return
+ *    On success, 0
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_submit_arena_task(vftasks_pool_t *pool,
+                              vftasks_arena_task_t *task,
+                              void *args,
+                              int num_workers);
+
+/** Allocates a block of scratch memory from a worker's arena.
+ *
+ *  The memory is suitably aligned for any scalar type.  It must not be freed
+ *  explicitly; it is released when the arena is reset.  Arena memory is reserved by
+ *  the worker thread itself, so on NUMA systems it is placed on the worker's node.
+ *
+ *  @param  arena  A pointer to the arena, as passed to the task.
+ *  @param  size   The size of the memory block.
+ *
+ *  @return
+ *    On success, a pointer to the memory block.
+ *    On failure, NULL.
+ */
+void *vftasks_worker_alloc(vftasks_arena_t *arena, size_t size);
+
+/** Releases all memory allocated from a worker's arena.
+ *
+ *  The memory remains reserved by the arena, so that subsequent allocations are
+ *  served without calling malloc.
+ *
+ *  @param  arena  A pointer to the arena.
+ */
+void vftasks_reset_arena(vftasks_arena_t *arena);
+
+/** Selects whether a worker's arena is reset at the end of every task.
+ *
+ *  In persistent mode, allocations outlive the task that made them and are only
+ *  released by an explicit call to vftasks_reset_arena().
+ *
+ *  @param  arena       A pointer to the arena.
+ *  @param  persistent  When set to non-zero, the arena is not reset at the end of a
+ *                      task.
+ */
+void vftasks_set_arena_persistent(vftasks_arena_t *arena, int persistent);
+
+/* ***************************************************************************
+ * Pool statistics
+ * ***************************************************************************/
+
+/** Retrieves statistics on a given worker-thread pool.
+ *
+ *  The statistics may be sampled while tasks are running.
+ *
+ *  @param  pool   A pointer to the pool.
+ *  @param  stats  A pointer to the location in which to store the statistics.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_get_pool_stats(vftasks_pool_t *pool, vftasks_pool_stats_t *stats);
+
+/* ***************************************************************************
+ * Pool introspection
+ * ***************************************************************************/
+
+/** Retrieves the current state of every worker in a given worker-thread pool.
+ *
+ *  The snapshot is wait-free: it reads a single state word per worker, which only
+ *  that worker writes, and never writes to memory shared with the workers.  It can
+ *  therefore be taken from a monitoring thread at a high frequency.  As the workers
+ *  keep running, the states of different workers are not taken at exactly the same
+ *  moment, and the task of a worker that just finished may be reported as NULL.
+ *
+ *  @param  pool      A pointer to the pool.
+ *  @param  snapshot  A pointer to an array in which to store the states of the
+ *                    workers; it must have as many elements as the pool has
+ *                    workers (see vftasks_get_pool_stats()).
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_get_pool_snapshot(vftasks_pool_t *pool,
+                              vftasks_worker_snapshot_t *snapshot);
+
+/** Creates a sampler for a given worker-thread pool.
+ *
+ *  A sampler is meant to be driven by a single monitoring thread, which calls
+ *  vftasks_sample_pool() at the rate of its choosing.
+ *
+ *  @param  pool  A pointer to the pool.
+ *
+ *  @return
+ *    On success, a pointer to the sampler.
+ *    On failure, NULL.
+ */
+vftasks_sampler_t *vftasks_create_sampler(vftasks_pool_t *pool);
+
+/** Destroys a given sampler.
+ *
+ *  @param  sampler  A pointer to the sampler.
+ */
+void vftasks_destroy_sampler(vftasks_sampler_t *sampler);
+
+/** Takes a snapshot of the pool of a given sampler and adds it to the histograms.
+ *
+ *  The histograms are cumulative: they count all samples taken since the sampler
+ *  was created or last reset.  To observe the utilization over successive windows,
+ *  retrieve the histograms and reset the sampler at the end of each window.
+ *
+ *  @param  sampler  A pointer to the sampler.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_sample_pool(vftasks_sampler_t *sampler);
+
+/** Clears the histograms of a given sampler, starting a new sampling window.
+ *
+ *  @param  sampler  A pointer to the sampler.
+ */
+void vftasks_reset_sampler(vftasks_sampler_t *sampler);
+
+/** Retrieves the histogram of the number of busy workers in the current window.
+ *
+ *  @param  sampler    A pointer to the sampler.
+ *  @param  histogram  A pointer to an array of one more element than the pool has
+ *                     workers; element k receives the number of samples in which
+ *                     exactly k workers were busy.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_get_busy_histogram(vftasks_sampler_t *sampler, unsigned long *histogram);
+
+/** Retrieves the number of samples in the current window in which a given worker
+ *  was in each state.
+ *
+ *  @param  sampler  A pointer to the sampler.
+ *  @param  worker   The index of the worker in the snapshots.
+ *  @param  counts   A pointer to an array of VFTASKS_NUM_WORKER_STATES elements,
+ *                   indexed by state.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_get_worker_state_counts(vftasks_sampler_t *sampler,
+                                    int worker,
+                                    unsigned long *counts);
+
+/* ***************************************************************************
+ * Timed tasks
+ * ***************************************************************************/
+
+/** Creates a timed task for a given worker-thread pool.
+ *
+ *  Timed tasks are kept in a hierarchical timer wheel that is serviced by the
+ *  workers of the pool: the last worker sleeps until the next timed task is due,
+ *  and any worker that finishes a task executes the timed tasks that have expired.
+ *  Time is measured on the monotonic clock.  Scheduling, rescheduling and cancelling
+ *  take constant time.
+ *
+ *  A timed task is executed on a worker thread, in between the tasks submitted to
+ *  that worker.  It has no workers at its disposal: vftasks_submit fails within a
+ *  timed task, and vftasks_get_num_available_workers returns 0.  Timed tasks must
+ *  be destroyed before their pool.
+ *
+ *  @param  pool  A pointer to the pool.
+ *  @param  task  A pointer to the task.
+ *  @param  args  A pointer to the arguments that are passed to the task.
+ *
+ *  @return
+ *    On success, a pointer to the timed task, which is not scheduled yet.
+ *    On failure, NULL.
+ */
+vftasks_timed_task_t *vftasks_create_timed_task(vftasks_pool_t *pool,
+                                                vftasks_task_t *task,
+                                                void *args);
+
+/** Cancels and destroys a given timed task.
+ *
+ *  If the task is being executed on a worker thread, it runs to completion.
+ *
+ *  @param  timer  A pointer to the timed task.
+ */
+void vftasks_destroy_timed_task(vftasks_timed_task_t *timer);
+
+/** Schedules a given timed task.
+ *
+ *  A timed task that is already scheduled is rescheduled.
+ *
+ *  @param  timer      A pointer to the timed task.
+ *  @param  delay_ns   The number of nanoseconds after which the task is executed.
+ *  @param  period_ns  The number of nanoseconds between subsequent executions of
+ *                     the task, or 0 if the task is to be executed only once.
+ *                     If the pool falls behind, missed executions are skipped.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_schedule_timed_task(vftasks_timed_task_t *timer,
+                                uint64_t delay_ns,
+                                uint64_t period_ns);
+
+/** Cancels a given timed task, if it is scheduled.
+ *
+ *  The timed task can be scheduled again later on.
+ *
+ *  @param  timer  A pointer to the timed task.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_cancel_timed_task(vftasks_timed_task_t *timer);
+
+/** Submits a task for execution in a given worker-thread pool after a delay.
+ *
+ *  Unlike tasks submitted through vftasks_submit(), the task is not joined by
+ *  vftasks_get().
+ *
+ *  @param  pool      A pointer to the pool.
+ *  @param  delay_ns  The number of nanoseconds after which the task is executed.
+ *  @param  task      A pointer to the task.
+ *  @param  args      A pointer to the arguments that are passed to the task.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_submit_after(vftasks_pool_t *pool,
+                         uint64_t delay_ns,
+                         vftasks_task_t *task,
+                         void *args);
+
+
+/* ***************************************************************************
+ * Eventcounts
+ * ***************************************************************************/
+
+/** Lets threads block until an arbitrary predicate holds, without lost wake-ups.
+ *
+ *  A thread that wants to wait for a predicate calls vftasks_prepare_wait(),
+ *  rechecks the predicate, and then calls either vftasks_cancel_wait(), if the
+ *  predicate holds, or vftasks_commit_wait(), if it does not.  A thread that makes
+ *  the predicate hold calls vftasks_notify() afterwards.  A notification that
+ *  happens after vftasks_prepare_wait() releases the waiter, even if it happens
+ *  before vftasks_commit_wait().
+ *
+ *  Waiting threads are blocked on a futex, where available.  When no thread is
+ *  waiting, a notification costs a memory fence and a single load.  At most 65535
+ *  threads can wait on an eventcount at the same time.
+ */
+typedef struct vftasks_eventcount_s vftasks_eventcount_t;
+
+/** Creates an eventcount.
+ *
+ *  @return
+ *    On success, a pointer to the eventcount.
+ *    On failure, NULL.
+ */
+vftasks_eventcount_t *vftasks_create_eventcount(void);
+
+/** Destroys a given eventcount.
+ *
+ *  @param  eventcount  A pointer to the eventcount.
+ */
+void vftasks_destroy_eventcount(vftasks_eventcount_t *eventcount);
+
+/** Registers the calling thread as a waiter on a given eventcount.
+ *
+ *  Must be followed by a call to either vftasks_cancel_wait() or
+ *  vftasks_commit_wait().
+ *
+ *  @param  eventcount  A pointer to the eventcount.
+ *
+ *  @return
+ *    The key that is to be passed to vftasks_cancel_wait() or
+ *    vftasks_commit_wait().
+ */
+unsigned int vftasks_prepare_wait(vftasks_eventcount_t *eventcount);
+
+/** Withdraws the calling thread as a waiter on a given eventcount.
+ *
+ *  @param  eventcount  A pointer to the eventcount.
+ *  @param  key         The key returned by vftasks_prepare_wait().
+ */
+void vftasks_cancel_wait(vftasks_eventcount_t *eventcount, unsigned int key);
+
+/** Blocks until a given eventcount is notified after the calling thread prepared
+ *  to wait.
+ *
+ *  @param  eventcount  A pointer to the eventcount.
+ *  @param  key         The key returned by vftasks_prepare_wait().
+ */
+void vftasks_commit_wait(vftasks_eventcount_t *eventcount, unsigned int key);
+
+/** Wakes up all threads that wait on a given eventcount.
+ *
+ *  @param  eventcount  A pointer to the eventcount.
+ */
+void vftasks_notify(vftasks_eventcount_t *eventcount);
+
+
+/* ***************************************************************************
+ * One-dimensional synchronization between tasks
+ * ***************************************************************************/
+
+/** A handle that is to be used to manage one-dimensional synchronization between
+ *  concurrent tasks.
+ */
+typedef struct vftasks_1d_sync_mgr_s vftasks_1d_sync_mgr_t;
+
+/** Synchronization modes of a synchronization manager.
+ */
+#define VFTASKS_SYNC_SEMAPHORE 0  /**< every wait and signal is a semaphore
+                                       operation */
+#define VFTASKS_SYNC_SPIN      1  /**< every thread (for a 1D-synchronization
+                                       manager) or outer iteration in flight (for a
+                                       2D-synchronization manager) publishes the
+                                       number of iterations it has completed, which
+                                       waiting threads poll; a wait for an iteration
+                                       that has been completed already is a single
+                                       load */
+
+/** Default number of bytes from one synchronization object of a synchronization
+ *  manager to the next: a cache line, so that objects used by different threads do
+ *  not share cache lines.
+ */
+#define VFTASKS_SYNC_SPACING 64
+
+/** Distributions of the iterations of a loop over the threads, for a
+ *  1D-synchronization manager.
+ */
+#define VFTASKS_DIST_CYCLIC       0  /**< iteration i is executed by thread
+                                          i % num_threads */
+#define VFTASKS_DIST_BLOCK_CYCLIC 1  /**< blocks of block_size consecutive
+                                          iterations are distributed over the
+                                          threads in a round-robin fashion */
+#define VFTASKS_DIST_BLOCK        2  /**< the num_iterations iterations are split
+                                          into one contiguous block per thread, of
+                                          ceil(num_iterations / num_threads)
+                                          iterations each */
+
+/** Holds the wait statistics that a synchronization manager records for a thread or
+ *  an outer iteration, if it was created with profiling enabled.
+ */
+typedef struct vftasks_sync_stats_s
+{
+  unsigned long num_waits;    /**< number of waits */
+  unsigned long num_blocked;  /**< number of waits that found the data they waited
+                                   for not yet produced, and had to block or spin */
+  uint64_t blocked_ns;        /**< total number of nanoseconds spent in the waits
+                                   that blocked */
+}
+vftasks_sync_stats_t;
+
+/** Formats in which the wait statistics of a synchronization manager can be
+ *  exported.
+ */
+#define VFTASKS_STATS_CSV  0  /**< a header line, followed by a line per thread or
+                                   outer iteration */
+#define VFTASKS_STATS_JSON 1  /**< an array with an object per thread or outer
+                                   iteration */
+
+/** Holds attributes that control the creation of a 1D-synchronization manager.
+ *
+ *  Attributes should be initialized through vftasks_init_1d_sync_attr() before any
+ *  of them are set.
+ */
+typedef struct vftasks_1d_sync_attr_s
+{
+  int mode;            /**< VFTASKS_SYNC_SEMAPHORE (the default) or
+                            VFTASKS_SYNC_SPIN */
+  int spin_limit;      /**< in spin mode, the number of polls, with exponential
+                            backoff, after which a waiting thread blocks; 0 lets
+                            waiting threads spin indefinitely, which saves the
+                            signalling thread a check for blocked threads */
+  int distribution;    /**< VFTASKS_DIST_CYCLIC (the default),
+                            VFTASKS_DIST_BLOCK_CYCLIC or VFTASKS_DIST_BLOCK */
+  int block_size;      /**< number of consecutive iterations per block, for
+                            VFTASKS_DIST_BLOCK_CYCLIC */
+  int num_iterations;  /**< number of iterations of the loop, for
+                            VFTASKS_DIST_BLOCK */
+  size_t spacing;      /**< in semaphore mode, the semaphores are laid out a
+                            multiple of this many bytes apart, which must be a
+                            power of two (VFTASKS_SYNC_SPACING by default); 0 packs
+                            the semaphores */
+  int profile;         /**< nonzero to record wait statistics per thread; see
+                            vftasks_get_1d_sync_stats() (0 by default) */
+}
+vftasks_1d_sync_attr_t;
+
+/** Creates a handle for managing one-dimensional synchronization between concurrent
+ *  tasks.
+ *
+ *  @param num_threads  The number of threads over which the iteration space of the
+ *                      concurrent tasks is partitioned in a round-robin fashion.
+ *  @param dist         The critical dependency deistance along the iteration space of
+ *                      the concurrent tasks.
+ *
+ *  @return
+ *    On success, a pointer to the handle.
+ *    On failure, NULL.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+vftasks_1d_sync_mgr_t *vftasks_create_1d_sync_mgr(int num_threads, int dist);
+
+/** Initializes a set of 1D-synchronization attributes with the default values.
+ *
+ *  @param  attr  A pointer to the attributes.
+ */
+void vftasks_init_1d_sync_attr(vftasks_1d_sync_attr_t *attr);
+
+/** Creates a handle for managing one-dimensional synchronization between concurrent
+ *  tasks with given attributes.
+ *
+ *  In spin mode, the signals for the iterations executed by a thread must be given
+ *  in iteration order.
+ *
+ *  @param num_threads  The number of threads over which the iteration space of the
+ *                      concurrent tasks is partitioned, according to the
+ *                      distribution given by the attributes.
+ *  @param dist         The critical dependency distance along the iteration space of
+ *                      the concurrent tasks.
+ *  @param attr         A pointer to the attributes; if NULL, the default attributes
+ *                      are used.
+ *
+ *  @return
+ *    On success, a pointer to the handle.
+ *    On failure, NULL.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+vftasks_1d_sync_mgr_t *vftasks_create_1d_sync_mgr_with_attr(
+  int num_threads,
+  int dist,
+  const vftasks_1d_sync_attr_t *attr);
+
+/** Destroys a given handle for managing one-dimension synchronization between
+ *  concurrent tasks.
+ *
+ *  @param mgr  A pointer to the handle.
+ */
+void vftasks_destroy_1d_sync_mgr(vftasks_1d_sync_mgr_t *mgr);
+
+/** Resets a given handle for managing one-dimensional synchronization between
+ *  concurrent tasks to the state it was created in, so that it can be reused for
+ *  another execution of the same loop.
+ *
+ *  The previous execution must have run to completion, and no task may use the
+ *  handle while it is being reset.  Takes time proportional to the number of
+ *  threads (on Windows, in semaphore mode, also to the critical distance),
+ *  independent of the number of iterations.
+ *
+ *  @param mgr  A pointer to the handle.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_reset_1d_sync_mgr(vftasks_1d_sync_mgr_t *mgr);
+
+/** Signals the completion of the production of data through a handle for managing
+ *  one-dimensional synchronization between concurrent tasks.
+ *
+ *  @param mgr  A pointer to the handle.
+ *  @param i    The index into the iteration space of the concurrent tasks.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ *
+ *  NOTE: Sometimes, computing the correct iteration index requires some effort. Iteration
+ *  indices are zero-based; so the index of the ith iteration should be i - 1.
+ */
+int vftasks_signal_1d(vftasks_1d_sync_mgr_t *mgr, int i);
+
+/** Synchronizes a task before the consumption of data with the tasks that produce the
+ *  data.
+ *
+ *  @param mgr  A pointer to the handle that manages synchronization.
+ *  @param i    The index into the iteration space of the concurrent tasks.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ *
+ *  NOTE: Sometimes, computing the correct iteration index requires some effort. Iteration
+ *  indices are zero-based; so the index of the ith iteration should be i - 1.
+ */
+int vftasks_wait_1d(vftasks_1d_sync_mgr_t *mgr, int i);
+
+/** Signals the completion of the production of data for a range of iterations
+ *  through a handle for managing one-dimensional synchronization between concurrent
+ *  tasks.
+ *
+ *  Takes one synchronization operation per block of producing iterations, rather
+ *  than one per iteration.  Ranges are meant to be used in pairs: a task waits for
+ *  a range through vftasks_wait_1d_range(), executes the iterations in the range in
+ *  order, and then signals the same range.  Dependencies between iterations in the
+ *  same range are not synchronized, as they are satisfied by the order of execution.
+ *
+ *  A range must lie within a single block of the distribution of iterations over
+ *  threads and be executed by the thread that owns that block, and every iteration
+ *  must be waited for and signalled as part of the same range; a range that crosses
+ *  a block boundary is rejected as an invalid argument.  Ranges in different blocks
+ *  may be of different sizes.
+ *
+ *  @param mgr    A pointer to the handle.
+ *  @param begin  The index of the first iteration in the range.
+ *  @param end    The index one past the last iteration in the range.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_signal_1d_range(vftasks_1d_sync_mgr_t *mgr, int begin, int end);
+
+/** Synchronizes a task before the consumption of data in a range of iterations with
+ *  the tasks that produce the data.
+ *
+ *  On return, all data that the range consumes from iterations outside the range has
+ *  been produced; see vftasks_signal_1d_range(), including the constraints on
+ *  ranges.  Waiting for a range trades the latency of the first iteration for fewer
+ *  synchronization operations.
+ *
+ *  @param mgr    A pointer to the handle that manages synchronization.
+ *  @param begin  The index of the first iteration in the range.
+ *  @param end    The index one past the last iteration in the range.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_wait_1d_range(vftasks_1d_sync_mgr_t *mgr, int begin, int end);
+
+/** Retrieves the wait statistics that a handle for managing one-dimensional
+ *  synchronization has recorded for a thread, if it was created with profiling
+ *  enabled.
+ *
+ *  Every wait is attributed to the thread that executes the waiting iterations.
+ *  The statistics accumulate over all executions of the loop, including those after
+ *  a reset, and should be retrieved while no task uses the handle.
+ *
+ *  @param mgr     A pointer to the handle.
+ *  @param thread  The index of the thread.
+ *  @param stats   A pointer to the location in which to store the statistics.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, including when profiling is not enabled, a nonzero value.
+ */
+int vftasks_get_1d_sync_stats(vftasks_1d_sync_mgr_t *mgr,
+                              int thread,
+                              vftasks_sync_stats_t *stats);
+
+/** Exports the wait statistics that a handle for managing one-dimensional
+ *  synchronization has recorded, for all threads, as text.
+ *
+ *  Like snprintf(), writes at most size bytes, including the terminating null
+ *  character, and returns the length of the complete text, so that a buffer of the
+ *  right size can be allocated by calling the function with a size of 0 first.
+ *
+ *  @param mgr     A pointer to the handle.
+ *  @param format  VFTASKS_STATS_CSV or VFTASKS_STATS_JSON; the threads are
+ *                 identified by the key "thread".
+ *  @param buf     A pointer to the buffer; may be NULL if size is 0.
+ *  @param size    The size of the buffer.
+ *
+ *  @return
+ *    On success, the length of the text, excluding the terminating null character.
+ *    On failure, including when profiling is not enabled, -1.
+ */
+int vftasks_format_1d_sync_stats(vftasks_1d_sync_mgr_t *mgr,
+                                 int format,
+                                 char *buf,
+                                 size_t size);
+
+
+/* ***************************************************************************
+ * Synchronization between the iterations of two loops
+ * ***************************************************************************/
+
+/** A handle that is to be used to manage synchronization between concurrent tasks
+ *  that execute the iterations of a loop and those that execute the iterations of a
+ *  second loop, which consumes data produced by the first one.
+ */
+typedef struct vftasks_cross_sync_mgr_s vftasks_cross_sync_mgr_t;
+
+/** Creates a handle for managing synchronization between the iterations of a
+ *  producing loop and those of a consuming loop, so that the two loops can be
+ *  executed concurrently.
+ *
+ *  Every thread that executes iterations of the producing loop publishes how many
+ *  of them it has completed, and every iteration of the consuming loop waits for the
+ *  thread that executes the iteration it consumes from.  The producing threads must
+ *  signal their iterations in iteration order; the iterations of the consuming loop
+ *  may be distributed over any number of threads in any way.
+ *
+ *  @param num_threads  The number of threads over which the iterations of the
+ *                      producing loop are partitioned, according to the
+ *                      distribution given by the attributes.
+ *  @param dist         The dependency distance: iteration j of the consuming loop
+ *                      consumes data produced by iteration j - dist of the producing
+ *                      loop.
+ *  @param attr         A pointer to 1D-synchronization attributes, of which the
+ *                      distribution, the block size, the number of iterations of the
+ *                      producing loop, and the spin limit are used; if NULL, the
+ *                      default attributes are used.  If the number of iterations is
+ *                      given, consuming iterations beyond the producing loop do not
+ *                      wait.
+ *
+ *  @return
+ *    On success, a pointer to the handle.
+ *    On failure, NULL.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+vftasks_cross_sync_mgr_t *vftasks_create_cross_sync_mgr(
+  int num_threads,
+  int dist,
+  const vftasks_1d_sync_attr_t *attr);
+
+/** Destroys a given handle for managing synchronization between the iterations of
+ *  two loops.
+ *
+ *  @param mgr  A pointer to the handle.
+ */
+void vftasks_destroy_cross_sync_mgr(vftasks_cross_sync_mgr_t *mgr);
+
+/** Resets a given handle for managing synchronization between the iterations of two
+ *  loops to the state it was created in, so that it can be reused for another
+ *  execution of the same loops.
+ *
+ *  Both loops must have run to completion, and no task may use the handle while it
+ *  is being reset.  Takes time proportional to the number of producing threads.
+ *
+ *  @param mgr  A pointer to the handle.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_reset_cross_sync_mgr(vftasks_cross_sync_mgr_t *mgr);
+
+/** Signals the completion of an iteration of the producing loop.
+ *
+ *  @param mgr  A pointer to the handle.
+ *  @param i    The index of the iteration of the producing loop.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_signal_cross(vftasks_cross_sync_mgr_t *mgr, int i);
+
+/** Synchronizes an iteration of the consuming loop with the iteration of the
+ *  producing loop it consumes from.  Iterations that would consume from an iteration
+ *  before the start of the producing loop do not wait.
+ *
+ *  @param mgr  A pointer to the handle.
+ *  @param j    The index of the iteration of the consuming loop.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_wait_cross(vftasks_cross_sync_mgr_t *mgr, int j);
+
+/** Signals the completion of a range of iterations of the producing loop, with one
+ *  synchronization operation per block of iterations.
+ *
+ *  @param mgr    A pointer to the handle.
+ *  @param begin  The index of the first iteration in the range.
+ *  @param end    The index one past the last iteration in the range.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_signal_cross_range(vftasks_cross_sync_mgr_t *mgr, int begin, int end);
+
+/** Synchronizes a range of iterations of the consuming loop with the iterations of
+ *  the producing loop they consume from, with at most one synchronization operation
+ *  per producing thread and block of iterations.
+ *
+ *  @param mgr    A pointer to the handle.
+ *  @param begin  The index of the first iteration of the consuming loop in the range.
+ *  @param end    The index one past the last iteration in the range.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_wait_cross_range(vftasks_cross_sync_mgr_t *mgr, int begin, int end);
+
+
+/* ***************************************************************************
+ * Two-dimensional synchronization between tasks
+ * ***************************************************************************/
+
+/** A handle that is to be used to manage two-dimensional synchronization between
+ *  concurrent tasks.
+ */
+typedef struct vftasks_2d_sync_mgr_s vftasks_2d_sync_mgr_t;
+
+/** Holds attributes that control the creation of a 2D-synchronization manager.
+ *
+ *  Attributes should be initialized through vftasks_init_2d_sync_attr() before any
+ *  of them are set.
+ */
+typedef struct vftasks_2d_sync_attr_s
+{
+  size_t spacing;   /**< in semaphore mode, the synchronization objects of the outer
+                         iterations are laid out a multiple of this many bytes apart,
+                         which must be a power of two (VFTASKS_SYNC_SPACING by
+                         default); 0 packs them */
+  int mode;         /**< VFTASKS_SYNC_SEMAPHORE (the default), which takes a
+                         semaphore per outer iteration, or VFTASKS_SYNC_SPIN, which
+                         takes a ring of num_threads + |dist_x| progress counters,
+                         independent of the number of outer iterations */
+  int spin_limit;   /**< in spin mode, the number of polls, with exponential
+                         backoff, after which a waiting thread blocks; 0 lets
+                         waiting threads spin indefinitely */
+  int num_threads;  /**< in spin mode, the maximum number of outer iterations that
+                         are executed concurrently; must be set; with profiling,
+                         the number of threads over which the outer iterations are
+                         distributed cyclically, as reported by
+                         vftasks_format_2d_sync_stats() */
+  int profile;      /**< nonzero to record wait statistics per outer iteration; see
+                         vftasks_get_2d_sync_stats() (0 by default); takes a record
+                         per outer iteration, also in spin mode, so the memory of a
+                         profiled handle grows with the number of outer iterations */
+}
+vftasks_2d_sync_attr_t;
+
+/** Creates a handle for managing two-dimensional synchronization between concurrent
+ *  tasks.
+ *
+ *  @param dim_x   The size of the first dimension of the joint iteration space of the
+ *                 concurrent tasks.
+ *  @param dim_y   The size of the second dimension of the joint iteration space of the
+ *                 concurrent tasks.
+ *  @param dist_x  The critical dependency distance along the first dimension of the
+ *                 joint iteration space of the concurrent tasks.
+ *  @param dist_y  The ciritial dependency distance along the second dimention of the
+ *                 joint iteration space of the concurrent tasks.
+ *
+ *  @return
+ *    On success, a pointer to the handle.
+ *    On failure, NULL.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+vftasks_2d_sync_mgr_t *vftasks_create_2d_sync_mgr(int dim_x,
+                                                  int dim_y,
+                                                  int dist_x,
+                                                  int dist_y);
+
+/** Initializes a set of 2D-synchronization attributes with the default values.
+ *
+ *  @param  attr  A pointer to the attributes.
+ */
+void vftasks_init_2d_sync_attr(vftasks_2d_sync_attr_t *attr);
+
+/** Creates a handle for managing two-dimensional synchronization between concurrent
+ *  tasks with given attributes.
+ *
+ *  In spin mode, the outer iterations must be started in order, by at most
+ *  num_threads threads at a time, and each must signal all of its inner iterations
+ *  (or ranges covering them) in order; an outer iteration that reuses the progress
+ *  counter of an earlier one waits for that one to complete first.
+ *
+ *  @param dim_x   The size of the first dimension of the joint iteration space of the
+ *                 concurrent tasks.
+ *  @param dim_y   The size of the second dimension of the joint iteration space of the
+ *                 concurrent tasks.
+ *  @param dist_x  The critical dependency distance along the first dimension of the
+ *                 joint iteration space of the concurrent tasks.
+ *  @param dist_y  The critical dependency distance along the second dimension of the
+ *                 joint iteration space of the concurrent tasks.
+ *  @param attr    A pointer to the attributes; if NULL, the default attributes are
+ *                 used.
+ *
+ *  @return
+ *    On success, a pointer to the handle.
+ *    On failure, NULL.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+vftasks_2d_sync_mgr_t *vftasks_create_2d_sync_mgr_with_attr(
+  int dim_x,
+  int dim_y,
+  int dist_x,
+  int dist_y,
+  const vftasks_2d_sync_attr_t *attr);
+
+/** Destroys a given handle for managing two-dimension synchronization between
+ *  concurrent tasks.
+ *
+ *  @param mgr  A pointer to the handle.
+ */
+void vftasks_destroy_2d_sync_mgr(vftasks_2d_sync_mgr_t *mgr);
+
+/** Resets a given handle for managing two-dimensional synchronization between
+ *  concurrent tasks to the state it was created in, so that it can be reused for
+ *  another execution of the same loop nest.
+ *
+ *  The previous execution must have run to completion, and no task may use the
+ *  handle while it is being reset.  Takes constant time in semaphore mode, and
+ *  time proportional to the number of threads in spin mode, independent of the
+ *  size of the iteration space.
+ *
+ *  @param mgr  A pointer to the handle.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_reset_2d_sync_mgr(vftasks_2d_sync_mgr_t *mgr);
+
+/** Signals the completion of an inner iteration through a handle for managing
+ *  two-dimensional synchronization between concurrent tasks.
+ *
+ *  @param mgr  A pointer to the handle.
+ *  @param x    The iteration's first-dimension index into the joint iteration space of
+ *              the concurrent tasks for the iteration.
+ *  @param y    The iteration's second-dimension index into the joint iteration space of
+ *              the concurrent tasks for the iteration.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_signal_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y);
+
+/** Synchronizes a task at the start of an inner iteration with the tasks it is
+ *  depending on.
+ *
+ *  @param mgr  A pointer to the handle that manages synchronization.
+ *  @param x    The iteration's first-dimension index into the joint iteration space of
+ *              the concurrent tasks for the iteration.
+ *  @param y    The iteration's second-dimension index into the joint iteration space of
+ *              the concurrent tasks for the iteration.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_wait_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y);
+
+/** Signals the completion of a range of inner iterations through a handle for
+ *  managing two-dimensional synchronization between concurrent tasks.
+ *
+ *  Takes a single semaphore operation, rather than one per inner iteration.  Ranges
+ *  are meant to be used in pairs: a task waits for a range through
+ *  vftasks_wait_2d_range(), executes the inner iterations in the range in order, and
+ *  then signals the same range.  Dependencies between iterations in the same range
+ *  are not synchronized, as they are satisfied by the order of execution.
+ *
+ *  @param mgr      A pointer to the handle.
+ *  @param x        The iterations' first-dimension index into the joint iteration
+ *                  space of the concurrent tasks.
+ *  @param y_begin  The second-dimension index of the first iteration in the range.
+ *  @param y_end    The second-dimension index one past the last iteration in the
+ *                  range.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_signal_2d_range(vftasks_2d_sync_mgr_t *mgr, int x, int y_begin, int y_end);
+
+/** Synchronizes a task at the start of a range of inner iterations with the tasks it
+ *  is depending on.
+ *
+ *  Takes a single semaphore operation: on return, the dependencies of all
+ *  iterations in the range on iterations outside the range have been satisfied; see
+ *  vftasks_signal_2d_range().  Larger ranges take fewer synchronization operations
+ *  at the cost of a longer pipeline fill.
+ *
+ *  @param mgr      A pointer to the handle that manages synchronization.
+ *  @param x        The iterations' first-dimension index into the joint iteration
+ *                  space of the concurrent tasks.
+ *  @param y_begin  The second-dimension index of the first iteration in the range.
+ *  @param y_end    The second-dimension index one past the last iteration in the
+ *                  range.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ *
+ *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
+ *  defined (which is the default), the function does not return on failure and instead
+ *  terminates the calling program.
+ */
+int vftasks_wait_2d_range(vftasks_2d_sync_mgr_t *mgr, int x, int y_begin, int y_end);
+
+/** Retrieves the wait statistics that a handle for managing two-dimensional
+ *  synchronization has recorded for an outer iteration, if it was created with
+ *  profiling enabled.
+ *
+ *  Every wait is attributed to the waiting outer iteration; in spin mode, so is the
+ *  wait of an outer iteration for its progress counter to be released by an
+ *  earlier one, if it blocks.  Plotted against the outer iterations, or summed per
+ *  thread, the time spent blocked shows whether the loop is stalled on its
+ *  dependencies.  The statistics accumulate over all executions of the loop,
+ *  including those after a reset, and should be retrieved while no task uses the
+ *  handle.
+ *
+ *  @param mgr    A pointer to the handle.
+ *  @param x      The index of the outer iteration.
+ *  @param stats  A pointer to the location in which to store the statistics.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, including when profiling is not enabled, a nonzero value.
+ */
+int vftasks_get_2d_sync_stats(vftasks_2d_sync_mgr_t *mgr,
+                              int x,
+                              vftasks_sync_stats_t *stats);
 
+/** Exports the wait statistics that a handle for managing two-dimensional
+ *  synchronization has recorded, for all outer iterations, as text.
+ *
+ *  Like snprintf(), writes at most size bytes, including the terminating null
+ *  character, and returns the length of the complete text.
+ *
+ *  @param mgr     A pointer to the handle.
+ *  @param format  VFTASKS_STATS_CSV or VFTASKS_STATS_JSON; the outer iterations are
+ *                 identified by the key "row", and the thread that executes them by
+ *                 the key "thread", which is the row modulo the num_threads
+ *                 attribute, or the row itself if that attribute is not set.
+ *  @param buf     A pointer to the buffer; may be NULL if size is 0.
+ *  @param size    The size of the buffer.
+ *
+ *  @return
+ *    On success, the length of the text, excluding the terminating null character.
+ *    On failure, including when profiling is not enabled, -1.
+ */
+int vftasks_format_2d_sync_stats(vftasks_2d_sync_mgr_t *mgr,
+                                 int format,
+                                 char *buf,
+                                 size_t size);
 
-__BEGIN_DECLS
 
 /* ***************************************************************************
- * Creation and destruction of worker-thread pools
+ * N-dimensional synchronization between tasks
  * ***************************************************************************/
 
-/** Creates a worker-thread pool of a given size.
+/** A handle that is to be used to manage synchronization between concurrent tasks
+ *  that execute the outer iterations of an N-dimensional loop nest.
+ */
+typedef struct vftasks_nd_sync_mgr_s vftasks_nd_sync_mgr_t;
+
+/** Creates a handle for managing N-dimensional synchronization between concurrent
+ *  tasks.
  *
- *  @param  num_workers  The number of worker threads in the pool.
- *  @param  busy_wait    When set to non-zero, the workers will be in a busy-wait loop
- *                       until work is submitted; otherwise they wait
- *                       without consuming resources.
+ *  The outer iterations (along the first dimension) may be distributed over the
+ *  threads in any way; the iterations within an outer iteration must be executed,
+ *  and signalled, in lexicographic order.  Distance vectors whose dependencies are
+ *  satisfied by that order, or by waiting for other distance vectors, possibly
+ *  through a chain of iterations, are not waited for; (2, 0, 0), for instance, is
+ *  implied by (1, 0, 0).
+ *
+ *  As with the 2D-synchronization manager, a dependency on a later outer iteration
+ *  (a negative first component) requires that iteration to be in flight while the
+ *  dependent one waits.
+ *
+ *  @param num_dims   The number of dimensions of the joint iteration space of the
+ *                    concurrent tasks.
+ *  @param dims       An array of num_dims sizes of the joint iteration space.
+ *  @param num_dists  The number of dependencies.
+ *  @param dists      An array of num_dists distance vectors of num_dims components
+ *                    each; within an outer iteration, an iteration can only depend
+ *                    on earlier ones.
  *
  *  @return
- *    On success, a pointer to the pool.
+ *    On success, a pointer to the handle.
  *    On failure, NULL.
  *
  *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
  *  defined (which is the default), the function does not return on failure and instead
  *  terminates the calling program.
  */
-vftasks_pool_t *vftasks_create_pool(int num_workers, int busy_wait);
+vftasks_nd_sync_mgr_t *vftasks_create_nd_sync_mgr(int num_dims,
+                                                  const int *dims,
+                                                  int num_dists,
+                                                  const int *dists);
 
-/** Destroys a given worker-thread pool.
+/** Destroys a given handle for managing N-dimensional synchronization between
+ *  concurrent tasks.
  *
- *  @param  pool  A pointer to the pool.
+ *  @param mgr  A pointer to the handle.
  */
-void vftasks_destroy_pool(vftasks_pool_t *pool);
-
-/* ***************************************************************************
- * Execution of parallel tasks
- * ***************************************************************************/
+void vftasks_destroy_nd_sync_mgr(vftasks_nd_sync_mgr_t *mgr);
 
-/** Submits a specified instance of a task to a given worker-thread pool.
+/** Resets a given handle for managing N-dimensional synchronization between
+ *  concurrent tasks to the state it was created in, so that it can be reused for
+ *  another execution of the same loop nest.
  *
- *  Executes the task in parallel on a thread from the pool.
+ *  The previous execution must have run to completion, and no task may use the
+ *  handle while it is being reset.  Takes constant time: rather than being
+ *  cleared, the progress counters count on from where the previous execution left
+ *  them.
  *
- *  @param  pool         A pointer to the pool.
- *  @param  task         A pointer to the task.
- *  @param  args         A pointer to the arguments for the instance.
- *  @param  num_workers  The number of additional worker threads that will be required
- *                       for the execution of the task.
+ *  @param mgr  A pointer to the handle.
  *
  *  @return
- *    On success, 0
+ *    On success, 0.
  *    On failure, a nonzero value.
+ */
+int vftasks_reset_nd_sync_mgr(vftasks_nd_sync_mgr_t *mgr);
+
+/** Retrieves the number of distance vectors that an iteration waits for, after
+ *  those that are redundant have been pruned.
  *
- *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
- *  defined (which is the default), the function does not return on failure and instead
- *  terminates the calling program.
+ *  @param mgr  A pointer to the handle.
+ *
+ *  @return
+ *    The number of distance vectors.
  */
-int vftasks_submit(vftasks_pool_t *pool,
-                   vftasks_task_t *task,
-                   void *args,
-                   int num_workers);
+int vftasks_get_nd_sync_num_waits(vftasks_nd_sync_mgr_t *mgr);
 
-/** Blocks until the most recent submitted task is finished.
+/** Signals the completion of an iteration through a handle for managing
+ *  N-dimensional synchronization between concurrent tasks.
  *
- *  @param  pool    A pointer to the pool.
+ *  @param mgr    A pointer to the handle.
+ *  @param index  An array of num_dims indices of the iteration into the joint
+ *                iteration space of the concurrent tasks.
  *
  *  @return
  *    On success, 0.
  *    On failure, a nonzero value.
+ */
+int vftasks_signal_nd(vftasks_nd_sync_mgr_t *mgr, const int *index);
+
+/** Synchronizes a task at the start of an iteration with the tasks it is depending
+ *  on.
  *
- *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
- *  defined (which is the default), the function does not return on failure and instead
- *  terminates the calling program.
+ *  @param mgr    A pointer to the handle that manages synchronization.
+ *  @param index  An array of num_dims indices of the iteration into the joint
+ *                iteration space of the concurrent tasks.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
  */
-int vftasks_get(vftasks_pool_t *pool);
+int vftasks_wait_nd(vftasks_nd_sync_mgr_t *mgr, const int *index);
 
 
 /* ***************************************************************************
- * One-dimensional synchronization between tasks
+ * Doacross synchronization between tasks
  * ***************************************************************************/
 
-/** A handle that is to be used to manage one-dimensional synchronization between
- *  concurrent tasks.
+/** A handle that is to be used to manage synchronization between concurrent tasks
+ *  that execute the iterations of a loop with dependency distances that are only
+ *  known at run time.
  */
-typedef struct vftasks_1d_sync_mgr_s vftasks_1d_sync_mgr_t;
+typedef struct vftasks_doacross_mgr_s vftasks_doacross_mgr_t;
 
-/** Creates a handle for managing one-dimensional synchronization between concurrent
- *  tasks.
+/** Creates a handle for managing doacross synchronization between concurrent tasks.
  *
- *  @param num_threads  The number of threads over which the iteration space of the
- *                      concurrent tasks is partitioned in a round-robin fashion.
- *  @param dist         The critical dependency deistance along the iteration space of
- *                      the concurrent tasks.
+ *  Every iteration signals its completion, and may wait for the completion of any
+ *  number of other iterations, each chosen at run time.  The iterations may be
+ *  distributed over the threads in any way, statically or dynamically; an iteration
+ *  that is waited for must have been, or eventually be, started by a thread that is
+ *  not itself waiting for a later iteration, which holds if every thread executes
+ *  its iterations in increasing order and iterations only wait for earlier ones.
+ *
+ *  @param num_iterations  The number of iterations of the loop.
  *
  *  @return
  *    On success, a pointer to the handle.
@@ -412,74 +1872,78 @@ typedef struct vftasks_1d_sync_mgr_s vftasks_1d_sync_mgr_t;
  *  defined (which is the default), the function does not return on failure and instead
  *  terminates the calling program.
  */
-vftasks_1d_sync_mgr_t *vftasks_create_1d_sync_mgr(int num_threads, int dist);
+vftasks_doacross_mgr_t *vftasks_create_doacross_mgr(int num_iterations);
 
-/** Destroys a given handle for managing one-dimension synchronization between
- *  concurrent tasks.
+/** Destroys a given handle for managing doacross synchronization between concurrent
+ *  tasks.
  *
  *  @param mgr  A pointer to the handle.
  */
-void vftasks_destroy_1d_sync_mgr(vftasks_1d_sync_mgr_t *mgr);
+void vftasks_destroy_doacross_mgr(vftasks_doacross_mgr_t *mgr);
 
-/** Signals the completion of the production of data through a handle for managing
- *  one-dimensional synchronization between concurrent tasks.
+/** Resets a given handle for managing doacross synchronization between concurrent
+ *  tasks to the state it was created in, so that it can be reused for another
+ *  execution of the same loop.
+ *
+ *  The previous execution must have run to completion, and no task may use the
+ *  handle while it is being reset.  Takes constant time.
  *
  *  @param mgr  A pointer to the handle.
- *  @param i    The index into the iteration space of the concurrent tasks.
  *
  *  @return
  *    On success, 0.
  *    On failure, a nonzero value.
+ */
+int vftasks_reset_doacross_mgr(vftasks_doacross_mgr_t *mgr);
+
+/** Signals the completion of an iteration through a handle for managing doacross
+ *  synchronization between concurrent tasks.
  *
- *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
- *  defined (which is the default), the function does not return on failure and instead
- *  terminates the calling program.
+ *  @param mgr  A pointer to the handle.
+ *  @param i    The index of the iteration; signals for indices outside the
+ *              iteration space are ignored.
  *
- *  NOTE: Sometimes, computing the correct iteration index requires some effort. Iteration
- *  indices are zero-based; so the index of the ith iteration should be i - 1.
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
  */
-int vftasks_signal_1d(vftasks_1d_sync_mgr_t *mgr, int i);
+int vftasks_signal_doacross(vftasks_doacross_mgr_t *mgr, int i);
 
-/** Synchronizes a task before the consumption of data with the tasks that produce the
- *  data.
+/** Synchronizes a task with the completion of an iteration, typically one that
+ *  produces data that the current iteration consumes.
+ *
+ *  Polls for the iteration with exponential backoff for a while, and then blocks.
  *
  *  @param mgr  A pointer to the handle that manages synchronization.
- *  @param i    The index into the iteration space of the concurrent tasks.
+ *  @param i    The index of the iteration that is waited for; for indices outside
+ *              the iteration space, the function returns immediately.
  *
  *  @return
  *    On success, 0.
  *    On failure, a nonzero value.
- *
- *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
- *  defined (which is the default), the function does not return on failure and instead
- *  terminates the calling program.
- *
- *  NOTE: Sometimes, computing the correct iteration index requires some effort. Iteration
- *  indices are zero-based; so the index of the ith iteration should be i - 1.
  */
-int vftasks_wait_1d(vftasks_1d_sync_mgr_t *mgr, int i);
+int vftasks_wait_doacross(vftasks_doacross_mgr_t *mgr, int i);
 
 
 /* ***************************************************************************
- * Two-dimensional synchronization between tasks
+ * Ordered sections
  * ***************************************************************************/
 
-/** A handle that is to be used to manage two-dimensional synchronization between
- *  concurrent tasks.
+/** A handle that is to be used to execute a section of the body of a partitioned
+ *  loop in iteration order.
  */
-typedef struct vftasks_2d_sync_mgr_s vftasks_2d_sync_mgr_t;
+typedef struct vftasks_ordered_s vftasks_ordered_t;
 
-/** Creates a handle for managing two-dimensional synchronization between concurrent
- *  tasks.
+/** Creates a handle for executing a section of the body of a partitioned loop in
+ *  iteration order.
  *
- *  @param dim_x   The size of the first dimension of the joint iteration space of the
- *                 concurrent tasks.
- *  @param dim_y   The size of the second dimension of the joint iteration space of the
- *                 concurrent tasks.
- *  @param dist_x  The critical dependency distance along the first dimension of the
- *                 joint iteration space of the concurrent tasks.
- *  @param dist_y  The ciritial dependency distance along the second dimention of the
- *                 joint iteration space of the concurrent tasks.
+ *  Every iteration, counting from 0, must pass through the section exactly once,
+ *  even if it has nothing to execute in it; the iterations may be distributed over
+ *  the threads in any way, as long as every thread executes its iterations in
+ *  increasing order.  The section is guarded by a single counter that holds the
+ *  index of the iteration whose turn it is, so that a thread that arrives in turn
+ *  enters the section with a single load, and one that arrives early polls the
+ *  counter for a while and then blocks.
  *
  *  @return
  *    On success, a pointer to the handle.
@@ -489,45 +1953,86 @@ typedef struct vftasks_2d_sync_mgr_s vftasks_2d_sync_mgr_t;
  *  defined (which is the default), the function does not return on failure and instead
  *  terminates the calling program.
  */
-vftasks_2d_sync_mgr_t *vftasks_create_2d_sync_mgr(int dim_x,
-                                                  int dim_y,
-                                                  int dist_x,
-                                                  int dist_y);
+vftasks_ordered_t *vftasks_create_ordered(void);
 
-/** Destroys a given handle for managing two-dimension synchronization between
- *  concurrent tasks.
+/** Destroys a given handle for executing a section in iteration order.
  *
- *  @param mgr  A pointer to the handle.
+ *  @param ordered  A pointer to the handle.
  */
-void vftasks_destroy_2d_sync_mgr(vftasks_2d_sync_mgr_t *mgr);
+void vftasks_destroy_ordered(vftasks_ordered_t *ordered);
 
-/** Signals the completion of an inner iteration through a handle for managing
- *  two-dimensional synchronization between concurrent tasks.
+/** Resets a given handle for executing a section in iteration order to the state it
+ *  was created in, so that it can be reused for another execution of the same loop.
  *
- *  @param mgr  A pointer to the handle.
- *  @param x    The iteration's first-dimension index into the joint iteration space of
- *              the concurrent tasks for the iteration.
- *  @param y    The iteration's second-dimension index into the joint iteration space of
- *              the concurrent tasks for the iteration.
+ *  No task may use the handle while it is being reset.
+ *
+ *  @param ordered  A pointer to the handle.
  *
  *  @return
  *    On success, 0.
  *    On failure, a nonzero value.
+ */
+int vftasks_reset_ordered(vftasks_ordered_t *ordered);
+
+/** Enters a section that is executed in iteration order, once all earlier
+ *  iterations have left it.
  *
- *  NOTE: If vfTasks was compiled with the VFTASKS_ABORT_ON_FAILURE preprocessor symbol
- *  defined (which is the default), the function does not return on failure and instead
- *  terminates the calling program.
+ *  @param ordered  A pointer to the handle.
+ *  @param i        The index of the iteration.
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
  */
-int vftasks_signal_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y);
+int vftasks_ordered_begin(vftasks_ordered_t *ordered, int i);
 
-/** Synchronizes a task at the start of an inner iteration with the tasks it is
- *  depending on.
+/** Leaves a section that is executed in iteration order, passing the turn on to the
+ *  next iteration.
  *
- *  @param mgr  A pointer to the handle that manages synchronization.
- *  @param x    The iteration's first-dimension index into the joint iteration space of
- *              the concurrent tasks for the iteration.
- *  @param y    The iteration's second-dimension index into the joint iteration space of
- *              the concurrent tasks for the iteration.
+ *  @param ordered  A pointer to the handle.
+ *  @param i        The index of the iteration, as passed to vftasks_ordered_begin().
+ *
+ *  @return
+ *    On success, 0.
+ *    On failure, a nonzero value.
+ */
+int vftasks_ordered_end(vftasks_ordered_t *ordered, int i);
+
+
+/* ***************************************************************************
+ * Wavefront execution of 2D loop nests
+ * ***************************************************************************/
+
+/** Represents the body of a 2D loop nest, applied to a tile of the iteration space:
+ *  the iterations (x, y) with x_begin <= x < x_end and y_begin <= y < y_end, which
+ *  must be executed in lexicographic order.
+ */
+typedef void (vftasks_tile_task_t)(void *ctx,
+                                   int x_begin,
+                                   int x_end,
+                                   int y_begin,
+                                   int y_end);
+
+/** Executes a 2D loop nest in which iteration (x, y) depends on iteration
+ *  (x - dist_x, y - dist_y).
+ *
+ *  The iteration space is cut into tiles, which are executed by the calling thread
+ *  and all workers of the pool that are available to it, each tile as soon as the
+ *  tiles it depends on have been executed.  The body needs no synchronization of
+ *  its own.  Returns once all tiles have been executed.
+ *
+ *  @param  pool    A pointer to the pool.
+ *  @param  dim_x   The size of the first dimension of the iteration space.
+ *  @param  dim_y   The size of the second dimension of the iteration space.
+ *  @param  dist_x  The dependency distance along the first dimension; must not be
+ *                  negative.
+ *  @param  dist_y  The dependency distance along the second dimension; must not be
+ *                  negative if dist_x is 0.
+ *  @param  tile_x  The size of a tile along the first dimension; at least dist_x.
+ *  @param  tile_y  The size of a tile along the second dimension; at least the
+ *                  magnitude of dist_y.
+ *  @param  body    A pointer to the loop body.
+ *  @param  ctx     A pointer that is passed to the loop body.
  *
  *  @return
  *    On success, 0.
@@ -537,7 +2042,15 @@ int vftasks_signal_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y);
  *  defined (which is the default), the function does not return on failure and instead
  *  terminates the calling program.
  */
-int vftasks_wait_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y);
+int vftasks_wavefront_2d(vftasks_pool_t *pool,
+                         int dim_x,
+                         int dim_y,
+                         int dist_x,
+                         int dist_y,
+                         int tile_x,
+                         int tile_y,
+                         vftasks_tile_task_t *body,
+                         void *ctx);
 
 
 /* ***************************************************************************
@@ -565,6 +2078,20 @@ typedef struct vftasks_rport_s vftasks_rport_t;
  */
 typedef struct vftasks_token_s vftasks_token_t;
 
+/** Kinds of FIFO channels, by the number of ports that can be connected to either
+ *  side.
+ */
+#define VFTASKS_CHAN_SPSC 0  /**< a single writer and a single reader */
+#define VFTASKS_CHAN_MPSC 1  /**< multiple writers and a single reader */
+#define VFTASKS_CHAN_SPMC 2  /**< a single writer and multiple readers */
+#define VFTASKS_CHAN_MPMC 3  /**< multiple writers and multiple readers
+                                  (VFTASKS_CHAN_MPSC | VFTASKS_CHAN_SPMC) */
+
+/** Flag that can be combined with any kind of FIFO channel to keep every token
+ *  in the FIFO buffer, next to its contents.
+ */
+#define VFTASKS_CHAN_FLAT 4
+
 /** Called when a writer that is connected to a FIFO channel might want to be
  *  suspended or resumed.
  *
@@ -615,7 +2142,7 @@ vftasks_malloc_t;
  *  of two.
  *
  *  @param  num_tokens  The number of tokens.
- *  @param  token_size  The token size.
+ *  @param  token_size  The token size; at most 2^30.
  *  @param  ctl_space   A pointer to the memory-management implementation that is to
  *                      be used to allocate memory for the channel's control
  *                      structure.
@@ -631,9 +2158,44 @@ vftasks_chan_t *vftasks_create_chan(int num_tokens,
                                     vftasks_malloc_t *ctl_space,
                                     vftasks_malloc_t *buf_space);
 
+/** Creates a FIFO channel of a given kind, to which multiple write ports, multiple
+ *  read ports, or both can be connected.
+ *
+ *  The ports on either side share the same FIFO order: a token is acquired by
+ *  exactly one of them.  Unlike on a channel with a single writer and reader,
+ *  vftasks_release_data() and vftasks_release_room() release the given token,
+ *  rather than the oldest one acquired through the port, so tokens can be
+ *  released out of order.  Hooks are called with the port that is to be suspended
+ *  or resumed, possibly from several threads at once, and a resume hook is called
+ *  for every suspended port on the other side once the watermark is reached.
+ *  Ports are to be created and destroyed while the channel is not in use.
+ *
+ *  @param  num_tokens  The number of tokens; for a channel of a kind other than
+ *                      VFTASKS_CHAN_SPSC, at most 2^28.
+ *  @param  token_size  The token size; at most 2^30.
+ *  @param  kind        VFTASKS_CHAN_SPSC, VFTASKS_CHAN_MPSC, VFTASKS_CHAN_SPMC, or
+ *                      VFTASKS_CHAN_MPMC, optionally combined with
+ *                      VFTASKS_CHAN_FLAT.
+ *  @param  ctl_space   A pointer to the memory-management implementation that is to
+ *                      be used to allocate memory for the channel's control
+ *                      structure.
+ *  @param  buf_space   A pointer to the memory-management implementation that is to
+ *                      be used to allocate memory for the channel's FIFO buffer.
+ *
+ *  @return
+ *     On success, a pointer to the channel.
+ *     On failure, NULL.
+ */
+vftasks_chan_t *vftasks_create_chan_with_kind(int num_tokens,
+                                              size_t token_size,
+                                              int kind,
+                                              vftasks_malloc_t *ctl_space,
+                                              vftasks_malloc_t *buf_space);
+
 /** Creates a write port and connects it to a given FIFO channel.
  *
- *  Fails if another write port is already connected to the channel.
+ *  Fails if another write port is already connected to the channel, unless the
+ *  channel was created for multiple writers.
  *
  *  @param   chan        A pointer to the FIFO channel.
  *  @param   port_space  A pointer to the memory-management implementation that is
@@ -648,7 +2210,8 @@ vftasks_wport_t *vftasks_create_write_port(vftasks_chan_t *chan,
 
 /** Creates a read port and connects it to a given FIFO channel.
  *
- *  Fails if another read port is already connected to the channel.
+ *  Fails if another read port is already connected to the channel, unless the
+ *  channel was created for multiple readers.
  *
  *  @param  chan        A pointer to the FIFO channel.
  *  @param  port_space  A pointer to the memory-management implementation that is
@@ -720,6 +2283,22 @@ void vftasks_install_chan_hooks(vftasks_chan_t *chan,
                                 vftasks_reader_hook_t suspend_reader,
                                 vftasks_reader_hook_t resume_reader);
 
+/** Installs hooks into a FIFO channel that let suspended writers and readers
+ *  block.
+ *
+ *  A suspended thread polls the channel, with exponential backoff, until a token
+ *  becomes available or it has polled a given number of times.  It then blocks
+ *  until it is resumed, that is, once the low-water mark (for a writer) or the
+ *  high-water mark (for a reader) is reached, or the other side flushes the
+ *  channel.  The hooks replace any hooks installed before, and use no
+ *  application-specific data.
+ *
+ *  @param  chan        A pointer to the channel.
+ *  @param  spin_limit  The number of polls after which a suspended thread blocks;
+ *                      0 lets it block right away.
+ */
+void vftasks_install_default_blocking_hooks(vftasks_chan_t *chan, int spin_limit);
+
 /* ***************************************************************************
  * Low- and high-water marks
  * ***************************************************************************/
@@ -788,6 +2367,34 @@ int vftasks_set_min_data(vftasks_chan_t *chan, int min_data);
  */
 int vftasks_get_min_data(vftasks_chan_t *chan);
 
+/** Sets the publication interval for a given FIFO channel.
+ *
+ *  The publication interval is the number of tokens that a writer releases
+ *  before it makes them available for acquisition through a read port.
+ *  Released tokens are also made available when the writer finds the channel
+ *  full, and when vftasks_flush_data() is called, so a writer that sets an
+ *  interval greater than 1 is to flush the channel once it pauses writing.
+ *  Only channels with a single writer and reader defer the publication of tokens.
+ *
+ *  @param  chan      A pointer to the channel.
+ *  @param  interval  The new publication interval; at least 1 and at most the
+ *                    number of tokens of the channel.
+ *
+ *  @return
+ *    On success, the new publication interval.
+ *    On failure, the old publication interval.
+ */
+int vftasks_set_publication_interval(vftasks_chan_t *chan, int interval);
+
+/** Retrieves the publication interval for a given FIFO channel.
+ *
+ *  @param  chan  A pointer to the channel.
+ *
+ *  @return
+ *    The publication interval; initially 1.
+ */
+int vftasks_get_publication_interval(vftasks_chan_t *chan);
+
 
 /* ***************************************************************************
  * Application-specific data
@@ -834,6 +2441,16 @@ int vftasks_shmem_supported(vftasks_chan_t *chan);
  */
 int vftasks_get_num_tokens(vftasks_chan_t *chan);
 
+/** Retrieves the kind of a given FIFO channel.
+ *
+ *  @param  chan  A pointer to the channel.
+ *
+ *  @return
+ *    VFTASKS_CHAN_SPSC, VFTASKS_CHAN_MPSC, VFTASKS_CHAN_SPMC, or VFTASKS_CHAN_MPMC,
+ *    combined with VFTASKS_CHAN_FLAT if the channel was created with it.
+ */
+int vftasks_get_chan_kind(vftasks_chan_t *chan);
+
 /** Retrieves the size of the tokens held by a given FIFO channel.
  *
  *  @param  chan  A pointer to the channel.
@@ -941,6 +2558,62 @@ vftasks_token_t *vftasks_acquire_room_nb(vftasks_wport_t *wport);
  */
 void vftasks_release_data(vftasks_wport_t *wport, vftasks_token_t *token);
 
+/** Acquires a run of consecutive tokens from a FIFO channel through a given write
+ *  port.
+ *
+ *  Blocks until the channel has at least one token available for acquisition
+ *  through the port, and then acquires as many of the available tokens as
+ *  requested, up to the end of the channel's buffer; a run that would wrap around
+ *  the end of the buffer is cut short, and the remaining tokens are acquired by a
+ *  next call.
+ *  Writers are suspended and resumed as by vftasks_acquire_room().
+ *  The other tokens of the run are retrieved by vftasks_token_in_run().
+ *
+ *  @param  wport  A pointer to the port.
+ *  @param  n      The maximum number of tokens to acquire; at least 1.
+ *  @param  count  A pointer to the location to store the number of acquired tokens
+ *                 in.
+ *
+ *  @return
+ *    A pointer to the first token of the run.
+ */
+vftasks_token_t *vftasks_acquire_room_n(vftasks_wport_t *wport, int n, int *count);
+
+/** Attempts to acquire a run of consecutive tokens from a FIFO channel through a
+ *  given write port.
+ *
+ *  Acquires as many of the available tokens as requested, up to the end of the
+ *  channel's buffer, as vftasks_acquire_room_n() does, but fails if the channel
+ *  does not have any tokens available for acquisition through the port.
+ *
+ *  @param  wport  A pointer to the port.
+ *  @param  n      The maximum number of tokens to acquire; at least 1.
+ *  @param  count  A pointer to the location to store the number of acquired tokens
+ *                 in; 0 on failure.
+ *
+ *  @return
+ *    On success, a pointer to the first token of the run.
+ *    On failure, NULL.
+ */
+vftasks_token_t *vftasks_acquire_room_n_nb(vftasks_wport_t *wport,
+                                           int n,
+                                           int *count);
+
+/** Releases a number of tokens that were previously acquired through a given write
+ *  port, as one batch.
+ *
+ *  Has the same effect as releasing the tokens one by one, but publishes them to
+ *  the readers at once, and checks the ``high-water mark'' only once.
+ *  On a channel with a single writer and reader, the oldest acquired tokens are
+ *  released; on other channels, the given token and the ones after it in the run
+ *  through which it was acquired.
+ *
+ *  @param  wport  A pointer to the port.
+ *  @param  token  A pointer to the first token.
+ *  @param  n      The number of tokens.
+ */
+void vftasks_release_data_n(vftasks_wport_t *wport, vftasks_token_t *token, int n);
+
 
 /* ***************************************************************************
  * Consumer operations
@@ -988,6 +2661,78 @@ vftasks_token_t *vftasks_acquire_data_nb(vftasks_rport_t *rport);
  */
 void vftasks_release_room(vftasks_rport_t *rport, vftasks_token_t *token);
 
+/** Acquires a run of consecutive tokens from a FIFO channel through a given read
+ *  port.
+ *
+ *  Blocks until the channel has at least one token available for acquisition
+ *  through the port, and then acquires as many of the available tokens as
+ *  requested, up to the end of the channel's buffer; a run that would wrap around
+ *  the end of the buffer is cut short, and the remaining tokens are acquired by a
+ *  next call.
+ *  Readers are suspended and resumed as by vftasks_acquire_data().
+ *  The other tokens of the run are retrieved by vftasks_token_in_run().
+ *
+ *  @param  rport  A pointer to the port.
+ *  @param  n      The maximum number of tokens to acquire; at least 1.
+ *  @param  count  A pointer to the location to store the number of acquired tokens
+ *                 in.
+ *
+ *  @return
+ *    A pointer to the first token of the run.
+ */
+vftasks_token_t *vftasks_acquire_data_n(vftasks_rport_t *rport, int n, int *count);
+
+/** Attempts to acquire a run of consecutive tokens from a FIFO channel through a
+ *  given read port.
+ *
+ *  Acquires as many of the available tokens as requested, up to the end of the
+ *  channel's buffer, as vftasks_acquire_data_n() does, but fails if the channel
+ *  does not have any tokens available for acquisition through the port.
+ *
+ *  @param  rport  A pointer to the port.
+ *  @param  n      The maximum number of tokens to acquire; at least 1.
+ *  @param  count  A pointer to the location to store the number of acquired tokens
+ *                 in; 0 on failure.
+ *
+ *  @return
+ *    On success, a pointer to the first token of the run.
+ *    On failure, NULL.
+ */
+vftasks_token_t *vftasks_acquire_data_n_nb(vftasks_rport_t *rport,
+                                           int n,
+                                           int *count);
+
+/** Releases a number of tokens that were previously acquired through a given read
+ *  port, as one batch.
+ *
+ *  Has the same effect as releasing the tokens one by one, but hands them back to
+ *  the writers at once, and checks the ``low-water mark'' only once.
+ *  On a channel with a single writer and reader, the oldest acquired tokens are
+ *  released; on other channels, the given token and the ones after it in the run
+ *  through which it was acquired.
+ *
+ *  @param  rport  A pointer to the port.
+ *  @param  token  A pointer to the first token.
+ *  @param  n      The number of tokens.
+ */
+void vftasks_release_room_n(vftasks_rport_t *rport, vftasks_token_t *token, int n);
+
+/** Retrieves a token of a run that was acquired by vftasks_acquire_room_n(),
+ *  vftasks_acquire_data_n(), or their nonblocking variants.
+ *  The tokens of a run are not necessarily adjacent in memory, so they are to be
+ *  retrieved by this function rather than by pointer arithmetic.
+ *
+ *  @param  chan   A pointer to the channel through which the run was acquired.
+ *  @param  token  A pointer to the first token of the run.
+ *  @param  k      The index of the token within the run.
+ *
+ *  @return
+ *    A pointer to the token.
+ */
+vftasks_token_t *vftasks_token_in_run(vftasks_chan_t *chan,
+                                      vftasks_token_t *token,
+                                      int k);
+
 
 /* ***************************************************************************
  * Shared-memory-mode operations
@@ -1307,6 +3052,8 @@ void *vftasks_get_ptr(vftasks_token_t *token, size_t offset);
  *
  *  That is, readers are notified through a hook that was installed by
  *  vftasks_install_chan_hooks.
+ *  Tokens released through the port that have not been made available for
+ *  reading yet, because of the publication interval, are made available first.
  *  Typically called by a writer to signal that it has completed its task and
  *  that no more tokens should be expected to become available for reading.
  *
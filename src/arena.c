@@ -0,0 +1,129 @@
+#include "arena.h"
+#include "platform.h"
+
+#include <stdlib.h>     /* for malloc and free */
+
+/* ***************************************************************************
+ * Per-worker scratch arenas
+ * ***************************************************************************/
+
+/* Alignment of the memory handed out by an arena; suffices for any scalar type */
+#define ARENA_ALIGNMENT 16
+
+#define ARENA_ROUND_UP(SIZE) \
+  (((SIZE) + (ARENA_ALIGNMENT - 1)) & ~((size_t)ARENA_ALIGNMENT - 1))
+
+/* size of a block header, rounded up so the usable space stays aligned */
+#define ARENA_HEADER_SIZE ARENA_ROUND_UP(sizeof(vftasks_arena_block_t))
+
+#define ARENA_BLOCK_DATA(BLOCK) ((char *)(BLOCK) + ARENA_HEADER_SIZE)
+
+/** initialize an arena; no memory is reserved until the first allocation, so that
+ *  blocks are first touched by the worker thread that uses them
+ */
+void _vftasks_arena_init(vftasks_arena_t *arena, size_t block_size)
+{
+  arena->first = NULL;
+  arena->current = NULL;
+  arena->next = NULL;
+  arena->limit = NULL;
+  arena->block_size = block_size > 0 ? block_size : VFTASKS_ARENA_BLOCK_SIZE;
+  arena->used = 0;
+  arena->high_water = 0;
+  arena->reserved = 0;
+  arena->persistent = 0;
+}
+
+/** release all blocks held by an arena
+ */
+void _vftasks_arena_destroy(vftasks_arena_t *arena)
+{
+  vftasks_arena_block_t *block, *next;  /* blocks in the arena */
+
+  for (block = arena->first; block != NULL; block = next)
+  {
+    next = block->next;
+    free(block);
+  }
+
+  _vftasks_arena_init(arena, arena->block_size);
+}
+
+/** make a block current
+ */
+static inline void vftasks_enter_block(vftasks_arena_t *arena,
+                                       vftasks_arena_block_t *block)
+{
+  arena->current = block;
+  arena->next = ARENA_BLOCK_DATA(block);
+  arena->limit = arena->next + block->size;
+}
+
+/** allocate from an arena
+ */
+void *vftasks_worker_alloc(vftasks_arena_t *arena, size_t size)
+{
+  vftasks_arena_block_t *block;  /* block to carve the allocation from */
+  char *ptr;                     /* the allocated memory */
+
+  if (arena == NULL) return NULL;
+
+  size = ARENA_ROUND_UP(size > 0 ? size : 1);
+
+  /* advance to the next retained block that is large enough, if the current one
+     is exhausted; a block that is too small is skipped for this cycle */
+  while (arena->next == NULL || (size_t)(arena->limit - arena->next) < size)
+  {
+    block = arena->current != NULL ? arena->current->next : arena->first;
+    if (block == NULL) break;
+    vftasks_enter_block(arena, block);
+  }
+
+  /* no retained block fits: append a fresh one */
+  if (arena->next == NULL || (size_t)(arena->limit - arena->next) < size)
+  {
+    size_t block_size = size > arena->block_size ? size : arena->block_size;
+
+    block = (vftasks_arena_block_t *)malloc(ARENA_HEADER_SIZE + block_size);
+    if (block == NULL) return NULL;
+
+    block->size = block_size;
+    block->next = NULL;
+    if (arena->current != NULL)
+      arena->current->next = block;
+    else
+      arena->first = block;
+
+    /* the statistics are read by other threads while the worker runs */
+    ATOMIC_STORE_RELAXED(&arena->reserved, arena->reserved + block_size);
+    vftasks_enter_block(arena, block);
+  }
+
+  /* carve the allocation */
+  ptr = arena->next;
+  arena->next += size;
+
+  /* keep track of the high-water mark */
+  arena->used += size;
+  if (arena->used > arena->high_water)
+    ATOMIC_STORE_RELAXED(&arena->high_water, arena->used);
+
+  return ptr;
+}
+
+/** reset an arena
+ */
+void vftasks_reset_arena(vftasks_arena_t *arena)
+{
+  /* retain the blocks, but start carving from the first one again */
+  arena->used = 0;
+  if (arena->first != NULL)
+    vftasks_enter_block(arena, arena->first);
+}
+
+/** select persistent mode
+ */
+void vftasks_set_arena_persistent(vftasks_arena_t *arena, int persistent)
+{
+  arena->persistent = persistent;
+}
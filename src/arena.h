@@ -0,0 +1,37 @@
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include "vftasks.h"
+
+/* Default size of the blocks from which a scratch arena carves its allocations */
+#define VFTASKS_ARENA_BLOCK_SIZE 65536
+
+typedef struct vftasks_arena_block_s vftasks_arena_block_t;
+
+/** block of scratch memory; the usable space follows the header
+ */
+struct vftasks_arena_block_s
+{
+  vftasks_arena_block_t *next;  /* next block in the arena */
+  size_t size;                  /* number of usable bytes in the block */
+};
+
+/** scratch arena
+ */
+struct vftasks_arena_s
+{
+  vftasks_arena_block_t *first;    /* first block in the arena */
+  vftasks_arena_block_t *current;  /* block that allocations are carved from */
+  char *next;                      /* first free byte in the current block */
+  char *limit;                     /* first byte beyond the current block */
+  size_t block_size;               /* minimum size of a freshly allocated block */
+  size_t used;                     /* bytes handed out since the last reset */
+  size_t high_water;               /* maximum of used over the arena's lifetime */
+  size_t reserved;                 /* total number of bytes held in blocks */
+  int persistent;                  /* nonzero if not reset at the end of a task */
+};
+
+void _vftasks_arena_init(vftasks_arena_t *, size_t);
+void _vftasks_arena_destroy(vftasks_arena_t *);
+
+#endif /* __ARENA_H */
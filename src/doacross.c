@@ -0,0 +1,141 @@
+#include "vftasks.h"
+#include "sync.h"
+
+#include <stdlib.h>     /* for malloc and free */
+
+/* Number of eventcounts on which threads that wait for an iteration park; iteration
+   i is waited for on eventcount i % DOACROSS_NUM_EVENTCOUNTS */
+#define DOACROSS_NUM_EVENTCOUNTS 64
+
+/* ***************************************************************************
+ * Doacross synchronization between tasks
+ * ***************************************************************************/
+
+/** eventcount in a cache line of its own
+ */
+typedef struct ALIGNED(CACHE_LINE_SIZE) vftasks_doacross_event_s
+{
+  vftasks_eventcount_t eventcount;  /* notified when one of the iterations that
+                                       map to it is signalled */
+} vftasks_doacross_event_t;
+
+/** doacross-synchronization manager
+ */
+struct vftasks_doacross_mgr_s
+{
+  int num_iterations;                /* number of iterations of the loop */
+  int64_t epoch;                     /* number of the current execution, counting
+                                        from 1 */
+  int64_t *signalled;                /* per iteration, the number of the last
+                                        execution in which it was signalled */
+  vftasks_doacross_event_t *events;  /* eventcounts for parking */
+};
+
+/** create a doacross-synchronization manager
+ */
+vftasks_doacross_mgr_t *vftasks_create_doacross_mgr(int num_iterations)
+{
+  vftasks_doacross_mgr_t *mgr;  /* pointer to the manager */
+  int i;                        /* index */
+
+  /* check argument */
+  if (num_iterations < 0)
+  {
+    _vftasks_abort_on_fail("vftasks_create_doacross_mgr: invalid argument");
+    return NULL;
+  }
+
+  /* allocate a manager */
+  mgr = (vftasks_doacross_mgr_t *)malloc(sizeof(vftasks_doacross_mgr_t));
+  if (mgr == NULL)
+  {
+    _vftasks_abort_on_fail("vftasks_create_doacross_mgr: not enough memory");
+    return NULL;
+  }
+
+  mgr->signalled = (int64_t *)malloc((num_iterations > 0 ? num_iterations : 1) *
+                                     sizeof(int64_t));
+  if (mgr->signalled == NULL)
+  {
+    free(mgr);
+    _vftasks_abort_on_fail("vftasks_create_doacross_mgr: not enough memory");
+    return NULL;
+  }
+
+  if (ALIGNED_MALLOC(mgr->events,
+                     CACHE_LINE_SIZE,
+                     DOACROSS_NUM_EVENTCOUNTS * sizeof(vftasks_doacross_event_t)) != 0)
+  {
+    free(mgr->signalled);
+    free(mgr);
+    _vftasks_abort_on_fail("vftasks_create_doacross_mgr: not enough memory");
+    return NULL;
+  }
+
+  mgr->num_iterations = num_iterations;
+  mgr->epoch = 1;
+  for (i = 0; i < num_iterations; ++i) mgr->signalled[i] = 0;
+  for (i = 0; i < DOACROSS_NUM_EVENTCOUNTS; ++i)
+    _vftasks_eventcount_init(&mgr->events[i].eventcount);
+
+  /* return the pointer to the manager */
+  return mgr;
+}
+
+/** destroy a doacross-synchronization manager
+ */
+void vftasks_destroy_doacross_mgr(vftasks_doacross_mgr_t *mgr)
+{
+  ALIGNED_FREE(mgr->events);
+  free(mgr->signalled);
+  free(mgr);
+}
+
+/** reset a doacross-synchronization manager
+ */
+int vftasks_reset_doacross_mgr(vftasks_doacross_mgr_t *mgr)
+{
+  /* check argument */
+  if (mgr == NULL)
+  {
+    _vftasks_abort_on_fail("vftasks_reset_doacross_mgr: invalid argument");
+    return 1;
+  }
+
+  /* rather than clearing the iterations, start a new execution: iterations
+     signalled in earlier ones no longer count as signalled */
+  ++mgr->epoch;
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** signal end of iteration
+ */
+int vftasks_signal_doacross(vftasks_doacross_mgr_t *mgr, int i)
+{
+  /* iterations outside the iteration space are not waited for */
+  if (i < 0 || i >= mgr->num_iterations) return 0;
+
+  ATOMIC_STORE_RELEASE(&mgr->signalled[i], mgr->epoch);
+  vftasks_notify(&mgr->events[i % DOACROSS_NUM_EVENTCOUNTS].eventcount);
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** wait for an iteration
+ */
+int vftasks_wait_doacross(vftasks_doacross_mgr_t *mgr, int i)
+{
+  /* iterations outside the iteration space are never signalled */
+  if (i < 0 || i >= mgr->num_iterations) return 0;
+
+  _vftasks_wait_count(&mgr->signalled[i],
+                      mgr->epoch,
+                      &mgr->events[i % DOACROSS_NUM_EVENTCOUNTS].eventcount,
+                      VFTASKS_SYNC_SPIN_LIMIT);
+
+  /* return 0 to indicate success */
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include "eventcount.h"
+#include "platform.h"
+
+#include <stdlib.h>     /* for malloc, free, and abort */
+#include <stdio.h>      /* for printing to stderr */
+
+/* ***************************************************************************
+ * Aborting on failure
+ * ***************************************************************************/
+
+/** abort
+ */
+static void abort_on_fail(char *msg)
+{
+#ifdef VFTASKS_ABORT_ON_FAILURE
+  fprintf(stderr, "Failure: %s\n", msg);
+  abort();
+#endif
+}
+
+/* ***************************************************************************
+ * Eventcounts
+ * ***************************************************************************/
+
+/* the epoch part of a state */
+#define EVENTCOUNT_EPOCH(STATE) ((unsigned int)(STATE) & ~EVENTCOUNT_WAITER_MASK)
+
+/** initialize an eventcount that is embedded in another structure
+ */
+void _vftasks_eventcount_init(vftasks_eventcount_t *eventcount)
+{
+  eventcount->state = 0;
+}
+
+/** create eventcount
+ */
+vftasks_eventcount_t *vftasks_create_eventcount(void)
+{
+  vftasks_eventcount_t *eventcount;  /* pointer to the eventcount */
+
+  eventcount = (vftasks_eventcount_t *)malloc(sizeof(vftasks_eventcount_t));
+  if (eventcount == NULL)
+  {
+    abort_on_fail("vftasks_create_eventcount: not enough memory");
+    return NULL;
+  }
+
+  _vftasks_eventcount_init(eventcount);
+
+  return eventcount;
+}
+
+/** destroy eventcount
+ */
+void vftasks_destroy_eventcount(vftasks_eventcount_t *eventcount)
+{
+  free(eventcount);
+}
+
+/** prepare wait
+ */
+unsigned int vftasks_prepare_wait(vftasks_eventcount_t *eventcount)
+{
+  /* registering as a waiter is a read-modify-write, which is ordered before the
+     caller rechecks its predicate */
+  return EVENTCOUNT_EPOCH(ATOMIC_FETCH_ADD(&eventcount->state, 1));
+}
+
+/** cancel wait
+ */
+void vftasks_cancel_wait(vftasks_eventcount_t *eventcount, unsigned int key)
+{
+  int state;  /* the current state */
+
+  /* withdraw as a waiter, unless a notification has already done so */
+  state = ATOMIC_LOAD_RELAXED(&eventcount->state);
+  while (EVENTCOUNT_EPOCH(state) == key &&
+         !ATOMIC_CAS(&eventcount->state, state, state - 1));
+}
+
+/** commit wait
+ */
+void vftasks_commit_wait(vftasks_eventcount_t *eventcount, unsigned int key)
+{
+  int state;  /* the current state */
+
+  /* the notification that advances the epoch also withdraws all waiters */
+  state = ATOMIC_LOAD_ACQUIRE(&eventcount->state);
+  while (EVENTCOUNT_EPOCH(state) == key)
+  {
+    ADDRESS_WAIT(&eventcount->state, state);
+    state = ATOMIC_LOAD_ACQUIRE(&eventcount->state);
+  }
+}
+
+/** notify
+ */
+void vftasks_notify(vftasks_eventcount_t *eventcount)
+{
+  int state;  /* the current state */
+
+  /* order the caller's update of the predicate before the check for waiters; a
+     waiter that registers later on is bound to see the update */
+  ATOMIC_FENCE();
+  state = ATOMIC_LOAD_RELAXED(&eventcount->state);
+  if ((state & EVENTCOUNT_WAITER_MASK) == 0) return;
+
+  /* advance the epoch and withdraw all waiters at once: setting all waiter bits
+     and adding one carries into the epoch */
+  while (!ATOMIC_CAS(&eventcount->state,
+                     state,
+                     (int)(((unsigned int)state | EVENTCOUNT_WAITER_MASK) + 1)))
+  {
+    if ((state & EVENTCOUNT_WAITER_MASK) == 0) return;
+  }
+
+  ADDRESS_WAKE_ALL(&eventcount->state);
+}
@@ -0,0 +1,21 @@
+#ifndef __EVENTCOUNT_H
+#define __EVENTCOUNT_H
+
+#include "vftasks.h"
+
+/* The state of an eventcount is a single integer, so that it can be waited on
+   directly: the lower bits count the waiters that have prepared to wait, the upper
+   bits hold the epoch, which is advanced by every notification that finds waiters */
+#define EVENTCOUNT_WAITER_BITS 16
+#define EVENTCOUNT_WAITER_MASK ((1u << EVENTCOUNT_WAITER_BITS) - 1)
+
+/** eventcount
+ */
+struct vftasks_eventcount_s
+{
+  int state;  /* epoch and number of waiters */
+};
+
+void _vftasks_eventcount_init(vftasks_eventcount_t *);
+
+#endif /* __EVENTCOUNT_H */
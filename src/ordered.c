@@ -0,0 +1,102 @@
+#include "vftasks.h"
+#include "sync.h"
+
+#include <stdlib.h>     /* for malloc and free */
+
+/* ***************************************************************************
+ * Ordered sections
+ * ***************************************************************************/
+
+/** ordered section
+ */
+struct vftasks_ordered_s
+{
+  vftasks_progress_t *ticket;  /* index of the iteration whose turn it is to
+                                  execute the section */
+};
+
+/** create an ordered section
+ */
+vftasks_ordered_t *vftasks_create_ordered(void)
+{
+  vftasks_ordered_t *ordered;  /* pointer to the section */
+
+  ordered = (vftasks_ordered_t *)malloc(sizeof(vftasks_ordered_t));
+  if (ordered == NULL)
+  {
+    _vftasks_abort_on_fail("vftasks_create_ordered: not enough memory");
+    return NULL;
+  }
+
+  ordered->ticket = _vftasks_create_progress(1, 0);
+  if (ordered->ticket == NULL)
+  {
+    free(ordered);
+    _vftasks_abort_on_fail("vftasks_create_ordered: not enough memory");
+    return NULL;
+  }
+
+  /* return the pointer to the section */
+  return ordered;
+}
+
+/** destroy an ordered section
+ */
+void vftasks_destroy_ordered(vftasks_ordered_t *ordered)
+{
+  _vftasks_destroy_progress(ordered->ticket);
+  free(ordered);
+}
+
+/** reset an ordered section
+ */
+int vftasks_reset_ordered(vftasks_ordered_t *ordered)
+{
+  /* check argument */
+  if (ordered == NULL)
+  {
+    _vftasks_abort_on_fail("vftasks_reset_ordered: invalid argument");
+    return 1;
+  }
+
+  ATOMIC_STORE_RELAXED(&ordered->ticket->count, 0);
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** enter an ordered section
+ */
+int vftasks_ordered_begin(vftasks_ordered_t *ordered, int i)
+{
+  int polls;  /* number of polls so far */
+
+  /* when iterations arrive in order, the turn has come already and this is a
+     single load */
+  if (ATOMIC_LOAD_ACQUIRE(&ordered->ticket->count) >= i) return 0;
+
+  /* the thread whose turn it is may share the processor with this one, so the
+     processor is yielded in between polls, rather than paused on */
+  for (polls = 0; polls < VFTASKS_SYNC_SPIN_LIMIT; ++polls)
+  {
+    THREAD_YIELD();
+    if (ATOMIC_LOAD_ACQUIRE(&ordered->ticket->count) >= i) return 0;
+  }
+
+  /* park until the turn has come */
+  _vftasks_wait_progress(ordered->ticket, i, 1);
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** leave an ordered section
+ */
+int vftasks_ordered_end(vftasks_ordered_t *ordered, int i)
+{
+  /* pass the turn on to the next iteration */
+  _vftasks_set_progress(ordered->ticket, (int64_t)i + 1, VFTASKS_SYNC_SPIN_LIMIT);
+
+  /* return 0 to indicate success */
+  return 0;
+}
@@ -9,4 +9,9 @@
 #error("unsupported platform")
 #endif /* _POSIX_SOURCE / _WIN32 */
 
+/* Size of a cache line on the targeted processors; used to lay out data that is
+   written by different threads in separate cache lines (in order to avoid false
+   sharing) */
+#define CACHE_LINE_SIZE 64
+
 #endif /* PLATFORM_H */
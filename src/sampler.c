@@ -0,0 +1,170 @@
+#include "vftasks.h"
+
+#include <stdlib.h>     /* for malloc, calloc, free, and abort */
+#include <stdio.h>      /* for printing to stderr */
+#include <string.h>     /* for memcpy and memset */
+
+/* ***************************************************************************
+ * Types
+ * ***************************************************************************/
+
+/** sampler
+ */
+struct vftasks_sampler_s
+{
+  vftasks_pool_t *pool;                  /* the sampled pool */
+  int num_workers;                       /* number of workers in the pool */
+  vftasks_worker_snapshot_t *snapshot;   /* the most recent snapshot */
+  unsigned long *busy_histogram;         /* number of samples per number of busy
+                                            workers */
+  unsigned long *state_counts;           /* number of samples per worker and
+                                            state */
+};
+
+/* ***************************************************************************
+ * Aborting on failure
+ * ***************************************************************************/
+
+/** abort
+ */
+static void abort_on_fail(char *msg)
+{
+#ifdef VFTASKS_ABORT_ON_FAILURE
+  fprintf(stderr, "Failure: %s\n", msg);
+  abort();
+#endif
+}
+
+/* ***************************************************************************
+ * Sampling of worker-thread pools
+ * ***************************************************************************/
+
+/** create sampler
+ */
+vftasks_sampler_t *vftasks_create_sampler(vftasks_pool_t *pool)
+{
+  vftasks_sampler_t *sampler;  /* pointer to the sampler */
+  vftasks_pool_stats_t stats;  /* statistics of the pool, for its size */
+
+  if (vftasks_get_pool_stats(pool, &stats) != 0)
+  {
+    abort_on_fail("vftasks_create_sampler: invalid pool");
+    return NULL;
+  }
+
+  /* allocate the sampler */
+  sampler = (vftasks_sampler_t *)malloc(sizeof(vftasks_sampler_t));
+  if (sampler == NULL)
+  {
+    abort_on_fail("vftasks_create_sampler: not enough memory");
+    return NULL;
+  }
+
+  sampler->pool = pool;
+  sampler->num_workers = stats.num_workers;
+
+  /* allocate the snapshot and the histograms */
+  sampler->snapshot = (vftasks_worker_snapshot_t *)
+    malloc(stats.num_workers * sizeof(vftasks_worker_snapshot_t));
+  sampler->busy_histogram = (unsigned long *)
+    calloc(stats.num_workers + 1, sizeof(unsigned long));
+  sampler->state_counts = (unsigned long *)
+    calloc(stats.num_workers * VFTASKS_NUM_WORKER_STATES, sizeof(unsigned long));
+
+  if (sampler->snapshot == NULL ||
+      sampler->busy_histogram == NULL ||
+      sampler->state_counts == NULL)
+  {
+    vftasks_destroy_sampler(sampler);
+    abort_on_fail("vftasks_create_sampler: not enough memory");
+    return NULL;
+  }
+
+  return sampler;
+}
+
+/** destroy sampler
+ */
+void vftasks_destroy_sampler(vftasks_sampler_t *sampler)
+{
+  free(sampler->snapshot);
+  free(sampler->busy_histogram);
+  free(sampler->state_counts);
+  free(sampler);
+}
+
+/** sample pool
+ */
+int vftasks_sample_pool(vftasks_sampler_t *sampler)
+{
+  int i;         /* index of a worker */
+  int num_busy;  /* number of busy workers in the snapshot */
+
+  if (sampler == NULL)
+  {
+    abort_on_fail("vftasks_sample_pool: invalid sampler");
+    return 1;
+  }
+
+  if (vftasks_get_pool_snapshot(sampler->pool, sampler->snapshot) != 0)
+  {
+    abort_on_fail("vftasks_sample_pool: snapshot failed");
+    return 1;
+  }
+
+  /* accumulate the snapshot */
+  num_busy = 0;
+  for (i = 0; i < sampler->num_workers; ++i)
+  {
+    if (sampler->snapshot[i].state == VFTASKS_WORKER_BUSY) num_busy++;
+    sampler->state_counts[i * VFTASKS_NUM_WORKER_STATES + sampler->snapshot[i].state]++;
+  }
+  sampler->busy_histogram[num_busy]++;
+
+  return 0;
+}
+
+/** reset sampler
+ */
+void vftasks_reset_sampler(vftasks_sampler_t *sampler)
+{
+  memset(sampler->busy_histogram, 0,
+         (sampler->num_workers + 1) * sizeof(unsigned long));
+  memset(sampler->state_counts, 0,
+         sampler->num_workers * VFTASKS_NUM_WORKER_STATES * sizeof(unsigned long));
+}
+
+/** get histogram of busy workers
+ */
+int vftasks_get_busy_histogram(vftasks_sampler_t *sampler, unsigned long *histogram)
+{
+  if (sampler == NULL || histogram == NULL)
+  {
+    abort_on_fail("vftasks_get_busy_histogram: invalid argument");
+    return 1;
+  }
+
+  memcpy(histogram, sampler->busy_histogram,
+         (sampler->num_workers + 1) * sizeof(unsigned long));
+
+  return 0;
+}
+
+/** get state counts of a worker
+ */
+int vftasks_get_worker_state_counts(vftasks_sampler_t *sampler,
+                                    int worker,
+                                    unsigned long *counts)
+{
+  if (sampler == NULL || counts == NULL ||
+      worker < 0 || worker >= sampler->num_workers)
+  {
+    abort_on_fail("vftasks_get_worker_state_counts: invalid argument");
+    return 1;
+  }
+
+  memcpy(counts, &sampler->state_counts[worker * VFTASKS_NUM_WORKER_STATES],
+         VFTASKS_NUM_WORKER_STATES * sizeof(unsigned long));
+
+  return 0;
+}
@@ -2,13 +2,38 @@
 
 #ifdef _POSIX_SOURCE
 
+#include "platform.h"
+
+#include <errno.h>
+
 int _vftasks_sem_create(_vftasks_semaphore_t *sem, int value)
 {
   int r;
 
   sem->value = value;
+  sem->wakeups = 0;
+  sem->first = NULL;
+  sem->last = &sem->first;
   r = pthread_mutex_init(&sem->lock, NULL);
-  if (!r) r = pthread_cond_init(&sem->flag, NULL);
+
+  /* bind the condition variables of the waiters to the clock that timed waits are
+     measured on */
+  if (!r)
+  {
+    r = pthread_condattr_init(&sem->attr);
+    if (r) pthread_mutex_destroy(&sem->lock);
+  }
+#ifdef _SEM_MONOTONIC
+  if (!r)
+  {
+    r = pthread_condattr_setclock(&sem->attr, _SEM_CLOCK);
+    if (r)
+    {
+      pthread_condattr_destroy(&sem->attr);
+      pthread_mutex_destroy(&sem->lock);
+    }
+  }
+#endif
 
   return (r != 0);
 }
@@ -17,40 +42,228 @@ int _vftasks_sem_destroy(_vftasks_semaphore_t *sem)
 {
   int r, s;
 
-  r = pthread_cond_destroy(&sem->flag);
+  r = pthread_condattr_destroy(&sem->attr);
   s = pthread_mutex_destroy(&sem->lock);
 
   return (r || s);
 }
 
+/** grant the units that have been handed over to the waiters at the front of the
+ *  line, as far as they suffice, and wake up only those waiters; the lock is held,
+ *  so a waiter cannot return, and dispose of its condition variable, before it
+ *  has been signalled
+ */
+static int _vftasks_sem_grant(_vftasks_semaphore_t *sem)
+{
+  _vftasks_sem_waiter_t *waiter;  /* the first waiter in line */
+  int r;
+
+  r = 0;
+  while ((waiter = sem->first) != NULL && waiter->needed <= sem->wakeups)
+  {
+    sem->wakeups -= waiter->needed;
+    waiter->granted = 1;
+    sem->first = waiter->next;
+    if (pthread_cond_signal(&waiter->flag) != 0) r = 1;
+  }
+
+  if (sem->first == NULL) sem->last = &sem->first;
+
+  return r;
+}
+
+/** remove a waiter that has not been granted its units from the line; the lock is
+ *  held
+ */
+static void _vftasks_sem_leave(_vftasks_semaphore_t *sem, _vftasks_sem_waiter_t *self)
+{
+  _vftasks_sem_waiter_t **link;  /* the link that points to the waiter */
+
+  for (link = &sem->first; *link != self; link = &(*link)->next);
+  *link = self->next;
+  if (sem->last == &self->next) sem->last = link;
+}
+
+/** join the line of waiters, short of a given number of units; the lock is held,
+ *  and the condition variable of the waiter has been initialized
+ */
+static int _vftasks_sem_join(_vftasks_semaphore_t *sem,
+                             _vftasks_sem_waiter_t *self,
+                             int needed)
+{
+  self->next = NULL;
+  self->needed = needed;
+  self->granted = 0;
+  *sem->last = self;
+  sem->last = &self->next;
+
+  /* posts may have handed over units before the waiter got the lock */
+  return _vftasks_sem_grant(sem);
+}
+
+/** block until a given number of units has been granted to the waiter; the lock
+ *  is held
+ */
+static int _vftasks_sem_collect(_vftasks_semaphore_t *sem, int needed)
+{
+  _vftasks_sem_waiter_t self;  /* the waiter's place in line */
+  int s;                       /* result of waiting */
+
+  if (pthread_cond_init(&self.flag, &sem->attr) != 0) return 1;
+
+  s = _vftasks_sem_join(sem, &self, needed);
+  while (!self.granted && s == 0)
+    s = pthread_cond_wait(&self.flag, &sem->lock);
+
+  if (!self.granted) _vftasks_sem_leave(sem, &self);
+
+  pthread_cond_destroy(&self.flag);
+
+  return s;
+}
+
 int _vftasks_sem_wait(_vftasks_semaphore_t *sem)
 {
+  return _vftasks_sem_wait_n(sem, 1);
+}
+
+int _vftasks_sem_wait_n(_vftasks_semaphore_t *sem, int n)
+{
+  int value;  /* the count before taking the units */
   int r, s;
 
+  /* take the units that are available; if that is not enough, the shortage is
+     recorded in the count */
+  value = ATOMIC_FETCH_ADD(&sem->value, -n);
+  if (value >= n) return 0;
+
+  r = pthread_mutex_lock(&sem->lock);
+  s = 0;
+
+  if (!r)
+  {
+    /* wait until posts have made up for the shortage */
+    s = _vftasks_sem_collect(sem, value > 0 ? n - value : n);
+    r = pthread_mutex_unlock(&sem->lock);
+  }
+
+  return (r || s);
+}
+
+int _vftasks_sem_timedwait(_vftasks_semaphore_t *sem, uint64_t timeout_ns)
+{
+  struct timespec deadline;
+  _vftasks_sem_waiter_t self;
+  int value;
+  int r, s;
+
+  /* take a unit if one is available; otherwise, register as a waiter */
+  if (ATOMIC_FETCH_ADD(&sem->value, -1) > 0) return 0;
+
+  /* convert the timeout into an absolute deadline */
+  clock_gettime(_SEM_CLOCK, &deadline);
+  deadline.tv_sec += timeout_ns / 1000000000;
+  deadline.tv_nsec += timeout_ns % 1000000000;
+  if (deadline.tv_nsec >= 1000000000)
+  {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+
   r = pthread_mutex_lock(&sem->lock);
   s = 0;
 
+  if (!r && pthread_cond_init(&self.flag, &sem->attr) != 0)
+  {
+    pthread_mutex_unlock(&sem->lock);
+    r = 1;
+  }
+
   if (!r)
   {
-    s = (--sem->value) < 0 ? pthread_cond_wait(&sem->flag, &sem->lock) : 0;
+    s = _vftasks_sem_join(sem, &self, 1);
+    while (!self.granted && s == 0)
+      s = pthread_cond_timedwait(&self.flag, &sem->lock, &deadline);
+
+    if (self.granted)
+    {
+      s = 0;
+    }
+    else
+    {
+      /* timed out; withdraw from the count, unless the shortage has been made up
+         for already, in which case the unit for this waiter is on its way; as
+         units are only granted in order, leaving the line never lets a waiter
+         behind this one through */
+      value = ATOMIC_LOAD_RELAXED(&sem->value);
+      while (value < 0 && !ATOMIC_CAS(&sem->value, value, value + 1));
+
+      if (value < 0)
+      {
+        _vftasks_sem_leave(sem, &self);
+        s = ETIMEDOUT;
+      }
+      else
+      {
+        s = 0;
+        while (!self.granted && s == 0)
+          s = pthread_cond_wait(&self.flag, &sem->lock);
+        if (!self.granted) _vftasks_sem_leave(sem, &self);
+      }
+    }
+
+    pthread_cond_destroy(&self.flag);
     r = pthread_mutex_unlock(&sem->lock);
   }
 
   return (r || s);
 }
 
+int _vftasks_sem_trywait_n(_vftasks_semaphore_t *sem, int n)
+{
+  int value;  /* the count before taking the units */
+  int taken;  /* number of units taken */
+
+  /* take as many of the available units as requested in a single update of the
+     count; if none are available, there is nothing to take */
+  value = ATOMIC_LOAD_RELAXED(&sem->value);
+  do
+  {
+    if (value <= 0) return 0;
+    taken = value < n ? value : n;
+  }
+  while (!ATOMIC_CAS(&sem->value, value, value - taken));
+
+  return taken;
+}
 
 int _vftasks_sem_post(_vftasks_semaphore_t *sem)
 {
+  return _vftasks_sem_post_n(sem, 1);
+}
+
+int _vftasks_sem_post_n(_vftasks_semaphore_t *sem, int n)
+{
+  int value;    /* the count before adding the units */
+  int handed;   /* number of units handed over to waiters */
   int r, s;
 
+  /* add the units; if there is no shortage, that is all */
+  value = ATOMIC_FETCH_ADD(&sem->value, n);
+  if (value >= 0) return 0;
+
   r = pthread_mutex_lock(&sem->lock);
   s = 0;
 
   if (!r)
   {
-    sem->value++;
-    s = pthread_cond_signal(&sem->flag);
+    /* hand over as many units as the waiters are short of, and grant them to the
+       waiters in line; a waiter that has not joined the line yet is granted its
+       units once it does */
+    handed = -value < n ? -value : n;
+    sem->wakeups += handed;
+    s = _vftasks_sem_grant(sem);
+
     r = pthread_mutex_unlock(&sem->lock);
   }
 
@@ -1,22 +1,61 @@
 #ifndef __SEMAPHORE_H
+#define __SEMAPHORE_H
 
 #include "vftasks.h"
 
 #ifdef _POSIX_SOURCE
 
 #include <pthread.h>
+#include <stdint.h>
+#include <time.h>
 
+/* clock against which timed waits are measured; the monotonic clock is used where
+   condition variables can be bound to it */
+#if defined(CLOCK_MONOTONIC) && !defined(__APPLE__)
+#define _SEM_MONOTONIC
+#define _SEM_CLOCK CLOCK_MONOTONIC
+#else
+#define _SEM_CLOCK CLOCK_REALTIME
+#endif
+
+/* A blocked waiter, queued on the semaphore; it lives on the waiter's stack and
+   sleeps on its own condition variable, so that a post only wakes up the waiters
+   it grants units to. */
+typedef struct _vftasks_sem_waiter_s
+{
+  struct _vftasks_sem_waiter_s *next;  /* next waiter in line */
+  int needed;                          /* number of units the waiter is short of */
+  int granted;                         /* set once the units have been handed over */
+  pthread_cond_t flag;                 /* signalled once the units are granted */
+} _vftasks_sem_waiter_t;
+
+/* The count is maintained atomically, so that posting to a semaphore without
+   waiters and waiting on a semaphore with units available do not take the lock.  A
+   negative count is minus the number of units that blocked waiters are short of.
+   Blocked waiters are served in order, each with all the units it is short of at
+   once, so that waiters for several units do not split the units among them. */
 typedef struct
 {
-  int value;
+  int value;              /* number of available units, minus the number of
+                             units that waiters are short of */
+  int wakeups;            /* number of units handed over by posts that have not
+                             been granted to a waiter yet; protected by lock */
+  _vftasks_sem_waiter_t *first;   /* first blocked waiter; protected by lock */
+  _vftasks_sem_waiter_t **last;   /* link to append the next waiter to;
+                                     protected by lock */
   pthread_mutex_t lock;
-  pthread_cond_t flag;
+  pthread_condattr_t attr;        /* attributes of the condition variables of the
+                                     waiters */
 } _vftasks_semaphore_t;
 
 int _vftasks_sem_create(_vftasks_semaphore_t *, int);
 int _vftasks_sem_destroy(_vftasks_semaphore_t *);
 int _vftasks_sem_wait(_vftasks_semaphore_t *);
+int _vftasks_sem_wait_n(_vftasks_semaphore_t *, int);
+int _vftasks_sem_timedwait(_vftasks_semaphore_t *, uint64_t);
+int _vftasks_sem_trywait_n(_vftasks_semaphore_t *, int);
 int _vftasks_sem_post(_vftasks_semaphore_t *);
+int _vftasks_sem_post_n(_vftasks_semaphore_t *, int);
 
 #endif /* _POSIX_SOURCE */
 #endif /* __SEMAPHORE_H */
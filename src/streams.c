@@ -37,6 +37,16 @@
  *  Calling vftasks_release_room releases the oldest acquired data token.
  *  It is possible to acquire multiple room tokens before releasing new data.
  *  Calling vftasks_release_data releases the oldest acquired room token.
+ *  The variants vftasks_acquire_room_n, vftasks_release_data_n, and so on, move
+ *  the pointers by a run of tokens at once, but never past limit: a run ends at
+ *  the end of the buffer.
+ *
+ *  Channels with multiple writers or readers do not use the head and tail
+ *  pointers.
+ *  Instead, every token carries a sequence number that tells which side it has
+ *  been released to, and for which position in the FIFO, and the ports on either
+ *  side claim the token at a shared position counter (see the section on channels
+ *  with multiple writers or readers below).
  */
 
 #include "vftasks.h"
@@ -46,9 +56,17 @@
 #include <string.h>   /* for memcpy */
 
 #include "platform.h"
+#include "eventcount.h"
 
 #define MAX(X,Y)  (((X) > (Y)) ? (X) : (Y))
 
+/* Maximum token size; sizes are rounded up to a power of 2 that fits an int */
+#define MAX_TOKEN_SIZE ((size_t)1 << 30)
+
+/* Maximum number of pauses in between two polls of a thread that is suspended by
+   the blocking hooks; beyond it, the thread yields the processor instead */
+#define MAX_BACKOFF 64
+
 /* ***************************************************************************
  * Types
  * ***************************************************************************/
@@ -72,6 +90,10 @@ struct vftasks_param_s
   int min_room;           /** resume writer when #room tokens >= min_room */
   vftasks_token_t *limit; /** points to first byte beyond token buffer    */
   vftasks_token_t *base;  /** points to start of token buffer             */
+  int kind;               /** kind of channel (VFTASKS_CHAN_SPSC, ...)    */
+  int interval;           /** publish tail once per interval data tokens  */
+  int size;               /** channel size (== #tokens + 1)               */
+  int stride;             /** distance in bytes from a token to the next  */
 };
 
 /**
@@ -79,15 +101,19 @@ struct vftasks_param_s
  */
 struct vftasks_token_s
 {
-  size_t token_size;  /** size of space allocated for the token (power of 2) */
   char *token_base;   /** points to the first byte allocated for the token   */
+  int token_size;     /** size of space allocated for the token (power of 2) */
+  int seq;            /** sequence number, on channels with multiple writers or
+                          readers: twice the position for which the token was
+                          released, plus one if it holds data                */
 };
 
-/** channel
+/** channel; the fields written by the reader and the writer are kept on cache
+ *  lines of their own, apart from each other and from the fields that are mostly
+ *  read
  */
 struct vftasks_chan_s
 {
-  vftasks_state_t state;                 /** channel state                     */
   vftasks_param_t param;                 /** channel parameters                */
   vftasks_rport_t *rport;                /** points to read port connected to
                                              this channel                      */
@@ -99,6 +125,33 @@ struct vftasks_chan_s
   vftasks_writer_hook_t resume_writer;   /** resume-writer hook                */
   vftasks_reader_hook_t suspend_reader;  /** suspend-reader hook               */
   vftasks_reader_hook_t resume_reader;   /** resume-reader hook                */
+  int num_positions;                     /** number of positions before they
+                                             wrap, on channels with multiple
+                                             writers or readers; a multiple of
+                                             #tokens, and at least twice it    */
+  int num_suspended_writers;             /** number of suspended writers, idem */
+  int num_suspended_readers;             /** number of suspended readers, idem */
+  int spin_limit;                        /** number of polls before a suspended
+                                             thread blocks, with the blocking
+                                             hooks                             */
+  vftasks_eventcount_t room_event;       /** notified when a writer is to be
+                                             resumed, idem                     */
+  vftasks_eventcount_t data_event;       /** notified when a reader is to be
+                                             resumed, idem                     */
+  int flat;                              /** nonzero if the tokens are kept in
+                                             the FIFO buffer                   */
+  char read_pad[CACHE_LINE_SIZE];        /** padding                           */
+  vftasks_token_t *head;                 /** points to oldest data token in the
+                                             FIFO                              */
+  int read_pos;                          /** position of the next data token,
+                                             on channels with multiple writers
+                                             or readers                        */
+  char write_pad[CACHE_LINE_SIZE];       /** padding                           */
+  vftasks_token_t *tail;                 /** points to next available room
+                                             token                             */
+  int write_pos;                         /** position of the next room token,
+                                             idem                              */
+  char end_pad[CACHE_LINE_SIZE];         /** padding                           */
 };
 
 /** write port
@@ -114,6 +167,16 @@ struct vftasks_wport_s
                                            zone                                */
   vftasks_token_t *wakeup_zone_end;    /** end of wake-up zone                 */
   vftasks_chan_t *chan;                /** points to channel                   */
+  int suspended;                       /** nonzero while the writer is
+                                           suspended, on channels with multiple
+                                           writers or readers                  */
+  vftasks_wport_t *next;               /** points to next write port connected
+                                           to the channel                      */
+  int num_unpublished;                 /** number of released data tokens that
+                                           have not been published yet         */
+  char end_pad[CACHE_LINE_SIZE];       /** padding, so that the port does not
+                                           share a cache line with what is
+                                           allocated after it                  */
 };
 
 /** read port
@@ -129,9 +192,336 @@ struct vftasks_rport_s
                                            zone                                */
   vftasks_token_t *wakeup_zone_end;    /** end of wake-up zone                 */
   vftasks_chan_t *chan;                /** points to channel                   */
+  int suspended;                       /** nonzero while the reader is
+                                           suspended, on channels with multiple
+                                           writers or readers                  */
+  vftasks_rport_t *next;               /** points to next read port connected
+                                           to the channel                      */
+  char end_pad[CACHE_LINE_SIZE];       /** padding, idem                       */
 };
 
 
+/* ***************************************************************************
+ * Token arithmetic
+ * ***************************************************************************/
+
+/** the token a number of tokens after a given one, without wrapping
+ */
+static inline vftasks_token_t *vftasks_token_after(vftasks_param_t *param,
+                                                   vftasks_token_t *token,
+                                                   int n)
+{
+  return (vftasks_token_t *)((char *)token + n * param->stride);
+}
+
+/** the number of tokens from a token to another one, without wrapping
+ */
+static inline int vftasks_tokens_between(vftasks_param_t *param,
+                                         vftasks_token_t *from,
+                                         vftasks_token_t *to)
+{
+  return (int)(((char *)to - (char *)from) / param->stride);
+}
+
+
+/* ***************************************************************************
+ * Channels with multiple writers or readers
+ * ***************************************************************************/
+
+/* Positions wrap before twice their number overflows an int, which is all that the
+   atomic read-modify-write operations support on every platform; sequence numbers
+   are only told apart if there are at least twice as many positions as tokens */
+#define MAX_POSITIONS (1 << 29)
+#define MAX_MULTI_TOKENS (MAX_POSITIONS / 2)
+
+/** check whether more than one write port can be connected to a channel
+ */
+static inline int vftasks_multi_writer(vftasks_param_t *param)
+{
+  return (param->kind & VFTASKS_CHAN_MPSC) != 0;
+}
+
+/** check whether more than one read port can be connected to a channel
+ */
+static inline int vftasks_multi_reader(vftasks_param_t *param)
+{
+  return (param->kind & VFTASKS_CHAN_SPMC) != 0;
+}
+
+/** the position a number of positions after a given one
+ */
+static inline int vftasks_pos_after(vftasks_chan_t *chan, int pos, int n)
+{
+  pos += n;
+  return pos >= chan->num_positions ? pos - chan->num_positions : pos;
+}
+
+/** the token at a given position
+ */
+static inline vftasks_token_t *vftasks_token_at(vftasks_chan_t *chan, int pos)
+{
+  return vftasks_token_after(&chan->param,
+                             chan->param.base,
+                             pos % (chan->param.size - 1));
+}
+
+/** compare a sequence number with an expected one: negative if the token has not
+ *  been released for the expected position yet, and positive if it has been
+ *  released for a later one
+ */
+static inline int vftasks_seq_cmp(vftasks_chan_t *chan, int seq, int expected)
+{
+  int diff = seq - expected;  /* difference, before taking wrapping into account */
+
+  if (diff >= chan->num_positions) return diff - 2 * chan->num_positions;
+  if (diff < -chan->num_positions) return diff + 2 * chan->num_positions;
+  return diff;
+}
+
+/** claim a run of up to a given number of consecutive tokens at a position counter,
+ *  as far as they have been released to the side that the counter belongs to and
+ *  do not wrap around the end of the buffer; the offset is 0 for the writing side
+ *  and 1 for the reading side, and the counter is only updated atomically if it is
+ *  shared
+ */
+static vftasks_token_t *vftasks_claim_tokens(vftasks_chan_t *chan,
+                                             int *pos_ptr,
+                                             int offset,
+                                             int shared,
+                                             int n,
+                                             int *count)
+{
+  vftasks_token_t *token;  /* the token at the position */
+  int pos;                 /* the position */
+  int cmp;                 /* comparison of the token's sequence number */
+  int max;                 /* maximum length of the run */
+  int k;                   /* length of the run */
+
+  pos = ATOMIC_LOAD_RELAXED(pos_ptr);
+  for (;;)
+  {
+    token = vftasks_token_at(chan, pos);
+    cmp = vftasks_seq_cmp(chan, ATOMIC_LOAD_ACQUIRE(&token->seq), 2 * pos + offset);
+
+    /* the token has not been released to this side yet */
+    if (cmp < 0) return NULL;
+
+    if (cmp > 0)
+    {
+      /* another port has claimed the position already */
+      pos = ATOMIC_LOAD_RELAXED(pos_ptr);
+      continue;
+    }
+
+    /* extend the run over the following tokens that have been released to this
+       side as well; no other port can claim them without moving the counter */
+    max = chan->param.size - 1 - pos % (chan->param.size - 1);
+    if (max > n) max = n;
+    for (k = 1;
+         k < max &&
+         vftasks_seq_cmp(chan,
+                         ATOMIC_LOAD_ACQUIRE(
+                           &vftasks_token_after(&chan->param, token, k)->seq),
+                         2 * vftasks_pos_after(chan, pos, k) + offset) == 0;
+         ++k);
+
+    if (!shared)
+    {
+      ATOMIC_STORE_RELAXED(pos_ptr, vftasks_pos_after(chan, pos, k));
+      *count = k;
+      return token;
+    }
+    else if (ATOMIC_CAS(pos_ptr, pos, vftasks_pos_after(chan, pos, k)))
+    {
+      *count = k;
+      return token;
+    }
+  }
+}
+
+/** claim the token at a position counter, if it has been released to the side
+ *  that the counter belongs to
+ */
+static inline vftasks_token_t *vftasks_claim_token(vftasks_chan_t *chan,
+                                                   int *pos_ptr,
+                                                   int offset,
+                                                   int shared)
+{
+  int count;  /* number of claimed tokens */
+
+  return vftasks_claim_tokens(chan, pos_ptr, offset, shared, 1, &count);
+}
+
+/** check whether the tokens at a position counter and a number of positions after
+ *  it have all been released to the side that the counter belongs to; only the
+ *  first and the last one are checked, so that the last release among them always
+ *  sees both, and the ones in between are not waited for
+ */
+static int vftasks_tokens_ready(vftasks_chan_t *chan, int *pos_ptr, int n, int offset)
+{
+  vftasks_token_t *token;  /* a token */
+  int pos;                 /* its position */
+
+  pos = ATOMIC_LOAD_RELAXED(pos_ptr);
+  token = vftasks_token_at(chan, pos);
+  if (vftasks_seq_cmp(chan, ATOMIC_LOAD_ACQUIRE(&token->seq), 2 * pos + offset) < 0)
+    return 0;
+
+  pos = vftasks_pos_after(chan, pos, n - 1);
+  token = vftasks_token_at(chan, pos);
+  return vftasks_seq_cmp(chan, ATOMIC_LOAD_ACQUIRE(&token->seq), 2 * pos + offset) >= 0;
+}
+
+#ifndef VFPOLLING
+
+/** resume the suspended writers, if any; if they only need to be resumed once
+ *  enough room has become available, the number of room tokens is given
+ */
+static void vftasks_resume_writers(vftasks_chan_t *chan, int min_room)
+{
+  vftasks_wport_t *wport;  /* a write port */
+
+  /* order the release before the check for suspended writers, so that either this
+     thread sees the writer or the suspending writer sees the room; pairs with the
+     fence in vftasks_acquire_room */
+  ATOMIC_FENCE();
+
+  if (ATOMIC_LOAD_RELAXED(&chan->num_suspended_writers) == 0) return;
+  if (min_room > 0 && !vftasks_tokens_ready(chan, &chan->write_pos, min_room, 0))
+    return;
+
+  for (wport = chan->wport; wport != NULL; wport = wport->next)
+    if (ATOMIC_LOAD_RELAXED(&wport->suspended)) (*chan->resume_writer)(wport);
+}
+
+/** resume the suspended readers, if any; if they only need to be resumed once
+ *  enough data has become available, the number of data tokens is given
+ */
+static void vftasks_resume_readers(vftasks_chan_t *chan, int min_data)
+{
+  vftasks_rport_t *rport;  /* a read port */
+
+  /* order the release before the check for suspended readers; pairs with the fence
+     in vftasks_acquire_data */
+  ATOMIC_FENCE();
+
+  if (ATOMIC_LOAD_RELAXED(&chan->num_suspended_readers) == 0) return;
+  if (min_data > 0 && !vftasks_tokens_ready(chan, &chan->read_pos, min_data, 1))
+    return;
+
+  for (rport = chan->rport; rport != NULL; rport = rport->next)
+    if (ATOMIC_LOAD_RELAXED(&rport->suspended)) (*chan->resume_reader)(rport);
+}
+
+#endif /* VFPOLLING */
+
+
+/* ***************************************************************************
+ * Publication of the channel state
+ * ***************************************************************************/
+
+/** update the tail pointer, publishing the data in the tokens before it, and
+ *  resume the reader if the tail enters its wake-up zone
+ */
+static inline void vftasks_publish_tail(vftasks_wport_t *wport,
+                                        vftasks_token_t *new_tail)
+{
+  vftasks_chan_t *chan = wport->chan;  /* pointer to the channel */
+
+  /* update tail pointer */
+  wport->cached_state.tail = new_tail;
+  ATOMIC_STORE_RELEASE(&chan->tail, new_tail);
+
+#ifndef VFPOLLING
+  /* if necessary, resume reader */
+  {
+    vftasks_token_t *wakeup_zone_start;  /* start of wake-up zone */
+
+    /* order the update of the tail before the check of the wake-up zone, so that
+       either this thread sees the zone or the suspending reader sees the tail */
+    ATOMIC_FENCE();
+
+    /* retrieve start of wake-up zone */
+    wakeup_zone_start = ATOMIC_LOAD_RELAXED(&wport->wakeup_zone_start);
+
+    /* check wake-up zone; as the zone extends up to the data pointer of the
+       reader, which the tail cannot pass, a tail that moves by several tokens at
+       once cannot skip it */
+    if (wakeup_zone_start != NULL)
+    {
+      vftasks_token_t *wakeup_zone_end;    /* end of wake-up zone   */
+
+      /* retrieve end of wake-up zone */
+      wakeup_zone_end = ATOMIC_LOAD_RELAXED(&wport->wakeup_zone_end);
+
+      /* check if tail points into wake-up zone */
+      if ((wakeup_zone_start <= wakeup_zone_end &&
+           (new_tail >= wakeup_zone_start && new_tail < wakeup_zone_end)) ||
+          (wakeup_zone_start > wakeup_zone_end &&
+           (new_tail >= wakeup_zone_start || new_tail < wakeup_zone_end)))
+        /* tail points into wake-up zone: resume reader */
+        (*chan->resume_reader)(chan->rport);
+    }
+  }
+#endif
+}
+
+/** update the head pointer, handing the tokens before it back to the writer, and
+ *  resume the writer if the head enters its wake-up zone
+ */
+static inline void vftasks_publish_head(vftasks_rport_t *rport,
+                                        vftasks_token_t *new_head)
+{
+  vftasks_chan_t *chan = rport->chan;  /* pointer to the channel */
+
+  /* update head pointer */
+  rport->cached_state.head = new_head;
+  ATOMIC_STORE_RELEASE(&chan->head, new_head);
+
+#ifndef VFPOLLING
+  /* if necessary, resume writer */
+  {
+    vftasks_token_t *wakeup_zone_start;  /* start of wake-up zone */
+
+    /* order the update of the head before the check of the wake-up zone, so that
+       either this thread sees the zone or the suspending writer sees the head */
+    ATOMIC_FENCE();
+
+    /* retrieve start of wake-up zone */
+    wakeup_zone_start = ATOMIC_LOAD_RELAXED(&rport->wakeup_zone_start);
+
+    /* check wake-up zone; like the tail, the head cannot skip it */
+    if (wakeup_zone_start != NULL)
+    {
+      vftasks_token_t *wakeup_zone_end;  /* end of wake-up zone */
+
+      /* retrieve end of wake-up zone */
+      wakeup_zone_end = ATOMIC_LOAD_RELAXED(&rport->wakeup_zone_end);
+
+      /* check if head points into wake-up zone */
+      if ((wakeup_zone_start <= wakeup_zone_end &&
+           (new_head >= wakeup_zone_start && new_head < wakeup_zone_end)) ||
+          (wakeup_zone_start > wakeup_zone_end &&
+           (new_head >= wakeup_zone_start || new_head < wakeup_zone_end)))
+        /* tail points into wake-up zone: resume reader */
+        (*chan->resume_writer)(chan->wport);
+    }
+  }
+#endif
+}
+
+/** publish the data tokens whose publication has been deferred, if any
+ */
+static inline void vftasks_publish_deferred_data(vftasks_wport_t *wport)
+{
+  if (wport->num_unpublished > 0)
+  {
+    wport->num_unpublished = 0;
+    vftasks_publish_tail(wport, wport->cached_state.tail);
+  }
+}
+
+
 /* ***************************************************************************
  * Creation and destruction of channels and ports
  * ***************************************************************************/
@@ -158,9 +548,26 @@ vftasks_chan_t *vftasks_create_chan(int num_tokens,
                                     size_t token_size,
                                     vftasks_malloc_t *ctl_space,
                                     vftasks_malloc_t *buf_space)
+{
+  return vftasks_create_chan_with_kind(num_tokens,
+                                       token_size,
+                                       VFTASKS_CHAN_SPSC,
+                                       ctl_space,
+                                       buf_space);
+}
+
+/** create channel of a given kind
+ */
+vftasks_chan_t *vftasks_create_chan_with_kind(int num_tokens,
+                                              size_t token_size,
+                                              int kind,
+                                              vftasks_malloc_t *ctl_space,
+                                              vftasks_malloc_t *buf_space)
 {
   int chan_size;              /* channel size (== #tokens + 1) */
   size_t overflow_size;       /* overflow size                 */
+  size_t stride;              /* distance between tokens       */
+  int flat;                   /* keep tokens in the buffer     */
   char *raw_buf;              /* the raw buffer                */
   vftasks_token_t *token_buf; /* the token buffer              */
   vftasks_chan_t *chan;       /* pointer to the channel        */
@@ -171,7 +578,18 @@ vftasks_chan_t *vftasks_create_chan(int num_tokens,
     return NULL;
   }
 
-  if (token_size <= 0)
+  if (token_size <= 0 || token_size > MAX_TOKEN_SIZE)
+  {
+    return NULL;
+  }
+
+  /* separate the layout from the kind */
+  flat = (kind & VFTASKS_CHAN_FLAT) != 0;
+  kind &= ~VFTASKS_CHAN_FLAT;
+
+  /* check kind */
+  if (kind < VFTASKS_CHAN_SPSC || kind > VFTASKS_CHAN_MPMC ||
+      (kind != VFTASKS_CHAN_SPSC && num_tokens > MAX_MULTI_TOKENS))
   {
     return NULL;
   }
@@ -195,32 +613,60 @@ vftasks_chan_t *vftasks_create_chan(int num_tokens,
                                   MAX(sizeof(float),
                                       MAX(sizeof(double), sizeof(void *)))))));
 
-  /* allocate raw buffer */
-  raw_buf = buf_space->malloc(chan_size * (token_size + overflow_size));
-  if (raw_buf == NULL)
+  if (flat)
   {
-    return NULL;
-  }
+    /* allocate a single buffer, in which every token is followed by its data;
+       the stride is rounded up so that every token stays aligned */
+    stride = sizeof(vftasks_token_t) + token_size + overflow_size;
+    stride = (stride + overflow_size - 1) / overflow_size * overflow_size;
 
-  /* allocate token buffer */
-  token_buf = ctl_space->malloc(chan_size * sizeof(vftasks_token_t));
-  if (token_buf == NULL)
+    raw_buf = buf_space->malloc(chan_size * stride);
+    if (raw_buf == NULL)
+    {
+      return NULL;
+    }
+    token_buf = (vftasks_token_t *)raw_buf;
+  }
+  else
   {
-    return NULL;
+    stride = sizeof(vftasks_token_t);
+
+    /* allocate raw buffer */
+    raw_buf = buf_space->malloc(chan_size * (token_size + overflow_size));
+    if (raw_buf == NULL)
+    {
+      return NULL;
+    }
+
+    /* allocate token buffer */
+    token_buf = ctl_space->malloc(chan_size * sizeof(vftasks_token_t));
+    if (token_buf == NULL)
+    {
+      buf_space->free(raw_buf);
+      return NULL;
+    }
   }
 
   /* fill token buffer */
   {
     char* raw_ix;              /* index into raw buffer   */
     vftasks_token_t* token_ix; /* index into token buffer */
+    int i;                     /* index of the token      */
 
     /* iterate through buffers */
-    raw_ix = raw_buf;
-    for (token_ix = token_buf; token_ix < token_buf + chan_size; ++token_ix)
+    raw_ix = flat ? raw_buf + sizeof(vftasks_token_t) : raw_buf;
+    token_ix = token_buf;
+    for (i = 0; i < chan_size; ++i)
     {
-      token_ix->token_size = token_size;
       token_ix->token_base = raw_ix;
-      raw_ix += (token_size + overflow_size);
+      token_ix->token_size = (int)token_size;
+      raw_ix += flat ? stride : token_size + overflow_size;
+
+      /* on channels with multiple writers or readers, the token is released to
+         the writers for its first position */
+      token_ix->seq = 2 * i;
+
+      token_ix = (vftasks_token_t *)((char *)token_ix + stride);
     }
   }
 
@@ -229,21 +675,34 @@ vftasks_chan_t *vftasks_create_chan(int num_tokens,
   if (chan == NULL)
   {
     buf_space->free(raw_buf);
-    ctl_space->free(token_buf);
+    if (!flat) ctl_space->free(token_buf);
     return NULL;
   }
 
   /* set parameters */
+  chan->param.size = chan_size;
+  chan->param.stride = (int)stride;
   chan->param.base = token_buf;
-  chan->param.limit = token_buf + num_tokens + 1;
+  chan->param.limit = vftasks_token_after(&chan->param, token_buf, chan_size);
   chan->param.min_data = 1;
   chan->param.min_room = 1;
+  chan->param.kind = kind;
+  chan->param.interval = 1;
 
   /* initialize state */
-  chan->state.tail = chan->param.base;
-  chan->state.head = chan->param.base;
+  chan->tail = chan->param.base;
+  chan->head = chan->param.base;
   chan->rport = NULL;
   chan->wport = NULL;
+  chan->write_pos = 0;
+  chan->read_pos = 0;
+  chan->num_positions = num_tokens * (MAX_POSITIONS / num_tokens);
+  chan->num_suspended_writers = 0;
+  chan->num_suspended_readers = 0;
+  chan->spin_limit = 0;
+  _vftasks_eventcount_init(&chan->room_event);
+  _vftasks_eventcount_init(&chan->data_event);
+  chan->flat = flat;
 
   /* initialize application-specific data */
   chan->info = NULL;
@@ -265,8 +724,8 @@ vftasks_wport_t *vftasks_create_write_port(vftasks_chan_t *chan,
 {
   vftasks_wport_t *wport;  /* pointer to the port */
 
-  /* check if channel already has a write port */
-  if (chan->wport != NULL)
+  /* check if channel already has a write port, and can only have one */
+  if (chan->wport != NULL && !vftasks_multi_writer(&chan->param))
   {
     return NULL;
   }
@@ -279,14 +738,18 @@ vftasks_wport_t *vftasks_create_write_port(vftasks_chan_t *chan,
   }
 
   /* initialize port */
-  memcpy(&wport->cached_state, &chan->state, sizeof(vftasks_state_t));
+  wport->cached_state.head = chan->head;
+  wport->cached_state.tail = chan->tail;
   memcpy(&wport->param, &chan->param, sizeof(vftasks_param_t));
   wport->room = wport->cached_state.tail;
   wport->wakeup_zone_start = NULL;
   wport->wakeup_zone_end = NULL;
+  wport->suspended = 0;
+  wport->num_unpublished = 0;
 
   /* connect port to channel */
   wport->chan = chan;
+  wport->next = chan->wport;
   chan->wport = wport;
 
   /* return port pointer */
@@ -300,8 +763,8 @@ vftasks_rport_t *vftasks_create_read_port(vftasks_chan_t *chan,
 {
   vftasks_rport_t *rport;  /* pointer to the port */
 
-  /* check if channel already has a read port */
-  if (chan->rport != NULL)
+  /* check if channel already has a read port, and can only have one */
+  if (chan->rport != NULL && !vftasks_multi_reader(&chan->param))
   {
     return NULL;
   }
@@ -314,14 +777,17 @@ vftasks_rport_t *vftasks_create_read_port(vftasks_chan_t *chan,
   }
 
   /* initialize port */
-  memcpy(&rport->cached_state, &chan->state, sizeof(vftasks_state_t));
+  rport->cached_state.head = chan->head;
+  rport->cached_state.tail = chan->tail;
   memcpy(&rport->param, &chan->param, sizeof(vftasks_param_t));
   rport->data = rport->cached_state.head;
   rport->wakeup_zone_start = NULL;
   rport->wakeup_zone_end = NULL;
+  rport->suspended = 0;
 
   /* connect port to channel */
   rport->chan = chan;
+  rport->next = chan->rport;
   chan->rport = rport;
 
   /* return port pointer */
@@ -334,11 +800,19 @@ void vftasks_destroy_chan(vftasks_chan_t *chan,
                           vftasks_malloc_t *ctl_space,
                           vftasks_malloc_t *buf_space)
 {
-  /* deallocate raw buffer */
-  buf_space->free(chan->param.base->token_base);
+  if (chan->flat)
+  {
+    /* deallocate the buffer, which holds the tokens too */
+    buf_space->free(chan->param.base);
+  }
+  else
+  {
+    /* deallocate raw buffer */
+    buf_space->free(chan->param.base->token_base);
 
-  /* deallocate token buffer */
-  ctl_space->free(chan->param.base);
+    /* deallocate token buffer */
+    ctl_space->free(chan->param.base);
+  }
 
   /* deallocate channel */
   ctl_space->free(chan);
@@ -349,8 +823,14 @@ void vftasks_destroy_chan(vftasks_chan_t *chan,
 void vftasks_destroy_write_port(vftasks_wport_t *wport,
                                 vftasks_malloc_t *port_space)
 {
+  vftasks_wport_t **link;  /* pointer to the link to the port */
+
+  /* publish the data whose publication has been deferred */
+  vftasks_publish_deferred_data(wport);
+
   /* disconnect port from channel */
-  wport->chan->wport = NULL;
+  for (link = &wport->chan->wport; *link != wport; link = &(*link)->next);
+  *link = wport->next;
 
   /* deallocate the port */
   port_space->free(wport);
@@ -361,8 +841,11 @@ void vftasks_destroy_write_port(vftasks_wport_t *wport,
 void vftasks_destroy_read_port(vftasks_rport_t *rport,
                                vftasks_malloc_t *port_space)
 {
+  vftasks_rport_t **link;  /* pointer to the link to the port */
+
   /* disconnect port from channel */
-  rport->chan->rport = NULL;
+  for (link = &rport->chan->rport; *link != rport; link = &(*link)->next);
+  *link = rport->next;
 
   /* deallocate the port */
   port_space->free(rport);
@@ -389,6 +872,118 @@ void vftasks_install_chan_hooks(vftasks_chan_t *chan,
   chan->resume_reader = resume_reader;
 }
 
+#ifndef VFPOLLING
+
+/** pause in between two polls, twice as long as the previous time up to a limit,
+ *  beyond which the processor is yielded instead
+ */
+static inline void vftasks_backoff(int *backoff)
+{
+  int k;  /* index */
+
+  if (*backoff <= MAX_BACKOFF)
+  {
+    for (k = 0; k < *backoff; ++k) CPU_PAUSE();
+    *backoff <<= 1;
+  }
+  else
+    THREAD_YIELD();
+}
+
+/** blocking suspend-writer hook: poll for room a limited number of times, then
+ *  block until the writer is resumed
+ */
+static void vftasks_blocking_suspend_writer(vftasks_wport_t *wport)
+{
+  vftasks_chan_t *chan;  /* pointer to the channel               */
+  int backoff;           /* number of pauses in between polls    */
+  int polls;             /* number of polls so far               */
+  unsigned int key;      /* key for blocking                     */
+
+  /* retrieve the channel */
+  chan = wport->chan;
+
+  /* poll with exponential backoff */
+  backoff = 1;
+  for (polls = 0; polls < chan->spin_limit; ++polls)
+  {
+    vftasks_backoff(&backoff);
+    if (vftasks_room_available(wport)) return;
+  }
+
+  /* register as a waiter before the room is rechecked, so that a resumption after
+     the check releases the writer */
+  key = vftasks_prepare_wait(&chan->room_event);
+  if (vftasks_room_available(wport))
+    vftasks_cancel_wait(&chan->room_event, key);
+  else
+    vftasks_commit_wait(&chan->room_event, key);
+}
+
+/** blocking resume-writer hook
+ */
+static void vftasks_blocking_resume_writer(vftasks_wport_t *wport)
+{
+  /* only wakes a writer up if one has blocked; further resumptions before it
+     suspends again find no waiters and do not enter the kernel */
+  vftasks_notify(&wport->chan->room_event);
+}
+
+/** blocking suspend-reader hook: poll for data a limited number of times, then
+ *  block until the reader is resumed
+ */
+static void vftasks_blocking_suspend_reader(vftasks_rport_t *rport)
+{
+  vftasks_chan_t *chan;  /* pointer to the channel               */
+  int backoff;           /* number of pauses in between polls    */
+  int polls;             /* number of polls so far               */
+  unsigned int key;      /* key for blocking                     */
+
+  /* retrieve the channel */
+  chan = rport->chan;
+
+  /* poll with exponential backoff */
+  backoff = 1;
+  for (polls = 0; polls < chan->spin_limit; ++polls)
+  {
+    vftasks_backoff(&backoff);
+    if (vftasks_data_available(rport)) return;
+  }
+
+  /* register as a waiter before the data is rechecked; idem */
+  key = vftasks_prepare_wait(&chan->data_event);
+  if (vftasks_data_available(rport))
+    vftasks_cancel_wait(&chan->data_event, key);
+  else
+    vftasks_commit_wait(&chan->data_event, key);
+}
+
+/** blocking resume-reader hook
+ */
+static void vftasks_blocking_resume_reader(vftasks_rport_t *rport)
+{
+  /* only wakes a reader up if one has blocked; idem */
+  vftasks_notify(&rport->chan->data_event);
+}
+
+#endif /* VFPOLLING */
+
+/** install blocking hooks
+ */
+void vftasks_install_default_blocking_hooks(vftasks_chan_t *chan, int spin_limit)
+{
+  /* a negative limit blocks right away, like a zero one */
+  chan->spin_limit = spin_limit > 0 ? spin_limit : 0;
+
+#ifndef VFPOLLING
+  vftasks_install_chan_hooks(chan,
+                             vftasks_blocking_suspend_writer,
+                             vftasks_blocking_resume_writer,
+                             vftasks_blocking_suspend_reader,
+                             vftasks_blocking_resume_reader);
+#endif
+}
+
 /* ***************************************************************************
  * Low- and high-water marks
  * ***************************************************************************/
@@ -399,12 +994,14 @@ int vftasks_set_min_room(vftasks_chan_t *chan, int min_room)
 {
   vftasks_param_t *param;  /* pointer to the channel parameters */
   int chan_size;           /* channel size (== #tokens + 1)     */
+  vftasks_rport_t *rport;  /* a read port                       */
+  vftasks_wport_t *wport;  /* a write port                      */
 
   /* retrieve parameter pointer */
   param = &chan->param;
 
   /* retrieve the channel size */
-  chan_size = param->limit - param->base;
+  chan_size = param->size;
 
   /* check if the new mark is within bounds;
      otherwise, do not update the mark */
@@ -417,8 +1014,10 @@ int vftasks_set_min_room(vftasks_chan_t *chan, int min_room)
   param->min_room = min_room;
 
   /* update copies held by ports */
-  if (chan->rport != NULL) chan->rport->param.min_room = min_room;
-  if (chan->wport != NULL) chan->wport->param.min_room = min_room;
+  for (rport = chan->rport; rport != NULL; rport = rport->next)
+    rport->param.min_room = min_room;
+  for (wport = chan->wport; wport != NULL; wport = wport->next)
+    wport->param.min_room = min_room;
 
   /* return the new mark */
   return min_room;
@@ -438,12 +1037,14 @@ int vftasks_set_min_data(vftasks_chan_t *chan, int min_data)
 {
   vftasks_param_t *param; /* pointer to the channel parameters */
   int chan_size;          /* channel size (== #tokens + 1)     */
+  vftasks_rport_t *rport; /* a read port                       */
+  vftasks_wport_t *wport; /* a write port                      */
 
   /* retrieve parameter pointer */
   param = &chan->param;
 
   /* retrieve the channel size */
-  chan_size = param->limit - param->base;
+  chan_size = param->size;
 
   /* check if the new mark is within bounds;
      otherwise, do not update the mark */
@@ -456,8 +1057,10 @@ int vftasks_set_min_data(vftasks_chan_t *chan, int min_data)
   param->min_data = min_data;
 
   /* update copies held by ports */
-  if (chan->rport != NULL) chan->rport->param.min_data = min_data;
-  if (chan->wport != NULL) chan->wport->param.min_data = min_data;
+  for (rport = chan->rport; rport != NULL; rport = rport->next)
+    rport->param.min_data = min_data;
+  for (wport = chan->wport; wport != NULL; wport = wport->next)
+    wport->param.min_data = min_data;
 
   /* return the new mark */
   return min_data;
@@ -471,25 +1074,69 @@ int vftasks_get_min_data(vftasks_chan_t *chan)
   return chan->param.min_data;
 }
 
-/* ***************************************************************************
- * Application-specific data
- * ***************************************************************************/
-
-/** set info
+/** set publication interval
  */
-void vftasks_set_chan_info(vftasks_chan_t *chan, void *info)
+int vftasks_set_publication_interval(vftasks_chan_t *chan, int interval)
 {
-  /* update info */
-  chan->info = info;
-}
+  vftasks_param_t *param; /* pointer to the channel parameters */
+  int chan_size;          /* channel size (== #tokens + 1)     */
+  vftasks_rport_t *rport; /* a read port                       */
+  vftasks_wport_t *wport; /* a write port                      */
 
-/** get info
- */
-void *vftasks_get_chan_info(vftasks_chan_t *chan)
-{
-  /* return info */
-  return chan->info;
-}
+  /* retrieve parameter pointer */
+  param = &chan->param;
+
+  /* retrieve the channel size */
+  chan_size = param->size;
+
+  /* check if the new interval is within bounds, and whether the channel publishes
+     its tail at all; otherwise, do not update the interval */
+  if (interval <= 0 || interval >= chan_size || param->kind != VFTASKS_CHAN_SPSC)
+  {
+    return param->interval;
+  }
+
+  /* update the interval */
+  param->interval = interval;
+
+  /* update copies held by ports; data deferred under a longer interval is
+     published with the next release */
+  for (rport = chan->rport; rport != NULL; rport = rport->next)
+    rport->param.interval = interval;
+  for (wport = chan->wport; wport != NULL; wport = wport->next)
+    wport->param.interval = interval;
+
+  /* return the new interval */
+  return interval;
+}
+
+/** get publication interval
+ */
+int vftasks_get_publication_interval(vftasks_chan_t *chan)
+{
+  /* return interval */
+  return chan->param.interval;
+}
+
+/* ***************************************************************************
+ * Application-specific data
+ * ***************************************************************************/
+
+/** set info
+ */
+void vftasks_set_chan_info(vftasks_chan_t *chan, void *info)
+{
+  /* update info */
+  chan->info = info;
+}
+
+/** get info
+ */
+void *vftasks_get_chan_info(vftasks_chan_t *chan)
+{
+  /* return info */
+  return chan->info;
+}
 
 /* ***************************************************************************
  * Channel queries
@@ -509,17 +1156,24 @@ int vftasks_get_num_tokens(vftasks_chan_t *chan)
   int chan_size;  /* channel size (== #tokens + 1) */
 
   /* retrieve the channel size */
-  chan_size = chan->param.limit - chan->param.base;
+  chan_size = chan->param.size;
 
   /* return #tokens */
   return chan_size - 1;
 }
 
+/** get kind
+ */
+int vftasks_get_chan_kind(vftasks_chan_t *chan)
+{
+  return chan->flat ? chan->param.kind | VFTASKS_CHAN_FLAT : chan->param.kind;
+}
+
 /** get token size
  */
 size_t vftasks_get_token_size(vftasks_chan_t *chan)
 {
-  return chan->param.base->token_size;
+  return (size_t)chan->param.base->token_size;
 }
 
 /* ***************************************************************************
@@ -552,16 +1206,25 @@ int vftasks_room_available(vftasks_wport_t *wport)
 {
   vftasks_token_t *new_room;  /* new room pointer, if room would be acquired now */
 
+  /* on channels with multiple writers or readers, check the next room token */
+  if (wport->param.kind != VFTASKS_CHAN_SPSC)
+    return vftasks_tokens_ready(wport->chan, &wport->chan->write_pos, 1, 0);
+
   /* determine new room pointer; if it is out of bounds, wrap it */
-  new_room = wport->room + 1;
+  new_room = vftasks_token_after(&wport->param, wport->room, 1);
   if (new_room == wport->param.limit) new_room = wport->param.base;
 
   /* check whether buffer is full */
   if (new_room == wport->cached_state.head)
   {
     /* update cache and recheck with updated cache */
-    wport->cached_state.head = wport->chan->state.head;
-    if (new_room == wport->cached_state.head) return 0;
+    wport->cached_state.head = ATOMIC_LOAD_ACQUIRE(&wport->chan->head);
+    if (new_room == wport->cached_state.head)
+    {
+      /* the reader may need the deferred data to make room */
+      vftasks_publish_deferred_data(wport);
+      return 0;
+    }
   }
 
   /* buffer still has room */
@@ -574,6 +1237,10 @@ int vftasks_data_available(vftasks_rport_t *rport)
 {
   vftasks_token_t* data;  /* current data pointer */
 
+  /* on channels with multiple writers or readers, check the next data token */
+  if (rport->param.kind != VFTASKS_CHAN_SPSC)
+    return vftasks_tokens_ready(rport->chan, &rport->chan->read_pos, 1, 1);
+
   /* retrieve data pointer */
   data = rport->data;
 
@@ -581,7 +1248,7 @@ int vftasks_data_available(vftasks_rport_t *rport)
   if (data == rport->cached_state.tail)
   {
     /* update cache and recheck with updated cache */
-    rport->cached_state.tail = rport->chan->state.tail;
+    rport->cached_state.tail = ATOMIC_LOAD_ACQUIRE(&rport->chan->tail);
     if (data == rport->cached_state.tail) return 0;
   }
 
@@ -600,20 +1267,29 @@ vftasks_token_t *vftasks_acquire_room_nb(vftasks_wport_t *wport)
   vftasks_token_t *room;      /* the current room pointer */
   vftasks_token_t *new_room;  /* the new room pointer     */
 
+  /* on channels with multiple writers or readers, claim the next room token */
+  if (wport->param.kind != VFTASKS_CHAN_SPSC)
+    return vftasks_claim_token(wport->chan,
+                               &wport->chan->write_pos,
+                               0,
+                               vftasks_multi_writer(&wport->param));
+
   /* retrieve the current room pointer */
   room = wport->room;
 
   /* determine new room pointer; if it is out of bounds, wrap it */
-  new_room = room + 1;
+  new_room = vftasks_token_after(&wport->param, room, 1);
   if (new_room == wport->param.limit) new_room = wport->param.base;
 
   /* check whether buffer is full */
   if (new_room == wport->cached_state.head)
   {
     /* update cache and recheck with updated cache */
-    wport->cached_state.head = wport->chan->state.head;
+    wport->cached_state.head = ATOMIC_LOAD_ACQUIRE(&wport->chan->head);
     if (new_room == wport->cached_state.head)
     {
+      /* the reader may need the deferred data to make room */
+      vftasks_publish_deferred_data(wport);
       return NULL;
     }
   }
@@ -625,6 +1301,144 @@ vftasks_token_t *vftasks_acquire_room_nb(vftasks_wport_t *wport)
   return room;
 }
 
+/** acquire a run of room tokens (nonblocking)
+ */
+vftasks_token_t *vftasks_acquire_room_n_nb(vftasks_wport_t *wport, int n, int *count)
+{
+  vftasks_token_t *room;      /* the current room pointer         */
+  vftasks_token_t *new_room;  /* the new room pointer             */
+  int size;                   /* number of tokens in the buffer   */
+  int end;                    /* number of tokens up to the end   */
+  int avail;                  /* number of available room tokens */
+
+  /* check the number of tokens */
+  if (n < 1)
+  {
+    *count = 0;
+    return NULL;
+  }
+
+  /* on channels with multiple writers or readers, claim the next room tokens */
+  if (wport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    room = vftasks_claim_tokens(wport->chan,
+                                &wport->chan->write_pos,
+                                0,
+                                vftasks_multi_writer(&wport->param),
+                                n,
+                                count);
+    if (room == NULL) *count = 0;
+    return room;
+  }
+
+  /* retrieve the current room pointer */
+  room = wport->room;
+  size = wport->param.size;
+
+  /* the run ends at the end of the buffer */
+  end = vftasks_tokens_between(&wport->param, room, wport->param.limit);
+  if (n > end) n = end;
+
+  /* count the room tokens up to the void token just before the head */
+  avail = vftasks_tokens_between(&wport->param,
+                                 room,
+                                 wport->cached_state.head) - 1;
+  if (avail < 0) avail += size;
+
+  if (avail < n)
+  {
+    /* update cache and recount with updated cache */
+    wport->cached_state.head = ATOMIC_LOAD_ACQUIRE(&wport->chan->head);
+    avail = vftasks_tokens_between(&wport->param,
+                                   room,
+                                   wport->cached_state.head) - 1;
+    if (avail < 0) avail += size;
+
+    if (avail == 0)
+    {
+      /* the reader may need the deferred data to make room */
+      vftasks_publish_deferred_data(wport);
+      *count = 0;
+      return NULL;
+    }
+    if (n > avail) n = avail;
+  }
+
+  /* determine new room pointer; if it is out of bounds, wrap it */
+  new_room = vftasks_token_after(&wport->param, room, n);
+  if (new_room == wport->param.limit) new_room = wport->param.base;
+
+  /* buffer has room; update room pointer */
+  wport->room = new_room;
+
+  /* return pointer to first acquired token */
+  *count = n;
+  return room;
+}
+
+#ifndef VFPOLLING
+
+/** suspend the writer after a failed acquisition
+ */
+static void vftasks_suspend_writer(vftasks_wport_t *wport)
+{
+  vftasks_chan_t *chan;          /* pointer to the channel                */
+  vftasks_token_t *room;         /* room pointer                          */
+  vftasks_token_t *wakeup_mark;  /* writer resumes when the head hits the
+                                    wake-up mark                          */
+  int wrap;                      /* overflow                              */
+
+  /* retrieve the channel */
+  chan = wport->chan;
+
+  /* on channels with multiple writers or readers, mark the writer as suspended,
+     and make that visible before the suspend hook rechecks the room; pairs with
+     the fence in vftasks_resume_writers */
+  if (wport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    ATOMIC_STORE_RELAXED(&wport->suspended, 1);
+    ATOMIC_FETCH_ADD(&chan->num_suspended_writers, 1);
+    ATOMIC_FENCE();
+
+    (*chan->suspend_writer)(wport);
+
+    ATOMIC_FETCH_ADD(&chan->num_suspended_writers, -1);
+    ATOMIC_STORE_RELAXED(&wport->suspended, 0);
+    return;
+  }
+
+  /* retrieve the room pointer */
+  room = wport->room;
+
+  /* compute the wake-up mark (the extra ``1'' accounts for the void token
+     just before the head */
+  wakeup_mark = vftasks_token_after(&wport->param, room, 1 + wport->param.min_room);
+
+  /* compute the overflow; if it is nonnegative, wrap the wake-up mark */
+  wrap = vftasks_tokens_between(&wport->param, wport->param.limit, wakeup_mark);
+  if (wrap >= 0)
+    wakeup_mark = vftasks_token_after(&wport->param, wport->param.base, wrap);
+
+  /* set wake-up zone on the read port; the start is stored last, as the reader
+     only looks at the end if the start is set */
+  ATOMIC_STORE_RELAXED(&chan->rport->wakeup_zone_end,
+                       vftasks_token_after(&wport->param, room, 1));
+  ATOMIC_STORE_RELAXED(&chan->rport->wakeup_zone_start, wakeup_mark);
+
+  /* make the wake-up zone visible before the suspend hook rechecks the head;
+     pairs with the fence in vftasks_publish_head */
+  ATOMIC_FENCE();
+
+  /* suspend writer */
+  (*chan->suspend_writer)(wport);
+
+  /* clear wake-up zone */
+  ATOMIC_STORE_RELAXED(&chan->rport->wakeup_zone_start, NULL);
+  ATOMIC_STORE_RELAXED(&chan->rport->wakeup_zone_end, NULL);
+}
+
+#endif /* VFPOLLING */
+
 /** acquire room
  */
 vftasks_token_t *vftasks_acquire_room(vftasks_wport_t *wport)
@@ -640,37 +1454,29 @@ vftasks_token_t *vftasks_acquire_room(vftasks_wport_t *wport)
 
 #ifndef VFPOLLING
     /* acquisition failed; put writer to sleep */
-    {
-      vftasks_chan_t *chan;          /* pointer to the channel                */
-      vftasks_token_t *room;         /* room pointer                          */
-      vftasks_token_t *wakeup_mark;  /* writer resumes when the head hits the
-                                        wake-up mark                          */
-      int wrap;                      /* overflow                              */
-
-      /* retrieve the channel and room pointers */
-      chan = wport->chan;
-      room = wport->room;
-
-      /* compute the wake-up mark (the extra ``1'' accounts for the void token
-         just before the head */
-      wakeup_mark = room + (1 + wport->param.min_room);
-
-      /* compute the overflow; if it is nonnegative, wrap the wake-up mark */
-      wrap = wakeup_mark - wport->param.limit;
-      if (wrap >= 0) wakeup_mark = wport->param.base + wrap;
+    vftasks_suspend_writer(wport);
+#endif
+  }
+  while (1);
+}
 
-      /* set wake-up zone on the read port */
-      chan->rport->wakeup_zone_start = wakeup_mark;
-      chan->rport->wakeup_zone_end = room + 1;
+/** acquire a run of room tokens
+ */
+vftasks_token_t *vftasks_acquire_room_n(vftasks_wport_t *wport, int n, int *count)
+{
+  vftasks_token_t *token;    /* pointer to first acquired token */
 
-      /* suspend writer */
-      (*chan->suspend_writer)(wport);
+  /* try to acquire tokens, until we have at least one */
+  do
+  {
+    /* try to acquire tokens */
+    token = vftasks_acquire_room_n_nb(wport, n, count);
+    if (token != NULL || n < 1) return token;
 
-      /* clear wake-up zone */
-      chan->rport->wakeup_zone_start = NULL;
-      chan->rport->wakeup_zone_end = NULL;
-    }
-#endif /* VFPOLLING */
+#ifndef VFPOLLING
+    /* acquisition failed; put writer to sleep */
+    vftasks_suspend_writer(wport);
+#endif
   }
   while (1);
 }
@@ -679,51 +1485,79 @@ vftasks_token_t *vftasks_acquire_room(vftasks_wport_t *wport)
  */
 void vftasks_release_data(vftasks_wport_t *wport, vftasks_token_t *token)
 {
-  vftasks_chan_t *chan;       /* pointer to the channel   */
-  vftasks_token_t* tail;      /* the current tail pointer */
   vftasks_token_t* new_tail;  /* the new tail pointer     */
 
-  /* retrieve the channel */
-  chan = wport->chan;
-
-  /* retrieve the tail pointer */
-  tail = wport->cached_state.tail;
+  /* on channels with multiple writers or readers, release the token itself to the
+     readers, and resume them once enough data is available */
+  if (wport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    ATOMIC_STORE_RELEASE(&token->seq, ATOMIC_LOAD_RELAXED(&token->seq) + 1);
+#ifndef VFPOLLING
+    vftasks_resume_readers(wport->chan, wport->param.min_data);
+#endif
+    return;
+  }
 
   /* determine new tail pointer; if it is out of bounds, wrap it */
-  new_tail = tail + 1;
+  new_tail = vftasks_token_after(&wport->param, wport->cached_state.tail, 1);
   if (new_tail == wport->param.limit) new_tail = wport->param.base;
 
-  /* update tail pointer */
-  wport->cached_state.tail = new_tail;
-  chan->state.tail = new_tail;
-
-#ifndef VFPOLLING
-  /* if necessary, resume reader */
+  /* defer the publication until enough data has been released */
+  if (++wport->num_unpublished < wport->param.interval)
   {
-    vftasks_token_t *wakeup_zone_start;  /* start of wake-up zone */
-
+    wport->cached_state.tail = new_tail;
+    return;
+  }
 
-    /* retrieve start of wake-up zone */
-    wakeup_zone_start = wport->wakeup_zone_start;
+  /* update tail pointer, publishing the data in the token */
+  wport->num_unpublished = 0;
+  vftasks_publish_tail(wport, new_tail);
+}
 
-    /* check wake-up zone */
-    if (wakeup_zone_start != NULL)
-    {
-      vftasks_token_t *wakeup_zone_end;    /* end of wake-up zone   */
+/** release a run of data tokens
+ */
+void vftasks_release_data_n(vftasks_wport_t *wport, vftasks_token_t *token, int n)
+{
+  vftasks_token_t* tail;      /* the current tail pointer */
+  int wrap;                   /* overflow                 */
+  int k;                      /* index                    */
 
-      /* retrieve end of wake-up zone */
-      wakeup_zone_end = wport->wakeup_zone_end;
+  if (n < 1) return;
 
-      /* check if tail points into wake-up zone */
-      if ((wakeup_zone_start <= wakeup_zone_end &&
-           (new_tail >= wakeup_zone_start && new_tail < wakeup_zone_end)) ||
-          (wakeup_zone_start > wakeup_zone_end &&
-           (new_tail >= wakeup_zone_start || new_tail < wakeup_zone_end)))
-        /* tail points into wake-up zone: resume reader */
-        (*chan->resume_reader)(chan->rport);
+  /* on channels with multiple writers or readers, release the tokens themselves to
+     the readers, and check whether to resume them once for the run */
+  if (wport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    for (k = 0; k < n; ++k)
+    {
+      ATOMIC_STORE_RELEASE(&token->seq, ATOMIC_LOAD_RELAXED(&token->seq) + 1);
+      token = vftasks_token_after(&wport->param, token, 1);
     }
-  }
+#ifndef VFPOLLING
+    vftasks_resume_readers(wport->chan, wport->param.min_data);
 #endif
+    return;
+  }
+
+  /* determine new tail pointer; if it is out of bounds, wrap it */
+  tail = wport->cached_state.tail;
+  wrap = n - vftasks_tokens_between(&wport->param, tail, wport->param.limit);
+  if (wrap >= 0)
+    tail = vftasks_token_after(&wport->param, wport->param.base, wrap);
+  else
+    tail = vftasks_token_after(&wport->param, tail, n);
+
+  /* defer the publication until enough data has been released */
+  wport->num_unpublished += n;
+  if (wport->num_unpublished < wport->param.interval)
+  {
+    wport->cached_state.tail = tail;
+    return;
+  }
+
+  /* update tail pointer once for the run, publishing the data in the tokens */
+  wport->num_unpublished = 0;
+  vftasks_publish_tail(wport, tail);
 }
 
 /* ***************************************************************************
@@ -737,6 +1571,13 @@ vftasks_token_t *vftasks_acquire_data_nb(vftasks_rport_t *rport)
   vftasks_token_t *data;      /* the current data pointer */
   vftasks_token_t *new_data;  /* the new data pointer     */
 
+  /* on channels with multiple writers or readers, claim the next data token */
+  if (rport->param.kind != VFTASKS_CHAN_SPSC)
+    return vftasks_claim_token(rport->chan,
+                               &rport->chan->read_pos,
+                               1,
+                               vftasks_multi_reader(&rport->param));
+
   /* retrieve the current data pointer */
   data = rport->data;
 
@@ -744,7 +1585,7 @@ vftasks_token_t *vftasks_acquire_data_nb(vftasks_rport_t *rport)
   if (data == rport->cached_state.tail)
   {
     /* update cache and recheck with updated cache */
-    rport->cached_state.tail = rport->chan->state.tail;
+    rport->cached_state.tail = ATOMIC_LOAD_ACQUIRE(&rport->chan->tail);
     if (data == rport->cached_state.tail)
     {
       return NULL;
@@ -752,7 +1593,7 @@ vftasks_token_t *vftasks_acquire_data_nb(vftasks_rport_t *rport)
   }
 
   /* determine new data pointer; if it is out of bounds, wrap it */
-  new_data = data + 1;
+  new_data = vftasks_token_after(&rport->param, data, 1);
   if (new_data == rport->param.limit) new_data = rport->param.base;
 
   /* buffer has data: update data pointer */
@@ -762,6 +1603,136 @@ vftasks_token_t *vftasks_acquire_data_nb(vftasks_rport_t *rport)
   return data;
 }
 
+/** acquire a run of data tokens (nonblocking)
+ */
+vftasks_token_t *vftasks_acquire_data_n_nb(vftasks_rport_t *rport, int n, int *count)
+{
+  vftasks_token_t *data;      /* the current data pointer         */
+  vftasks_token_t *new_data;  /* the new data pointer             */
+  int size;                   /* number of tokens in the buffer   */
+  int end;                    /* number of tokens up to the end   */
+  int avail;                  /* number of available data tokens */
+
+  /* check the number of tokens */
+  if (n < 1)
+  {
+    *count = 0;
+    return NULL;
+  }
+
+  /* on channels with multiple writers or readers, claim the next data tokens */
+  if (rport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    data = vftasks_claim_tokens(rport->chan,
+                                &rport->chan->read_pos,
+                                1,
+                                vftasks_multi_reader(&rport->param),
+                                n,
+                                count);
+    if (data == NULL) *count = 0;
+    return data;
+  }
+
+  /* retrieve the current data pointer */
+  data = rport->data;
+  size = rport->param.size;
+
+  /* the run ends at the end of the buffer */
+  end = vftasks_tokens_between(&rport->param, data, rport->param.limit);
+  if (n > end) n = end;
+
+  /* count the data tokens up to the tail */
+  avail = vftasks_tokens_between(&rport->param, data, rport->cached_state.tail);
+  if (avail < 0) avail += size;
+
+  if (avail < n)
+  {
+    /* update cache and recount with updated cache */
+    rport->cached_state.tail = ATOMIC_LOAD_ACQUIRE(&rport->chan->tail);
+    avail = vftasks_tokens_between(&rport->param, data, rport->cached_state.tail);
+    if (avail < 0) avail += size;
+
+    if (avail == 0)
+    {
+      *count = 0;
+      return NULL;
+    }
+    if (n > avail) n = avail;
+  }
+
+  /* determine new data pointer; if it is out of bounds, wrap it */
+  new_data = vftasks_token_after(&rport->param, data, n);
+  if (new_data == rport->param.limit) new_data = rport->param.base;
+
+  /* buffer has data: update data pointer */
+  rport->data = new_data;
+
+  /* return pointer to first acquired token */
+  *count = n;
+  return data;
+}
+
+#ifndef VFPOLLING
+
+/** suspend the reader after a failed acquisition
+ */
+static void vftasks_suspend_reader(vftasks_rport_t *rport)
+{
+  vftasks_chan_t *chan;          /* pointer to the channel                */
+  vftasks_token_t *data;         /* data pointer                          */
+  vftasks_token_t *wakeup_mark;  /* reader resumes when the tail hits the
+                                    wake-up mark                          */
+  int wrap;                      /* overflow                              */
+
+  /* retrieve the channel */
+  chan = rport->chan;
+
+  /* on channels with multiple writers or readers, mark the reader as suspended,
+     and make that visible before the suspend hook rechecks the data; pairs with
+     the fence in vftasks_resume_readers */
+  if (rport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    ATOMIC_STORE_RELAXED(&rport->suspended, 1);
+    ATOMIC_FETCH_ADD(&chan->num_suspended_readers, 1);
+    ATOMIC_FENCE();
+
+    (*chan->suspend_reader)(rport);
+
+    ATOMIC_FETCH_ADD(&chan->num_suspended_readers, -1);
+    ATOMIC_STORE_RELAXED(&rport->suspended, 0);
+    return;
+  }
+
+  /* retrieve the data pointer */
+  data = rport->data;
+
+  /* compute the wake-up mark */
+  wakeup_mark = vftasks_token_after(&rport->param, data, rport->param.min_data);
+
+  /* compute the overflow; if it is nonnegative, wrap the wake-up mark */
+  wrap = vftasks_tokens_between(&rport->param, rport->param.limit, wakeup_mark);
+  if (wrap >= 0)
+    wakeup_mark = vftasks_token_after(&rport->param, rport->param.base, wrap);
+
+  /* set wake-up zone on the write port; the start is stored last, as the
+     writer only looks at the end if the start is set */
+  ATOMIC_STORE_RELAXED(&chan->wport->wakeup_zone_end, data);
+  ATOMIC_STORE_RELAXED(&chan->wport->wakeup_zone_start, wakeup_mark);
+
+  /* make the wake-up zone visible before the suspend hook rechecks the tail;
+     pairs with the fence in vftasks_publish_tail */
+  ATOMIC_FENCE();
+
+  /* suspend reader */
+  (*chan->suspend_reader)(rport);
+
+  /* clear wake-up zone */
+  ATOMIC_STORE_RELAXED(&chan->wport->wakeup_zone_start, NULL);
+  ATOMIC_STORE_RELAXED(&chan->wport->wakeup_zone_end, NULL);
+}
+
+#endif /* VFPOLLING */
+
 /** acquire data
  */
 vftasks_token_t *vftasks_acquire_data(vftasks_rport_t *rport)
@@ -777,36 +1748,29 @@ vftasks_token_t *vftasks_acquire_data(vftasks_rport_t *rport)
 
 #ifndef VFPOLLING
     /* acquisition failed; put reader to sleep */
-    {
-      vftasks_chan_t *chan;          /* pointer to the channel                */
-      vftasks_token_t *data;         /* data pointer                          */
-      vftasks_token_t *wakeup_mark;  /* reader resumes when the tail hits the
-                                        wake-up mark                          */
-      int wrap;                      /* overflow                              */
-
-      /* retrieve the channel and data pointers */
-      chan = rport->chan;
-      data = rport->data;
-
-      /* compute the wake-up mark */
-      wakeup_mark = data + rport->param.min_data;
-
-      /* compute the overflow; if it is nonnegative, wrap the wake-up mark */
-      wrap = wakeup_mark - rport->param.limit;
-      if (wrap >= 0) wakeup_mark = rport->param.base + wrap;
+    vftasks_suspend_reader(rport);
+#endif
+  }
+  while (1);
+}
 
-      /* set wake-up zone on the write port */
-      chan->wport->wakeup_zone_start = wakeup_mark;
-      chan->wport->wakeup_zone_end = data;
+/** acquire a run of data tokens
+ */
+vftasks_token_t *vftasks_acquire_data_n(vftasks_rport_t *rport, int n, int *count)
+{
+  vftasks_token_t *token;    /* pointer to the first acquired token */
 
-      /* suspend reader */
-      (*chan->suspend_reader)(rport);
+  /* try to acquire tokens, until we have at least one */
+  do
+  {
+    /* try to acquire tokens */
+    token = vftasks_acquire_data_n_nb(rport, n, count);
+    if (token != NULL || n < 1) return token;
 
-      /* clear wake-up zone */
-      chan->wport->wakeup_zone_start = NULL;
-      chan->wport->wakeup_zone_end = NULL;
-    }
-#endif /* VFPOLLING */
+#ifndef VFPOLLING
+    /* acquisition failed; put reader to sleep */
+    vftasks_suspend_reader(rport);
+#endif
   }
   while (1);
 }
@@ -816,49 +1780,86 @@ vftasks_token_t *vftasks_acquire_data(vftasks_rport_t *rport)
 void vftasks_release_room(vftasks_rport_t *rport, vftasks_token_t *token)
 {
   vftasks_chan_t *chan;       /* pointer to the channel   */
-  vftasks_token_t* head;      /* the current head pointer */
   vftasks_token_t* new_head;  /* the new head pointer     */
 
   /* retrieve the channel */
   chan = rport->chan;
 
-  /* retrieve the head pointer */
-  head = rport->cached_state.head;
+  /* on channels with multiple writers or readers, release the token itself to the
+     writers, for the position a round of tokens later, and resume them once enough
+     room is available */
+  if (rport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    int pos = (ATOMIC_LOAD_RELAXED(&token->seq) - 1) / 2;  /* the token's position */
+
+    ATOMIC_STORE_RELEASE(&token->seq,
+                         2 * vftasks_pos_after(chan, pos, chan->param.size - 1));
+#ifndef VFPOLLING
+    vftasks_resume_writers(chan, rport->param.min_room);
+#endif
+    return;
+  }
 
   /* determine new head pointer; if it is out of bounds, wrap it */
-  new_head = head + 1;
+  new_head = vftasks_token_after(&rport->param, rport->cached_state.head, 1);
   if (new_head == rport->param.limit) new_head = rport->param.base;
 
-  /* update head pointer */
-  rport->cached_state.head = new_head;
-  chan->state.head = new_head;
+  /* update head pointer, handing the token back to the writer */
+  vftasks_publish_head(rport, new_head);
+}
 
-#ifndef VFPOLLING
-  /* if necessary, resume writer */
-  {
-    vftasks_token_t *wakeup_zone_start;  /* start of wake-up zone */
+/** release a run of room tokens
+ */
+void vftasks_release_room_n(vftasks_rport_t *rport, vftasks_token_t *token, int n)
+{
+  vftasks_chan_t *chan;       /* pointer to the channel   */
+  vftasks_token_t* head;      /* the current head pointer */
+  int wrap;                   /* overflow                 */
+  int k;                      /* index                    */
 
-    /* retrieve start of wake-up zone */
-    wakeup_zone_start = rport->wakeup_zone_start;
+  if (n < 1) return;
 
-    /* check wake-up zone */
-    if (wakeup_zone_start != NULL)
-    {
-      vftasks_token_t *wakeup_zone_end;  /* end of wake-up zone */
+  /* retrieve the channel */
+  chan = rport->chan;
 
-      /* retrieve end of wake-up zone */
-      wakeup_zone_end = chan->rport->wakeup_zone_end;
+  /* on channels with multiple writers or readers, release the tokens themselves to
+     the writers, and check whether to resume them once for the run */
+  if (rport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    for (k = 0; k < n; ++k)
+    {
+      int pos = (ATOMIC_LOAD_RELAXED(&token->seq) - 1) / 2;  /* the token's
+                                                                position */
 
-      /* check if head points into wake-up zone */
-      if ((wakeup_zone_start <= wakeup_zone_end &&
-           (new_head >= wakeup_zone_start && new_head < wakeup_zone_end)) ||
-          (wakeup_zone_start > wakeup_zone_end &&
-           (new_head >= wakeup_zone_start || new_head < wakeup_zone_end)))
-        /* tail points into wake-up zone: resume reader */
-        (*chan->resume_writer)(chan->wport);
+      ATOMIC_STORE_RELEASE(&token->seq,
+                           2 * vftasks_pos_after(chan, pos, chan->param.size - 1));
+      token = vftasks_token_after(&rport->param, token, 1);
     }
-  }
+#ifndef VFPOLLING
+    vftasks_resume_writers(chan, rport->param.min_room);
 #endif
+    return;
+  }
+
+  /* determine new head pointer; if it is out of bounds, wrap it */
+  head = rport->cached_state.head;
+  wrap = n - vftasks_tokens_between(&rport->param, head, rport->param.limit);
+  if (wrap >= 0)
+    head = vftasks_token_after(&rport->param, rport->param.base, wrap);
+  else
+    head = vftasks_token_after(&rport->param, head, n);
+
+  /* update head pointer once for the run, handing the tokens back to the writer */
+  vftasks_publish_head(rport, head);
+}
+
+/** get a token in a run
+ */
+vftasks_token_t *vftasks_token_in_run(vftasks_chan_t *chan,
+                                      vftasks_token_t *token,
+                                      int k)
+{
+  return vftasks_token_after(&chan->param, token, k);
 }
 
 /* ***************************************************************************
@@ -1002,9 +2003,30 @@ void vftasks_flush_data(vftasks_wport_t *wport)
 {
 #ifndef VFPOLLING
   vftasks_token_t *wakeup_zone_start;  /* start of wake-up zone */
+#endif
+
+  /* publish the data whose publication has been deferred; the reader is resumed
+     below regardless of the high-water mark */
+  if (wport->num_unpublished > 0)
+  {
+    wport->num_unpublished = 0;
+    ATOMIC_STORE_RELEASE(&wport->chan->tail, wport->cached_state.tail);
+#ifndef VFPOLLING
+    ATOMIC_FENCE();
+#endif
+  }
+
+#ifndef VFPOLLING
+
+  /* on channels with multiple writers or readers, resume all suspended readers */
+  if (wport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    vftasks_resume_readers(wport->chan, 0);
+    return;
+  }
 
   /* retrieve start of wake-up zone */
-  wakeup_zone_start = wport->wakeup_zone_start;
+  wakeup_zone_start = ATOMIC_LOAD_RELAXED(&wport->wakeup_zone_start);
 
   /* check wake-up zone */
   if (wakeup_zone_start != NULL)
@@ -1027,8 +2049,15 @@ void vftasks_flush_room(vftasks_rport_t *rport)
 #ifndef VFPOLLING
   vftasks_token_t *wakeup_zone_start;  /* start of wake-up zone */
 
+  /* on channels with multiple writers or readers, resume all suspended writers */
+  if (rport->param.kind != VFTASKS_CHAN_SPSC)
+  {
+    vftasks_resume_writers(rport->chan, 0);
+    return;
+  }
+
   /* retrieve start of wake-up zone */
-  wakeup_zone_start = rport->wakeup_zone_start;
+  wakeup_zone_start = ATOMIC_LOAD_RELAXED(&rport->wakeup_zone_start);
 
   /* check wake-up zone */
   if (wakeup_zone_start != NULL)
@@ -0,0 +1,316 @@
+#include "sync.h"
+#include "timer_wheel.h"
+
+#include <stdarg.h>     /* for va_list */
+#include <stdio.h>      /* for vsnprintf and printing to stderr */
+#include <stdlib.h>     /* for abort */
+#include <string.h>     /* for memset */
+
+/* Maximum number of pauses in between two polls of a progress counter */
+#define MAX_BACKOFF 64
+
+/* ***************************************************************************
+ * Failure handling shared by the synchronization managers
+ * ***************************************************************************/
+
+/** abort
+ */
+void _vftasks_abort_on_fail(char *msg)
+{
+#ifdef VFTASKS_ABORT_ON_FAILURE
+  fprintf(stderr, "Failure: %s\n", msg);
+  abort();
+#endif
+}
+
+/* ***************************************************************************
+ * Storage shared by the synchronization managers
+ * ***************************************************************************/
+
+/** create an array of semaphores; a nonzero spacing, which must be a power of two,
+ *  places every semaphore at the start of its own block of a multiple of that many
+ *  bytes, while a spacing of 0 packs the semaphores
+ */
+int _vftasks_create_sem_array(vftasks_sem_array_t *array,
+                              int num_sems,
+                              size_t spacing,
+                              int value,
+                              int max)
+{
+  size_t alignment;  /* alignment of the array */
+  int i;             /* index */
+
+  if (spacing & (spacing - 1)) return 1;
+
+  if (spacing == 0)
+  {
+    array->spacing = sizeof(semaphore_t);
+    alignment = CACHE_LINE_SIZE;
+  }
+  else
+  {
+    array->spacing = (sizeof(semaphore_t) + spacing - 1) & ~(spacing - 1);
+    alignment = spacing > sizeof(void *) ? spacing : sizeof(void *);
+  }
+
+  array->num_sems = num_sems;
+  if (ALIGNED_MALLOC(array->base, alignment, num_sems * array->spacing) != 0)
+    return 1;
+
+  for (i = 0; i < num_sems; ++i)
+  {
+    if (SEMAPHORE_CREATE(*_vftasks_sem_at(array, i), value, max) != 0)
+    {
+      array->num_sems = i;
+      _vftasks_destroy_sem_array(array);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/** destroy an array of semaphores
+ */
+void _vftasks_destroy_sem_array(vftasks_sem_array_t *array)
+{
+  int i;  /* index */
+
+  for (i = 0; i < array->num_sems; ++i)
+  {
+    SEMAPHORE_DESTROY(*_vftasks_sem_at(array, i));
+  }
+
+  ALIGNED_FREE(array->base);
+}
+
+/** create an array of progress counters with a given initial count
+ */
+vftasks_progress_t *_vftasks_create_progress(int num_counters, int64_t count)
+{
+  vftasks_progress_t *progress;  /* the counters */
+  int i;                         /* index */
+
+  if (ALIGNED_MALLOC(progress,
+                     CACHE_LINE_SIZE,
+                     num_counters * sizeof(vftasks_progress_t)) != 0)
+    return NULL;
+
+  for (i = 0; i < num_counters; ++i)
+  {
+    progress[i].count = count;
+    _vftasks_eventcount_init(&progress[i].eventcount);
+  }
+
+  return progress;
+}
+
+/** destroy an array of progress counters
+ */
+void _vftasks_destroy_progress(vftasks_progress_t *progress)
+{
+  ALIGNED_FREE(progress);
+}
+
+/** wait until a count has reached a given value; the count is polled with
+ *  exponential backoff, and after spin_limit polls, unless that is 0, the waiting
+ *  thread parks on an eventcount that is notified whenever the count is updated
+ */
+void _vftasks_wait_count(int64_t *count,
+                         int64_t value,
+                         vftasks_eventcount_t *eventcount,
+                         int spin_limit)
+{
+  int backoff;       /* number of pauses in between polls */
+  int polls;         /* number of polls so far */
+  unsigned int key;  /* key for parking */
+  int k;             /* index */
+
+  /* if the value has been reached already, that is all */
+  if (ATOMIC_LOAD_ACQUIRE(count) >= value) return;
+
+  /* poll with exponential backoff */
+  backoff = 1;
+  for (polls = 0; spin_limit == 0 || polls < spin_limit; ++polls)
+  {
+    for (k = 0; k < backoff; ++k) CPU_PAUSE();
+    if (backoff < MAX_BACKOFF) backoff <<= 1;
+
+    if (ATOMIC_LOAD_ACQUIRE(count) >= value) return;
+  }
+
+  /* park until the value is reached */
+  for (;;)
+  {
+    key = vftasks_prepare_wait(eventcount);
+    if (ATOMIC_LOAD_ACQUIRE(count) >= value)
+    {
+      vftasks_cancel_wait(eventcount, key);
+      return;
+    }
+    vftasks_commit_wait(eventcount, key);
+  }
+}
+
+/* ***************************************************************************
+ * Wait statistics
+ * ***************************************************************************/
+
+/** create an array of cleared wait records
+ */
+vftasks_wait_record_t *_vftasks_create_wait_records(int num_records)
+{
+  vftasks_wait_record_t *records;  /* the records */
+
+  if (ALIGNED_MALLOC(records,
+                     CACHE_LINE_SIZE,
+                     num_records * sizeof(vftasks_wait_record_t)) != 0)
+    return NULL;
+
+  memset(records, 0, num_records * sizeof(vftasks_wait_record_t));
+
+  return records;
+}
+
+/** destroy an array of wait records
+ */
+void _vftasks_destroy_wait_records(vftasks_wait_record_t *records)
+{
+  ALIGNED_FREE(records);
+}
+
+/** wait until a progress counter has reached a given count, and record the wait;
+ *  it is timed only if the count has not been reached yet
+ */
+void _vftasks_record_wait_progress(vftasks_wait_record_t *record,
+                                   vftasks_progress_t *progress,
+                                   int64_t count,
+                                   int spin_limit)
+{
+  uint64_t start;  /* time at which the wait started blocking */
+
+  record->stats.num_waits++;
+  if (ATOMIC_LOAD_ACQUIRE(&progress->count) >= count) return;
+
+  start = _vftasks_monotonic_ns();
+  _vftasks_wait_progress(progress, count, spin_limit);
+  record->stats.blocked_ns += _vftasks_monotonic_ns() - start;
+  record->stats.num_blocked++;
+}
+
+/** take a number of units from a semaphore, and record the wait; units that are
+ *  available are taken without blocking, and the wait is timed only if that does
+ *  not suffice
+ */
+int _vftasks_record_sem_wait_n(vftasks_wait_record_t *record, semaphore_t *sem, int n)
+{
+  uint64_t start;  /* time at which the wait started blocking */
+  int rc;          /* return code */
+
+  record->stats.num_waits++;
+  n -= SEMAPHORE_TRYWAIT_N(*sem, n);
+  if (n == 0) return 0;
+
+  start = _vftasks_monotonic_ns();
+  rc = SEMAPHORE_WAIT_N(*sem, n);
+  record->stats.blocked_ns += _vftasks_monotonic_ns() - start;
+  record->stats.num_blocked++;
+
+  return rc;
+}
+
+/** copy the statistics of one of an array of wait records
+ */
+int _vftasks_get_wait_record(vftasks_wait_record_t *records,
+                             int num_records,
+                             int index,
+                             vftasks_sync_stats_t *stats)
+{
+  if (records == NULL || index < 0 || index >= num_records || stats == NULL)
+    return 1;
+
+  *stats = records[index].stats;
+
+  return 0;
+}
+
+/** append formatted text to a buffer, as far as it fits, and keep track of the
+ *  length of the complete text
+ */
+static void vftasks_append(char *buf, size_t size, size_t *len, const char *format, ...)
+{
+  va_list args;  /* the values to format */
+  int n;         /* length of the formatted text */
+
+  va_start(args, format);
+  n = vsnprintf(*len < size ? buf + *len : NULL,
+                *len < size ? size - *len : 0,
+                format,
+                args);
+  va_end(args);
+
+  if (n > 0) *len += n;
+}
+
+/** format an array of wait records as CSV or JSON; if num_threads is positive, a
+ *  "thread" column gives the index of each record modulo num_threads; the text is
+ *  truncated to fit in a buffer of the given size, and its complete length is
+ *  returned
+ */
+int _vftasks_format_wait_records(vftasks_wait_record_t *records,
+                                 int num_records,
+                                 const char *key,
+                                 int num_threads,
+                                 int format,
+                                 char *buf,
+                                 size_t size)
+{
+  vftasks_sync_stats_t *stats;  /* the statistics of a record */
+  size_t len;                   /* length of the text so far */
+  int k;                        /* index */
+
+  if (records == NULL || (buf == NULL && size > 0) ||
+      (format != VFTASKS_STATS_CSV && format != VFTASKS_STATS_JSON))
+    return -1;
+
+  if (size > 0) buf[0] = '\0';
+  len = 0;
+
+  if (format == VFTASKS_STATS_CSV)
+    vftasks_append(buf, size, &len, "%s,%swaits,blocked,blocked_ns\n",
+                   key,
+                   num_threads > 0 ? "thread," : "");
+  else
+    vftasks_append(buf, size, &len, "[");
+
+  for (k = 0; k < num_records; ++k)
+  {
+    stats = &records[k].stats;
+
+    if (format == VFTASKS_STATS_CSV)
+    {
+      vftasks_append(buf, size, &len, "%d,", k);
+      if (num_threads > 0) vftasks_append(buf, size, &len, "%d,", k % num_threads);
+      vftasks_append(buf, size, &len, "%lu,%lu,%llu\n",
+                     stats->num_waits,
+                     stats->num_blocked,
+                     (unsigned long long)stats->blocked_ns);
+    }
+    else
+    {
+      vftasks_append(buf, size, &len, "%s\n  {\"%s\": %d, ", k > 0 ? "," : "", key, k);
+      if (num_threads > 0)
+        vftasks_append(buf, size, &len, "\"thread\": %d, ", k % num_threads);
+      vftasks_append(buf, size, &len,
+                     "\"waits\": %lu, \"blocked\": %lu, \"blocked_ns\": %llu}",
+                     stats->num_waits,
+                     stats->num_blocked,
+                     (unsigned long long)stats->blocked_ns);
+    }
+  }
+
+  if (format == VFTASKS_STATS_JSON)
+    vftasks_append(buf, size, &len, "\n]\n");
+
+  return (int)len;
+}
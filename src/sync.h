@@ -0,0 +1,96 @@
+#ifndef __SYNC_H
+#define __SYNC_H
+
+#include "vftasks.h"
+#include "eventcount.h"
+#include "platform.h"
+
+/* Default number of polls after which a thread that waits for a progress counter
+   parks */
+#define VFTASKS_SYNC_SPIN_LIMIT 1000
+
+/** array of semaphores that are laid out a fixed number of bytes apart, so that
+ *  semaphores used by different threads do not share cache lines
+ */
+typedef struct vftasks_sem_array_s
+{
+  char *base;      /* pointer to the first semaphore */
+  size_t spacing;  /* number of bytes from one semaphore to the next */
+  int num_sems;    /* number of semaphores */
+} vftasks_sem_array_t;
+
+/** progress counter; every counter is written by a different thread, so counters
+ *  are kept in separate cache lines
+ */
+typedef struct ALIGNED(CACHE_LINE_SIZE) vftasks_progress_s
+{
+  int64_t count;                    /* amount of progress; only ever increases */
+  vftasks_eventcount_t eventcount;  /* for parking threads that wait for the
+                                       counter */
+} vftasks_progress_t;
+
+/** wait statistics of a thread or of an outer iteration; every record is updated by
+ *  a single thread, so records are kept in separate cache lines
+ */
+typedef struct ALIGNED(CACHE_LINE_SIZE) vftasks_wait_record_s
+{
+  vftasks_sync_stats_t stats;  /* the statistics */
+} vftasks_wait_record_t;
+
+void _vftasks_abort_on_fail(char *);
+
+int _vftasks_create_sem_array(vftasks_sem_array_t *, int, size_t, int, int);
+void _vftasks_destroy_sem_array(vftasks_sem_array_t *);
+
+vftasks_progress_t *_vftasks_create_progress(int, int64_t);
+void _vftasks_destroy_progress(vftasks_progress_t *);
+void _vftasks_wait_count(int64_t *, int64_t, vftasks_eventcount_t *, int);
+
+/** wait until a progress counter has reached a given count; see
+ *  _vftasks_wait_count()
+ */
+static inline void _vftasks_wait_progress(vftasks_progress_t *progress,
+                                          int64_t count,
+                                          int spin_limit)
+{
+  _vftasks_wait_count(&progress->count, count, &progress->eventcount, spin_limit);
+}
+
+vftasks_wait_record_t *_vftasks_create_wait_records(int);
+void _vftasks_destroy_wait_records(vftasks_wait_record_t *);
+void _vftasks_record_wait_progress(vftasks_wait_record_t *,
+                                   vftasks_progress_t *,
+                                   int64_t,
+                                   int);
+int _vftasks_record_sem_wait_n(vftasks_wait_record_t *, semaphore_t *, int);
+int _vftasks_get_wait_record(vftasks_wait_record_t *,
+                             int,
+                             int,
+                             vftasks_sync_stats_t *);
+int _vftasks_format_wait_records(vftasks_wait_record_t *,
+                                 int,
+                                 const char *,
+                                 int,
+                                 int,
+                                 char *,
+                                 size_t);
+
+/** publish the progress of a thread; threads parked on the counter are woken up
+ *  unless waiting threads never park
+ */
+static inline void _vftasks_set_progress(vftasks_progress_t *progress,
+                                         int64_t count,
+                                         int spin_limit)
+{
+  ATOMIC_STORE_RELEASE(&progress->count, count);
+  if (spin_limit > 0) vftasks_notify(&progress->eventcount);
+}
+
+/** the semaphore at a given index in an array
+ */
+static inline semaphore_t *_vftasks_sem_at(vftasks_sem_array_t *array, int index)
+{
+  return (semaphore_t *)(array->base + (size_t)index * array->spacing);
+}
+
+#endif /* __SYNC_H */
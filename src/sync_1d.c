@@ -1,6 +1,7 @@
 #include "vftasks.h"
-#include "platform.h"
+#include "sync.h"
 
+#include <limits.h>     /* INT_MAX */
 #include <stdlib.h>     /* abort */
 #include <stdio.h>      /* for printing to stderr */
 
@@ -12,9 +13,22 @@
  */
 struct vftasks_1d_sync_mgr_s
 {
-  int num_threads;    /* number of threads */
-  int dist;           /* critical distance */
-  semaphore_t *sems;  /* pointer to an array of num_threads semaphores */
+  int num_threads;                /* number of threads */
+  int dist;                       /* critical distance */
+  int block_size;                 /* number of consecutive iterations executed by
+                                     the same thread */
+  int stride;                     /* number of iterations in a round of blocks */
+  int mode;                       /* synchronization mode */
+  int spin_limit;                 /* number of polls before parking, or 0 */
+  int num_links;                  /* number of threads that produce for a thread:
+                                     1 if dist is a multiple of the block size,
+                                     2 otherwise */
+  vftasks_sem_array_t sems;       /* array of num_threads * num_links semaphores,
+                                     in semaphore mode */
+  vftasks_progress_t *progress;   /* pointer to an array of num_threads progress
+                                     counters, in spin mode */
+  vftasks_wait_record_t *records; /* pointer to an array of num_threads wait
+                                     records, if profiling is enabled */
 };
 
 /** abort
@@ -27,15 +41,80 @@ void _vftasks_abort_on_fail_sync_1d(char *msg)
 #endif
 }
 
+/** the thread that executes a given iteration
+ */
+static inline int vftasks_owner_1d(vftasks_1d_sync_mgr_t *mgr, int i)
+{
+  return (i / mgr->block_size) % mgr->num_threads;
+}
+
+/** the position of a given iteration among the iterations executed by its thread
+ */
+static inline int vftasks_local_index_1d(vftasks_1d_sync_mgr_t *mgr, int i)
+{
+  return (i / mgr->stride) * mgr->block_size + i % mgr->block_size;
+}
+
+/** the semaphore through which a given iteration waits for iteration i - dist;
+ *  as the units of a semaphore are interchangeable, every semaphore is signalled by
+ *  a single thread, in iteration order
+ */
+static inline semaphore_t *vftasks_link_1d(vftasks_1d_sync_mgr_t *mgr, int i)
+{
+  int e;  /* 0 if the producing block is dist / block_size blocks back, 1 if it is
+             one block further back */
+
+  e = i / mgr->block_size - (i - mgr->dist) / mgr->block_size -
+      mgr->dist / mgr->block_size;
+
+  return _vftasks_sem_at(&mgr->sems, vftasks_owner_1d(mgr, i) * mgr->num_links + e);
+}
+
+/** initialize attributes of a 1D-synchronization manager
+ */
+void vftasks_init_1d_sync_attr(vftasks_1d_sync_attr_t *attr)
+{
+  attr->mode = VFTASKS_SYNC_SEMAPHORE;
+  attr->spin_limit = VFTASKS_SYNC_SPIN_LIMIT;
+  attr->distribution = VFTASKS_DIST_CYCLIC;
+  attr->block_size = 1;
+  attr->num_iterations = 0;
+  attr->spacing = VFTASKS_SYNC_SPACING;
+  attr->profile = 0;
+}
+
 /** create a 1D-synchronization manager
  */
 vftasks_1d_sync_mgr_t *vftasks_create_1d_sync_mgr(int num_threads, int dist)
 {
-  vftasks_1d_sync_mgr_t *mgr;  /* pointer to the manager */
-  int t;                       /* index */
+  return vftasks_create_1d_sync_mgr_with_attr(num_threads, dist, NULL);
+}
+
+/** create a 1D-synchronization manager with attributes
+ */
+vftasks_1d_sync_mgr_t *vftasks_create_1d_sync_mgr_with_attr(
+  int num_threads,
+  int dist,
+  const vftasks_1d_sync_attr_t *attr)
+{
+  vftasks_1d_sync_mgr_t *mgr;           /* pointer to the manager */
+  vftasks_1d_sync_attr_t default_attr;  /* attributes used if none are given */
+
+  if (attr == NULL)
+  {
+    vftasks_init_1d_sync_attr(&default_attr);
+    attr = &default_attr;
+  }
 
   /* check arguments */
-  if (num_threads < 1 || dist < 1)
+  if (num_threads < 1 || dist < 1 ||
+      (attr->mode != VFTASKS_SYNC_SEMAPHORE && attr->mode != VFTASKS_SYNC_SPIN) ||
+      attr->spin_limit < 0 || (attr->spacing & (attr->spacing - 1)) ||
+      (attr->distribution == VFTASKS_DIST_BLOCK_CYCLIC && attr->block_size < 1) ||
+      (attr->distribution == VFTASKS_DIST_BLOCK && attr->num_iterations < 1) ||
+      (attr->distribution != VFTASKS_DIST_CYCLIC &&
+       attr->distribution != VFTASKS_DIST_BLOCK_CYCLIC &&
+       attr->distribution != VFTASKS_DIST_BLOCK))
   {
     _vftasks_abort_on_fail_sync_1d("vftasks_create_1d_mgr: invalid argument");
     return NULL;
@@ -52,23 +131,65 @@ vftasks_1d_sync_mgr_t *vftasks_create_1d_sync_mgr(int num_threads, int dist)
   /* set the data for manager */
   mgr->num_threads = num_threads;
   mgr->dist = dist;
+  mgr->mode = attr->mode;
 
-  /* allocate the semaphores held by the manager */
-  mgr->sems = (semaphore_t *)malloc(num_threads * sizeof(semaphore_t));
-  if (mgr->sems == NULL)
+  /* every distribution is block-cyclic with some block size */
+  switch (attr->distribution)
   {
-    free(mgr);
-    _vftasks_abort_on_fail_sync_1d("vftasks_create_1d_mgr: not enough memory");
-    return NULL;
+  case VFTASKS_DIST_BLOCK_CYCLIC:
+    mgr->block_size = attr->block_size;
+    break;
+  case VFTASKS_DIST_BLOCK:
+    mgr->block_size = (attr->num_iterations + num_threads - 1) / num_threads;
+    break;
+  default:
+    mgr->block_size = 1;
+  }
+  mgr->stride = mgr->block_size * num_threads;
+  mgr->num_links = dist % mgr->block_size == 0 ? 1 : 2;
+
+  mgr->spin_limit = attr->spin_limit;
+  mgr->progress = NULL;
+  mgr->records = NULL;
+
+  /* allocate the wait records, if profiling is enabled */
+  if (attr->profile)
+  {
+    mgr->records = _vftasks_create_wait_records(num_threads);
+    if (mgr->records == NULL)
+    {
+      free(mgr);
+      _vftasks_abort_on_fail_sync_1d("vftasks_create_1d_mgr: not enough memory");
+      return NULL;
+    }
   }
 
-  /* initialize the semaphores */
-  for (t = 0; t < num_threads; ++t)
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
   {
+    /* allocate the progress counters; no thread has completed any iterations yet */
+    mgr->progress = _vftasks_create_progress(num_threads, 0);
+    if (mgr->progress == NULL)
+    {
+      if (mgr->records != NULL) _vftasks_destroy_wait_records(mgr->records);
+      free(mgr);
+      _vftasks_abort_on_fail_sync_1d("vftasks_create_1d_mgr: not enough memory");
+      return NULL;
+    }
+
+    return mgr;
+  }
 
-    SEMAPHORE_CREATE(mgr->sems[t],
-                     dist / num_threads + (t < dist % num_threads),
-                     dist / num_threads + 1);
+  /* allocate and initialize the semaphores held by the manager */
+  if (_vftasks_create_sem_array(&mgr->sems,
+                                num_threads * mgr->num_links,
+                                attr->spacing,
+                                0,
+                                (dist / mgr->stride + 2) * mgr->block_size) != 0)
+  {
+    if (mgr->records != NULL) _vftasks_destroy_wait_records(mgr->records);
+    free(mgr);
+    _vftasks_abort_on_fail_sync_1d("vftasks_create_1d_mgr: not enough memory");
+    return NULL;
   }
 
   /* return the pointer to the manager */
@@ -79,33 +200,64 @@ vftasks_1d_sync_mgr_t *vftasks_create_1d_sync_mgr(int num_threads, int dist)
  */
 void vftasks_destroy_1d_sync_mgr(vftasks_1d_sync_mgr_t *mgr)
 {
-  int t;  /* index */
-
   /* check argument */
   if (mgr == NULL)
   {
     _vftasks_abort_on_fail_sync_1d("vftasks_destroy_1d_mgr: invalid argument");
   }
 
-  /* destroy the semaphores held by the manager */
-  for (t = 0; t < mgr->num_threads; ++t)
+  /* release the wait records */
+  if (mgr->records != NULL) _vftasks_destroy_wait_records(mgr->records);
+
+  /* release the progress counters held by the manager */
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
   {
-    SEMAPHORE_DESTROY(mgr->sems[t]);
+    _vftasks_destroy_progress(mgr->progress);
+    free(mgr);
+    return;
   }
 
-  /* deallocate the semaphores */
-  free(mgr->sems);
+  /* destroy and deallocate the semaphores held by the manager */
+  _vftasks_destroy_sem_array(&mgr->sems);
 
   /* deallocate the manager */
   free(mgr);
 }
 
+/** reset a 1D-synchronization manager
+ */
+int vftasks_reset_1d_sync_mgr(vftasks_1d_sync_mgr_t *mgr)
+{
+  int s;  /* index */
+
+  /* check argument */
+  if (mgr == NULL)
+  {
+    _vftasks_abort_on_fail_sync_1d("vftasks_reset_1d_mgr: invalid argument");
+    return 1;
+  }
+
+  /* no thread has completed any iterations yet */
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
+  {
+    for (s = 0; s < mgr->num_threads; ++s)
+      ATOMIC_STORE_RELAXED(&mgr->progress[s].count, 0);
+    return 0;
+  }
+
+  /* take back the units signalled by the last dist iterations, which no iteration
+     has waited for */
+  for (s = 0; s < mgr->sems.num_sems; ++s)
+    SEMAPHORE_TRYWAIT_N(*_vftasks_sem_at(&mgr->sems, s), INT_MAX);
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
 /** signal production of data
  */
 int vftasks_signal_1d(vftasks_1d_sync_mgr_t *mgr, int i)
 {
-  int t;  /* index of the thread to signal to */
-
   /* check arguments */
   if (mgr == NULL || i < 0)
   {
@@ -113,11 +265,20 @@ int vftasks_signal_1d(vftasks_1d_sync_mgr_t *mgr, int i)
     return 1;
   }
 
-  /* determing the index of the thread to signal to */
-  t = (i + mgr->dist) % mgr->num_threads;
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
+  {
+    vftasks_progress_t *progress;  /* progress of the thread executing iteration i */
+
+    /* publish the number of iterations that the thread has completed */
+    progress = &mgr->progress[vftasks_owner_1d(mgr, i)];
+    _vftasks_set_progress(progress, vftasks_local_index_1d(mgr, i) + 1, mgr->spin_limit);
+
+    return 0;
+  }
 
-  /* signal through the thread's semaphore; on failure, return 1 */
-  if (SEMAPHORE_POST(mgr->sems[t]) != 0)
+  /* signal to the thread that executes iteration i + dist, through the semaphore
+     that links it to this thread; on failure, return 1 */
+  if (SEMAPHORE_POST(*vftasks_link_1d(mgr, i + mgr->dist)) != 0)
   {
     _vftasks_abort_on_fail_sync_1d("vftasks_signal_1d");
     return 1;
@@ -127,12 +288,28 @@ int vftasks_signal_1d(vftasks_1d_sync_mgr_t *mgr, int i)
   return 0;
 }
 
+/** wait in iteration i until iteration j has been completed, in spin mode
+ */
+static void vftasks_spin_wait_1d(vftasks_1d_sync_mgr_t *mgr, int i, int j)
+{
+  /* the first dist iterations do not wait */
+  if (j < 0) return;
+
+  if (mgr->records != NULL)
+    _vftasks_record_wait_progress(&mgr->records[vftasks_owner_1d(mgr, i)],
+                                  &mgr->progress[vftasks_owner_1d(mgr, j)],
+                                  vftasks_local_index_1d(mgr, j) + 1,
+                                  mgr->spin_limit);
+  else
+    _vftasks_wait_progress(&mgr->progress[vftasks_owner_1d(mgr, j)],
+                           vftasks_local_index_1d(mgr, j) + 1,
+                           mgr->spin_limit);
+}
+
 /** synchronize before consuming data
  */
 int vftasks_wait_1d(vftasks_1d_sync_mgr_t *mgr, int i)
 {
-  int t; /* index of the executing thread */
-
   /* check arguments */
   if (mgr == NULL || i < 0)
   {
@@ -140,11 +317,22 @@ int vftasks_wait_1d(vftasks_1d_sync_mgr_t *mgr, int i)
     return 1;
   }
 
-  /* determine the index of the executing thread */
-  t = (i % mgr->num_threads);
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
+  {
+    vftasks_spin_wait_1d(mgr, i, i - mgr->dist);
+    return 0;
+  }
+
+  /* the first dist iterations do not wait */
+  if (i < mgr->dist) return 0;
 
-  /* wait through the other thread's semaphore; on failure, return 1 */
-  if (SEMAPHORE_WAIT(mgr->sems[t]) != 0)
+  /* wait through the semaphore that links the executing thread to the thread that
+     executes iteration i - dist; on failure, return 1 */
+  if ((mgr->records != NULL ?
+       _vftasks_record_sem_wait_n(&mgr->records[vftasks_owner_1d(mgr, i)],
+                                  vftasks_link_1d(mgr, i),
+                                  1) :
+       SEMAPHORE_WAIT(*vftasks_link_1d(mgr, i))) != 0)
   {
     _vftasks_abort_on_fail_sync_1d("vftasks_wait_1d");
     return 1;
@@ -153,3 +341,130 @@ int vftasks_wait_1d(vftasks_1d_sync_mgr_t *mgr, int i)
   /* return 0 to indicate success */
   return 0;
 }
+
+/** signal production of data for a range of iterations
+ */
+int vftasks_signal_1d_range(vftasks_1d_sync_mgr_t *mgr, int begin, int end)
+{
+  int b;     /* block size */
+  int i;     /* start of a run of iterations */
+  int next;  /* end of the run */
+
+  /* check arguments; a nonempty range must lie within a single block */
+  if (mgr == NULL || begin < 0 || end < begin ||
+      (end > begin && begin / mgr->block_size != (end - 1) / mgr->block_size))
+  {
+    _vftasks_abort_on_fail_sync_1d("vftasks_signal_1d_range: invalid argument");
+    return 1;
+  }
+
+  if (end == begin) return 0;
+
+  b = mgr->block_size;
+
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
+  {
+    /* publish the number of iterations that the owning thread has completed */
+    _vftasks_set_progress(&mgr->progress[vftasks_owner_1d(mgr, begin)],
+                          vftasks_local_index_1d(mgr, end - 1) + 1,
+                          mgr->spin_limit);
+
+    return 0;
+  }
+
+  /* iterations that signal to iterations in the range itself do not, as those do
+     not wait for them */
+  for (i = begin > end - mgr->dist ? begin : end - mgr->dist; i < end; i = next)
+  {
+    /* the run ends where the iterations signalled to cross a block boundary */
+    next = ((i + mgr->dist) / b + 1) * b - mgr->dist;
+    if (next > end) next = end;
+
+    if (SEMAPHORE_POST_N(*vftasks_link_1d(mgr, i + mgr->dist), next - i) != 0)
+    {
+      _vftasks_abort_on_fail_sync_1d("vftasks_signal_1d_range");
+      return 1;
+    }
+  }
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** synchronize before consuming data for a range of iterations
+ */
+int vftasks_wait_1d_range(vftasks_1d_sync_mgr_t *mgr, int begin, int end)
+{
+  int b;     /* block size */
+  int i;     /* start of a run of iterations */
+  int next;  /* end of the run */
+
+  /* check arguments; a nonempty range must lie within a single block */
+  if (mgr == NULL || begin < 0 || end < begin ||
+      (end > begin && begin / mgr->block_size != (end - 1) / mgr->block_size))
+  {
+    _vftasks_abort_on_fail_sync_1d("vftasks_wait_1d_range: invalid argument");
+    return 1;
+  }
+
+  b = mgr->block_size;
+
+  /* iterations that depend on iterations in the range itself do not wait, as those
+     are executed before them */
+  if (end > begin + mgr->dist) end = begin + mgr->dist;
+
+  /* the first dist iterations do not wait */
+  for (i = begin > mgr->dist ? begin : mgr->dist; i < end; i = next)
+  {
+    /* the run ends where the iterations waited for cross a block boundary */
+    next = ((i - mgr->dist) / b + 1) * b + mgr->dist;
+    if (next > end) next = end;
+
+    if (mgr->mode == VFTASKS_SYNC_SPIN)
+    {
+      /* the last iteration of the run is completed after the others */
+      vftasks_spin_wait_1d(mgr, i, next - 1 - mgr->dist);
+    }
+    else if ((mgr->records != NULL ?
+              _vftasks_record_sem_wait_n(&mgr->records[vftasks_owner_1d(mgr, i)],
+                                         vftasks_link_1d(mgr, i),
+                                         next - i) :
+              SEMAPHORE_WAIT_N(*vftasks_link_1d(mgr, i), next - i)) != 0)
+    {
+      _vftasks_abort_on_fail_sync_1d("vftasks_wait_1d_range");
+      return 1;
+    }
+  }
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** get the wait statistics of a thread
+ */
+int vftasks_get_1d_sync_stats(vftasks_1d_sync_mgr_t *mgr,
+                              int thread,
+                              vftasks_sync_stats_t *stats)
+{
+  if (mgr == NULL) return 1;
+
+  return _vftasks_get_wait_record(mgr->records, mgr->num_threads, thread, stats);
+}
+
+/** export the wait statistics of all threads
+ */
+int vftasks_format_1d_sync_stats(vftasks_1d_sync_mgr_t *mgr,
+                                 int format,
+                                 char *buf,
+                                 size_t size)
+{
+  if (mgr == NULL) return -1;
+
+  return _vftasks_format_wait_records(mgr->records,
+                                      mgr->num_threads,
+                                      "thread",
+                                      0,
+                                      format,
+                                      buf,
+                                      size);
+}
@@ -1,5 +1,5 @@
 #include "vftasks.h"
-#include "platform.h"
+#include "sync.h"
 
 #include <stdlib.h>     /* for malloc, free, and abort */
 #include <stdio.h>      /* for printing to stderr */
@@ -16,7 +16,19 @@ struct vftasks_2d_sync_mgr_s
   int dim_y;    /* iteration-space size along y-dimension */
   int dist_x;   /* critical distance along x-dimension */
   int dist_y;   /* critical distance along y-dimension */
-  semaphore_t *sems;  /* pointer to an array of dim_x semaphores */
+  int mode;     /* VFTASKS_SYNC_SEMAPHORE or VFTASKS_SYNC_SPIN */
+  int spin_limit;  /* in spin mode, the number of polls before a waiting thread
+                      blocks */
+  vftasks_sem_array_t sems;  /* in semaphore mode, array of dim_x semaphores */
+  int num_threads;  /* number of threads over which the outer iterations are
+                       distributed cyclically, or 0 if unknown */
+  int ring_size;   /* in spin mode, the number of progress counters */
+  vftasks_progress_t *ring;  /* in spin mode, ring of progress counters; outer
+                                iteration x uses counter x % ring_size, to which it
+                                writes x * (dim_y + 1) plus the number of inner
+                                iterations completed */
+  vftasks_wait_record_t *records;  /* array of dim_x wait records, if profiling is
+                                      enabled */
 };
 
 /** abort
@@ -29,6 +41,33 @@ void _vftasks_abort_on_fail_sync_2d(char *msg)
 #endif
 }
 
+/** initialize attributes of a 2D-synchronization manager
+ */
+void vftasks_init_2d_sync_attr(vftasks_2d_sync_attr_t *attr)
+{
+  attr->spacing = VFTASKS_SYNC_SPACING;
+  attr->mode = VFTASKS_SYNC_SEMAPHORE;
+  attr->spin_limit = VFTASKS_SYNC_SPIN_LIMIT;
+  attr->num_threads = 0;
+  attr->profile = 0;
+}
+
+/** the count that the progress counter for an outer iteration holds once a given
+ *  number of its inner iterations have been completed
+ */
+static inline int64_t vftasks_row_count_2d(vftasks_2d_sync_mgr_t *mgr, int x, int n)
+{
+  return (int64_t)x * (mgr->dim_y + 1) + n;
+}
+
+/** the progress counter used by an outer iteration
+ */
+static inline vftasks_progress_t *vftasks_row_progress_2d(vftasks_2d_sync_mgr_t *mgr,
+                                                          int x)
+{
+  return &mgr->ring[x % mgr->ring_size];
+}
+
 /** create a 2D-synchronization manager
  */
 vftasks_2d_sync_mgr_t *vftasks_create_2d_sync_mgr(int dim_x,
@@ -36,8 +75,27 @@ vftasks_2d_sync_mgr_t *vftasks_create_2d_sync_mgr(int dim_x,
                                                   int dist_x,
                                                   int dist_y)
 {
-  vftasks_2d_sync_mgr_t *mgr;  /* pointer to the manager */
-  int x;                 /* index */
+  return vftasks_create_2d_sync_mgr_with_attr(dim_x, dim_y, dist_x, dist_y, NULL);
+}
+
+/** create a 2D-synchronization manager with attributes
+ */
+vftasks_2d_sync_mgr_t *vftasks_create_2d_sync_mgr_with_attr(
+  int dim_x,
+  int dim_y,
+  int dist_x,
+  int dist_y,
+  const vftasks_2d_sync_attr_t *attr)
+{
+  vftasks_2d_sync_mgr_t *mgr;           /* pointer to the manager */
+  vftasks_2d_sync_attr_t default_attr;  /* attributes used if none are given */
+  int s;                                /* index */
+
+  if (attr == NULL)
+  {
+    vftasks_init_2d_sync_attr(&default_attr);
+    attr = &default_attr;
+  }
 
   if (abs(dist_x) >= dim_x || abs(dist_y) >= dim_y)
   {
@@ -46,6 +104,16 @@ vftasks_2d_sync_mgr_t *vftasks_create_2d_sync_mgr(int dim_x,
     return NULL;
   }
 
+  /* the spacing of the synchronization objects must be a power of two */
+  if (attr->spacing & (attr->spacing - 1) ||
+      (attr->mode != VFTASKS_SYNC_SEMAPHORE && attr->mode != VFTASKS_SYNC_SPIN) ||
+      (attr->mode == VFTASKS_SYNC_SPIN && attr->num_threads < 1) ||
+      attr->spin_limit < 0)
+  {
+    _vftasks_abort_on_fail_sync_2d("vftasks_create_2d_mgr: invalid argument");
+    return NULL;
+  }
+
   /* allocate a manager */
   mgr = (vftasks_2d_sync_mgr_t *)malloc(sizeof(vftasks_2d_sync_mgr_t));
   if (mgr == NULL)
@@ -59,20 +127,55 @@ vftasks_2d_sync_mgr_t *vftasks_create_2d_sync_mgr(int dim_x,
   mgr->dim_y = dim_y;
   mgr->dist_x = dist_x;
   mgr->dist_y = dist_y;
+  mgr->mode = attr->mode;
+  mgr->spin_limit = attr->spin_limit;
+  mgr->num_threads = attr->num_threads;
+  mgr->records = NULL;
 
-  /* allocate the semaphores held by the manager */
-  mgr->sems = (semaphore_t *)malloc(dim_x * sizeof(semaphore_t));
-  if (mgr->sems == NULL)
+  /* allocate the wait records, if profiling is enabled */
+  if (attr->profile)
   {
-    free(mgr);
-    _vftasks_abort_on_fail_sync_2d("vftasks_create_2d_mgr: not enough memory");
-    return NULL;
+    mgr->records = _vftasks_create_wait_records(dim_x);
+    if (mgr->records == NULL)
+    {
+      free(mgr);
+      _vftasks_abort_on_fail_sync_2d("vftasks_create_2d_mgr: not enough memory");
+      return NULL;
+    }
   }
 
-  /* initialize the semaphores */
-  for (x = 0; x < dim_x; ++x)
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
   {
-    SEMAPHORE_CREATE(mgr->sems[x], 0, dim_y);
+    /* the outer iterations whose progress is still needed are those in flight,
+       one per thread, and those they are waiting for */
+    mgr->ring_size = attr->num_threads + abs(dist_x);
+    if (mgr->ring_size > dim_x) mgr->ring_size = dim_x;
+
+    mgr->ring = _vftasks_create_progress(mgr->ring_size, 0);
+    if (mgr->ring == NULL)
+    {
+      if (mgr->records != NULL) _vftasks_destroy_wait_records(mgr->records);
+      free(mgr);
+      _vftasks_abort_on_fail_sync_2d("vftasks_create_2d_mgr: not enough memory");
+      return NULL;
+    }
+
+    /* each counter starts out as if it had been used by a completed outer iteration
+       ring_size iterations before the first one to use it */
+    for (s = 0; s < mgr->ring_size; ++s)
+      mgr->ring[s].count = vftasks_row_count_2d(mgr, s - mgr->ring_size, dim_y);
+  }
+  else
+  {
+    /* allocate and initialize the semaphores held by the manager */
+    mgr->ring = NULL;
+    if (_vftasks_create_sem_array(&mgr->sems, dim_x, attr->spacing, 0, dim_y) != 0)
+    {
+      if (mgr->records != NULL) _vftasks_destroy_wait_records(mgr->records);
+      free(mgr);
+      _vftasks_abort_on_fail_sync_2d("vftasks_create_2d_mgr: not enough memory");
+      return NULL;
+    }
   }
 
   /* return the pointer to the manager */
@@ -83,31 +186,122 @@ vftasks_2d_sync_mgr_t *vftasks_create_2d_sync_mgr(int dim_x,
  */
 void vftasks_destroy_2d_sync_mgr(vftasks_2d_sync_mgr_t *mgr)
 {
-  int x;  /* index */
+  /* destroy and deallocate the synchronization objects held by the manager */
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
+    _vftasks_destroy_progress(mgr->ring);
+  else
+    _vftasks_destroy_sem_array(&mgr->sems);
+
+  if (mgr->records != NULL) _vftasks_destroy_wait_records(mgr->records);
+
+  /* deallocate the manager */
+  free(mgr);
+}
+
+/** reset a 2D-synchronization manager
+ */
+int vftasks_reset_2d_sync_mgr(vftasks_2d_sync_mgr_t *mgr)
+{
+  int s;  /* index */
 
-  /* destroy the semaphores held by the manager */
-  for (x = 0; x < mgr->dim_x; ++x)
+  /* check argument */
+  if (mgr == NULL)
   {
-    SEMAPHORE_DESTROY(mgr->sems[x]);
+    _vftasks_abort_on_fail_sync_2d("vftasks_reset_2d_mgr: invalid argument");
+    return 1;
   }
 
-  /* deallocate the semaphores */
-  free(mgr->sems);
+  /* in semaphore mode, every signal of a completed execution has been waited for,
+     so that all semaphores are back at 0 already */
+  if (mgr->mode != VFTASKS_SYNC_SPIN) return 0;
 
-  /* deallocate the manager */
-  free(mgr);
+  /* restore the ring of progress counters */
+  for (s = 0; s < mgr->ring_size; ++s)
+    ATOMIC_STORE_RELAXED(&mgr->ring[s].count,
+                         vftasks_row_count_2d(mgr, s - mgr->ring_size, mgr->dim_y));
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** publish the number of inner iterations completed by an outer iteration, in spin
+ *  mode
+ */
+static void vftasks_spin_signal_2d(vftasks_2d_sync_mgr_t *mgr, int x, int n)
+{
+  vftasks_progress_t *progress;  /* the outer iteration's progress counter */
+  int64_t count;                 /* the count to publish */
+  int64_t prev;                  /* the count of the outer iteration that used the
+                                    counter before, once completed */
+
+  if (x < 0 || x >= mgr->dim_x) return;
+  if (n > mgr->dim_y) n = mgr->dim_y;
+
+  progress = vftasks_row_progress_2d(mgr, x);
+  count = vftasks_row_count_2d(mgr, x, n);
+
+  /* before taking over its counter, wait for the outer iteration that used it
+     before to complete */
+  if (ATOMIC_LOAD_RELAXED(&progress->count) < vftasks_row_count_2d(mgr, x, 0))
+  {
+    prev = vftasks_row_count_2d(mgr, x - mgr->ring_size, mgr->dim_y);
+
+    /* this is not a dependence, so it is only recorded if it actually waits */
+    if (mgr->records != NULL && ATOMIC_LOAD_ACQUIRE(&progress->count) < prev)
+      _vftasks_record_wait_progress(&mgr->records[x], progress, prev, mgr->spin_limit);
+    else
+      _vftasks_wait_progress(progress, prev, mgr->spin_limit);
+  }
+
+  _vftasks_set_progress(progress, count, mgr->spin_limit);
+}
+
+/** wait in outer iteration x until outer iteration x - dist_x has completed a given
+ *  inner iteration, in spin mode
+ */
+static void vftasks_spin_wait_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y)
+{
+  if (mgr->records != NULL)
+    _vftasks_record_wait_progress(&mgr->records[x],
+                                  vftasks_row_progress_2d(mgr, x - mgr->dist_x),
+                                  vftasks_row_count_2d(mgr, x - mgr->dist_x, y + 1),
+                                  mgr->spin_limit);
+  else
+    _vftasks_wait_progress(vftasks_row_progress_2d(mgr, x - mgr->dist_x),
+                           vftasks_row_count_2d(mgr, x - mgr->dist_x, y + 1),
+                           mgr->spin_limit);
+}
+
+/** take a number of units from the semaphore of outer iteration x - dist_x, in
+ *  outer iteration x, in semaphore mode
+ */
+static int vftasks_sem_wait_2d(vftasks_2d_sync_mgr_t *mgr, int x, int n)
+{
+  semaphore_t *sem = _vftasks_sem_at(&mgr->sems, x - mgr->dist_x);
+
+  if (mgr->records != NULL)
+    return _vftasks_record_sem_wait_n(&mgr->records[x], sem, n);
+
+  return n == 1 ? SEMAPHORE_WAIT(*sem) : SEMAPHORE_WAIT_N(*sem, n);
 }
 
 /** signal end of inner iteration
  */
 int vftasks_signal_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y)
 {
+  /* in spin mode, every inner iteration is recorded */
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
+  {
+    if (y >= 0) vftasks_spin_signal_2d(mgr, x, y + 1);
+    return 0;
+  }
+
   /* check whether it is necessary to signal to another outer iteration */
   if (x >= -mgr->dist_x && x < mgr->dim_x - mgr->dist_x &&
       y >= -mgr->dist_y && y < mgr->dim_y - mgr->dist_y)
   {
     /* signal through the current outer iteration's semaphore; on failure, return 1 */
-    if (SEMAPHORE_POST(mgr->sems[x]) != 0)
+    if (SEMAPHORE_POST(*_vftasks_sem_at(&mgr->sems, x)) != 0)
     {
       _vftasks_abort_on_fail_sync_2d("vftasks_signal_2d");
       return 1;
@@ -118,6 +312,61 @@ int vftasks_signal_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y)
   return 0;
 }
 
+/** the number of indices in [begin, end) that also lie in [lo, hi)
+ */
+static int vftasks_count_in_2d(int begin, int end, int lo, int hi)
+{
+  if (begin < lo) begin = lo;
+  if (end > hi) end = hi;
+
+  return end > begin ? end - begin : 0;
+}
+
+/** signal end of a range of inner iterations
+ */
+int vftasks_signal_2d_range(vftasks_2d_sync_mgr_t *mgr, int x, int y_begin, int y_end)
+{
+  int n;  /* number of inner iterations in the range that are waited for */
+
+  /* check arguments */
+  if (mgr == NULL || y_end < y_begin)
+  {
+    _vftasks_abort_on_fail_sync_2d("vftasks_signal_2d_range: invalid argument");
+    return 1;
+  }
+
+  /* in spin mode, every range is recorded */
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
+  {
+    if (y_end > y_begin && y_end > 0) vftasks_spin_signal_2d(mgr, x, y_end);
+    return 0;
+  }
+
+  /* check whether it is necessary to signal to another outer iteration */
+  if (x < -mgr->dist_x || x >= mgr->dim_x - mgr->dist_x) return 0;
+  n = vftasks_count_in_2d(y_begin, y_end, -mgr->dist_y, mgr->dim_y - mgr->dist_y);
+
+  /* within an outer iteration, iterations in the range do not signal to each other */
+  if (mgr->dist_x == 0)
+    n -= vftasks_count_in_2d(y_begin, y_end,
+                             -mgr->dist_y > y_begin - mgr->dist_y ?
+                             -mgr->dist_y : y_begin - mgr->dist_y,
+                             mgr->dim_y - mgr->dist_y < y_end - mgr->dist_y ?
+                             mgr->dim_y - mgr->dist_y : y_end - mgr->dist_y);
+  if (n == 0) return 0;
+
+  /* signal all at once through the current outer iteration's semaphore; on failure,
+     return 1 */
+  if (SEMAPHORE_POST_N(*_vftasks_sem_at(&mgr->sems, x), n) != 0)
+  {
+    _vftasks_abort_on_fail_sync_2d("vftasks_signal_2d_range");
+    return 1;
+  }
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
 /** synchronize at start of inner iteration
  */
 int vftasks_wait_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y)
@@ -126,8 +375,14 @@ int vftasks_wait_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y)
   if (x >= mgr->dist_x && x < mgr->dim_x + mgr->dist_x &&
       y >= mgr->dist_y && y < mgr->dim_y + mgr->dist_y)
   {
+    if (mgr->mode == VFTASKS_SYNC_SPIN)
+    {
+      vftasks_spin_wait_2d(mgr, x, y - mgr->dist_y);
+      return 0;
+    }
+
     /* wait through the other iteration's semaphore; on failure, return 1 */
-    if (SEMAPHORE_WAIT(mgr->sems[x - mgr->dist_x]) != 0)
+    if (vftasks_sem_wait_2d(mgr, x, 1) != 0)
     {
       _vftasks_abort_on_fail_sync_2d("vftasks_wait_2d");
       return 1;
@@ -137,3 +392,84 @@ int vftasks_wait_2d(vftasks_2d_sync_mgr_t *mgr, int x, int y)
   /* return 0 to indicate success */
   return 0;
 }
+
+/** synchronize at start of a range of inner iterations
+ */
+int vftasks_wait_2d_range(vftasks_2d_sync_mgr_t *mgr, int x, int y_begin, int y_end)
+{
+  int n;  /* number of inner iterations in the range that wait */
+  int y;  /* last inner iteration of the other outer iteration that is waited for */
+
+  /* check arguments */
+  if (mgr == NULL || y_end < y_begin)
+  {
+    _vftasks_abort_on_fail_sync_2d("vftasks_wait_2d_range: invalid argument");
+    return 1;
+  }
+
+  /* check whether it is necessary to wait for another outer iteration */
+  if (x < mgr->dist_x || x >= mgr->dim_x + mgr->dist_x) return 0;
+
+  /* in spin mode, waiting for the last inner iteration that is depended on suffices,
+     as the inner iterations of an outer iteration are completed in order */
+  if (mgr->mode == VFTASKS_SYNC_SPIN)
+  {
+    y = y_end - mgr->dist_y;
+    if (y > mgr->dim_y) y = mgr->dim_y;
+    if (mgr->dist_x == 0 && y > y_begin) y = y_begin;
+    if (y - 1 >= 0 && y - 1 >= y_begin - mgr->dist_y)
+      vftasks_spin_wait_2d(mgr, x, y - 1);
+    return 0;
+  }
+
+  n = vftasks_count_in_2d(y_begin, y_end, mgr->dist_y, mgr->dim_y + mgr->dist_y);
+
+  /* within an outer iteration, iterations in the range do not wait for each other */
+  if (mgr->dist_x == 0)
+    n -= vftasks_count_in_2d(y_begin, y_end,
+                             mgr->dist_y > y_begin + mgr->dist_y ?
+                             mgr->dist_y : y_begin + mgr->dist_y,
+                             mgr->dim_y + mgr->dist_y < y_end + mgr->dist_y ?
+                             mgr->dim_y + mgr->dist_y : y_end + mgr->dist_y);
+  if (n == 0) return 0;
+
+  /* wait for the whole range through the other iteration's semaphore; on failure,
+     return 1 */
+  if (vftasks_sem_wait_2d(mgr, x, n) != 0)
+  {
+    _vftasks_abort_on_fail_sync_2d("vftasks_wait_2d_range");
+    return 1;
+  }
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** get the wait statistics of an outer iteration
+ */
+int vftasks_get_2d_sync_stats(vftasks_2d_sync_mgr_t *mgr,
+                              int x,
+                              vftasks_sync_stats_t *stats)
+{
+  if (mgr == NULL) return 1;
+
+  return _vftasks_get_wait_record(mgr->records, mgr->dim_x, x, stats);
+}
+
+/** export the wait statistics of all outer iterations
+ */
+int vftasks_format_2d_sync_stats(vftasks_2d_sync_mgr_t *mgr,
+                                 int format,
+                                 char *buf,
+                                 size_t size)
+{
+  if (mgr == NULL) return -1;
+
+  return _vftasks_format_wait_records(mgr->records,
+                                      mgr->dim_x,
+                                      "row",
+                                      mgr->num_threads > 0 ? mgr->num_threads : mgr->dim_x,
+                                      format,
+                                      buf,
+                                      size);
+}
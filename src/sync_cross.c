@@ -0,0 +1,229 @@
+#include "vftasks.h"
+#include "sync.h"
+
+#include <stdlib.h>     /* for malloc and free */
+
+/* ***************************************************************************
+ * Synchronization between the iterations of two loops
+ * ***************************************************************************/
+
+/** cross-loop synchronization manager
+ */
+struct vftasks_cross_sync_mgr_s
+{
+  int num_threads;                /* number of threads executing the producing
+                                     loop */
+  int dist;                       /* distance from a consuming iteration to the
+                                     producing iteration it depends on */
+  int num_iterations;             /* number of iterations of the producing loop, or
+                                     0 if unknown */
+  int block_size;                 /* number of consecutive producing iterations
+                                     executed by the same thread */
+  int stride;                     /* number of iterations in a round of blocks */
+  int spin_limit;                 /* number of polls before parking, or 0 */
+  vftasks_progress_t *progress;   /* pointer to an array of num_threads progress
+                                     counters, one per producing thread */
+};
+
+/** the thread that executes a given producing iteration
+ */
+static inline int vftasks_owner_cross(vftasks_cross_sync_mgr_t *mgr, int i)
+{
+  return (i / mgr->block_size) % mgr->num_threads;
+}
+
+/** the position of a given producing iteration among the iterations executed by
+ *  its thread
+ */
+static inline int vftasks_local_index_cross(vftasks_cross_sync_mgr_t *mgr, int i)
+{
+  return (i / mgr->stride) * mgr->block_size + i % mgr->block_size;
+}
+
+/** create a cross-loop synchronization manager
+ */
+vftasks_cross_sync_mgr_t *vftasks_create_cross_sync_mgr(
+  int num_threads,
+  int dist,
+  const vftasks_1d_sync_attr_t *attr)
+{
+  vftasks_cross_sync_mgr_t *mgr;        /* pointer to the manager */
+  vftasks_1d_sync_attr_t default_attr;  /* attributes used if none are given */
+
+  if (attr == NULL)
+  {
+    vftasks_init_1d_sync_attr(&default_attr);
+    attr = &default_attr;
+  }
+
+  /* check arguments */
+  if (num_threads < 1 || attr->spin_limit < 0 || attr->num_iterations < 0 ||
+      (attr->distribution == VFTASKS_DIST_BLOCK_CYCLIC && attr->block_size < 1) ||
+      (attr->distribution == VFTASKS_DIST_BLOCK && attr->num_iterations < 1) ||
+      (attr->distribution != VFTASKS_DIST_CYCLIC &&
+       attr->distribution != VFTASKS_DIST_BLOCK_CYCLIC &&
+       attr->distribution != VFTASKS_DIST_BLOCK))
+  {
+    _vftasks_abort_on_fail("vftasks_create_cross_sync_mgr: invalid argument");
+    return NULL;
+  }
+
+  /* allocate a manager */
+  mgr = (vftasks_cross_sync_mgr_t *)malloc(sizeof(vftasks_cross_sync_mgr_t));
+  if (mgr == NULL)
+  {
+    _vftasks_abort_on_fail("vftasks_create_cross_sync_mgr: not enough memory");
+    return NULL;
+  }
+
+  mgr->num_threads = num_threads;
+  mgr->dist = dist;
+  mgr->num_iterations = attr->num_iterations;
+  mgr->spin_limit = attr->spin_limit;
+
+  /* every distribution is block-cyclic with some block size */
+  switch (attr->distribution)
+  {
+  case VFTASKS_DIST_BLOCK_CYCLIC:
+    mgr->block_size = attr->block_size;
+    break;
+  case VFTASKS_DIST_BLOCK:
+    mgr->block_size = (attr->num_iterations + num_threads - 1) / num_threads;
+    break;
+  default:
+    mgr->block_size = 1;
+  }
+  mgr->stride = mgr->block_size * num_threads;
+
+  /* allocate the progress counters; no thread has completed any iterations yet */
+  mgr->progress = _vftasks_create_progress(num_threads, 0);
+  if (mgr->progress == NULL)
+  {
+    free(mgr);
+    _vftasks_abort_on_fail("vftasks_create_cross_sync_mgr: not enough memory");
+    return NULL;
+  }
+
+  /* return the pointer to the manager */
+  return mgr;
+}
+
+/** destroy a cross-loop synchronization manager
+ */
+void vftasks_destroy_cross_sync_mgr(vftasks_cross_sync_mgr_t *mgr)
+{
+  _vftasks_destroy_progress(mgr->progress);
+  free(mgr);
+}
+
+/** reset a cross-loop synchronization manager
+ */
+int vftasks_reset_cross_sync_mgr(vftasks_cross_sync_mgr_t *mgr)
+{
+  int t;  /* index */
+
+  /* check argument */
+  if (mgr == NULL)
+  {
+    _vftasks_abort_on_fail("vftasks_reset_cross_sync_mgr: invalid argument");
+    return 1;
+  }
+
+  /* no thread has completed any iterations yet */
+  for (t = 0; t < mgr->num_threads; ++t)
+    ATOMIC_STORE_RELAXED(&mgr->progress[t].count, 0);
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** signal completion of a range of producing iterations
+ */
+int vftasks_signal_cross_range(vftasks_cross_sync_mgr_t *mgr, int begin, int end)
+{
+  int b;     /* block size */
+  int i;     /* start of a run of iterations */
+  int next;  /* end of the run */
+
+  /* check arguments */
+  if (mgr == NULL || begin < 0 || end < begin)
+  {
+    _vftasks_abort_on_fail("vftasks_signal_cross_range: invalid argument");
+    return 1;
+  }
+
+  b = mgr->block_size;
+
+  /* publish the progress per run of iterations within a block */
+  for (i = begin; i < end; i = next)
+  {
+    next = (i / b + 1) * b;
+    if (next > end) next = end;
+
+    _vftasks_set_progress(&mgr->progress[vftasks_owner_cross(mgr, i)],
+                          vftasks_local_index_cross(mgr, next - 1) + 1,
+                          mgr->spin_limit);
+  }
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** signal completion of a producing iteration
+ */
+int vftasks_signal_cross(vftasks_cross_sync_mgr_t *mgr, int i)
+{
+  return vftasks_signal_cross_range(mgr, i, i + 1);
+}
+
+/** synchronize a range of consuming iterations with the producing iterations they
+ *  depend on
+ */
+int vftasks_wait_cross_range(vftasks_cross_sync_mgr_t *mgr, int begin, int end)
+{
+  int b;     /* block size */
+  int i;     /* start of a run of producing iterations */
+  int next;  /* end of the run */
+
+  /* check arguments */
+  if (mgr == NULL || end < begin)
+  {
+    _vftasks_abort_on_fail("vftasks_wait_cross_range: invalid argument");
+    return 1;
+  }
+
+  b = mgr->block_size;
+
+  /* the producing iterations that the range depends on, as far as they exist */
+  begin -= mgr->dist;
+  end -= mgr->dist;
+  if (begin < 0) begin = 0;
+  if (mgr->num_iterations > 0 && end > mgr->num_iterations)
+    end = mgr->num_iterations;
+
+  /* an iteration has the same thread as the one a round of blocks later, which is
+     completed after it */
+  if (begin < end - mgr->stride) begin = end - mgr->stride;
+
+  /* per run of iterations within a block, the last one is completed after the
+     others */
+  for (i = begin; i < end; i = next)
+  {
+    next = (i / b + 1) * b;
+    if (next > end) next = end;
+
+    _vftasks_wait_progress(&mgr->progress[vftasks_owner_cross(mgr, i)],
+                           vftasks_local_index_cross(mgr, next - 1) + 1,
+                           mgr->spin_limit);
+  }
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** synchronize a consuming iteration with the producing iteration it depends on
+ */
+int vftasks_wait_cross(vftasks_cross_sync_mgr_t *mgr, int i)
+{
+  return vftasks_wait_cross_range(mgr, i, i + 1);
+}
@@ -0,0 +1,308 @@
+#include "vftasks.h"
+#include "sync.h"
+
+#include <stdlib.h>     /* for malloc, free, and abs */
+
+/* maximum number of steps taken to find out whether a distance vector is
+   implied by others */
+#define MAX_PRUNING_STEPS 1024
+
+/* ***************************************************************************
+ * N-dimensional synchronization between tasks
+ * ***************************************************************************/
+
+/** ND-synchronization manager
+ */
+struct vftasks_nd_sync_mgr_s
+{
+  int num_dims;                  /* dimensionality of the iteration space */
+  int *dims;                     /* iteration-space size along each dimension */
+  int64_t *strides;              /* number of iterations spanned by a step along
+                                    each dimension, within an outer iteration */
+  int num_dists;                 /* number of distance vectors that are waited for */
+  int *dists;                    /* num_dists distance vectors of num_dims
+                                    components each */
+  int64_t size;                  /* number of iterations within an outer
+                                    iteration */
+  int64_t base;                  /* count of the progress counters at the start of
+                                    the current execution */
+  vftasks_progress_t *progress;  /* array of dims[0] progress counters, holding base
+                                    plus the number of completed inner iterations
+                                    of each outer iteration */
+};
+
+/** check whether distance vector a reaches back at least one outer iteration and no
+ *  further than distance vector b, along every dimension: then the source of a lies
+ *  in the iteration space whenever that of b does, and b - a is a distance from the
+ *  source of a to that of b
+ */
+static int vftasks_within_nd(const int *a, const int *b, int num_dims)
+{
+  int k;  /* index */
+
+  if (a[0] < 1 || a[0] > b[0]) return 0;
+
+  for (k = 1; k < num_dims; ++k)
+    if (b[k] >= 0 ? a[k] < 0 || a[k] > b[k] : a[k] > 0 || a[k] < b[k]) return 0;
+
+  return 1;
+}
+
+/** check whether a dependency at distance vector c is satisfied by the order of
+ *  execution and by the dependencies at the distance vectors in dists: the source
+ *  lies in the same outer iteration, before the dependent iteration, or a source of
+ *  one of the vectors, which is completed first, depends on it in turn; c is
+ *  restored on return, and the search gives up, conservatively, once the budget
+ *  of steps is exhausted
+ */
+static int vftasks_implied_nd(int *c,
+                              const int *dists,
+                              int num_dists,
+                              int num_dims,
+                              int *budget)
+{
+  const int *a;  /* distance vector */
+  int implied;   /* nonzero if the dependency is satisfied */
+  int j, k;      /* indices */
+
+  if (c[0] == 0)
+  {
+    for (k = 1; k < num_dims && c[k] == 0; ++k);
+    return k == num_dims || c[k] > 0;
+  }
+
+  if (--*budget < 0) return 0;
+
+  for (j = 0; j < num_dists; ++j)
+  {
+    a = &dists[j * num_dims];
+    if (!vftasks_within_nd(a, c, num_dims)) continue;
+
+    for (k = 0; k < num_dims; ++k) c[k] -= a[k];
+    implied = vftasks_implied_nd(c, dists, num_dists, num_dims, budget);
+    for (k = 0; k < num_dims; ++k) c[k] += a[k];
+
+    if (implied) return 1;
+  }
+
+  return 0;
+}
+
+/** create an ND-synchronization manager
+ */
+vftasks_nd_sync_mgr_t *vftasks_create_nd_sync_mgr(int num_dims,
+                                                  const int *dims,
+                                                  int num_dists,
+                                                  const int *dists)
+{
+  vftasks_nd_sync_mgr_t *mgr;  /* pointer to the manager */
+  const int *v, *w;            /* distance vectors */
+  int *rest;                   /* distance from the source of w to that of v */
+  int budget;                  /* number of steps left to prune v */
+  int i, j, k;                 /* indices */
+
+  /* check arguments */
+  if (num_dims < 1 || dims == NULL || num_dists < 0 ||
+      (num_dists > 0 && dists == NULL))
+  {
+    _vftasks_abort_on_fail("vftasks_create_nd_sync_mgr: invalid argument");
+    return NULL;
+  }
+
+  for (k = 0; k < num_dims; ++k)
+    if (dims[k] < 1)
+    {
+      _vftasks_abort_on_fail("vftasks_create_nd_sync_mgr: invalid argument");
+      return NULL;
+    }
+
+  for (i = 0; i < num_dists; ++i)
+  {
+    v = &dists[i * num_dims];
+
+    for (k = 0; k < num_dims; ++k)
+      if (abs(v[k]) >= dims[k])
+      {
+        _vftasks_abort_on_fail("vftasks_create_nd_sync_mgr: "
+                               "distance larger than dimension");
+        return NULL;
+      }
+
+    /* within an outer iteration, an iteration can only depend on earlier ones */
+    if (v[0] == 0)
+    {
+      for (k = 1; k < num_dims && v[k] == 0; ++k);
+      if (k == num_dims || v[k] < 0)
+      {
+        _vftasks_abort_on_fail("vftasks_create_nd_sync_mgr: invalid distance");
+        return NULL;
+      }
+    }
+  }
+
+  /* allocate a manager */
+  mgr = (vftasks_nd_sync_mgr_t *)malloc(sizeof(vftasks_nd_sync_mgr_t));
+  if (mgr == NULL)
+  {
+    _vftasks_abort_on_fail("vftasks_create_nd_sync_mgr: not enough memory");
+    return NULL;
+  }
+
+  mgr->num_dims = num_dims;
+  mgr->dims = (int *)malloc(num_dims * sizeof(int));
+  mgr->strides = (int64_t *)malloc(num_dims * sizeof(int64_t));
+  mgr->dists = (int *)malloc((num_dists > 0 ? num_dists : 1) * num_dims * sizeof(int));
+  mgr->progress = _vftasks_create_progress(dims[0], 0);
+  rest = (int *)malloc(num_dims * sizeof(int));
+  if (mgr->dims == NULL || mgr->strides == NULL || mgr->dists == NULL ||
+      mgr->progress == NULL || rest == NULL)
+  {
+    free(rest);
+    free(mgr->dims);
+    free(mgr->strides);
+    free(mgr->dists);
+    if (mgr->progress != NULL) _vftasks_destroy_progress(mgr->progress);
+    free(mgr);
+    _vftasks_abort_on_fail("vftasks_create_nd_sync_mgr: not enough memory");
+    return NULL;
+  }
+
+  /* the inner iterations of an outer iteration are numbered in execution order */
+  for (k = 0; k < num_dims; ++k) mgr->dims[k] = dims[k];
+  mgr->strides[num_dims - 1] = 1;
+  for (k = num_dims - 1; k > 1; --k)
+    mgr->strides[k - 1] = mgr->strides[k] * dims[k];
+  mgr->size = num_dims > 1 ? mgr->strides[1] * dims[1] : 1;
+  mgr->strides[0] = 0;
+  mgr->base = 0;
+
+  /* keep the distance vectors that are not satisfied by the order of execution or
+     by waiting for other vectors, possibly through a chain of sources; of equal
+     vectors, the first is kept.  A vector is only implied through vectors that
+     are smaller, or equal and earlier, so pruning never relies on a vector that
+     is pruned in turn because of it */
+  mgr->num_dists = 0;
+  for (i = 0; i < num_dists; ++i)
+  {
+    v = &dists[i * num_dims];
+    if (v[0] == 0) continue;
+
+    budget = MAX_PRUNING_STEPS;
+    for (j = 0; j < num_dists; ++j)
+    {
+      w = &dists[j * num_dims];
+      if (j == i || !vftasks_within_nd(w, v, num_dims) ||
+          (j > i && vftasks_within_nd(v, w, num_dims)))
+        continue;
+
+      for (k = 0; k < num_dims; ++k) rest[k] = v[k] - w[k];
+      if (vftasks_implied_nd(rest, dists, num_dists, num_dims, &budget)) break;
+    }
+
+    if (j == num_dists)
+    {
+      for (k = 0; k < num_dims; ++k)
+        mgr->dists[mgr->num_dists * num_dims + k] = v[k];
+      ++mgr->num_dists;
+    }
+  }
+
+  free(rest);
+
+  /* return the pointer to the manager */
+  return mgr;
+}
+
+/** destroy an ND-synchronization manager
+ */
+void vftasks_destroy_nd_sync_mgr(vftasks_nd_sync_mgr_t *mgr)
+{
+  _vftasks_destroy_progress(mgr->progress);
+  free(mgr->dists);
+  free(mgr->strides);
+  free(mgr->dims);
+  free(mgr);
+}
+
+/** get the number of distance vectors that are waited for
+ */
+int vftasks_get_nd_sync_num_waits(vftasks_nd_sync_mgr_t *mgr)
+{
+  return mgr->num_dists;
+}
+
+/** reset an ND-synchronization manager
+ */
+int vftasks_reset_nd_sync_mgr(vftasks_nd_sync_mgr_t *mgr)
+{
+  /* check argument */
+  if (mgr == NULL)
+  {
+    _vftasks_abort_on_fail("vftasks_reset_nd_sync_mgr: invalid argument");
+    return 1;
+  }
+
+  /* rather than clearing all progress counters, count on from where a completed
+     outer iteration leaves its counter */
+  mgr->base += mgr->size;
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** signal end of iteration
+ */
+int vftasks_signal_nd(vftasks_nd_sync_mgr_t *mgr, const int *index)
+{
+  int64_t position;  /* position of the iteration within its outer iteration */
+  int k;             /* index */
+
+  /* iterations outside the iteration space are not waited for */
+  position = 0;
+  for (k = 0; k < mgr->num_dims; ++k)
+  {
+    if (index[k] < 0 || index[k] >= mgr->dims[k]) return 0;
+    position += index[k] * mgr->strides[k];
+  }
+
+  /* publish the progress of the outer iteration */
+  _vftasks_set_progress(&mgr->progress[index[0]],
+                        mgr->base + position + 1,
+                        VFTASKS_SYNC_SPIN_LIMIT);
+
+  /* return 0 to indicate success */
+  return 0;
+}
+
+/** synchronize at start of iteration
+ */
+int vftasks_wait_nd(vftasks_nd_sync_mgr_t *mgr, const int *index)
+{
+  const int *v;      /* distance vector */
+  int64_t position;  /* position of the source iteration within its outer
+                        iteration */
+  int source;        /* coordinate of the source iteration */
+  int i, k;          /* indices */
+
+  for (i = 0; i < mgr->num_dists; ++i)
+  {
+    v = &mgr->dists[i * mgr->num_dims];
+
+    /* only sources inside the iteration space are waited for */
+    position = 0;
+    for (k = 0; k < mgr->num_dims; ++k)
+    {
+      source = index[k] - v[k];
+      if (source < 0 || source >= mgr->dims[k]) break;
+      position += source * mgr->strides[k];
+    }
+
+    if (k == mgr->num_dims)
+      _vftasks_wait_progress(&mgr->progress[index[0] - v[0]],
+                             mgr->base + position + 1,
+                             VFTASKS_SYNC_SPIN_LIMIT);
+  }
+
+  /* return 0 to indicate success */
+  return 0;
+}
@@ -1,12 +1,29 @@
+#ifdef __linux__
+#define _GNU_SOURCE     /* for pthread_setname_np */
+#endif
+
 #include "vftasks.h"
 #include "platform.h"
+#include "arena.h"
+#include "timer_wheel.h"
 
 #include <stdlib.h>     /* for malloc, free, and abort */
 #include <stdio.h>      /* for printing to stderr */
+#include <string.h>     /* for memset, strlen, strncpy, and strcat */
+
+/* Alignment of the worker records; two cache lines, so that the adjacent-line
+   prefetcher does not couple neighbouring workers (in order to avoid false sharing) */
+#define WORKER_ALIGNMENT (2 * CACHE_LINE_SIZE)
+
+/* Maximum length of a thread name, including the terminating null character */
+#define MAX_THREAD_NAME_LENGTH 16
 
-/* Used in structures to enforce entries falling into different cache
-   lines (in order to avoid false sharing) */
-#define MAX_CACHE_LINE_SIZE 256
+/* Number of task functions for which a chunk keeps execution-time profiles */
+#define NUM_PROFILES 8
+
+/* Number of executions of a task function that are measured before the function
+   can be considered for inline execution */
+#define MIN_PROFILE_SAMPLES 4
 
 /* ***************************************************************************
  * Types
@@ -14,26 +31,38 @@
 
 /* forward declaration */
 
-/* vftasks_worker_t is volatile because associated variables can be modified from
-   multiple threads; the nonvolatile version of the structure is provided to keep
-   pthread and libc library functions happy
+/* fields of vftasks_worker_t that are shared between threads are accessed through
+   the ATOMIC_* operations of the platform layer
+ */
+typedef struct vftasks_worker_s vftasks_worker_t;
+
+/** execution-time profile of a task function
  */
-typedef volatile struct vftasks_worker_s vftasks_worker_t;
-typedef struct vftasks_worker_s vftasks_nv_worker_t;
+typedef struct vftasks_profile_s
+{
+  vftasks_task_t *task;  /* the task function */
+  int64_t avg_ns;        /* running average of the execution time */
+  int num_samples;       /* number of measured executions, saturating */
+} vftasks_profile_t;
 
-/** zero or more workers in the pool
+/** zero or more workers in the pool; a chunk is owned by a single thread, so chunks
+ *  are aligned to cache lines to keep the bookkeeping of different threads apart
  */
-typedef struct vftasks_chunk_s
+typedef struct ALIGNED(CACHE_LINE_SIZE) vftasks_chunk_s
 {
   vftasks_worker_t *base;   /* pointer to the first worker in the chunk */
   vftasks_worker_t *limit;  /* pointer to the first byte beyond the last worker in the
                                chunk */
   vftasks_worker_t *next;   /* pointer to the next available worker in the chunk */
+  unsigned long num_submitted;  /* number of tasks submitted through the chunk */
+  unsigned long num_inlined;    /* number of those that were executed inline */
+  vftasks_profile_t profiles[NUM_PROFILES];  /* profiles of recently submitted task
+                                                functions */
 } vftasks_chunk_t;
 
-/** worker
+/** worker; records are aligned so that each worker occupies its own cache lines
  */
-struct vftasks_worker_s
+struct ALIGNED(WORKER_ALIGNMENT) vftasks_worker_s
 {
   /* WARNING: This structure has a very specific layout to enhance cache utilization
      and avoid false sharing, think twice before changing it. */
@@ -41,41 +70,74 @@ struct vftasks_worker_s
      improve cache utilization when spinning */
   int is_active;           /* 0 if inactive, nonzero otherwise */
   int busy_wait;           /* the worker should spin or wait on a semaphore */
-  vftasks_task_t *task;    /* task to be executed */
+  vftasks_task_t *task;    /* task to be executed; storing it hands the task, with
+                              its arguments, over to the worker (release), and
+                              clearing it hands the results back (release) */
+  int state;               /* VFTASKS_WORKER_PARKED, _SPINNING or _BUSY; only
+                              written by the worker itself, so that monitoring
+                              threads can read it without synchronization */
+  int with_arena;          /* nonzero if the task is arena_task */
+  int measure;             /* nonzero if the worker measures the tasks it executes */
+  int timekeeper;          /* nonzero if the worker sleeps until the next timer
+                              expires, rather than until work is submitted */
+  uint64_t duration;       /* execution time of the most recent task, if measured */
   thread_t thread;         /* pointer to a handle for the thread on which the
                               worker is running */
   tls_key_t key;           /* the TLS-key of the containing pool */
 
   void *args;              /* task arguments */
+  vftasks_arena_task_t *arena_task;  /* task to be executed, if with_arena is
+                                        nonzero; task is then vftasks_arena_marker */
   vftasks_chunk_t *chunk;  /* pointer to a chunk of subsidiary workers */
+  vftasks_timer_wheel_t *timers;  /* the timers of the containing pool */
+  vftasks_chunk_t *timer_chunk;   /* empty chunk that is installed while timed tasks
+                                     are executed */
+  int wake_pending;               /* nonzero while a unit posted to timer_sem has
+                                     not been taken by the timekeeper yet */
+
+  /* the following are only accessed by the thread that submitted to the worker */
+  vftasks_task_t *submitted;  /* the most recently submitted task */
+  int inlined;                /* nonzero if the submitted task was executed inline */
+
   semaphore_t submit_sem;  /* wait for work semaphore used when busy_wait is 0 */
   semaphore_t get_sem;     /* wait for join semaphore used when busy_wait is 0 */
-
-  /* Avoid false sharing between different tasks */
-  char padding[MAX_CACHE_LINE_SIZE];
+  semaphore_t timer_sem;   /* semaphore on which the timekeeper waits instead of
+                              submit_sem, when busy_wait is 0 */
+  vftasks_arena_t arena;   /* scratch memory for the tasks executed by the worker */
 };
 
 /** worker-thread pool
  */
 struct vftasks_pool_s
 {
-  tls_key_t key; /* TLS-key for the pool */
+  tls_key_t key;           /* TLS-key for the pool */
+  vftasks_chunk_t *chunk;  /* chunk containing all the workers in the pool */
+  size_t worker_memory;    /* bytes allocated for the pool and its workers */
+  size_t stack_memory;     /* bytes reserved for the stacks of the workers */
+  uint64_t coalesce_ns;    /* tasks shorter than this are executed inline; 0 if tasks
+                              are always dispatched */
+  vftasks_timer_wheel_t timers;  /* timed tasks, serviced by the workers */
 };
 
-#define WORKER_WAIT(WORKER)                                \
-  if ((WORKER)->busy_wait)                                 \
-    while ((WORKER)->is_active && (WORKER)->task == NULL); \
-  else                                                     \
+#define WORKER_WAIT(WORKER)                                   \
+  if ((WORKER)->busy_wait)                                    \
+    while (ATOMIC_LOAD_ACQUIRE(&(WORKER)->is_active) &&       \
+           ATOMIC_LOAD_ACQUIRE(&(WORKER)->task) == NULL)      \
+      CPU_PAUSE();                                            \
+  else                                                        \
     SEMAPHORE_WAIT((WORKER)->submit_sem)
 
-#define CALLER_WAIT(WORKER)                                \
-  if ((WORKER)->busy_wait)                                 \
-    while (worker->task != NULL);                          \
-  else                                                     \
+#define CALLER_WAIT(WORKER)                                   \
+  if ((WORKER)->busy_wait)                                    \
+    while (ATOMIC_LOAD_ACQUIRE(&(WORKER)->task) != NULL)      \
+      CPU_PAUSE();                                            \
+  else                                                        \
     SEMAPHORE_WAIT((WORKER)->get_sem)
 
 #define WORKER_SIGNAL(WORKER)                   \
-  if (!(WORKER)->busy_wait)                     \
+  if ((WORKER)->timekeeper)                     \
+    vftasks_wake_timekeeper(WORKER);            \
+  else if (!(WORKER)->busy_wait)                \
     SEMAPHORE_POST((WORKER)->submit_sem)
 
 #define CALLER_SIGNAL(WORKER)                   \
@@ -96,40 +158,192 @@ static void abort_on_fail(char *msg)
 #endif
 }
 
+/** stand-in for a task that takes an arena, in the task field of a worker, which is
+ *  set to hand a task over; never executed
+ */
+static void vftasks_arena_marker(void *args)
+{
+  /* workers execute arena_task instead */
+  (void)args;
+}
+
+/* ***************************************************************************
+ * Task profiles
+ * ***************************************************************************/
+
+/** retrieve the profile of a task function from a chunk
+ */
+static inline vftasks_profile_t *vftasks_get_profile(vftasks_chunk_t *chunk,
+                                                     vftasks_task_t *task)
+{
+  vftasks_profile_t *profile;  /* pointer to the profile */
+
+  /* profiles are direct mapped on the address of the function */
+  profile = &chunk->profiles[((size_t)task >> 4) % NUM_PROFILES];
+
+  /* on a conflict, evict the profile of the other function */
+  if (profile->task != task)
+  {
+    profile->task = task;
+    profile->avg_ns = 0;
+    profile->num_samples = 0;
+  }
+
+  return profile;
+}
+
+/** add a measured execution time to a profile
+ */
+static inline void vftasks_update_profile(vftasks_profile_t *profile,
+                                          uint64_t duration)
+{
+  if (profile->num_samples == 0)
+    profile->avg_ns = (int64_t)duration;
+  else
+    profile->avg_ns += ((int64_t)duration - profile->avg_ns) / 8;
+
+  if (profile->num_samples < MIN_PROFILE_SAMPLES) profile->num_samples++;
+}
+
 /* ***************************************************************************
  * Workers
  * ***************************************************************************/
 
+/** wait until work is submitted to the timekeeper or a timer expires
+ */
+static inline void vftasks_timekeeper_wait(vftasks_worker_t *worker)
+{
+  uint64_t timeout;  /* the time until the next timer expires */
+
+  if (worker->busy_wait)
+  {
+    while (ATOMIC_LOAD_ACQUIRE(&worker->is_active) &&
+           ATOMIC_LOAD_ACQUIRE(&worker->task) == NULL &&
+           !_vftasks_timer_wheel_expired(worker->timers))
+      CPU_PAUSE();
+  }
+  else
+  {
+    timeout = _vftasks_timer_wheel_timeout(worker->timers);
+    if (timeout == TIMER_WHEEL_NO_TIMEOUT)
+      SEMAPHORE_WAIT(worker->timer_sem);
+    else if (timeout > 0)
+      SEMAPHORE_TIMEDWAIT(worker->timer_sem, timeout);
+
+    /* accept the next wake-up before the task and the deadline are rechecked; pairs
+       with the fence in vftasks_wake_timekeeper (a unit that is left over from a
+       wait that timed out only causes a spurious recheck) */
+    ATOMIC_STORE_RELAXED(&worker->wake_pending, 0);
+    ATOMIC_FENCE();
+  }
+}
+
+/** wake up the timekeeper, as it has been submitted a task, is finalized, or the
+ *  next timer expires earlier than it expected
+ */
+static void vftasks_wake_timekeeper(void *arg)
+{
+  vftasks_worker_t *worker;  /* pointer to the timekeeper */
+  int pending;               /* expected value of the wake-up flag */
+
+  worker = (vftasks_worker_t *)arg;
+
+  /* a busy-waiting timekeeper polls the deadline itself */
+  if (worker->busy_wait) return;
+
+  /* order the caller's update of the task or the deadline before the check for an
+     outstanding wake-up, so that either the timekeeper sees the update or this
+     thread posts a unit */
+  ATOMIC_FENCE();
+
+  /* at most one unit is outstanding at a time; the timekeeper rechecks both its
+     task and the deadline after taking it, so units never stand for submissions */
+  pending = 0;
+  if (ATOMIC_CAS(&worker->wake_pending, pending, 1))
+    SEMAPHORE_POST(worker->timer_sem);
+}
+
 /** loop executed by a worker thread
  */
 static WORKER_PROTO(vftasks_worker_loop, arg)
 {
   vftasks_worker_t *worker;  /* pointer to the worker */
+  vftasks_arena_t *arena;    /* pointer to the worker's scratch arena */
+  vftasks_task_t *task;      /* the task assigned to the worker */
 
   /* retrieve the worker pointer */
   worker = (vftasks_worker_t *)arg;
 
+  /* retrieve the scratch arena, which is only ever touched from this thread */
+  arena = &worker->arena;
+
   /* store the pointer to the chunk of subsidiary workers in TLS */
   TLS_SET(worker->key, worker->chunk);
 
-  /* worker->is_active is volatile and updated from another thread */
-  while (worker->is_active)
+  /* worker->is_active is updated from another thread */
+  while (ATOMIC_LOAD_ACQUIRE(&worker->is_active))
   {
+    /* publish whether the worker is about to spin or block */
+    ATOMIC_STORE_RELAXED(&worker->state, worker->busy_wait ?
+                                         VFTASKS_WORKER_SPINNING :
+                                         VFTASKS_WORKER_PARKED);
+
     /* wait for work to be submitted */
-    WORKER_WAIT(worker);
+    if (worker->timekeeper)
+    {
+      vftasks_timekeeper_wait(worker);
+    }
+    else
+    {
+      WORKER_WAIT(worker);
+    }
 
-    /* check whether the worker is still active */
-    if (worker->is_active)
+    /* check whether the worker is still active and has been assigned a task; the
+       timekeeper also wakes up when a timer expires */
+    task = ATOMIC_LOAD_ACQUIRE(&worker->task);
+    if (ATOMIC_LOAD_ACQUIRE(&worker->is_active) && task != NULL)
     {
+      uint64_t start;  /* start time of the task */
+
+      ATOMIC_STORE_RELAXED(&worker->state, VFTASKS_WORKER_BUSY);
+
+      if (worker->measure) vftasks_timer_start(&start);
+
       /* execute the assigned task */
-      worker->task(worker->args);
+      if (worker->with_arena)
+      {
+        worker->arena_task(worker->args, arena);
 
-      /* forget about the executed task */
-      worker->task = NULL;
+        /* release the scratch memory used by the task */
+        if (!arena->persistent) vftasks_reset_arena(arena);
+      }
+      else
+      {
+        task(worker->args);
+      }
+
+      if (worker->measure) worker->duration = vftasks_timer_stop(&start);
+
+      /* forget about the executed task, publishing its results */
+      ATOMIC_STORE_RELEASE(&worker->task, NULL);
 
       /* notify caller that current work has finished */
       CALLER_SIGNAL(worker);
     }
+
+    /* execute the timed tasks that have expired; only the timekeeper waits for
+       another worker that is already doing so */
+    if (ATOMIC_LOAD_ACQUIRE(&worker->is_active) &&
+        (worker->timekeeper || _vftasks_timer_wheel_expired(worker->timers)))
+    {
+      ATOMIC_STORE_RELAXED(&worker->state, VFTASKS_WORKER_BUSY);
+
+      /* the subsidiary workers of the worker belong to the thread that submitted
+         to it again, which may hand them out meanwhile; timed tasks get none */
+      TLS_SET(worker->key, worker->timer_chunk);
+      _vftasks_timer_wheel_service(worker->timers, worker->timekeeper);
+      TLS_SET(worker->key, worker->chunk);
+    }
   }
 
   /* worker is deactivated, so return */
@@ -164,6 +378,13 @@ static inline int vftasks_initialize_sync(vftasks_worker_t *worker)
       abort_on_fail("vftasks_create_pool: get semaphore creation failed");
       return 1;
     }
+    if (worker->timekeeper && (SEMAPHORE_CREATE(worker->timer_sem, 0, 1)) != 0)
+    {
+      SEMAPHORE_DESTROY(worker->submit_sem);
+      SEMAPHORE_DESTROY(worker->get_sem);
+      abort_on_fail("vftasks_create_pool: timer semaphore creation failed");
+      return 1;
+    }
   }
 
   return 0;
@@ -175,28 +396,47 @@ static inline void vftasks_destroy_sync(vftasks_worker_t *worker)
   {
     SEMAPHORE_DESTROY(worker->submit_sem);
     SEMAPHORE_DESTROY(worker->get_sem);
+    if (worker->timekeeper) SEMAPHORE_DESTROY(worker->timer_sem);
   }
 }
 
 /** initialize worker
  */
 static inline int vftasks_initialize_worker(vftasks_worker_t *worker,
+                                            vftasks_chunk_t *chunk,
                                             int busy_wait,
-                                            tls_key_t key)
+                                            tls_key_t key,
+                                            vftasks_timer_wheel_t *timers,
+                                            vftasks_chunk_t *timer_chunk,
+                                            int timekeeper,
+                                            const vftasks_pool_attr_t *attr)
 {
   /* store the TLS-key for the containing pool */
   worker->key = key;
 
-  /* allocate a chunk of subsidiary workers */
-  worker->chunk = (vftasks_chunk_t *)malloc(sizeof(vftasks_chunk_t));
-  if (worker->chunk == NULL)
-  {
-    abort_on_fail("vftasks_create_pool: thread chunk allocation failed");
-    return 1;
-  }
+  /* store the chunk of subsidiary workers */
+  worker->chunk = chunk;
+
+  /* timers are serviced by all workers, but only the timekeeper waits for them */
+  worker->timers = timers;
+  worker->timer_chunk = timer_chunk;
+  worker->timekeeper = timekeeper;
+  worker->wake_pending = 0;
 
   /* initially the worker does not have a task assigned */
   worker->task = NULL;
+  worker->state = VFTASKS_WORKER_PARKED;
+  worker->with_arena = 0;
+  worker->arena_task = NULL;
+  worker->submitted = NULL;
+  worker->inlined = 0;
+
+  /* only measure tasks if the pool may execute them inline */
+  worker->measure = attr->coalesce_ns > 0;
+  worker->duration = 0;
+
+  /* blocks are only reserved once the worker allocates from its arena */
+  _vftasks_arena_init(&worker->arena, attr->arena_block_size);
 
   /* activate the worker and have it running on a freshly forked thread */
   worker->is_active = 1;
@@ -205,16 +445,16 @@ static inline int vftasks_initialize_worker(vftasks_worker_t *worker,
 
   if (vftasks_initialize_sync(worker) != 0)
   {
-    free(worker->chunk);
     abort_on_fail("vftasks_create_pool: semaphore creation failed");
     return 1;
   }
 
-  if (THREAD_CREATE(worker->thread,
-                    vftasks_worker_loop,
-                    (vftasks_nv_worker_t *) worker) != 0)
+  if (THREAD_CREATE_WITH_ATTR(worker->thread,
+                              vftasks_worker_loop,
+                              worker,
+                              attr->stack_size,
+                              attr->guard_size) != 0)
   {
-    free(worker->chunk);
     vftasks_destroy_sync(worker);
     abort_on_fail("vftasks_create_pool: thread creation failed");
     return 1;
@@ -229,47 +469,94 @@ static inline int vftasks_initialize_worker(vftasks_worker_t *worker,
 static inline void vftasks_finalize_worker(vftasks_worker_t *worker)
 {
   /* deactivate the worker and join with the thread it is running on */
-  worker->is_active = 0;
+  ATOMIC_STORE_RELEASE(&worker->is_active, 0);
 
   /* make sure the worker is not in wait state before joining */
   WORKER_SIGNAL(worker);
   THREAD_JOIN(worker->thread);
   vftasks_destroy_sync(worker);
 
-  /* deallocate the chunk of subsidiary workers */
-  free(worker->chunk);
+  /* release the scratch memory of the worker */
+  _vftasks_arena_destroy(&worker->arena);
+}
+
+/** determine the size of the block that holds a given number of workers
+ */
+static inline size_t vftasks_workers_size(int num_workers)
+{
+  /* the workers come first, followed by the chunk of the pool, the subsidiary
+     chunks of the workers, and the empty chunk for timed tasks */
+  return num_workers * sizeof(vftasks_worker_t) +
+         (num_workers + 2) * sizeof(vftasks_chunk_t);
 }
 
-/** create and activate a chunk of workers of a given size
+/** name the thread of a worker after the pool and the worker's index
+ */
+static inline void vftasks_name_worker(vftasks_worker_t *worker,
+                                       const char *name,
+                                       int index)
+{
+  char thread_name[MAX_THREAD_NAME_LENGTH];  /* the name of the thread */
+  char suffix[MAX_THREAD_NAME_LENGTH];       /* the index as a string */
+  int prefix_length;                         /* the length of the name prefix */
+
+  /* truncate the name, so that the index always fits */
+  snprintf(suffix, sizeof(suffix), "-%d", index);
+  prefix_length = MAX_THREAD_NAME_LENGTH - 1 - (int)strlen(suffix);
+  strncpy(thread_name, name, prefix_length);
+  thread_name[prefix_length] = '\0';
+  strcat(thread_name, suffix);
+
+  /* naming is a debugging aid only, so failures are ignored */
+  (void)THREAD_SET_NAME(worker->thread, thread_name);
+}
+
+/** create and activate a chunk of workers of a given size; all workers and chunks are
+ *  allocated from a single, aligned block of memory
  */
 static inline vftasks_chunk_t *vftasks_create_workers(int num_workers,
                                                       tls_key_t key,
-                                                      int busy_wait)
+                                                      int busy_wait,
+                                                      vftasks_timer_wheel_t *timers,
+                                                      const vftasks_pool_attr_t *attr)
 {
+  char *block;                         /* memory for the workers and chunks */
   vftasks_chunk_t *chunk;              /* pointer to the chunk of workers */
+  vftasks_chunk_t *subchunk;           /* pointer to a subsidiary chunk */
+  vftasks_chunk_t *timer_chunk;        /* pointer to the empty chunk */
   vftasks_worker_t *worker, *worker_;  /* pointers to workers in the chunk */
 
   if (num_workers <= 0) return NULL;
 
-  /* allocate the chunk */
-  chunk = (vftasks_chunk_t *)malloc(sizeof(vftasks_chunk_t));
-  if (chunk == NULL) return NULL;
-
-  /* allocate the workers */
-  chunk->base = (vftasks_worker_t *) malloc(num_workers * sizeof(vftasks_worker_t));
-  if (chunk->base == NULL)
+  /* allocate the workers and chunks */
+  if (ALIGNED_MALLOC(block, WORKER_ALIGNMENT, vftasks_workers_size(num_workers)) != 0)
   {
-    free(chunk);
     abort_on_fail("vftasks_create_pool: not enough memory");
     return NULL;
   }
+  memset(block, 0, vftasks_workers_size(num_workers));
+
+  /* the chunk containing all the workers directly follows the workers */
+  chunk = (vftasks_chunk_t *)(block + num_workers * sizeof(vftasks_worker_t));
+  chunk->base = (vftasks_worker_t *)block;
   chunk->limit = chunk->base + num_workers;
   chunk->next = chunk->base;
 
+  /* the empty chunk comes last; it never has a worker available */
+  timer_chunk = chunk + 1 + num_workers;
+  timer_chunk->base = chunk->limit;
+  timer_chunk->limit = chunk->limit;
+  timer_chunk->next = chunk->limit;
+
   /* initialize the workers */
-  for (worker = chunk->base; worker < chunk->limit; ++worker)
+  for (worker = chunk->base, subchunk = chunk + 1;
+       worker < chunk->limit;
+       ++worker, ++subchunk)
   {
-    if (vftasks_initialize_worker(worker, busy_wait, key) != 0)
+    /* the last worker is the least likely to be handed tasks, so it keeps time */
+    if (vftasks_initialize_worker(worker, subchunk, busy_wait, key, timers,
+                                  timer_chunk, worker == chunk->limit - 1,
+                                  attr) != 0)
     {
       /* no get calls have been done at this point so the workers are only waiting
        * on their internal semaphore, which is released by finalize itself.
@@ -278,11 +565,13 @@ static inline vftasks_chunk_t *vftasks_create_workers(int num_workers,
       {
         vftasks_finalize_worker(worker_);
       }
-      free((vftasks_nv_worker_t *)chunk->base);
-      free(chunk);
+      ALIGNED_FREE(block);
       abort_on_fail("vftasks_create_pool: worker initialization failed");
       return NULL;
     }
+
+    if (attr->name != NULL)
+      vftasks_name_worker(worker, attr->name, worker - chunk->base);
   }
 
   /* return the chunk */
@@ -301,20 +590,46 @@ static void vftasks_destroy_workers(vftasks_chunk_t *chunk)
     vftasks_finalize_worker(worker);
   }
 
-  /* deallocate the workers */
-  free((vftasks_nv_worker_t *)chunk->base);
+  /* deallocate the workers and chunks, which start at the first worker */
+  ALIGNED_FREE(chunk->base);
+}
 
-  /* deallocate the chunk pointer */
-  free(chunk);
+/** initialize pool attributes
+ */
+void vftasks_init_pool_attr(vftasks_pool_attr_t *attr)
+{
+  attr->stack_size = 0;
+  attr->guard_size = 0;
+  attr->name = NULL;
+  attr->arena_block_size = VFTASKS_ARENA_BLOCK_SIZE;
+  attr->coalesce_ns = 0;
+  attr->timer_tick_ns = VFTASKS_TIMER_TICK_NS;
 }
 
 /** create pool
  */
 vftasks_pool_t *vftasks_create_pool(int num_workers, int busy_wait)
 {
-  vftasks_pool_t *pool;    /* pointer to the pool */
-  tls_key_t key;           /* TLS-key for the pool pointer */
-  vftasks_chunk_t *chunk;  /* pointer to a chunk containing all the workers */
+  return vftasks_create_pool_with_attr(num_workers, busy_wait, NULL);
+}
+
+/** create pool with attributes
+ */
+vftasks_pool_t *vftasks_create_pool_with_attr(int num_workers,
+                                              int busy_wait,
+                                              const vftasks_pool_attr_t *attr)
+{
+  vftasks_pool_t *pool;              /* pointer to the pool */
+  tls_key_t key;                     /* TLS-key for the pool pointer */
+  vftasks_chunk_t *chunk;            /* pointer to a chunk containing all the workers */
+  vftasks_pool_attr_t default_attr;  /* attributes used if none are given */
+
+  /* fall back on the default attributes */
+  if (attr == NULL)
+  {
+    vftasks_init_pool_attr(&default_attr);
+    attr = &default_attr;
+  }
 
   /* allocate the pool */
   pool = (vftasks_pool_t *)malloc(sizeof(vftasks_pool_t));
@@ -335,20 +650,43 @@ vftasks_pool_t *vftasks_create_pool(int num_workers, int busy_wait)
   /* store the key with the pool */
   pool->key = key;
 
+  /* create the timer wheel, which the workers service */
+  if (_vftasks_timer_wheel_init(&pool->timers, attr->timer_tick_ns) != 0)
+  {
+    TLS_DESTROY(key);
+    free(pool);
+    abort_on_fail("vftasks_create_pool: timer creation failed");
+    return NULL;
+  }
+
   /* create the workers */
-  chunk = vftasks_create_workers(num_workers, key, busy_wait);
+  chunk = vftasks_create_workers(num_workers, key, busy_wait, &pool->timers, attr);
   if (chunk == NULL)
   {
+    _vftasks_timer_wheel_destroy(&pool->timers);
     TLS_DESTROY(key);
     free(pool);
     abort_on_fail("vftasks_create_pool: worker creation failed");
     return NULL;
   }
 
+  /* have the timekeeper woken up when a timer is scheduled before its deadline */
+  pool->timers.wake = vftasks_wake_timekeeper;
+  pool->timers.wake_arg = chunk->limit - 1;
+
+  /* store the workers with the pool and account for the memory they take */
+  pool->chunk = chunk;
+  pool->worker_memory = sizeof(vftasks_pool_t) + vftasks_workers_size(num_workers);
+  pool->stack_memory = num_workers * (attr->stack_size > 0 ?
+                                      attr->stack_size :
+                                      THREAD_DEFAULT_STACK_SIZE());
+  pool->coalesce_ns = attr->coalesce_ns;
+
   /* store the workers in TLS */
   if (TLS_SET(key, chunk) != 0)
   {
     vftasks_destroy_workers(chunk);
+    _vftasks_timer_wheel_destroy(&pool->timers);
     TLS_DESTROY(key);
     free(pool);
     return NULL;
@@ -362,8 +700,11 @@ vftasks_pool_t *vftasks_create_pool(int num_workers, int busy_wait)
  */
 void vftasks_destroy_pool(vftasks_pool_t *pool)
 {
-  /* retrieve the chunk that contains the workers in the pool and destroy the workers */
-  vftasks_destroy_workers(vftasks_get_chunk(pool));
+  /* destroy the workers in the pool */
+  vftasks_destroy_workers(pool->chunk);
+
+  /* cancel the timers that are still pending */
+  _vftasks_timer_wheel_destroy(&pool->timers);
 
   /* delete the TLS-key for the pool */
   TLS_DESTROY(pool->key);
@@ -376,24 +717,32 @@ void vftasks_destroy_pool(vftasks_pool_t *pool)
  * Execution of parallel tasks
  * ***************************************************************************/
 
-/** submit a task
+/** submit a task, or else a task that takes the arena of the worker; a task that
+ *  is independent of the submitter may be executed inline
  */
-int vftasks_submit(vftasks_pool_t *pool,
-                   vftasks_task_t *task,
-                   void *args,
-                   int num_workers)
+static int vftasks_submit_task(vftasks_pool_t *pool,
+                               vftasks_task_t *task,
+                               vftasks_arena_task_t *arena_task,
+                               void *args,
+                               int num_workers,
+                               int independent)
 {
   vftasks_chunk_t *chunk;    /* pointer to the chunk of subsidiary workers that the
                                 calling thread has at its disposal */
   vftasks_worker_t *worker;  /* pointer to the worker that is to execute the task */
   vftasks_worker_t *current;
+  int with_arena;            /* nonzero if the task takes an arena */
 
-  if (task == NULL)
+  if (task == NULL && arena_task == NULL)
   {
     abort_on_fail("vftasks_submit: no task");
     return 1;
   }
 
+  /* a task that takes an arena is handed over through the marker */
+  with_arena = arena_task != NULL;
+  if (with_arena) task = vftasks_arena_marker;
+
   if (num_workers < 0)
   {
     abort_on_fail("vftasks_submit: invalid number of workers");
@@ -428,9 +777,47 @@ int vftasks_submit(vftasks_pool_t *pool,
   /* update the pointer to the first available worker in this chunk */
   chunk->next = worker + 1;
 
-  /* assign the task and the corresponding arguments to the worker */
+  /* the counters are only written by the owner of the chunk */
+  ATOMIC_STORE_RELAXED(&chunk->num_submitted, chunk->num_submitted + 1);
+  worker->submitted = task;
+
+  /* independent tasks that were observed to take less time than a round trip to a
+     worker are executed inline; the worker stays reserved, so that vftasks_get()
+     still pairs up with this submission */
+  if (pool->coalesce_ns > 0 && independent)
+  {
+    vftasks_profile_t *profile;  /* profile of the task function */
+    vftasks_chunk_t *empty;      /* the empty chunk of the pool */
+    uint64_t start;              /* start time of the task */
+
+    profile = vftasks_get_profile(chunk, task);
+    if (profile->num_samples >= MIN_PROFILE_SAMPLES &&
+        profile->avg_ns < (int64_t)pool->coalesce_ns)
+    {
+      worker->inlined = 1;
+      ATOMIC_STORE_RELAXED(&chunk->num_inlined, chunk->num_inlined + 1);
+
+      /* the workers of the submitter are not the task's to use */
+      empty = pool->chunk + 1 + (pool->chunk->limit - pool->chunk->base);
+      TLS_SET(pool->key, empty);
+
+      /* keep measuring, so that a task that grows is dispatched again */
+      vftasks_timer_start(&start);
+      task(args);
+      vftasks_update_profile(profile, vftasks_timer_stop(&start));
+
+      TLS_SET(pool->key, chunk);
+
+      return 0;
+    }
+  }
+
+  /* assign the task and the corresponding arguments to the worker; the task is
+     stored last, so that a spinning worker sees the arguments along with it */
   worker->args = args;
-  worker->task = task;
+  ATOMIC_STORE_RELAXED(&worker->arena_task, arena_task);
+  worker->with_arena = with_arena;
+  ATOMIC_STORE_RELEASE(&worker->task, task);
 
   /* signal the (blocked) worker to continue execution */
   WORKER_SIGNAL(worker);
@@ -439,6 +826,35 @@ int vftasks_submit(vftasks_pool_t *pool,
   return 0;
 }
 
+/** submit a task
+ */
+int vftasks_submit(vftasks_pool_t *pool,
+                   vftasks_task_t *task,
+                   void *args,
+                   int num_workers)
+{
+  return vftasks_submit_task(pool, task, NULL, args, num_workers, 0);
+}
+
+/** submit a task that is independent of the submitter
+ */
+int vftasks_submit_independent(vftasks_pool_t *pool,
+                               vftasks_task_t *task,
+                               void *args)
+{
+  return vftasks_submit_task(pool, task, NULL, args, 0, 1);
+}
+
+/** submit a task that uses the scratch arena of its worker
+ */
+int vftasks_submit_arena_task(vftasks_pool_t *pool,
+                              vftasks_arena_task_t *task,
+                              void *args,
+                              int num_workers)
+{
+  return vftasks_submit_task(pool, NULL, task, args, num_workers, 0);
+}
+
 /** block until the most recently submitted task finishes
  */
 int vftasks_get(vftasks_pool_t *pool)
@@ -465,14 +881,227 @@ int vftasks_get(vftasks_pool_t *pool)
   /* retrieve the worker that is executing most recently submitted task in this chunk */
   worker = chunk->next - 1;
 
-  /* wait until the task has finished execution */
-  CALLER_WAIT(worker);
+  if (worker->inlined)
+  {
+    /* the task was executed by vftasks_submit() itself */
+    worker->inlined = 0;
+  }
+  else
+  {
+    /* wait until the task has finished execution */
+    CALLER_WAIT(worker);
+
+    /* learn from the execution time of the task */
+    if (worker->measure && !worker->with_arena)
+      vftasks_update_profile(vftasks_get_profile(chunk, worker->submitted),
+                             worker->duration);
+  }
 
   /* release the current worker and its subsidiary chunk
    * it is assumed that all subsidiary workers have joined
    */
   chunk->next = worker->chunk->base;
 
+  /* empty the subsidiary chunk, so that the released workers cannot be reached
+     through it until the worker is submitted to again */
+  worker->chunk->limit = worker->chunk->base;
+  worker->chunk->next = worker->chunk->base;
+
   /* return 0 to indicate success */
   return 0;
 }
+
+/** get the number of workers available to the calling thread
+ */
+int vftasks_get_num_available_workers(vftasks_pool_t *pool)
+{
+  vftasks_chunk_t *chunk;  /* pointer to the chunk of subsidiary workers that the
+                              calling thread has at its disposal */
+
+  chunk = pool != NULL ? vftasks_get_chunk(pool) : NULL;
+  if (chunk == NULL) return 0;
+
+  return chunk->limit - chunk->next;
+}
+
+/* ***************************************************************************
+ * Pool statistics
+ * ***************************************************************************/
+
+/** get pool statistics
+ */
+int vftasks_get_pool_stats(vftasks_pool_t *pool, vftasks_pool_stats_t *stats)
+{
+  vftasks_worker_t *worker;  /* pointer to a worker in the pool */
+  vftasks_chunk_t *chunk;    /* pointer to a chunk in the pool */
+
+  if (pool == NULL || stats == NULL)
+  {
+    abort_on_fail("vftasks_get_pool_stats: invalid argument");
+    return 1;
+  }
+
+  stats->num_workers = pool->chunk->limit - pool->chunk->base;
+  stats->worker_memory = pool->worker_memory;
+  stats->stack_memory = pool->stack_memory;
+  stats->arena_high_water = 0;
+  stats->arena_reserved = 0;
+  stats->tasks_submitted = 0;
+  stats->tasks_inlined = 0;
+
+  /* the chunk of the pool is followed by the subsidiary chunks of the workers */
+  for (chunk = pool->chunk; chunk <= pool->chunk + stats->num_workers; ++chunk)
+  {
+    stats->tasks_submitted += ATOMIC_LOAD_RELAXED(&chunk->num_submitted);
+    stats->tasks_inlined += ATOMIC_LOAD_RELAXED(&chunk->num_inlined);
+  }
+
+  /* the arena counters are only written by their workers; reading them while the
+     workers run yields a slightly stale, but consistent enough, picture */
+  for (worker = pool->chunk->base; worker < pool->chunk->limit; ++worker)
+  {
+    size_t high_water = ATOMIC_LOAD_RELAXED(&worker->arena.high_water);
+
+    if (high_water > stats->arena_high_water)
+      stats->arena_high_water = high_water;
+    stats->arena_reserved += ATOMIC_LOAD_RELAXED(&worker->arena.reserved);
+  }
+
+  return 0;
+}
+
+/** get pool snapshot
+ */
+int vftasks_get_pool_snapshot(vftasks_pool_t *pool,
+                              vftasks_worker_snapshot_t *snapshot)
+{
+  vftasks_worker_t *worker;  /* pointer to a worker in the pool */
+
+  if (pool == NULL || snapshot == NULL)
+  {
+    abort_on_fail("vftasks_get_pool_snapshot: invalid argument");
+    return 1;
+  }
+
+  /* the state words are only written by their workers; a single read of each
+     suffices, so the snapshot never waits for the workers nor disturbs them by
+     writing to their cache lines; the arena task may already belong to the next
+     submission, which the snapshot cannot tell apart from the current one */
+  for (worker = pool->chunk->base; worker < pool->chunk->limit; ++worker, ++snapshot)
+  {
+    snapshot->state = ATOMIC_LOAD_RELAXED(&worker->state);
+    snapshot->task = snapshot->state == VFTASKS_WORKER_BUSY ?
+                     ATOMIC_LOAD_RELAXED(&worker->task) :
+                     NULL;
+    snapshot->arena_task = NULL;
+    if (snapshot->task == vftasks_arena_marker)
+    {
+      snapshot->task = NULL;
+      snapshot->arena_task = ATOMIC_LOAD_RELAXED(&worker->arena_task);
+    }
+  }
+
+  return 0;
+}
+
+/* ***************************************************************************
+ * Timed tasks
+ * ***************************************************************************/
+
+/** create timed task
+ */
+vftasks_timed_task_t *vftasks_create_timed_task(vftasks_pool_t *pool,
+                                                vftasks_task_t *task,
+                                                void *args)
+{
+  vftasks_timed_task_t *timer;  /* pointer to the timed task */
+
+  if (pool == NULL || task == NULL)
+  {
+    abort_on_fail("vftasks_create_timed_task: invalid pool or task");
+    return NULL;
+  }
+
+  /* allocate the timed task */
+  timer = (vftasks_timed_task_t *)malloc(sizeof(vftasks_timed_task_t));
+  if (timer == NULL)
+  {
+    abort_on_fail("vftasks_create_timed_task: not enough memory");
+    return NULL;
+  }
+
+  /* initially the timed task is not scheduled */
+  timer->link.next = NULL;
+  timer->link.prev = NULL;
+  timer->wheel = &pool->timers;
+  timer->task = task;
+  timer->args = args;
+  timer->expires = 0;
+  timer->period = 0;
+  timer->one_off = 0;
+
+  return timer;
+}
+
+/** destroy timed task
+ */
+void vftasks_destroy_timed_task(vftasks_timed_task_t *timer)
+{
+  _vftasks_timer_wheel_cancel(timer->wheel, timer);
+  free(timer);
+}
+
+/** schedule timed task
+ */
+int vftasks_schedule_timed_task(vftasks_timed_task_t *timer,
+                                uint64_t delay_ns,
+                                uint64_t period_ns)
+{
+  if (timer == NULL)
+  {
+    abort_on_fail("vftasks_schedule_timed_task: invalid timed task");
+    return 1;
+  }
+
+  _vftasks_timer_wheel_schedule(timer->wheel, timer, delay_ns, period_ns);
+
+  return 0;
+}
+
+/** cancel timed task
+ */
+int vftasks_cancel_timed_task(vftasks_timed_task_t *timer)
+{
+  if (timer == NULL)
+  {
+    abort_on_fail("vftasks_cancel_timed_task: invalid timed task");
+    return 1;
+  }
+
+  _vftasks_timer_wheel_cancel(timer->wheel, timer);
+
+  return 0;
+}
+
+/** submit a task for execution after a delay
+ */
+int vftasks_submit_after(vftasks_pool_t *pool,
+                         uint64_t delay_ns,
+                         vftasks_task_t *task,
+                         void *args)
+{
+  vftasks_timed_task_t *timer;  /* pointer to the timed task */
+
+  timer = vftasks_create_timed_task(pool, task, args);
+  if (timer == NULL)
+  {
+    abort_on_fail("vftasks_submit_after: timed task creation failed");
+    return 1;
+  }
+
+  /* the timed task is released by the worker that executes it */
+  timer->one_off = 1;
+  _vftasks_timer_wheel_schedule(timer->wheel, timer, delay_ns, 0);
+
+  return 0;
+}
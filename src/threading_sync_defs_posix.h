@@ -2,8 +2,18 @@
 #define THREADING_SYNC_DEFS_POSIX_H
 
 #include <pthread.h>
+#include <stdlib.h>     /* for posix_memalign and free */
 #include "semaphore.h"
 
+#ifdef __linux__
+#include <linux/futex.h>
+#include <limits.h>     /* for INT_MAX */
+#include <sys/syscall.h>
+#include <unistd.h>     /* for syscall */
+#else
+#include <sched.h>      /* for sched_yield */
+#endif
+
 
 typedef pthread_t thread_t;
 typedef pthread_key_t tls_key_t;
@@ -14,6 +24,17 @@ typedef _vftasks_semaphore_t semaphore_t;
 #define THREAD_CREATE(THREAD,FUNC,ARGS) \
   pthread_create((pthread_t *)&(THREAD), NULL, FUNC, ARGS)
 
+#define THREAD_CREATE_WITH_ATTR(THREAD,FUNC,ARGS,STACK_SIZE,GUARD_SIZE)      \
+  _vftasks_thread_create((pthread_t *)&(THREAD), FUNC, ARGS, STACK_SIZE, GUARD_SIZE)
+
+#define THREAD_DEFAULT_STACK_SIZE() _vftasks_thread_default_stack_size()
+
+#if defined(__linux__) && defined(_GNU_SOURCE)
+#define THREAD_SET_NAME(THREAD,NAME) pthread_setname_np(THREAD, NAME)
+#else
+#define THREAD_SET_NAME(THREAD,NAME) 0
+#endif
+
 #define THREAD_EXIT() pthread_exit(NULL)
 #define THREAD_JOIN(THREAD) pthread_join(THREAD, NULL)
 
@@ -28,6 +49,7 @@ typedef _vftasks_semaphore_t semaphore_t;
 
 
 #define MUTEX_LOCK(MUTEX) pthread_mutex_lock(&(MUTEX))
+#define MUTEX_TRYLOCK(MUTEX) pthread_mutex_trylock(&(MUTEX))
 #define MUTEX_UNLOCK(MUTEX) pthread_mutex_unlock(&(MUTEX))
 #define MUTEX_CREATE(MUTEX) pthread_mutex_init(&(MUTEX), NULL)
 
@@ -38,11 +60,106 @@ typedef _vftasks_semaphore_t semaphore_t;
   }
 
 
+/* atomic operations; the name gives the memory ordering, and read-modify-write
+   operations are acquire-release; ATOMIC_CAS updates EXPECTED on failure */
+#define ATOMIC_LOAD_RELAXED(PTR) __atomic_load_n(PTR, __ATOMIC_RELAXED)
+#define ATOMIC_LOAD_ACQUIRE(PTR) __atomic_load_n(PTR, __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE_RELAXED(PTR,VAL) __atomic_store_n(PTR, VAL, __ATOMIC_RELAXED)
+#define ATOMIC_STORE_RELEASE(PTR,VAL) __atomic_store_n(PTR, VAL, __ATOMIC_RELEASE)
+#define ATOMIC_FETCH_ADD(PTR,VAL) __atomic_fetch_add(PTR, VAL, __ATOMIC_ACQ_REL)
+#define ATOMIC_CAS(PTR,EXPECTED,DESIRED)                                  \
+  __atomic_compare_exchange_n(PTR, &(EXPECTED), DESIRED, 0,               \
+                              __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define ATOMIC_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+/* hint to the processor that the calling thread is spinning */
+#if defined(__i386__) || defined(__x86_64__)
+#define CPU_PAUSE() __builtin_ia32_pause()
+#elif defined(__aarch64__)
+#define CPU_PAUSE() __asm__ __volatile__("yield")
+#else
+#define CPU_PAUSE() ((void)0)
+#endif
+
+/* let other threads run on the calling thread's processor */
+#define THREAD_YIELD() sched_yield()
+
+/* block while an integer holds a given value, and wake up all threads blocked on
+   an integer; waits may return spuriously */
+#ifdef __linux__
+#define ADDRESS_WAIT(PTR,VAL) \
+  syscall(SYS_futex, (int *)(PTR), FUTEX_WAIT_PRIVATE, VAL, NULL, NULL, 0)
+#define ADDRESS_WAKE_ALL(PTR) \
+  syscall(SYS_futex, (int *)(PTR), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0)
+#else
+/* without futexes, waiting degrades to yielding the processor */
+#define ADDRESS_WAIT(PTR,VAL) sched_yield()
+#define ADDRESS_WAKE_ALL(PTR) ((void)0)
+#endif
+
+
+#define ALIGNED(ALIGNMENT) __attribute__((aligned(ALIGNMENT)))
+
+#define ALIGNED_MALLOC(PTR,ALIGNMENT,SIZE) \
+  posix_memalign((void **)&(PTR), ALIGNMENT, SIZE)
+#define ALIGNED_FREE(PTR) free(PTR)
+
+
 #define SEMAPHORE_CREATE(SEM,VALUE,MAX) \
   _vftasks_sem_create((_vftasks_semaphore_t *)(&(SEM)), VALUE)
 #define SEMAPHORE_DESTROY(SEM) _vftasks_sem_destroy((_vftasks_semaphore_t *)(&(SEM)))
 #define SEMAPHORE_WAIT(SEM) _vftasks_sem_wait((_vftasks_semaphore_t *)(&(SEM)))
 #define SEMAPHORE_POST(SEM) _vftasks_sem_post((_vftasks_semaphore_t *)(&(SEM)))
+#define SEMAPHORE_WAIT_N(SEM,N) _vftasks_sem_wait_n((_vftasks_semaphore_t *)(&(SEM)), N)
+#define SEMAPHORE_POST_N(SEM,N) _vftasks_sem_post_n((_vftasks_semaphore_t *)(&(SEM)), N)
+#define SEMAPHORE_TIMEDWAIT(SEM,TIMEOUT_NS) \
+  _vftasks_sem_timedwait((_vftasks_semaphore_t *)(&(SEM)), TIMEOUT_NS)
+
+/* take a unit, or up to a number of units, that are available without blocking;
+   SEMAPHORE_TRYWAIT returns 0 if it took a unit, SEMAPHORE_TRYWAIT_N the number of
+   units taken */
+#define SEMAPHORE_TRYWAIT(SEM) \
+  (_vftasks_sem_trywait_n((_vftasks_semaphore_t *)(&(SEM)), 1) != 1)
+#define SEMAPHORE_TRYWAIT_N(SEM,N) \
+  _vftasks_sem_trywait_n((_vftasks_semaphore_t *)(&(SEM)), N)
+
+
+
+/* create a thread with a given stack and guard size; zero selects the default */
+static inline int _vftasks_thread_create(pthread_t *thread,
+                                         void *(*func)(void *),
+                                         void *args,
+                                         size_t stack_size,
+                                         size_t guard_size)
+{
+  pthread_attr_t attr;
+  int r;
+
+  if (stack_size == 0 && guard_size == 0)
+    return pthread_create(thread, NULL, func, args);
+
+  r = pthread_attr_init(&attr);
+  if (!r && stack_size > 0) r = pthread_attr_setstacksize(&attr, stack_size);
+  if (!r && guard_size > 0) r = pthread_attr_setguardsize(&attr, guard_size);
+  if (!r) r = pthread_create(thread, &attr, func, args);
+  pthread_attr_destroy(&attr);
+
+  return r;
+}
+
+/* the size of the stack reserved for a thread that is created without attributes */
+static inline size_t _vftasks_thread_default_stack_size(void)
+{
+  pthread_attr_t attr;
+  size_t stack_size = 0;
+
+  if (pthread_attr_init(&attr) == 0)
+  {
+    pthread_attr_getstacksize(&attr, &stack_size);
+    pthread_attr_destroy(&attr);
+  }
 
+  return stack_size;
+}
 
 #endif /* THREADING_SYNC_DEFS_POSIX_H */
@@ -2,6 +2,7 @@
 #define THREADING_SYNC_DEFS_WIN_H
 
 #include <windows.h>
+#include <malloc.h>     /* for _aligned_malloc and _aligned_free */
 
 #ifndef __cplusplus
 #define inline __inline
@@ -16,6 +17,16 @@ typedef HANDLE semaphore_t;
 #define THREAD_CREATE(THREAD,FUNC,ARG) \
   (!(((THREAD) = CreateThread(NULL, 0, FUNC, (ARG), 0, NULL)) != NULL))
 
+#define THREAD_CREATE_WITH_ATTR(THREAD,FUNC,ARG,STACK_SIZE,GUARD_SIZE)        \
+  (!(((THREAD) = CreateThread(NULL, STACK_SIZE, FUNC, (ARG),                    \
+                              STACK_SIZE ? STACK_SIZE_PARAM_IS_A_RESERVATION : 0, \
+                              NULL)) != NULL))
+
+/* the linker default for the stack reservation of a thread */
+#define THREAD_DEFAULT_STACK_SIZE() ((size_t)1 << 20)
+
+#define THREAD_SET_NAME(THREAD,NAME) 0
+
 #define THREAD_EXIT_SUCCESS 0
 #define THREAD_EXIT() ExitThread(THREAD_EXIT_SUCCESS)
 
@@ -36,6 +47,7 @@ typedef HANDLE semaphore_t;
 
 
 #define MUTEX_LOCK(MUTEX) (!(WaitForSingleObject(MUTEX, INFINITE) == WAIT_OBJECT_0))
+#define MUTEX_TRYLOCK(MUTEX) (!(WaitForSingleObject(MUTEX, 0) == WAIT_OBJECT_0))
 #define MUTEX_UNLOCK(MUTEX) ReleaseMutex(MUTEX)
 #define MUTEX_CREATE(MUTEX) (!(((MUTEX) = CreateMutex(NULL, FALSE, NULL)) != NULL))
 
@@ -46,11 +58,110 @@ typedef HANDLE semaphore_t;
   }
 
 
+/* atomic operations; the name gives the memory ordering, and read-modify-write
+   operations are acquire-release; ATOMIC_CAS updates EXPECTED on failure
+
+   On x64, plain loads and stores of aligned words of up to 64 bits are atomic and
+   have acquire and release semantics, so loads and stores only need to be kept
+   from being reordered or cached by the compiler.  32-bit x86 is not supported,
+   as plain accesses to the 64-bit progress counts and deadlines are not atomic
+   there.  An acquire load is a volatile load, which the compiler does not move
+   later accesses ahead of (/volatile:ms, the default on x64; __typeof__ requires
+   Visual Studio 2022 17.9); a release store is preceded by a compiler barrier.
+   Read-modify-write operations are only provided for (32-bit) integers. */
+#if !defined(_M_X64)
+#error "atomic loads and stores are only implemented for x64 on Windows"
+#endif
+
+#define ATOMIC_LOAD_RELAXED(PTR) (_ReadWriteBarrier(), *(PTR))
+#define ATOMIC_LOAD_ACQUIRE(PTR) (*(volatile __typeof__(*(PTR)) *)(PTR))
+#define ATOMIC_STORE_RELAXED(PTR,VAL) (_ReadWriteBarrier(), *(PTR) = (VAL))
+#define ATOMIC_STORE_RELEASE(PTR,VAL) (_ReadWriteBarrier(), *(PTR) = (VAL))
+#define ATOMIC_FETCH_ADD(PTR,VAL) InterlockedExchangeAdd((volatile LONG *)(PTR), VAL)
+#define ATOMIC_CAS(PTR,EXPECTED,DESIRED) \
+  _vftasks_atomic_cas((volatile LONG *)(PTR), (LONG *)&(EXPECTED), DESIRED)
+#define ATOMIC_FENCE() MemoryBarrier()
+
+/* hint to the processor that the calling thread is spinning */
+#define CPU_PAUSE() YieldProcessor()
+
+/* let other threads run on the calling thread's processor */
+#define THREAD_YIELD() SwitchToThread()
+
+/* block while an integer holds a given value, and wake up all threads blocked on
+   an integer; waits may return spuriously (requires Windows 8 and
+   Synchronization.lib) */
+#define ADDRESS_WAIT(PTR,VAL) _vftasks_address_wait((volatile LONG *)(PTR), VAL)
+#define ADDRESS_WAKE_ALL(PTR) WakeByAddressAll((PVOID)(PTR))
+
+
+#define ALIGNED(ALIGNMENT) __declspec(align(ALIGNMENT))
+
+#define ALIGNED_MALLOC(PTR,ALIGNMENT,SIZE) \
+  (!(((PTR) = _aligned_malloc(SIZE, ALIGNMENT)) != NULL))
+#define ALIGNED_FREE(PTR) _aligned_free(PTR)
+
+
 #define SEMAPHORE_CREATE(SEM,VALUE,MAX)                                 \
   (!(((SEM) = CreateSemaphore(NULL, VALUE, MAX, NULL)) != NULL))
 
 #define SEMAPHORE_DESTROY(SEM) CloseHandle(SEM)
 #define SEMAPHORE_WAIT(SEM) (!(WaitForSingleObject(SEM, INFINITE) == WAIT_OBJECT_0))
 #define SEMAPHORE_POST(SEM) (!ReleaseSemaphore(SEM, 1, NULL))
+#define SEMAPHORE_POST_N(SEM,N) (!ReleaseSemaphore(SEM, N, NULL))
+
+/* Windows semaphores cannot take several units at once, so they are taken one by
+   one; a semaphore may therefore have only one waiter for several units at a time,
+   which holds for the links of the synchronization managers */
+#define SEMAPHORE_WAIT_N(SEM,N) _vftasks_sem_wait_n(SEM, N)
+
+/* the timeout is rounded up to whole milliseconds */
+#define SEMAPHORE_TIMEDWAIT(SEM,TIMEOUT_NS)                                   \
+  (!(WaitForSingleObject(SEM, (DWORD)(((TIMEOUT_NS) + 999999) / 1000000)) == \
+     WAIT_OBJECT_0))
+
+/* take a unit, or up to a number of units, that are available without blocking;
+   SEMAPHORE_TRYWAIT returns 0 if it took a unit, SEMAPHORE_TRYWAIT_N the number of
+   units taken, which it takes one by one */
+#define SEMAPHORE_TRYWAIT(SEM) (!(WaitForSingleObject(SEM, 0) == WAIT_OBJECT_0))
+#define SEMAPHORE_TRYWAIT_N(SEM,N) _vftasks_sem_trywait_n(SEM, N)
+
+/* take up to a number of units from a semaphore without blocking */
+static inline int _vftasks_sem_trywait_n(HANDLE sem, int n)
+{
+  int taken = 0;
+
+  while (taken < n && WaitForSingleObject(sem, 0) == WAIT_OBJECT_0) taken++;
+
+  return taken;
+}
+
+/* take a number of units from a semaphore */
+static inline int _vftasks_sem_wait_n(HANDLE sem, int n)
+{
+  while (n-- > 0)
+  {
+    if (WaitForSingleObject(sem, INFINITE) != WAIT_OBJECT_0) return 1;
+  }
+
+  return 0;
+}
+
+/* block while an integer holds a given value */
+static inline void _vftasks_address_wait(volatile LONG *ptr, LONG value)
+{
+  WaitOnAddress(ptr, &value, sizeof(LONG), INFINITE);
+}
+
+/* compare and swap an integer; on failure, the expected value is updated */
+static inline int _vftasks_atomic_cas(volatile LONG *ptr, LONG *expected, LONG desired)
+{
+  LONG old = InterlockedCompareExchange(ptr, desired, *expected);
+
+  if (old == *expected) return 1;
+
+  *expected = old;
+  return 0;
+}
 
 #endif /* THREADING_SYNC_DEFS_WIN_H */
@@ -1,5 +1,6 @@
 #include "vftasks.h"
 #include "platform.h"
+#include "timer_wheel.h"
 
 #include <stdint.h>
 #include <assert.h>
@@ -26,6 +27,19 @@ uint64_t vftasks_timer_stop(uint64_t *start)
   return stop - *start;
 }
 
+uint64_t _vftasks_monotonic_ns(void)
+{
+  struct timespec tp;
+
+#ifdef CLOCK_MONOTONIC
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+#else
+  clock_gettime(CLOCK_REALTIME, &tp);
+#endif
+
+  return tp.tv_sec * ((uint64_t) 1000000000) + tp.tv_nsec;
+}
+
 #elif defined (_WIN32)
 
 #include <windows.h>
@@ -55,6 +69,21 @@ uint64_t vftasks_timer_stop(uint64_t *start)
   return (uint64_t)((val.QuadPart - *start) * resolution);
 }
 
+uint64_t _vftasks_monotonic_ns(void)
+{
+  LARGE_INTEGER val, freq;
+  int rc;
+
+  rc = QueryPerformanceCounter(&val);
+  assert(rc);
+  rc = QueryPerformanceFrequency(&freq);
+  assert(rc);
+
+  /* split the conversion to avoid overflowing the intermediate product */
+  return (uint64_t)(val.QuadPart / freq.QuadPart) * 1000000000 +
+         (uint64_t)(val.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart;
+}
+
 #else
 #error("unsupported platform")
 #endif /* _POSIX_SOURCE / _WIN32 */
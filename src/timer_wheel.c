@@ -0,0 +1,423 @@
+#include "timer_wheel.h"
+
+#include <stdlib.h>     /* for free */
+
+/* ***************************************************************************
+ * Lists of timers
+ * ***************************************************************************/
+
+/** initialize an empty list
+ */
+static inline void vftasks_init_list(vftasks_timer_link_t *head)
+{
+  head->next = head;
+  head->prev = head;
+}
+
+/** check whether a list is empty
+ */
+static inline int vftasks_list_empty(vftasks_timer_link_t *head)
+{
+  return head->next == head;
+}
+
+/** append a link to a list
+ */
+static inline void vftasks_list_append(vftasks_timer_link_t *head,
+                                       vftasks_timer_link_t *link)
+{
+  link->next = head;
+  link->prev = head->prev;
+  head->prev->next = link;
+  head->prev = link;
+}
+
+/** remove a link from the list it is in
+ */
+static inline void vftasks_list_remove(vftasks_timer_link_t *link)
+{
+  link->prev->next = link->next;
+  link->next->prev = link->prev;
+  link->next = NULL;
+  link->prev = NULL;
+}
+
+/* ***************************************************************************
+ * Timer wheel
+ * ***************************************************************************/
+
+/** the index of the lowest bit that is set in a nonzero word
+ */
+static inline int vftasks_lowest_bit(uint64_t word)
+{
+  static const int positions[64] =
+  {
+     0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+    62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+    63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+    46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6
+  };
+
+  /* isolate the bit, and look up its position through a de Bruijn sequence */
+  return positions[((word & (~word + 1)) * 0x03f79d71b4cb0a89ULL) >> 58];
+}
+
+/** remove a timer from the slot or the list it is in, and keep track of the slots
+ *  that hold timers
+ */
+static void vftasks_remove_timer(vftasks_timer_wheel_t *wheel,
+                                 vftasks_timer_link_t *link)
+{
+  vftasks_timer_link_t *next;  /* the link after the timer */
+  int slot;                    /* position of the slot among all slots */
+
+  next = link->next;
+  vftasks_list_remove(link);
+
+  /* if the timer was the last one in a slot rather than in the due list, the link
+     after it is the slot */
+  if (next != &wheel->due && vftasks_list_empty(next))
+  {
+    slot = (int)(next - &wheel->slots[0][0]);
+    wheel->occupied[slot / TIMER_WHEEL_SLOTS] &=
+      ~((uint64_t)1 << (slot % TIMER_WHEEL_SLOTS));
+  }
+}
+
+/** convert a point in time to the first tick that starts at or after it
+ */
+static inline uint64_t vftasks_ns_to_tick(vftasks_timer_wheel_t *wheel, uint64_t ns)
+{
+  if (ns <= wheel->origin_ns) return 0;
+  return (ns - wheel->origin_ns + wheel->tick_ns - 1) / wheel->tick_ns;
+}
+
+/** determine the tick that is currently in progress
+ */
+static inline uint64_t vftasks_current_tick(vftasks_timer_wheel_t *wheel)
+{
+  return (_vftasks_monotonic_ns() - wheel->origin_ns) / wheel->tick_ns;
+}
+
+/** insert a timer into the slot that covers its expiration tick
+ */
+static void vftasks_insert_timer(vftasks_timer_wheel_t *wheel,
+                                 vftasks_timed_task_t *timer)
+{
+  uint64_t expires;  /* the tick at which the timer expires */
+  uint64_t delta;    /* the number of ticks until then */
+  int level, index;  /* position of the slot in the wheel */
+
+  /* timers that are already overdue expire on the next tick */
+  expires = timer->expires > wheel->now ? timer->expires : wheel->now;
+  delta = expires - wheel->now;
+
+  /* find the lowest level that spans the delta */
+  for (level = 0; level < TIMER_WHEEL_LEVELS - 1; ++level)
+  {
+    if (delta < ((uint64_t)1 << ((level + 1) * TIMER_WHEEL_BITS))) break;
+  }
+
+  /* timers beyond the span of the wheel are parked in the furthest slot of the top
+     level; they are moved down when that slot is cascaded */
+  if (delta >= ((uint64_t)1 << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS)))
+    expires = wheel->now +
+              ((uint64_t)1 << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS)) - 1;
+
+  index = (expires >> (level * TIMER_WHEEL_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+  vftasks_list_append(&wheel->slots[level][index], &timer->link);
+  wheel->occupied[level] |= (uint64_t)1 << index;
+}
+
+/** move the timers in a slot to the lower levels of the wheel
+ */
+static void vftasks_cascade(vftasks_timer_wheel_t *wheel, int level, int index)
+{
+  vftasks_timer_link_t list;  /* the timers in the slot */
+  vftasks_timer_link_t *link;  /* a timer in the slot */
+
+  /* take the timers out of the slot first, as they may be reinserted in it */
+  vftasks_init_list(&list);
+  if (!vftasks_list_empty(&wheel->slots[level][index]))
+  {
+    list.next = wheel->slots[level][index].next;
+    list.prev = wheel->slots[level][index].prev;
+    list.next->prev = &list;
+    list.prev->next = &list;
+    vftasks_init_list(&wheel->slots[level][index]);
+    wheel->occupied[level] &= ~((uint64_t)1 << index);
+  }
+
+  while (!vftasks_list_empty(&list))
+  {
+    link = list.next;
+    vftasks_list_remove(link);
+    vftasks_insert_timer(wheel, (vftasks_timed_task_t *)link);
+  }
+}
+
+/** process the ticks up to and including a given tick
+ */
+static void vftasks_advance(vftasks_timer_wheel_t *wheel, uint64_t tick)
+{
+  vftasks_timer_link_t *slot;  /* the level-0 slot of the current tick */
+  int level, index;            /* position of a slot in the wheel */
+
+  /* nothing can expire in an empty wheel */
+  if (wheel->num_pending == 0)
+  {
+    if (tick >= wheel->now) wheel->now = tick + 1;
+    return;
+  }
+
+  for (; wheel->now <= tick; wheel->now++)
+  {
+    index = wheel->now & (TIMER_WHEEL_SLOTS - 1);
+
+    /* at the start of a round, bring down the timers of the next slot of the
+       higher levels */
+    for (level = 1; index == 0 && level < TIMER_WHEEL_LEVELS; ++level)
+    {
+      index = (wheel->now >> (level * TIMER_WHEEL_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+      vftasks_cascade(wheel, level, index);
+    }
+
+    /* the timers in the level-0 slot expire now */
+    index = wheel->now & (TIMER_WHEEL_SLOTS - 1);
+    slot = &wheel->slots[0][index];
+    while (!vftasks_list_empty(slot))
+    {
+      vftasks_timer_link_t *link = slot->next;
+      vftasks_list_remove(link);
+      vftasks_list_append(&wheel->due, link);
+    }
+    wheel->occupied[0] &= ~((uint64_t)1 << index);
+  }
+}
+
+/** determine when the wheel next needs to be serviced, in constant time
+ */
+static void vftasks_update_deadline(vftasks_timer_wheel_t *wheel)
+{
+  uint64_t deadline_ns;  /* the new deadline */
+  uint64_t previous_ns;  /* the previous deadline */
+  uint64_t tick;         /* the tick of the next event */
+  uint64_t ahead;        /* occupied level-0 slots in the rest of the round */
+
+  if (wheel->num_pending == 0)
+  {
+    deadline_ns = TIMER_WHEEL_NO_TIMEOUT;
+  }
+  else if (!vftasks_list_empty(&wheel->due))
+  {
+    deadline_ns = 0;
+  }
+  else
+  {
+    /* the first occupied level-0 slot in the current round, or else the start of
+       the next round, where the higher levels are cascaded */
+    ahead = wheel->occupied[0] &
+            (~(uint64_t)0 << (wheel->now & (TIMER_WHEEL_SLOTS - 1)));
+    if (ahead != 0)
+      tick = (wheel->now & ~(uint64_t)(TIMER_WHEEL_SLOTS - 1)) +
+             vftasks_lowest_bit(ahead);
+    else
+      tick = (wheel->now | (TIMER_WHEEL_SLOTS - 1)) + 1;
+
+    deadline_ns = wheel->origin_ns + tick * wheel->tick_ns;
+  }
+
+  /* publish the deadline, and then wake up the thread that sleeps until the
+     previous one, so that it sees the new deadline once it is woken up */
+  previous_ns = wheel->deadline_ns;
+  ATOMIC_STORE_RELAXED(&wheel->deadline_ns, deadline_ns);
+  if (deadline_ns < previous_ns && wheel->wake != NULL)
+    wheel->wake(wheel->wake_arg);
+}
+
+/** initialize a timer wheel
+ */
+int _vftasks_timer_wheel_init(vftasks_timer_wheel_t *wheel, uint64_t tick_ns)
+{
+  int level, index;  /* position of a slot in the wheel */
+
+  if (MUTEX_CREATE(wheel->lock) != 0) return 1;
+
+  wheel->tick_ns = tick_ns > 0 ? tick_ns : VFTASKS_TIMER_TICK_NS;
+  wheel->origin_ns = _vftasks_monotonic_ns();
+  wheel->now = 0;
+  wheel->num_pending = 0;
+  wheel->deadline_ns = TIMER_WHEEL_NO_TIMEOUT;
+  wheel->wake = NULL;
+  wheel->wake_arg = NULL;
+
+  vftasks_init_list(&wheel->due);
+  for (level = 0; level < TIMER_WHEEL_LEVELS; ++level)
+  {
+    wheel->occupied[level] = 0;
+    for (index = 0; index < TIMER_WHEEL_SLOTS; ++index)
+      vftasks_init_list(&wheel->slots[level][index]);
+  }
+
+  return 0;
+}
+
+/** destroy a timer wheel; timers that are still pending are cancelled
+ */
+void _vftasks_timer_wheel_destroy(vftasks_timer_wheel_t *wheel)
+{
+  vftasks_timer_link_t *link;  /* a pending timer */
+  int level, index;            /* position of a slot in the wheel */
+
+  /* the lock is held until it is destroyed */
+  MUTEX_LOCK(wheel->lock);
+
+  /* gather all pending timers in the due list */
+  for (level = 0; level < TIMER_WHEEL_LEVELS; ++level)
+  {
+    for (index = 0; index < TIMER_WHEEL_SLOTS; ++index)
+    {
+      while (!vftasks_list_empty(&wheel->slots[level][index]))
+      {
+        link = wheel->slots[level][index].next;
+        vftasks_list_remove(link);
+        vftasks_list_append(&wheel->due, link);
+      }
+    }
+  }
+
+  /* cancel them, releasing the ones that no one else refers to */
+  while (!vftasks_list_empty(&wheel->due))
+  {
+    link = wheel->due.next;
+    vftasks_list_remove(link);
+    if (((vftasks_timed_task_t *)link)->one_off) free(link);
+  }
+
+  wheel->num_pending = 0;
+
+  MUTEX_DESTROY(wheel->lock);
+}
+
+/** schedule a timer; a pending timer is rescheduled; takes constant time, as the
+ *  wheel is only advanced when it is serviced
+ */
+void _vftasks_timer_wheel_schedule(vftasks_timer_wheel_t *wheel,
+                                   vftasks_timed_task_t *timer,
+                                   uint64_t delay_ns,
+                                   uint64_t period_ns)
+{
+  uint64_t tick;  /* the tick that is currently in progress */
+
+  MUTEX_LOCK(wheel->lock);
+
+  /* the timer is placed relative to the next tick to be processed, which may lag
+     behind the current one; an empty wheel is brought up to date at once, so that
+     servicing it does not have to step through the ticks that passed while it was
+     empty */
+  tick = vftasks_current_tick(wheel);
+  if (wheel->num_pending == 0 && tick >= wheel->now) wheel->now = tick + 1;
+
+  if (timer->link.next != NULL)
+    vftasks_remove_timer(wheel, &timer->link);
+  else
+    ATOMIC_STORE_RELAXED(&wheel->num_pending, wheel->num_pending + 1);
+
+  /* periods are rounded up to whole ticks */
+  timer->expires = vftasks_ns_to_tick(wheel, _vftasks_monotonic_ns() + delay_ns);
+  timer->period = (period_ns + wheel->tick_ns - 1) / wheel->tick_ns;
+
+  vftasks_insert_timer(wheel, timer);
+  vftasks_update_deadline(wheel);
+
+  MUTEX_UNLOCK(wheel->lock);
+}
+
+/** cancel a timer, if it is pending
+ */
+void _vftasks_timer_wheel_cancel(vftasks_timer_wheel_t *wheel,
+                                 vftasks_timed_task_t *timer)
+{
+  MUTEX_LOCK(wheel->lock);
+
+  if (timer->link.next != NULL)
+  {
+    vftasks_remove_timer(wheel, &timer->link);
+    ATOMIC_STORE_RELAXED(&wheel->num_pending, wheel->num_pending - 1);
+    vftasks_update_deadline(wheel);
+  }
+
+  MUTEX_UNLOCK(wheel->lock);
+}
+
+/** execute the timers that have expired; if block is zero and another thread is
+ *  already servicing the wheel, the expired timers are left to that thread
+ */
+void _vftasks_timer_wheel_service(vftasks_timer_wheel_t *wheel, int block)
+{
+  vftasks_timed_task_t *timer;  /* an expired timer */
+  vftasks_task_t *task;         /* the task of the timer */
+  void *args;                   /* the arguments of the task */
+
+  if (block)
+    MUTEX_LOCK(wheel->lock);
+  else if (MUTEX_TRYLOCK(wheel->lock) != 0)
+    return;
+
+  vftasks_advance(wheel, vftasks_current_tick(wheel));
+
+  while (!vftasks_list_empty(&wheel->due))
+  {
+    timer = (vftasks_timed_task_t *)wheel->due.next;
+    vftasks_list_remove(&timer->link);
+
+    /* the timer may be cancelled, rescheduled or destroyed as soon as the lock is
+       released, so the task is copied first */
+    task = timer->task;
+    args = timer->args;
+
+    if (timer->period > 0)
+    {
+      /* keep to the original schedule; if expirations were missed, they are
+         collapsed into one */
+      timer->expires += timer->period;
+      if (timer->expires < wheel->now)
+        timer->expires += (wheel->now - timer->expires + timer->period - 1) /
+                          timer->period * timer->period;
+      vftasks_insert_timer(wheel, timer);
+    }
+    else
+    {
+      ATOMIC_STORE_RELAXED(&wheel->num_pending, wheel->num_pending - 1);
+      if (timer->one_off) free(timer);
+    }
+
+    vftasks_update_deadline(wheel);
+
+    /* execute the task without holding the lock */
+    MUTEX_UNLOCK(wheel->lock);
+    task(args);
+    if (MUTEX_TRYLOCK(wheel->lock) != 0) return;
+
+    /* catch up with the ticks that passed while executing the task */
+    vftasks_advance(wheel, vftasks_current_tick(wheel));
+  }
+
+  vftasks_update_deadline(wheel);
+
+  MUTEX_UNLOCK(wheel->lock);
+}
+
+/** determine the number of nanoseconds until the wheel needs to be serviced
+ */
+uint64_t _vftasks_timer_wheel_timeout(vftasks_timer_wheel_t *wheel)
+{
+  uint64_t deadline_ns;  /* the deadline of the wheel */
+  uint64_t now_ns;       /* the current time */
+
+  deadline_ns = ATOMIC_LOAD_RELAXED(&wheel->deadline_ns);
+  if (deadline_ns == TIMER_WHEEL_NO_TIMEOUT) return TIMER_WHEEL_NO_TIMEOUT;
+
+  now_ns = _vftasks_monotonic_ns();
+  return deadline_ns > now_ns ? deadline_ns - now_ns : 0;
+}
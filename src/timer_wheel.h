@@ -0,0 +1,89 @@
+#ifndef __TIMER_WHEEL_H
+#define __TIMER_WHEEL_H
+
+#include "vftasks.h"
+#include "platform.h"
+
+/* Default resolution of the timer wheel in nanoseconds */
+#define VFTASKS_TIMER_TICK_NS 1000000
+
+/* The timer wheel consists of TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots
+   each; a slot at level l covers TIMER_WHEEL_SLOTS^l ticks.  The occupied slots of
+   a level are tracked in a 64-bit word, so there are at most 64 slots per level */
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+/* Value returned by _vftasks_timer_wheel_timeout if no timers are pending */
+#define TIMER_WHEEL_NO_TIMEOUT UINT64_MAX
+
+typedef struct vftasks_timer_link_s vftasks_timer_link_t;
+typedef struct vftasks_timer_wheel_s vftasks_timer_wheel_t;
+
+/** link in a circular, doubly-linked list of timers
+ */
+struct vftasks_timer_link_s
+{
+  vftasks_timer_link_t *next;  /* next link in the list */
+  vftasks_timer_link_t *prev;  /* previous link in the list */
+};
+
+/** timed task; the link comes first, so that a link can be cast to its timer
+ */
+struct vftasks_timed_task_s
+{
+  vftasks_timer_link_t link;     /* link in a slot of the wheel; next is NULL if the
+                                    timer is not pending */
+  vftasks_timer_wheel_t *wheel;  /* the wheel in which the timer is scheduled */
+  vftasks_task_t *task;          /* task to be executed */
+  void *args;                    /* task arguments */
+  uint64_t expires;              /* tick at which the timer expires */
+  uint64_t period;               /* number of ticks between expirations; 0 if the
+                                    timer expires only once */
+  int one_off;                   /* nonzero if the timer is destroyed once it has
+                                    expired */
+};
+
+/** hierarchical timer wheel
+ */
+struct vftasks_timer_wheel_s
+{
+  mutex_t lock;                 /* protects all of the fields below */
+  uint64_t tick_ns;             /* duration of a tick */
+  uint64_t origin_ns;           /* time at which tick 0 started */
+  uint64_t now;                 /* next tick to be processed */
+  int num_pending;              /* number of timers in the wheel or due; may be
+                                   read without holding the lock */
+  uint64_t deadline_ns;         /* time at which the wheel next needs to be
+                                   serviced; may be read without holding the
+                                   lock */
+  void (*wake)(void *);         /* called when the deadline moves closer */
+  void *wake_arg;               /* argument passed to wake */
+  vftasks_timer_link_t due;     /* timers that have expired, but have not been
+                                   executed yet */
+  uint64_t occupied[TIMER_WHEEL_LEVELS];  /* per level, a bit per slot that holds
+                                             timers */
+  vftasks_timer_link_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+
+uint64_t _vftasks_monotonic_ns(void);
+
+int _vftasks_timer_wheel_init(vftasks_timer_wheel_t *, uint64_t);
+void _vftasks_timer_wheel_destroy(vftasks_timer_wheel_t *);
+void _vftasks_timer_wheel_schedule(vftasks_timer_wheel_t *,
+                                   vftasks_timed_task_t *,
+                                   uint64_t,
+                                   uint64_t);
+void _vftasks_timer_wheel_cancel(vftasks_timer_wheel_t *, vftasks_timed_task_t *);
+void _vftasks_timer_wheel_service(vftasks_timer_wheel_t *, int);
+uint64_t _vftasks_timer_wheel_timeout(vftasks_timer_wheel_t *);
+
+/** check whether a timer wheel needs to be serviced
+ */
+static inline int _vftasks_timer_wheel_expired(vftasks_timer_wheel_t *wheel)
+{
+  return ATOMIC_LOAD_RELAXED(&wheel->num_pending) > 0 &&
+         _vftasks_monotonic_ns() >= ATOMIC_LOAD_RELAXED(&wheel->deadline_ns);
+}
+
+#endif /* __TIMER_WHEEL_H */
@@ -0,0 +1,243 @@
+#include "vftasks.h"
+#include "sync.h"
+
+#include <stdlib.h>     /* for malloc and free */
+
+/* ***************************************************************************
+ * Wavefront execution of 2D loop nests
+ * ***************************************************************************/
+
+/** wavefront over the tiles of a 2D iteration space
+ */
+typedef struct vftasks_wavefront_s
+{
+  vftasks_tile_task_t *body;  /* the loop body, applied per tile */
+  void *ctx;                  /* context passed to the body */
+  int dim_x;                  /* iteration-space size along x-dimension */
+  int dim_y;                  /* iteration-space size along y-dimension */
+  int tile_x;                 /* tile size along x-dimension */
+  int tile_y;                 /* tile size along y-dimension */
+  int num_tiles_x;            /* number of tiles along x-dimension */
+  int num_tiles_y;            /* number of tiles along y-dimension */
+  int num_tiles;              /* total number of tiles */
+  int min_dx, max_dx;         /* range of x-offsets of a tile relative to the
+                                 tiles it depends on */
+  int min_dy, max_dy;         /* range of y-offsets of a tile relative to the
+                                 tiles it depends on */
+  int *counts;                /* per tile, the number of tiles it still waits for */
+  int *ready;                 /* tiles whose dependencies are satisfied, in the
+                                 order in which they became ready */
+  int head;                   /* index of the next ready tile to execute */
+  int tail;                   /* number of tiles that became ready */
+  int num_done;               /* number of executed tiles */
+  int num_participants;       /* number of threads that execute tiles */
+  mutex_t lock;               /* protects head and tail */
+  semaphore_t sem;            /* counts the ready tiles, and the participants that
+                                 are to stop once all tiles have been executed */
+} vftasks_wavefront_t;
+
+/** round down a quotient with a positive divisor
+ */
+static inline int vftasks_floor_div(int n, int d)
+{
+  return n >= 0 ? n / d : -((-n + d - 1) / d);
+}
+
+/** check whether a tile depends on the tile at a given offset
+ */
+static inline int vftasks_is_tile_dep(vftasks_wavefront_t *wf, int dx, int dy)
+{
+  return (dx != 0 || dy != 0) &&
+         dx >= wf->min_dx && dx <= wf->max_dx &&
+         dy >= wf->min_dy && dy <= wf->max_dy;
+}
+
+/** mark a number of tiles as ready
+ */
+static void vftasks_push_tiles(vftasks_wavefront_t *wf, const int *tiles, int n)
+{
+  int k;  /* index */
+
+  if (n == 0) return;
+
+  MUTEX_LOCK(wf->lock);
+  for (k = 0; k < n; ++k) wf->ready[wf->tail++] = tiles[k];
+  MUTEX_UNLOCK(wf->lock);
+
+  SEMAPHORE_POST_N(wf->sem, n);
+}
+
+/** execute ready tiles until all tiles have been executed
+ */
+static void vftasks_run_wavefront(void *raw_wf)
+{
+  vftasks_wavefront_t *wf = (vftasks_wavefront_t *)raw_wf;
+  int released[9];  /* tiles that became ready; at most the 3 x 3 neighbours of a
+                       tile, as tiles are at least as large as the distances */
+  int num_released;  /* number of released tiles */
+  int tile;          /* tile to execute */
+  int tx, ty;        /* tile coordinates */
+  int ux, uy;        /* coordinates of a dependent tile */
+  int x_begin, y_begin;
+
+  for (;;)
+  {
+    /* take the next ready tile, or stop */
+    SEMAPHORE_WAIT(wf->sem);
+    MUTEX_LOCK(wf->lock);
+    tile = wf->head < wf->tail ? wf->ready[wf->head++] : -1;
+    MUTEX_UNLOCK(wf->lock);
+    if (tile < 0) return;
+
+    /* execute the tile */
+    tx = tile / wf->num_tiles_y;
+    ty = tile % wf->num_tiles_y;
+    x_begin = tx * wf->tile_x;
+    y_begin = ty * wf->tile_y;
+    wf->body(wf->ctx,
+             x_begin,
+             x_begin + wf->tile_x < wf->dim_x ? x_begin + wf->tile_x : wf->dim_x,
+             y_begin,
+             y_begin + wf->tile_y < wf->dim_y ? y_begin + wf->tile_y : wf->dim_y);
+
+    /* release the tiles that depend on it; the counters hand over the results of
+       the tile (acq_rel) */
+    num_released = 0;
+    for (ux = tx + wf->min_dx; ux <= tx + wf->max_dx; ++ux)
+      for (uy = ty + wf->min_dy; uy <= ty + wf->max_dy; ++uy)
+        if (ux >= 0 && ux < wf->num_tiles_x && uy >= 0 && uy < wf->num_tiles_y &&
+            vftasks_is_tile_dep(wf, ux - tx, uy - ty) &&
+            ATOMIC_FETCH_ADD(&wf->counts[ux * wf->num_tiles_y + uy], -1) == 1)
+          released[num_released++] = ux * wf->num_tiles_y + uy;
+    vftasks_push_tiles(wf, released, num_released);
+
+    /* after the last tile, let all participants stop */
+    if (ATOMIC_FETCH_ADD(&wf->num_done, 1) + 1 == wf->num_tiles)
+      SEMAPHORE_POST_N(wf->sem, wf->num_participants);
+  }
+}
+
+/** execute a 2D loop nest as a wavefront of tiles
+ */
+int vftasks_wavefront_2d(vftasks_pool_t *pool,
+                         int dim_x,
+                         int dim_y,
+                         int dist_x,
+                         int dist_y,
+                         int tile_x,
+                         int tile_y,
+                         vftasks_tile_task_t *body,
+                         void *ctx)
+{
+  vftasks_wavefront_t wf;  /* the wavefront */
+  int num_workers;         /* number of workers that are available */
+  int num_submitted;       /* number of workers that execute tiles */
+  int tx, ty;              /* tile coordinates */
+  int ux, uy;              /* coordinates of a tile depended on */
+  int k;                   /* index */
+
+  /* check arguments; dependencies must point backwards in the order of execution,
+     and tiles must cover the distances, so that a tile depends on its neighbours
+     only */
+  if (pool == NULL || body == NULL || dim_x < 0 || dim_y < 0 ||
+      dist_x < 0 || (dist_x == 0 && dist_y < 0) ||
+      tile_x < 1 || tile_y < 1 || tile_x < dist_x || tile_y < abs(dist_y))
+  {
+    _vftasks_abort_on_fail("vftasks_wavefront_2d: invalid argument");
+    return 1;
+  }
+
+  if (dim_x == 0 || dim_y == 0) return 0;
+
+  wf.body = body;
+  wf.ctx = ctx;
+  wf.dim_x = dim_x;
+  wf.dim_y = dim_y;
+  wf.tile_x = tile_x;
+  wf.tile_y = tile_y;
+  wf.num_tiles_x = (dim_x + tile_x - 1) / tile_x;
+  wf.num_tiles_y = (dim_y + tile_y - 1) / tile_y;
+  wf.num_tiles = wf.num_tiles_x * wf.num_tiles_y;
+
+  /* iteration (x, y) depends on (x - dist_x, y - dist_y); over the iterations of a
+     tile, the tile containing the latter lies within these offsets */
+  wf.min_dx = -vftasks_floor_div(tile_x - 1 - dist_x, tile_x);
+  wf.max_dx = -vftasks_floor_div(-dist_x, tile_x);
+  wf.min_dy = -vftasks_floor_div(tile_y - 1 - dist_y, tile_y);
+  wf.max_dy = -vftasks_floor_div(-dist_y, tile_y);
+
+  wf.head = 0;
+  wf.tail = 0;
+  wf.num_done = 0;
+
+  /* all workers that are available to the calling thread take part, as does the
+     calling thread itself */
+  num_workers = vftasks_get_num_available_workers(pool);
+  if (num_workers > wf.num_tiles - 1) num_workers = wf.num_tiles - 1;
+
+  wf.counts = (int *)malloc(wf.num_tiles * sizeof(int));
+  wf.ready = (int *)malloc(wf.num_tiles * sizeof(int));
+  if (wf.counts == NULL || wf.ready == NULL)
+  {
+    free(wf.counts);
+    free(wf.ready);
+    _vftasks_abort_on_fail("vftasks_wavefront_2d: not enough memory");
+    return 1;
+  }
+
+  if (MUTEX_CREATE(wf.lock) != 0)
+  {
+    free(wf.counts);
+    free(wf.ready);
+    _vftasks_abort_on_fail("vftasks_wavefront_2d: mutex creation failed");
+    return 1;
+  }
+
+  if (SEMAPHORE_CREATE(wf.sem, 0, wf.num_tiles + num_workers + 1) != 0)
+  {
+    MUTEX_LOCK(wf.lock);
+    MUTEX_DESTROY(wf.lock);
+    free(wf.counts);
+    free(wf.ready);
+    _vftasks_abort_on_fail("vftasks_wavefront_2d: semaphore creation failed");
+    return 1;
+  }
+
+  /* count the dependencies of every tile, and start with those that have none */
+  for (tx = 0; tx < wf.num_tiles_x; ++tx)
+    for (ty = 0; ty < wf.num_tiles_y; ++ty)
+    {
+      k = 0;
+      for (ux = tx - wf.max_dx; ux <= tx - wf.min_dx; ++ux)
+        for (uy = ty - wf.max_dy; uy <= ty - wf.min_dy; ++uy)
+          if (ux >= 0 && ux < wf.num_tiles_x && uy >= 0 && uy < wf.num_tiles_y &&
+              vftasks_is_tile_dep(&wf, tx - ux, ty - uy))
+            ++k;
+
+      wf.counts[tx * wf.num_tiles_y + ty] = k;
+      if (k == 0) wf.ready[wf.tail++] = tx * wf.num_tiles_y + ty;
+    }
+
+  /* hand the wavefront to the workers; they wait for the first ready tiles, which
+     are only posted once it is known how many workers take part */
+  num_submitted = 0;
+  while (num_submitted < num_workers &&
+         vftasks_submit(pool, vftasks_run_wavefront, &wf, 0) == 0)
+    ++num_submitted;
+  wf.num_participants = num_submitted + 1;
+  SEMAPHORE_POST_N(wf.sem, wf.tail);
+
+  /* execute the tiles */
+  vftasks_run_wavefront(&wf);
+  for (k = 0; k < num_submitted; ++k)
+    vftasks_get(pool);
+
+  SEMAPHORE_DESTROY(wf.sem);
+  MUTEX_LOCK(wf.lock);
+  MUTEX_DESTROY(wf.lock);
+  free(wf.counts);
+  free(wf.ready);
+
+  /* return 0 to indicate success */
+  return 0;
+}
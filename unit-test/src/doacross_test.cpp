@@ -0,0 +1,225 @@
+#include "doacross_test.h"
+
+extern "C"
+{
+#include "platform.h"
+}
+
+#define NUM_THREADS 4
+#define LOOP_SIZE 1000
+#define NUM_DEPS 3
+
+typedef struct
+{
+  vftasks_doacross_mgr_t *mgr;
+  int index;  /* iteration that the thread waits for */
+} args_t;
+
+typedef struct
+{
+  vftasks_doacross_mgr_t *mgr;
+  int thread;            /* index of the thread */
+  int dynamic;           /* nonzero if iterations are claimed through next */
+  int *next;             /* next iteration to claim */
+  int (*deps)[NUM_DEPS]; /* per iteration, the iterations it depends on */
+  int *data;             /* array of LOOP_SIZE elements */
+} loop_args_t;
+
+static semaphore_t sem;
+static volatile int set = 0;
+
+#define ASSERT_AND_CLEAN(mgr,ref)               \
+  {                                             \
+    CPPUNIT_ASSERT(mgr ref);                    \
+    if (mgr != NULL)                            \
+      vftasks_destroy_doacross_mgr(mgr);        \
+  }
+
+/* Worker function that waits for an iteration and then sets a global.
+ */
+static WORKER_PROTO(waitAndSet, raw_args)
+{
+  args_t *args = (args_t *)raw_args;
+
+  vftasks_wait_doacross(args->mgr, args->index);
+
+  set = 1;
+  SEMAPHORE_POST(sem);
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+/* Execute an iteration of the loop
+ *   for (i = 0; i < LOOP_SIZE; i++)
+ *     for (d = 0; d < NUM_DEPS; d++) data[i] += data[deps[i][d]];
+ */
+static void update(int *data, int (*deps)[NUM_DEPS], int i)
+{
+  int d;
+
+  for (d = 0; d < NUM_DEPS; d++)
+    if (deps[i][d] >= 0) data[i] += data[deps[i][d]];
+}
+
+/* Worker function that executes iterations of the loop, either every NUM_THREADS-th
+ * one or those it claims one by one.
+ */
+static WORKER_PROTO(runLoop, raw_args)
+{
+  loop_args_t *args = (loop_args_t *)raw_args;
+  int i, d;
+
+  i = args->dynamic ? ATOMIC_FETCH_ADD(args->next, 1) : args->thread;
+  while (i < LOOP_SIZE)
+  {
+    for (d = 0; d < NUM_DEPS; d++)
+      vftasks_wait_doacross(args->mgr, args->deps[i][d]);
+    update(args->data, args->deps, i);
+    vftasks_signal_doacross(args->mgr, i);
+
+    i = args->dynamic ? ATOMIC_FETCH_ADD(args->next, 1) : i + NUM_THREADS;
+  }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+DoacrossTest::DoacrossTest()
+{
+  this->sync_mgr = NULL;
+}
+
+void DoacrossTest::setUp()
+{
+}
+
+void DoacrossTest::tearDown()
+{
+  if (this->sync_mgr != NULL)
+    vftasks_destroy_doacross_mgr(this->sync_mgr);
+  this->sync_mgr = NULL;
+}
+
+void DoacrossTest::testCreateManager()
+{
+  this->sync_mgr = vftasks_create_doacross_mgr(LOOP_SIZE);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+}
+
+void DoacrossTest::testCreateManagerBoundaries()
+{
+  vftasks_doacross_mgr_t *sync_mgr;
+
+  sync_mgr = vftasks_create_doacross_mgr(0);
+  ASSERT_AND_CLEAN(sync_mgr, != NULL);
+
+  sync_mgr = vftasks_create_doacross_mgr(1);
+  ASSERT_AND_CLEAN(sync_mgr, != NULL);
+
+  sync_mgr = vftasks_create_doacross_mgr(-1);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+}
+
+void DoacrossTest::testWaitSignal()
+{
+  thread_t thread;
+  args_t args;
+
+  this->sync_mgr = vftasks_create_doacross_mgr(LOOP_SIZE);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+
+  /* iterations outside the iteration space do not have to be waited for */
+  CPPUNIT_ASSERT(vftasks_wait_doacross(this->sync_mgr, -1) == 0);
+  CPPUNIT_ASSERT(vftasks_wait_doacross(this->sync_mgr, LOOP_SIZE) == 0);
+  CPPUNIT_ASSERT(vftasks_signal_doacross(this->sync_mgr, LOOP_SIZE) == 0);
+
+  /* a waiting thread proceeds once the iteration is signalled, irrespective of
+     other iterations */
+  CPPUNIT_ASSERT(SEMAPHORE_CREATE(sem, 0, 1) == 0);
+  set = 0;
+  args.mgr = this->sync_mgr;
+  args.index = 7;
+  CPPUNIT_ASSERT(THREAD_CREATE(thread, waitAndSet, &args) == 0);
+
+  CPPUNIT_ASSERT(vftasks_signal_doacross(this->sync_mgr, 6) == 0);
+  CPPUNIT_ASSERT(vftasks_signal_doacross(this->sync_mgr, 8) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_TIMEDWAIT(sem, 100000000) != 0);
+  CPPUNIT_ASSERT_EQUAL(0, (int)set);
+
+  CPPUNIT_ASSERT(vftasks_signal_doacross(this->sync_mgr, 7) == 0);
+  SEMAPHORE_WAIT(sem);
+  CPPUNIT_ASSERT_EQUAL(1, (int)set);
+
+  THREAD_JOIN(thread);
+  SEMAPHORE_DESTROY(sem);
+}
+
+/* Run a loop with pseudo-random dependency distances over several threads and
+ * compare the result with that of a sequential run.
+ */
+void DoacrossTest::testIrregularLoop(int dynamic, int num_runs)
+{
+  static int data[LOOP_SIZE];
+  static int expected[LOOP_SIZE];
+  static int deps[LOOP_SIZE][NUM_DEPS];
+  loop_args_t args[NUM_THREADS];
+  thread_t threads[NUM_THREADS];
+  unsigned int seed = 12345;
+  int i, d, t, run, next;
+
+  /* every iteration depends on up to NUM_DEPS earlier ones, some of them near and
+     some far; -1 denotes the absence of a dependency */
+  for (i = 0; i < LOOP_SIZE; i++)
+    for (d = 0; d < NUM_DEPS; d++)
+    {
+      seed = seed * 1103515245 + 12345;
+      deps[i][d] = i - 1 - (int)((seed >> 16) % (d == 0 ? 4 : 64));
+      if (deps[i][d] < 0) deps[i][d] = -1;
+    }
+
+  for (i = 0; i < LOOP_SIZE; i++) expected[i] = i % 7;
+  for (i = 0; i < LOOP_SIZE; i++) update(expected, deps, i);
+
+  this->sync_mgr = vftasks_create_doacross_mgr(LOOP_SIZE);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+
+  /* later runs reuse the manager */
+  for (run = 0; run < num_runs; run++)
+  {
+    if (run > 0) CPPUNIT_ASSERT(vftasks_reset_doacross_mgr(this->sync_mgr) == 0);
+
+    for (i = 0; i < LOOP_SIZE; i++) data[i] = i % 7;
+    next = 0;
+
+    for (t = 0; t < NUM_THREADS; t++)
+    {
+      args[t].mgr = this->sync_mgr;
+      args[t].thread = t;
+      args[t].dynamic = dynamic;
+      args[t].next = &next;
+      args[t].deps = deps;
+      args[t].data = data;
+      CPPUNIT_ASSERT(THREAD_CREATE(threads[t], runLoop, &args[t]) == 0);
+    }
+
+    for (t = 0; t < NUM_THREADS; t++) THREAD_JOIN(threads[t]);
+
+    for (i = 0; i < LOOP_SIZE; i++) CPPUNIT_ASSERT_EQUAL(expected[i], data[i]);
+  }
+
+  this->tearDown();
+}
+
+void DoacrossTest::testLoop()
+{
+  this->testIrregularLoop(0);
+  this->testIrregularLoop(1);
+}
+
+void DoacrossTest::testReset()
+{
+  this->testIrregularLoop(0, 3);
+  this->testIrregularLoop(1, 3);
+}
+
+// register fixture
+CPPUNIT_TEST_SUITE_REGISTRATION(DoacrossTest);
@@ -0,0 +1,41 @@
+#ifndef DOACROSS_TEST_H
+#define DOACROSS_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+extern "C"
+{
+#include <vftasks.h>
+}
+
+class DoacrossTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(DoacrossTest);
+
+  CPPUNIT_TEST(testCreateManager);
+  CPPUNIT_TEST(testCreateManagerBoundaries);
+  CPPUNIT_TEST(testWaitSignal);
+  CPPUNIT_TEST(testLoop);
+  CPPUNIT_TEST(testReset);
+
+  CPPUNIT_TEST_SUITE_END(); // DoacrossTest
+
+public:
+  void testCreateManager();
+  void testCreateManagerBoundaries();
+  void testWaitSignal();
+  void testLoop();
+  void testReset();
+
+  DoacrossTest();
+
+  void setUp();
+  void tearDown();
+
+private:
+  void testIrregularLoop(int dynamic, int num_runs = 1);
+
+  vftasks_doacross_mgr_t *sync_mgr;
+};
+
+#endif // DOACROSS_TEST_H
@@ -0,0 +1,118 @@
+#include "eventcounttest.h"
+
+extern "C"
+{
+#include "platform.h"
+}
+
+#define NUM_WAITERS 4
+#define NUM_ROUNDS 1000
+
+typedef struct
+{
+  vftasks_eventcount_t *eventcount;
+  int *counter;  /* counter that is advanced by the notifier */
+  int target;    /* value of the counter to wait for */
+} waiter_args_t;
+
+/* Worker function that waits until a counter has reached a given value.
+ */
+static WORKER_PROTO(waitForCounter, raw_args)
+{
+  waiter_args_t *args = (waiter_args_t *)raw_args;
+  unsigned int key;
+
+  while (ATOMIC_LOAD_ACQUIRE(args->counter) < args->target)
+  {
+    key = vftasks_prepare_wait(args->eventcount);
+    if (ATOMIC_LOAD_ACQUIRE(args->counter) < args->target)
+      vftasks_commit_wait(args->eventcount, key);
+    else
+      vftasks_cancel_wait(args->eventcount, key);
+  }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+void EventcountTest::setUp()
+{
+  this->eventcount = vftasks_create_eventcount();
+  CPPUNIT_ASSERT(this->eventcount != NULL);
+}
+
+void EventcountTest::tearDown()
+{
+  vftasks_destroy_eventcount(this->eventcount);
+}
+
+void EventcountTest::testCancelWait()
+{
+  unsigned int key;
+
+  // notifying without waiters does not advance the epoch
+  key = vftasks_prepare_wait(this->eventcount);
+  vftasks_cancel_wait(this->eventcount, key);
+  vftasks_notify(this->eventcount);
+  CPPUNIT_ASSERT(vftasks_prepare_wait(this->eventcount) == key);
+  vftasks_cancel_wait(this->eventcount, key);
+}
+
+void EventcountTest::testNotifyBeforeCommit()
+{
+  unsigned int key;
+
+  // a notification in between preparing and committing is not lost
+  key = vftasks_prepare_wait(this->eventcount);
+  vftasks_notify(this->eventcount);
+  vftasks_commit_wait(this->eventcount, key);
+
+  // cancelling after a notification is harmless
+  key = vftasks_prepare_wait(this->eventcount);
+  vftasks_notify(this->eventcount);
+  vftasks_cancel_wait(this->eventcount, key);
+  CPPUNIT_ASSERT(vftasks_prepare_wait(this->eventcount) != key);
+}
+
+void EventcountTest::testWaitForPredicate()
+{
+  int counter = 0;
+  waiter_args_t args = { this->eventcount, &counter, NUM_ROUNDS };
+  thread_t thread;
+  int i;
+
+  CPPUNIT_ASSERT(THREAD_CREATE(thread, waitForCounter, &args) == 0);
+
+  for (i = 0; i < NUM_ROUNDS; ++i)
+  {
+    ATOMIC_FETCH_ADD(&counter, 1);
+    vftasks_notify(this->eventcount);
+  }
+
+  THREAD_JOIN(thread);
+  CPPUNIT_ASSERT(ATOMIC_LOAD_ACQUIRE(&counter) == NUM_ROUNDS);
+}
+
+void EventcountTest::testNotifyWakesAll()
+{
+  int counter = 0;
+  waiter_args_t args[NUM_WAITERS];
+  thread_t threads[NUM_WAITERS];
+  int i;
+
+  for (i = 0; i < NUM_WAITERS; ++i)
+  {
+    args[i].eventcount = this->eventcount;
+    args[i].counter = &counter;
+    args[i].target = 1;
+    CPPUNIT_ASSERT(THREAD_CREATE(threads[i], waitForCounter, &args[i]) == 0);
+  }
+
+  // a single notification releases all waiters
+  ATOMIC_STORE_RELEASE(&counter, 1);
+  vftasks_notify(this->eventcount);
+
+  for (i = 0; i < NUM_WAITERS; ++i) THREAD_JOIN(threads[i]);
+}
+
+// register fixture
+CPPUNIT_TEST_SUITE_REGISTRATION(EventcountTest);
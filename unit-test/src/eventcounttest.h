@@ -0,0 +1,35 @@
+#ifndef EVENTCOUNTTEST_H
+#define EVENTCOUNTTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+extern "C"
+{
+#include <vftasks.h>
+}
+
+class EventcountTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(EventcountTest);
+
+  CPPUNIT_TEST(testCancelWait);
+  CPPUNIT_TEST(testNotifyBeforeCommit);
+  CPPUNIT_TEST(testWaitForPredicate);
+  CPPUNIT_TEST(testNotifyWakesAll);
+
+  CPPUNIT_TEST_SUITE_END(); // EventcountTest
+
+public:
+  void testCancelWait();
+  void testNotifyBeforeCommit();
+  void testWaitForPredicate();
+  void testNotifyWakesAll();
+
+  void setUp();
+  void tearDown();
+
+private:
+  vftasks_eventcount_t *eventcount;
+};
+
+#endif // EVENTCOUNTTEST_H
@@ -0,0 +1,638 @@
+#include "mpmc_streamtest.h"
+
+#include <cstdlib>  // for malloc, free
+
+extern "C"
+{
+#include "platform.h"
+}
+
+#define NUM_ITEMS 2000  /* number of items written by every writer */
+#define NUM_TOKENS 8    /* number of tokens of the channels that are shared */
+#define END -1          /* item that tells a reader to stop */
+
+typedef struct
+{
+  vftasks_wport_t *wport;
+  int writer;  /* index of the writer */
+  int run;     /* maximum number of tokens acquired at once */
+} writer_args_t;
+
+typedef struct
+{
+  vftasks_rport_t *rport;
+  int *seen;        /* per item, the number of times it was read */
+  int last[MPMC_MAX_PORTS];  /* per writer, the last item read from it, or -1 */
+  int num_read;     /* number of items read */
+  int in_order;     /* nonzero while items of every writer are read in order */
+  int run;          /* maximum number of tokens acquired at once */
+  int *num_left;    /* number of items that no reader has read yet */
+} reader_args_t;
+
+static int writerSuspendCount;
+static int writerResumeCount;
+static int readerSuspendCount;
+static int readerResumeCount;
+
+
+// hooks for threads that keep trying
+static void yieldWriter(vftasks_wport_t *wport)
+{
+  THREAD_YIELD();
+}
+
+static void yieldReader(vftasks_rport_t *rport)
+{
+  THREAD_YIELD();
+}
+
+static void resumeWriter(vftasks_wport_t *wport)
+{
+}
+
+static void resumeReader(vftasks_rport_t *rport)
+{
+}
+
+// hooks that count, and let suspended threads exit
+static void exitWriter(vftasks_wport_t *wport)
+{
+  ++writerSuspendCount;
+  THREAD_EXIT();
+}
+
+static void countWriterResume(vftasks_wport_t *wport)
+{
+  ++writerResumeCount;
+}
+
+static void exitReader(vftasks_rport_t *rport)
+{
+  ++readerSuspendCount;
+  THREAD_EXIT();
+}
+
+static void countReaderResume(vftasks_rport_t *rport)
+{
+  ++readerResumeCount;
+}
+
+/* Worker function that writes the items of a writer in order.
+ */
+static WORKER_PROTO(writeItems, raw_args)
+{
+  writer_args_t *args = (writer_args_t *)raw_args;
+  vftasks_chan_t *chan = vftasks_chan_of_wport(args->wport);
+  vftasks_token_t *token;
+  int count;
+  int i, k;
+
+  if (args->run == 1)
+  {
+    for (k = 0; k < NUM_ITEMS; k++)
+      vftasks_write_int32(args->wport, args->writer * NUM_ITEMS + k);
+
+    return THREAD_EXIT_SUCCESS;
+  }
+
+  for (k = 0; k < NUM_ITEMS; k += count)
+  {
+    token = vftasks_acquire_room_n(args->wport,
+                                   NUM_ITEMS - k < args->run ? NUM_ITEMS - k : args->run,
+                                   &count);
+    for (i = 0; i < count; i++)
+      vftasks_put_int32(vftasks_token_in_run(chan, token, i), 0,
+                        args->writer * NUM_ITEMS + k + i);
+    vftasks_release_data_n(args->wport, token, count);
+  }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+/* Worker function that reads items until it reads END, and checks that it reads
+ * the items of every writer in the order in which they were written.
+ */
+static WORKER_PROTO(readItems, raw_args)
+{
+  reader_args_t *args = (reader_args_t *)raw_args;
+  vftasks_chan_t *chan = vftasks_chan_of_rport(args->rport);
+  vftasks_token_t *token;
+  int item;
+  int count;
+  int i;
+
+  if (args->run == 1)
+  {
+    while ((item = vftasks_read_int32(args->rport)) != END)
+    {
+      if (item <= args->last[item / NUM_ITEMS]) args->in_order = 0;
+      args->last[item / NUM_ITEMS] = item;
+      args->seen[item]++;
+      args->num_read++;
+    }
+
+    return THREAD_EXIT_SUCCESS;
+  }
+
+  // a run may hold several END items, so readers of runs stop once all items have
+  // been read instead
+  while (ATOMIC_LOAD_ACQUIRE(args->num_left) > 0)
+  {
+    token = vftasks_acquire_data_n_nb(args->rport, args->run, &count);
+    if (token == NULL)
+    {
+      THREAD_YIELD();
+      continue;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+      item = vftasks_get_int32(vftasks_token_in_run(chan, token, i), 0);
+      if (item <= args->last[item / NUM_ITEMS]) args->in_order = 0;
+      args->last[item / NUM_ITEMS] = item;
+      args->seen[item]++;
+      args->num_read++;
+    }
+    vftasks_release_room_n(args->rport, token, count);
+    ATOMIC_FETCH_ADD(args->num_left, -count);
+  }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+/* Worker function that writes a single item.
+ */
+static WORKER_PROTO(writeItem, raw_args)
+{
+  vftasks_write_int32((vftasks_wport_t *)raw_args, 1);
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+/* Worker function that reads a single item.
+ */
+static WORKER_PROTO(readItem, raw_args)
+{
+  vftasks_read_int32((vftasks_rport_t *)raw_args);
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+void MpmcStreamTest::setUp()
+{
+  int k;
+
+  this->mem_mgr.malloc = malloc;
+  this->mem_mgr.free = free;
+
+  this->chan = NULL;
+  for (k = 0; k < MPMC_MAX_PORTS; k++)
+  {
+    this->wports[k] = NULL;
+    this->rports[k] = NULL;
+  }
+
+  writerSuspendCount = 0;
+  writerResumeCount = 0;
+  readerSuspendCount = 0;
+  readerResumeCount = 0;
+}
+
+void MpmcStreamTest::tearDown()
+{
+  int k;
+
+  for (k = 0; k < MPMC_MAX_PORTS; k++)
+  {
+    if (this->wports[k] != NULL)
+      vftasks_destroy_write_port(this->wports[k], &this->mem_mgr);
+    if (this->rports[k] != NULL)
+      vftasks_destroy_read_port(this->rports[k], &this->mem_mgr);
+  }
+
+  if (this->chan != NULL)
+    vftasks_destroy_chan(this->chan, &this->mem_mgr, &this->mem_mgr);
+}
+
+/* Create a channel of a given kind with a number of write and read ports.
+ */
+void MpmcStreamTest::createChan(int num_tokens, int kind, int num_wports, int num_rports)
+{
+  int k;
+
+  this->chan = vftasks_create_chan_with_kind(num_tokens,
+                                             sizeof(int32_t),
+                                             kind,
+                                             &this->mem_mgr,
+                                             &this->mem_mgr);
+  CPPUNIT_ASSERT(this->chan != NULL);
+
+  for (k = 0; k < num_wports; k++)
+  {
+    this->wports[k] = vftasks_create_write_port(this->chan, &this->mem_mgr);
+    CPPUNIT_ASSERT(this->wports[k] != NULL);
+  }
+
+  for (k = 0; k < num_rports; k++)
+  {
+    this->rports[k] = vftasks_create_read_port(this->chan, &this->mem_mgr);
+    CPPUNIT_ASSERT(this->rports[k] != NULL);
+  }
+}
+
+void MpmcStreamTest::testCreation()
+{
+  this->createChan(16, VFTASKS_CHAN_MPMC, 2, 2);
+
+  // verify channel queries
+  CPPUNIT_ASSERT_EQUAL(VFTASKS_CHAN_MPMC, vftasks_get_chan_kind(this->chan));
+  CPPUNIT_ASSERT_EQUAL(16, vftasks_get_num_tokens(this->chan));
+  CPPUNIT_ASSERT(vftasks_get_token_size(this->chan) == 4);
+
+  // verify that every token is published when it is released
+  CPPUNIT_ASSERT_EQUAL(1, vftasks_set_publication_interval(this->chan, 4));
+
+  // verify port queries
+  CPPUNIT_ASSERT(vftasks_chan_of_wport(this->wports[1]) == this->chan);
+  CPPUNIT_ASSERT(vftasks_chan_of_rport(this->rports[1]) == this->chan);
+
+  // a channel created without a kind has a single writer and reader
+  vftasks_chan_t *chan = vftasks_create_chan(16, 4, &this->mem_mgr, &this->mem_mgr);
+  CPPUNIT_ASSERT(chan != NULL);
+  CPPUNIT_ASSERT_EQUAL(VFTASKS_CHAN_SPSC, vftasks_get_chan_kind(chan));
+  vftasks_destroy_chan(chan, &this->mem_mgr, &this->mem_mgr);
+}
+
+void MpmcStreamTest::testCreatingChannelOfInvalidKind()
+{
+  CPPUNIT_ASSERT(vftasks_create_chan_with_kind(16, 4, -1, &this->mem_mgr,
+                                               &this->mem_mgr) == NULL);
+  CPPUNIT_ASSERT(vftasks_create_chan_with_kind(16, 4,
+                                               (VFTASKS_CHAN_MPMC | VFTASKS_CHAN_FLAT) + 1,
+                                               &this->mem_mgr, &this->mem_mgr) == NULL);
+  CPPUNIT_ASSERT(vftasks_create_chan_with_kind(0, 4, VFTASKS_CHAN_MPMC,
+                                               &this->mem_mgr, &this->mem_mgr) == NULL);
+  CPPUNIT_ASSERT(vftasks_create_chan_with_kind((1 << 28) + 1, 4, VFTASKS_CHAN_MPSC,
+                                               &this->mem_mgr, &this->mem_mgr) == NULL);
+}
+
+void MpmcStreamTest::testConnectingMultiplePorts()
+{
+  int kind;
+
+  for (kind = VFTASKS_CHAN_SPSC; kind <= VFTASKS_CHAN_MPMC; kind++)
+  {
+    this->createChan(16, kind, 1, 1);
+
+    // verify that a second port can only be connected to a side with multiple ports
+    this->wports[1] = vftasks_create_write_port(this->chan, &this->mem_mgr);
+    this->rports[1] = vftasks_create_read_port(this->chan, &this->mem_mgr);
+    CPPUNIT_ASSERT((this->wports[1] != NULL) == (kind & VFTASKS_CHAN_MPSC));
+    CPPUNIT_ASSERT((this->rports[1] != NULL) == (kind & VFTASKS_CHAN_SPMC) >> 1);
+
+    this->tearDown();
+    this->setUp();
+  }
+}
+
+void MpmcStreamTest::testPortRenewal()
+{
+  this->createChan(4, VFTASKS_CHAN_MPMC, 3, 3);
+
+  // disconnect the ports in the middle, and connect new ones
+  vftasks_destroy_write_port(this->wports[1], &this->mem_mgr);
+  vftasks_destroy_read_port(this->rports[1], &this->mem_mgr);
+  this->wports[1] = vftasks_create_write_port(this->chan, &this->mem_mgr);
+  this->rports[1] = vftasks_create_read_port(this->chan, &this->mem_mgr);
+  CPPUNIT_ASSERT(this->wports[1] != NULL);
+  CPPUNIT_ASSERT(this->rports[1] != NULL);
+
+  // verify that the marks reach all ports, old and new
+  vftasks_set_min_room(this->chan, 3);
+  vftasks_set_min_data(this->chan, 2);
+  vftasks_write_int32(this->wports[1], 7);
+  vftasks_write_int32(this->wports[2], 8);
+  CPPUNIT_ASSERT_EQUAL(7, (int)vftasks_read_int32(this->rports[0]));
+  CPPUNIT_ASSERT_EQUAL(8, (int)vftasks_read_int32(this->rports[1]));
+}
+
+void MpmcStreamTest::testFifoBehavior()
+{
+  int k;
+
+  this->createChan(4, VFTASKS_CHAN_MPMC, 2, 2);
+
+  // fill the channel through alternating write ports
+  CPPUNIT_ASSERT(!vftasks_data_available(this->rports[0]));
+  for (k = 0; k < 4; k++)
+  {
+    CPPUNIT_ASSERT(vftasks_room_available(this->wports[k % 2]));
+    vftasks_write_int32(this->wports[k % 2], k);
+  }
+
+  // verify that neither write port can acquire room
+  CPPUNIT_ASSERT(!vftasks_room_available(this->wports[0]));
+  CPPUNIT_ASSERT(vftasks_acquire_room_nb(this->wports[0]) == NULL);
+  CPPUNIT_ASSERT(vftasks_acquire_room_nb(this->wports[1]) == NULL);
+
+  // empty the channel through alternating read ports, in FIFO order
+  for (k = 0; k < 4; k++)
+  {
+    CPPUNIT_ASSERT(vftasks_data_available(this->rports[k % 2]));
+    CPPUNIT_ASSERT_EQUAL(k, (int)vftasks_read_int32(this->rports[1 - k % 2]));
+  }
+
+  // verify that neither read port can acquire data
+  CPPUNIT_ASSERT(!vftasks_data_available(this->rports[1]));
+  CPPUNIT_ASSERT(vftasks_acquire_data_nb(this->rports[0]) == NULL);
+  CPPUNIT_ASSERT(vftasks_acquire_data_nb(this->rports[1]) == NULL);
+  CPPUNIT_ASSERT(vftasks_room_available(this->wports[1]));
+}
+
+void MpmcStreamTest::testReleasingOutOfOrder()
+{
+  vftasks_token_t *first, *second;
+
+  this->createChan(2, VFTASKS_CHAN_MPMC, 2, 2);
+
+  // acquire room through both ports, and release the later token first
+  first = vftasks_acquire_room_nb(this->wports[0]);
+  second = vftasks_acquire_room_nb(this->wports[1]);
+  CPPUNIT_ASSERT(first != NULL && second != NULL && first != second);
+  vftasks_put_int32(first, 0, 1);
+  vftasks_put_int32(second, 0, 2);
+  vftasks_release_data(this->wports[1], second);
+
+  // verify that the data is only available once the earlier token is released too
+  CPPUNIT_ASSERT(!vftasks_data_available(this->rports[0]));
+  vftasks_release_data(this->wports[0], first);
+  CPPUNIT_ASSERT(vftasks_data_available(this->rports[0]));
+
+  // acquire data through both ports, and release the later token first
+  first = vftasks_acquire_data_nb(this->rports[1]);
+  second = vftasks_acquire_data_nb(this->rports[0]);
+  CPPUNIT_ASSERT(first != NULL && second != NULL);
+  CPPUNIT_ASSERT_EQUAL(1, (int)vftasks_get_int32(first, 0));
+  CPPUNIT_ASSERT_EQUAL(2, (int)vftasks_get_int32(second, 0));
+  vftasks_release_room(this->rports[0], second);
+
+  // verify that room is only available once the earlier token is released too
+  CPPUNIT_ASSERT(!vftasks_room_available(this->wports[0]));
+  vftasks_release_room(this->rports[1], first);
+  CPPUNIT_ASSERT(vftasks_room_available(this->wports[0]));
+  CPPUNIT_ASSERT(vftasks_acquire_room_nb(this->wports[0]) == first);
+}
+
+void MpmcStreamTest::testTokenReuse()
+{
+  int kind, k;
+
+  // a single token, and a number of tokens that does not divide the positions
+  for (kind = VFTASKS_CHAN_MPSC; kind <= VFTASKS_CHAN_MPMC; kind++)
+  {
+    this->createChan(kind == VFTASKS_CHAN_SPMC ? 1 : 3, kind, 1, 1);
+
+    for (k = 0; k < 100; k++)
+    {
+      vftasks_write_int32(this->wports[0], k);
+      CPPUNIT_ASSERT_EQUAL(k, (int)vftasks_read_int32(this->rports[0]));
+    }
+
+    this->tearDown();
+    this->setUp();
+  }
+}
+
+void MpmcStreamTest::testRuns()
+{
+  vftasks_token_t *first, *second, *token;
+  int count, k;
+
+  this->createChan(8, VFTASKS_CHAN_MPMC, 2, 2);
+
+  // acquire room through both ports; the second run ends at the end of the buffer
+  first = vftasks_acquire_room_n_nb(this->wports[0], 3, &count);
+  CPPUNIT_ASSERT(first != NULL);
+  CPPUNIT_ASSERT_EQUAL(3, count);
+  second = vftasks_acquire_room_n_nb(this->wports[1], 10, &count);
+  CPPUNIT_ASSERT(second == vftasks_token_in_run(this->chan, first, 3));
+  CPPUNIT_ASSERT_EQUAL(5, count);
+  CPPUNIT_ASSERT(vftasks_acquire_room_n_nb(this->wports[0], 1, &count) == NULL);
+  CPPUNIT_ASSERT_EQUAL(0, count);
+
+  // release the later run first, and verify that the data only becomes available
+  // once the earlier run is released too
+  for (k = 0; k < 8; k++)
+    vftasks_put_int32(vftasks_token_in_run(this->chan, first, k), 0, k);
+  vftasks_release_data_n(this->wports[1], second, 5);
+  CPPUNIT_ASSERT(!vftasks_data_available(this->rports[0]));
+  vftasks_release_data_n(this->wports[0], first, 3);
+
+  // acquire the data as a single run, in FIFO order
+  token = vftasks_acquire_data_n_nb(this->rports[1], 8, &count);
+  CPPUNIT_ASSERT(token == first);
+  CPPUNIT_ASSERT_EQUAL(8, count);
+  for (k = 0; k < 8; k++)
+    CPPUNIT_ASSERT_EQUAL(k,
+                         (int)vftasks_get_int32(vftasks_token_in_run(this->chan, token, k),
+                                                0));
+  CPPUNIT_ASSERT(vftasks_acquire_data_n_nb(this->rports[0], 8, &count) == NULL);
+
+  // release part of the run, and verify that only that part can be reacquired
+  vftasks_release_room_n(this->rports[1], token, 2);
+  CPPUNIT_ASSERT(vftasks_acquire_room_n(this->wports[0], 8, &count) == first);
+  CPPUNIT_ASSERT_EQUAL(2, count);
+}
+
+void MpmcStreamTest::testFlatLayout()
+{
+  vftasks_token_t *token;
+  int kind, count, i, k;
+
+  for (kind = VFTASKS_CHAN_SPSC; kind <= VFTASKS_CHAN_MPMC; kind++)
+  {
+    this->createChan(3, kind | VFTASKS_CHAN_FLAT, 1, 1);
+    CPPUNIT_ASSERT_EQUAL(kind | VFTASKS_CHAN_FLAT, vftasks_get_chan_kind(this->chan));
+    CPPUNIT_ASSERT_EQUAL(3, vftasks_get_num_tokens(this->chan));
+
+    // pass single tokens, wrapping around the buffer several times
+    for (k = 0; k < 10; k++)
+    {
+      vftasks_write_int32(this->wports[0], k);
+      CPPUNIT_ASSERT_EQUAL(k, (int)vftasks_read_int32(this->rports[0]));
+    }
+
+    // pass runs, which end at the end of the buffer
+    for (k = 0; k < 30; k += count)
+    {
+      token = vftasks_acquire_room_n(this->wports[0], 3, &count);
+      for (i = 0; i < count; i++)
+        vftasks_put_int32(vftasks_token_in_run(this->chan, token, i), 0, k + i);
+      vftasks_release_data_n(this->wports[0], token, count);
+
+      token = vftasks_acquire_data_n(this->rports[0], count, &i);
+      CPPUNIT_ASSERT_EQUAL(count, i);
+      for (i = 0; i < count; i++)
+        CPPUNIT_ASSERT_EQUAL(k + i,
+                             (int)vftasks_get_int32(
+                               vftasks_token_in_run(this->chan, token, i), 0));
+      vftasks_release_room_n(this->rports[0], token, count);
+    }
+
+    this->tearDown();
+    this->setUp();
+  }
+}
+
+void MpmcStreamTest::testHittingLowWaterMark()
+{
+  this->createChan(4, VFTASKS_CHAN_MPMC, 2, 1);
+  vftasks_install_chan_hooks(this->chan, exitWriter, countWriterResume,
+                             yieldReader, resumeReader);
+
+  // fill the channel, and let another writer be suspended
+  vftasks_set_min_room(this->chan, 2);
+  while (vftasks_room_available(this->wports[0]))
+    vftasks_write_int32(this->wports[0], 0);
+  {
+    thread_t writer;
+    CPPUNIT_ASSERT(THREAD_CREATE(writer, writeItem, this->wports[1]) == 0);
+    THREAD_JOIN(writer);
+  }
+  CPPUNIT_ASSERT_EQUAL(1, writerSuspendCount);
+
+  // verify that the writer is only resumed once there is room for two tokens
+  vftasks_read_int32(this->rports[0]);
+  CPPUNIT_ASSERT_EQUAL(0, writerResumeCount);
+  vftasks_read_int32(this->rports[0]);
+  CPPUNIT_ASSERT_EQUAL(1, writerResumeCount);
+}
+
+void MpmcStreamTest::testHittingHighWaterMark()
+{
+  this->createChan(4, VFTASKS_CHAN_MPSC, 2, 1);
+  vftasks_install_chan_hooks(this->chan, yieldWriter, resumeWriter,
+                             exitReader, countReaderResume);
+
+  // let the reader be suspended
+  vftasks_set_min_data(this->chan, 2);
+  {
+    thread_t reader;
+    CPPUNIT_ASSERT(THREAD_CREATE(reader, readItem, this->rports[0]) == 0);
+    THREAD_JOIN(reader);
+  }
+  CPPUNIT_ASSERT_EQUAL(1, readerSuspendCount);
+
+  // verify that the reader is only resumed once two tokens of data are available
+  vftasks_write_int32(this->wports[0], 0);
+  CPPUNIT_ASSERT_EQUAL(0, readerResumeCount);
+  vftasks_write_int32(this->wports[1], 1);
+  CPPUNIT_ASSERT_EQUAL(1, readerResumeCount);
+
+  // verify that flushing resumes the reader regardless
+  vftasks_flush_data(this->wports[0]);
+  CPPUNIT_ASSERT_EQUAL(2, readerResumeCount);
+}
+
+/* Let a number of writers and readers communicate concurrently through a channel
+ * of a given kind, acquiring runs of up to a given number of tokens, and verify that every item is read exactly once, and that every
+ * reader reads the items of every writer in order.  Suspended threads either yield
+ * or block.
+ */
+void MpmcStreamTest::testConcurrent(int kind, int num_writers, int num_readers, int run,
+                                    bool blocking)
+{
+  static int seen[MPMC_MAX_PORTS * NUM_ITEMS];
+  writer_args_t writer_args[MPMC_MAX_PORTS];
+  reader_args_t reader_args[MPMC_MAX_PORTS];
+  thread_t writers[MPMC_MAX_PORTS];
+  thread_t readers[MPMC_MAX_PORTS];
+  int num_read;
+  int num_left;
+  int i, k;
+
+  this->createChan(NUM_TOKENS, kind, num_writers, num_readers);
+  if (blocking)
+    vftasks_install_default_blocking_hooks(this->chan, 0);
+  else
+    vftasks_install_chan_hooks(this->chan, yieldWriter, resumeWriter,
+                               yieldReader, resumeReader);
+
+  for (i = 0; i < num_writers * NUM_ITEMS; i++) seen[i] = 0;
+  num_left = num_writers * NUM_ITEMS;
+
+  for (k = 0; k < num_readers; k++)
+  {
+    reader_args[k].rport = this->rports[k];
+    reader_args[k].seen = seen;
+    for (i = 0; i < MPMC_MAX_PORTS; i++) reader_args[k].last[i] = -1;
+    reader_args[k].num_read = 0;
+    reader_args[k].in_order = 1;
+    reader_args[k].run = run;
+    reader_args[k].num_left = &num_left;
+    CPPUNIT_ASSERT(THREAD_CREATE(readers[k], readItems, &reader_args[k]) == 0);
+  }
+
+  for (k = 0; k < num_writers; k++)
+  {
+    writer_args[k].wport = this->wports[k];
+    writer_args[k].writer = k;
+    writer_args[k].run = run;
+    CPPUNIT_ASSERT(THREAD_CREATE(writers[k], writeItems, &writer_args[k]) == 0);
+  }
+
+  for (k = 0; k < num_writers; k++) THREAD_JOIN(writers[k]);
+
+  // let every reader stop
+  if (run == 1)
+    for (k = 0; k < num_readers; k++) vftasks_write_int32(this->wports[0], END);
+  for (k = 0; k < num_readers; k++) THREAD_JOIN(readers[k]);
+
+  num_read = 0;
+  for (k = 0; k < num_readers; k++)
+  {
+    CPPUNIT_ASSERT(reader_args[k].in_order);
+    num_read += reader_args[k].num_read;
+  }
+  CPPUNIT_ASSERT_EQUAL(num_writers * NUM_ITEMS, num_read);
+  for (i = 0; i < num_writers * NUM_ITEMS; i++) CPPUNIT_ASSERT_EQUAL(1, seen[i]);
+}
+
+void MpmcStreamTest::testMpsc()
+{
+  this->testConcurrent(VFTASKS_CHAN_MPSC, MPMC_MAX_PORTS, 1);
+}
+
+void MpmcStreamTest::testSpmc()
+{
+  this->testConcurrent(VFTASKS_CHAN_SPMC, 1, MPMC_MAX_PORTS);
+}
+
+void MpmcStreamTest::testMpmc()
+{
+  this->testConcurrent(VFTASKS_CHAN_MPMC, MPMC_MAX_PORTS, MPMC_MAX_PORTS);
+}
+
+void MpmcStreamTest::testSpscRuns()
+{
+  this->testConcurrent(VFTASKS_CHAN_SPSC, 1, 1, 3);
+}
+
+void MpmcStreamTest::testMpmcRuns()
+{
+  this->testConcurrent(VFTASKS_CHAN_MPMC, MPMC_MAX_PORTS, MPMC_MAX_PORTS, 3);
+}
+
+void MpmcStreamTest::testFlatMpmcRuns()
+{
+  this->testConcurrent(VFTASKS_CHAN_MPMC | VFTASKS_CHAN_FLAT,
+                       MPMC_MAX_PORTS, MPMC_MAX_PORTS, 3);
+}
+
+void MpmcStreamTest::testBlockingMpmc()
+{
+  this->testConcurrent(VFTASKS_CHAN_MPMC, MPMC_MAX_PORTS, MPMC_MAX_PORTS, 1, true);
+}
+
+// register fixture
+CPPUNIT_TEST_SUITE_REGISTRATION(MpmcStreamTest);
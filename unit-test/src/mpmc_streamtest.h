@@ -0,0 +1,78 @@
+#ifndef MPMC_STREAMTEST_H
+#define MPMC_STREAMTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+extern "C"
+{
+#include <vftasks.h>
+}
+
+#define MPMC_MAX_PORTS 4
+
+class MpmcStreamTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(MpmcStreamTest);
+
+  CPPUNIT_TEST(testCreation);
+  CPPUNIT_TEST(testCreatingChannelOfInvalidKind);
+  CPPUNIT_TEST(testConnectingMultiplePorts);
+  CPPUNIT_TEST(testPortRenewal);
+
+  CPPUNIT_TEST(testFifoBehavior);
+  CPPUNIT_TEST(testReleasingOutOfOrder);
+  CPPUNIT_TEST(testTokenReuse);
+  CPPUNIT_TEST(testRuns);
+  CPPUNIT_TEST(testFlatLayout);
+
+  CPPUNIT_TEST(testHittingLowWaterMark);
+  CPPUNIT_TEST(testHittingHighWaterMark);
+
+  CPPUNIT_TEST(testMpsc);
+  CPPUNIT_TEST(testSpmc);
+  CPPUNIT_TEST(testMpmc);
+  CPPUNIT_TEST(testSpscRuns);
+  CPPUNIT_TEST(testMpmcRuns);
+  CPPUNIT_TEST(testFlatMpmcRuns);
+  CPPUNIT_TEST(testBlockingMpmc);
+
+  CPPUNIT_TEST_SUITE_END();  // MpmcStreamTest
+
+public:
+  void setUp();
+  void tearDown();
+
+  void testCreation();
+  void testCreatingChannelOfInvalidKind();
+  void testConnectingMultiplePorts();
+  void testPortRenewal();
+
+  void testFifoBehavior();
+  void testReleasingOutOfOrder();
+  void testTokenReuse();
+  void testRuns();
+  void testFlatLayout();
+
+  void testHittingLowWaterMark();
+  void testHittingHighWaterMark();
+
+  void testMpsc();
+  void testSpmc();
+  void testMpmc();
+  void testSpscRuns();
+  void testMpmcRuns();
+  void testFlatMpmcRuns();
+  void testBlockingMpmc();
+
+private:
+  void createChan(int num_tokens, int kind, int num_wports, int num_rports);
+  void testConcurrent(int kind, int num_writers, int num_readers, int run = 1,
+                      bool blocking = false);
+
+  vftasks_malloc_t mem_mgr;
+  vftasks_chan_t *chan;
+  vftasks_wport_t *wports[MPMC_MAX_PORTS];
+  vftasks_rport_t *rports[MPMC_MAX_PORTS];
+};
+
+#endif // MPMC_STREAMTEST_H
@@ -0,0 +1,181 @@
+#include "ordered_test.h"
+
+extern "C"
+{
+#include "platform.h"
+}
+
+#define NUM_THREADS 4
+#define LOOP_SIZE 1000
+
+typedef struct
+{
+  vftasks_ordered_t *ordered;
+  int index;  /* iteration in which the thread enters the section */
+} args_t;
+
+typedef struct
+{
+  vftasks_ordered_t *ordered;
+  int thread;    /* index of the thread */
+  int dynamic;   /* nonzero if iterations are claimed through next */
+  int *next;     /* next iteration to claim */
+  int *output;   /* array of LOOP_SIZE elements that iterations append to */
+  int *length;   /* number of elements appended */
+} loop_args_t;
+
+static semaphore_t sem;
+static volatile int set = 0;
+
+/* Worker function that enters the section in a given iteration and then sets a
+ * global.
+ */
+static WORKER_PROTO(beginAndSet, raw_args)
+{
+  args_t *args = (args_t *)raw_args;
+
+  vftasks_ordered_begin(args->ordered, args->index);
+
+  set = 1;
+  SEMAPHORE_POST(sem);
+
+  vftasks_ordered_end(args->ordered, args->index);
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+/* Worker function that executes iterations of a loop that appends the index of
+ * every iteration in which it is odd to an output array, either every NUM_THREADS-th
+ * iteration or those it claims one by one.
+ */
+static WORKER_PROTO(runLoop, raw_args)
+{
+  loop_args_t *args = (loop_args_t *)raw_args;
+  int i;
+
+  i = args->dynamic ? ATOMIC_FETCH_ADD(args->next, 1) : args->thread;
+  while (i < LOOP_SIZE)
+  {
+    vftasks_ordered_begin(args->ordered, i);
+    if (i % 2 == 1) args->output[(*args->length)++] = i;
+    vftasks_ordered_end(args->ordered, i);
+
+    i = args->dynamic ? ATOMIC_FETCH_ADD(args->next, 1) : i + NUM_THREADS;
+  }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+OrderedTest::OrderedTest()
+{
+  this->ordered = NULL;
+}
+
+void OrderedTest::setUp()
+{
+}
+
+void OrderedTest::tearDown()
+{
+  if (this->ordered != NULL)
+    vftasks_destroy_ordered(this->ordered);
+  this->ordered = NULL;
+}
+
+void OrderedTest::testCreate()
+{
+  this->ordered = vftasks_create_ordered();
+  CPPUNIT_ASSERT(this->ordered != NULL);
+}
+
+void OrderedTest::testBeginEnd()
+{
+  thread_t thread;
+  args_t args;
+
+  this->ordered = vftasks_create_ordered();
+  CPPUNIT_ASSERT(this->ordered != NULL);
+
+  /* in turn, the section is entered right away */
+  CPPUNIT_ASSERT(vftasks_ordered_begin(this->ordered, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_ordered_end(this->ordered, 0) == 0);
+
+  /* iteration 2 has to wait for iteration 1 */
+  CPPUNIT_ASSERT(SEMAPHORE_CREATE(sem, 0, 1) == 0);
+  set = 0;
+  args.ordered = this->ordered;
+  args.index = 2;
+  CPPUNIT_ASSERT(THREAD_CREATE(thread, beginAndSet, &args) == 0);
+
+  CPPUNIT_ASSERT(vftasks_ordered_begin(this->ordered, 1) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_TIMEDWAIT(sem, 100000000) != 0);
+  CPPUNIT_ASSERT_EQUAL(0, (int)set);
+
+  CPPUNIT_ASSERT(vftasks_ordered_end(this->ordered, 1) == 0);
+  SEMAPHORE_WAIT(sem);
+  CPPUNIT_ASSERT_EQUAL(1, (int)set);
+
+  THREAD_JOIN(thread);
+  SEMAPHORE_DESTROY(sem);
+
+  /* after a reset, it is iteration 0's turn again */
+  CPPUNIT_ASSERT(vftasks_reset_ordered(this->ordered) == 0);
+  CPPUNIT_ASSERT(vftasks_ordered_begin(this->ordered, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_ordered_end(this->ordered, 0) == 0);
+}
+
+/* Run a loop that appends to an output array in an ordered section over several
+ * threads and check that the output is in iteration order.
+ */
+void OrderedTest::testAppend(int dynamic, int num_runs)
+{
+  static int output[LOOP_SIZE];
+  loop_args_t args[NUM_THREADS];
+  thread_t threads[NUM_THREADS];
+  int i, t, run, next, length;
+
+  this->ordered = vftasks_create_ordered();
+  CPPUNIT_ASSERT(this->ordered != NULL);
+
+  /* later runs reuse the section */
+  for (run = 0; run < num_runs; run++)
+  {
+    if (run > 0) CPPUNIT_ASSERT(vftasks_reset_ordered(this->ordered) == 0);
+
+    next = 0;
+    length = 0;
+
+    for (t = 0; t < NUM_THREADS; t++)
+    {
+      args[t].ordered = this->ordered;
+      args[t].thread = t;
+      args[t].dynamic = dynamic;
+      args[t].next = &next;
+      args[t].output = output;
+      args[t].length = &length;
+      CPPUNIT_ASSERT(THREAD_CREATE(threads[t], runLoop, &args[t]) == 0);
+    }
+
+    for (t = 0; t < NUM_THREADS; t++) THREAD_JOIN(threads[t]);
+
+    CPPUNIT_ASSERT_EQUAL(LOOP_SIZE / 2, length);
+    for (i = 0; i < length; i++) CPPUNIT_ASSERT_EQUAL(2 * i + 1, output[i]);
+  }
+
+  this->tearDown();
+}
+
+void OrderedTest::testLoop()
+{
+  this->testAppend(0);
+  this->testAppend(1);
+}
+
+void OrderedTest::testReset()
+{
+  this->testAppend(0, 3);
+  this->testAppend(1, 3);
+}
+
+// register fixture
+CPPUNIT_TEST_SUITE_REGISTRATION(OrderedTest);
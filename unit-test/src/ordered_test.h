@@ -0,0 +1,39 @@
+#ifndef ORDERED_TEST_H
+#define ORDERED_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+extern "C"
+{
+#include <vftasks.h>
+}
+
+class OrderedTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(OrderedTest);
+
+  CPPUNIT_TEST(testCreate);
+  CPPUNIT_TEST(testBeginEnd);
+  CPPUNIT_TEST(testLoop);
+  CPPUNIT_TEST(testReset);
+
+  CPPUNIT_TEST_SUITE_END(); // OrderedTest
+
+public:
+  void testCreate();
+  void testBeginEnd();
+  void testLoop();
+  void testReset();
+
+  OrderedTest();
+
+  void setUp();
+  void tearDown();
+
+private:
+  void testAppend(int dynamic, int num_runs = 1);
+
+  vftasks_ordered_t *ordered;
+};
+
+#endif // ORDERED_TEST_H
@@ -0,0 +1,160 @@
+#include "semaphoretest.h"
+
+#define NUM_WAITERS 3
+
+typedef struct
+{
+  semaphore_t *sem;
+  int units;  /* number of units to wait for */
+  int done;   /* set once the units have been taken */
+} waiter_args_t;
+
+/* Worker function that takes a number of units from a semaphore.
+ */
+static WORKER_PROTO(waitN, raw_args)
+{
+  waiter_args_t *args = (waiter_args_t *)raw_args;
+
+  SEMAPHORE_WAIT_N(*args->sem, args->units);
+  ATOMIC_STORE_RELEASE(&args->done, 1);
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+/* spin for a given number of nanoseconds */
+static void spin(uint64_t duration_ns)
+{
+  uint64_t start;
+
+  vftasks_timer_start(&start);
+  while (vftasks_timer_stop(&start) < duration_ns);
+}
+
+void SemaphoreTest::setUp()
+{
+  CPPUNIT_ASSERT(SEMAPHORE_CREATE(this->sem, 0, 16) == 0);
+}
+
+void SemaphoreTest::tearDown()
+{
+  SEMAPHORE_DESTROY(this->sem);
+}
+
+void SemaphoreTest::testPostNWaitN()
+{
+  CPPUNIT_ASSERT(SEMAPHORE_POST_N(this->sem, 5) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_WAIT_N(this->sem, 3) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_WAIT_N(this->sem, 2) == 0);
+
+  // all units have been taken
+  CPPUNIT_ASSERT(SEMAPHORE_TIMEDWAIT(this->sem, 1000000) != 0);
+}
+
+void SemaphoreTest::testWaitNBlocks()
+{
+  waiter_args_t args = { &this->sem, 3, 0 };
+  thread_t thread;
+
+  CPPUNIT_ASSERT(THREAD_CREATE(thread, waitN, &args) == 0);
+
+  // the waiter only proceeds once all units have been posted
+  CPPUNIT_ASSERT(SEMAPHORE_POST(this->sem) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_POST_N(this->sem, 1) == 0);
+  spin(10000000);
+  CPPUNIT_ASSERT(ATOMIC_LOAD_ACQUIRE(&args.done) == 0);
+
+  CPPUNIT_ASSERT(SEMAPHORE_POST(this->sem) == 0);
+  THREAD_JOIN(thread);
+  CPPUNIT_ASSERT(ATOMIC_LOAD_ACQUIRE(&args.done) == 1);
+}
+
+void SemaphoreTest::testPostNWakesWaiters()
+{
+  waiter_args_t args[NUM_WAITERS];
+  thread_t threads[NUM_WAITERS];
+  int i;
+
+  for (i = 0; i < NUM_WAITERS; ++i)
+  {
+    args[i].sem = &this->sem;
+    args[i].units = 1;
+    args[i].done = 0;
+    CPPUNIT_ASSERT(THREAD_CREATE(threads[i], waitN, &args[i]) == 0);
+  }
+
+  // a single post releases all waiters
+  spin(10000000);
+  CPPUNIT_ASSERT(SEMAPHORE_POST_N(this->sem, NUM_WAITERS) == 0);
+
+  for (i = 0; i < NUM_WAITERS; ++i)
+  {
+    THREAD_JOIN(threads[i]);
+    CPPUNIT_ASSERT(ATOMIC_LOAD_ACQUIRE(&args[i].done) == 1);
+  }
+}
+
+void SemaphoreTest::testWaitNTwoWaiters()
+{
+  waiter_args_t args[2];
+  thread_t threads[2];
+  int i;
+
+  for (i = 0; i < 2; ++i)
+  {
+    args[i].sem = &this->sem;
+    args[i].units = 2;
+    args[i].done = 0;
+    CPPUNIT_ASSERT(THREAD_CREATE(threads[i], waitN, &args[i]) == 0);
+  }
+
+  // the units go to one waiter as a whole, rather than one to each
+  spin(10000000);
+  CPPUNIT_ASSERT(SEMAPHORE_POST_N(this->sem, 2) == 0);
+  spin(10000000);
+  CPPUNIT_ASSERT(ATOMIC_LOAD_ACQUIRE(&args[0].done) +
+                 ATOMIC_LOAD_ACQUIRE(&args[1].done) == 1);
+
+  // the same holds for units posted one at a time
+  CPPUNIT_ASSERT(SEMAPHORE_POST(this->sem) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_POST(this->sem) == 0);
+
+  for (i = 0; i < 2; ++i)
+  {
+    THREAD_JOIN(threads[i]);
+    CPPUNIT_ASSERT(ATOMIC_LOAD_ACQUIRE(&args[i].done) == 1);
+  }
+
+  // all units have been taken
+  CPPUNIT_ASSERT(SEMAPHORE_TIMEDWAIT(this->sem, 1000000) != 0);
+}
+
+void SemaphoreTest::testTimedWait()
+{
+  CPPUNIT_ASSERT(SEMAPHORE_TIMEDWAIT(this->sem, 1000000) != 0);
+
+  // a timed-out wait does not take a unit posted later on
+  CPPUNIT_ASSERT(SEMAPHORE_POST(this->sem) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_TIMEDWAIT(this->sem, 1000000) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_TIMEDWAIT(this->sem, 1000000) != 0);
+}
+
+void SemaphoreTest::testTryWait()
+{
+  CPPUNIT_ASSERT(SEMAPHORE_TRYWAIT(this->sem) != 0);
+  CPPUNIT_ASSERT_EQUAL(0, SEMAPHORE_TRYWAIT_N(this->sem, 4));
+
+  // at most the available units are taken
+  CPPUNIT_ASSERT(SEMAPHORE_POST_N(this->sem, 5) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_TRYWAIT(this->sem) == 0);
+  CPPUNIT_ASSERT_EQUAL(3, SEMAPHORE_TRYWAIT_N(this->sem, 3));
+  CPPUNIT_ASSERT_EQUAL(1, SEMAPHORE_TRYWAIT_N(this->sem, 3));
+  CPPUNIT_ASSERT(SEMAPHORE_TRYWAIT(this->sem) != 0);
+
+  // a timed-out wait leaves no shortage behind that would hide a posted unit
+  CPPUNIT_ASSERT(SEMAPHORE_TIMEDWAIT(this->sem, 1000000) != 0);
+  CPPUNIT_ASSERT(SEMAPHORE_POST(this->sem) == 0);
+  CPPUNIT_ASSERT_EQUAL(1, SEMAPHORE_TRYWAIT_N(this->sem, 2));
+}
+
+// register fixture
+CPPUNIT_TEST_SUITE_REGISTRATION(SemaphoreTest);
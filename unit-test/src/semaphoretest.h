@@ -0,0 +1,39 @@
+#ifndef SEMAPHORETEST_H
+#define SEMAPHORETEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+extern "C"
+{
+#include "platform.h"
+}
+
+class SemaphoreTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(SemaphoreTest);
+
+  CPPUNIT_TEST(testPostNWaitN);
+  CPPUNIT_TEST(testWaitNBlocks);
+  CPPUNIT_TEST(testPostNWakesWaiters);
+  CPPUNIT_TEST(testWaitNTwoWaiters);
+  CPPUNIT_TEST(testTimedWait);
+  CPPUNIT_TEST(testTryWait);
+
+  CPPUNIT_TEST_SUITE_END(); // SemaphoreTest
+
+public:
+  void testPostNWaitN();
+  void testWaitNBlocks();
+  void testPostNWakesWaiters();
+  void testWaitNTwoWaiters();
+  void testTimedWait();
+  void testTryWait();
+
+  void setUp();
+  void tearDown();
+
+private:
+  semaphore_t sem;
+};
+
+#endif // SEMAPHORETEST_H
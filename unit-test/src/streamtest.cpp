@@ -379,6 +379,32 @@ void StreamTest::testSettingHighWaterMarkWayTooHigh()
   CPPUNIT_ASSERT(vftasks_get_min_data(this->chan) == 1);
 }
 
+void StreamTest::testInitialPublicationInterval()
+{
+  CREATE_CHAN(16, 8);
+
+  // verify that initially every token is published when it is released
+  CPPUNIT_ASSERT(vftasks_get_publication_interval(this->chan) == 1);
+}
+
+void StreamTest::testSettingPublicationInterval()
+{
+  CREATE_CHAN(16, 8);
+
+  // set the publication interval and verify that it's updated
+  CPPUNIT_ASSERT(vftasks_set_publication_interval(this->chan, 16) == 16);
+  CPPUNIT_ASSERT(vftasks_get_publication_interval(this->chan) == 16);
+}
+
+void StreamTest::testSettingPublicationIntervalTooHigh()
+{
+  CREATE_CHAN(16, 8);
+
+  // set the publication interval too high and verify that it's not updated
+  CPPUNIT_ASSERT(vftasks_set_publication_interval(this->chan, 17) == 1);
+  CPPUNIT_ASSERT(vftasks_get_publication_interval(this->chan) == 1);
+}
+
 void StreamTest::testInitialApplicationSpecificData()
 {
   CREATE_CHAN(16, 8);
@@ -871,6 +897,134 @@ void StreamTest::testAcquiringDataAfterFillingAndEmptying()
   CPPUNIT_ASSERT(token == NULL);
 }
 
+void StreamTest::testAcquiringRoomRuns()
+{
+  vftasks_token_t *first, *second;  // pointers to the first tokens of runs
+  int count;                        // number of tokens in a run
+
+  CREATE_CHAN(16, 8) WITH_WPORT WITH_RPORT;
+
+  // acquire a run of room
+  first = vftasks_acquire_room_n_nb(this->wport, 10, &count);
+  CPPUNIT_ASSERT(first != NULL);
+  CPPUNIT_ASSERT(count == 10);
+
+  // acquire another run; only the rest of the room is available
+  second = vftasks_acquire_room_n_nb(this->wport, 10, &count);
+  CPPUNIT_ASSERT(second == vftasks_token_in_run(this->chan, first, 10));
+  CPPUNIT_ASSERT(count == 6);
+
+  // try to acquire room and verify that it failed
+  CPPUNIT_ASSERT(vftasks_acquire_room_n_nb(this->wport, 1, &count) == NULL);
+  CPPUNIT_ASSERT(count == 0);
+
+  // release both runs at once, and read them in FIFO order
+  for (int i = 0; i < 16; ++i)
+    vftasks_put_int32(vftasks_token_in_run(this->chan, first, i), 0, i);
+  vftasks_release_data_n(this->wport, first, 16);
+  for (int j = 0; j < 16; ++j)
+    CPPUNIT_ASSERT(vftasks_read_int32(this->rport) == j);
+}
+
+void StreamTest::testAcquiringDataRuns()
+{
+  vftasks_token_t *token;  // pointer to the first token of a run
+  int count;               // number of tokens in a run
+  int total;               // number of tokens written or read
+
+  CREATE_CHAN(16, 8) WITH_WPORT WITH_RPORT;
+
+  // move the pointers close to the end of the buffer
+  for (int i = 0; i < 12; ++i) vftasks_write_int32(this->wport, i);
+  for (int j = 0; j < 12; ++j) vftasks_read_int32(this->rport);
+
+  // write runs up to the end of the buffer, and beyond
+  for (total = 0; total < 10; total += count)
+  {
+    token = vftasks_acquire_room_n_nb(this->wport, 10 - total, &count);
+    CPPUNIT_ASSERT(token != NULL);
+    CPPUNIT_ASSERT(count == 5);
+    for (int i = 0; i < count; ++i)
+      vftasks_put_int32(vftasks_token_in_run(this->chan, token, i), 0, total + i);
+    vftasks_release_data_n(this->wport, token, count);
+  }
+
+  // read runs in FIFO order; the first one ends at the end of the buffer
+  token = vftasks_acquire_data_n_nb(this->rport, 16, &count);
+  CPPUNIT_ASSERT(token != NULL);
+  CPPUNIT_ASSERT(count == 5);
+  for (int j = 0; j < count; ++j)
+    CPPUNIT_ASSERT(vftasks_get_int32(vftasks_token_in_run(this->chan, token, j), 0) == j);
+  vftasks_release_room_n(this->rport, token, count);
+
+  token = vftasks_acquire_data_n(this->rport, 16, &count);
+  CPPUNIT_ASSERT(count == 5);
+  for (int j = 0; j < count; ++j)
+    CPPUNIT_ASSERT(vftasks_get_int32(vftasks_token_in_run(this->chan, token, j), 0) ==
+                   5 + j);
+  vftasks_release_room_n(this->rport, token, count);
+
+  // try to acquire data and verify that it failed
+  CPPUNIT_ASSERT(vftasks_acquire_data_n_nb(this->rport, 1, &count) == NULL);
+  CPPUNIT_ASSERT(count == 0);
+}
+
+void StreamTest::testDeferringPublication()
+{
+  CREATE_CHAN(16, 8) WITH_WPORT WITH_RPORT;
+
+  // publish once per four tokens
+  vftasks_set_publication_interval(this->chan, 4);
+
+  // write three tokens and verify that no data is available yet
+  for (int i = 0; i < 3; ++i) vftasks_write_int32(this->wport, i);
+  CPPUNIT_ASSERT(!vftasks_data_available(this->rport));
+
+  // write a fourth token and verify that all four are available
+  vftasks_write_int32(this->wport, 3);
+  for (int j = 0; j < 4; ++j)
+    CPPUNIT_ASSERT(vftasks_read_int32(this->rport) == j);
+  CPPUNIT_ASSERT(!vftasks_data_available(this->rport));
+}
+
+void StreamTest::testPublishingWhenFull()
+{
+  int count;  // number of tokens in a run
+
+  CREATE_CHAN(8, 8) WITH_WPORT WITH_RPORT;
+
+  // publish once per five tokens
+  vftasks_set_publication_interval(this->chan, 5);
+
+  // fill the channel and verify that only the first five tokens are available
+  for (int i = 0; i < 8; ++i) vftasks_write_int32(this->wport, i);
+  CPPUNIT_ASSERT(vftasks_acquire_data_n_nb(this->rport, 8, &count) != NULL);
+  CPPUNIT_ASSERT(count == 5);
+
+  // try to acquire room and verify that it failed, publishing the other tokens
+  CPPUNIT_ASSERT(vftasks_acquire_room_nb(this->wport) == NULL);
+  CPPUNIT_ASSERT(vftasks_acquire_data_n_nb(this->rport, 8, &count) != NULL);
+  CPPUNIT_ASSERT(count == 3);
+}
+
+void StreamTest::testFlushingDeferredData()
+{
+  CREATE_CHAN(16, 8) WITH_WPORT WITH_RPORT;
+
+  // publish once per four tokens
+  vftasks_set_publication_interval(this->chan, 4);
+
+  // write two tokens and verify that no data is available yet
+  vftasks_write_int32(this->wport, 2);
+  vftasks_write_int32(this->wport, 3);
+  CPPUNIT_ASSERT(!vftasks_data_available(this->rport));
+
+  // flush and verify that both tokens are available
+  vftasks_flush_data(this->wport);
+  CPPUNIT_ASSERT(vftasks_read_int32(this->rport) == 2);
+  CPPUNIT_ASSERT(vftasks_read_int32(this->rport) == 3);
+}
+
 void StreamTest::testSharedMemorySupport()
 {
   CREATE_CHAN(16, 8);
@@ -1715,5 +1869,222 @@ void StreamTest::testPassingHighWaterMark()
   CPPUNIT_ASSERT(flag);
 }
 
+static WORKER_PROTO(testPassingLowWaterMarkWithRun_write, arg)
+{
+  WPORT_FROM_VOID(wport, arg);
+
+  // fill the channel
+  for (int i = 0; i < 16; ++i) vftasks_write_int32(wport, i);
+
+  // try to write another token; this should cause the writer to be suspended
+  vftasks_write_int32(wport, 17);
+
+  // exit writer thread
+  return THREAD_EXIT_SUCCESS;
+}
+
+static void testPassingLowWaterMarkWithRun_suspendWriter(vftasks_wport_t *wport)
+{
+  // exit writer thread
+  THREAD_EXIT();
+}
+
+static void testPassingLowWaterMarkWithRun_resumeWriter(vftasks_wport_t *wport)
+{
+  // set flag
+  *(bool *)vftasks_get_chan_info(vftasks_chan_of_wport(wport)) = true;
+}
+
+void StreamTest::testPassingLowWaterMarkWithRun()
+{
+  bool flag;               // flag
+  vftasks_token_t *token;  // pointer to the first token of a run
+  int count;               // number of tokens in the run
+
+  CREATE_CHAN(16, 8) WITH_WPORT WITH_RPORT;
+
+  // set low-water mark
+  vftasks_set_min_room(this->chan, 6);
+
+  // install channel hooks
+  vftasks_install_chan_hooks(this->chan,
+                             testPassingLowWaterMarkWithRun_suspendWriter,
+                             testPassingLowWaterMarkWithRun_resumeWriter,
+                             suspendReader,
+                             resumeReader);
+
+  // initialize flag and add it to the channel
+  flag = false;
+  vftasks_set_chan_info(this->chan, &flag);
+
+  EXEC_ON_WORKER_THREAD(testPassingLowWaterMarkWithRun_write, this->wport);
+
+  // read a run of tokens
+  token = vftasks_acquire_data_n(this->rport, 8, &count);
+  CPPUNIT_ASSERT(count == 8);
+
+  // verify that writer hasn't resumed yet
+  CPPUNIT_ASSERT(!flag);
+
+  // release the run at once, moving the head past the low-water mark; this should
+  // cause the writer to resume
+  vftasks_release_room_n(this->rport, token, count);
+
+  // verify that writer has resumed
+  CPPUNIT_ASSERT(flag);
+}
+
+static WORKER_PROTO(testPassingHighWaterMarkWithRun_read, arg)
+{
+  RPORT_FROM_VOID(rport, arg);
+
+  // try to read a token; this should cause the reader to be suspended
+  vftasks_read_int32(rport);
+
+  // exit reader thread
+  return THREAD_EXIT_SUCCESS;
+}
+
+static void testPassingHighWaterMarkWithRun_suspendReader(vftasks_rport_t *rport)
+{
+  // exit reader thread
+  THREAD_EXIT();
+}
+
+static void testPassingHighWaterMarkWithRun_resumeReader(vftasks_rport_t *rport)
+{
+  // set flag
+  *(bool *)vftasks_get_chan_info(vftasks_chan_of_rport(rport)) = true;
+}
+
+void StreamTest::testPassingHighWaterMarkWithRun()
+{
+  bool flag;               // flag
+  vftasks_token_t *token;  // pointer to the first token of a run
+  int count;               // number of tokens in the run
+
+  CREATE_CHAN(16, 8) WITH_WPORT WITH_RPORT;
+
+  // set high-water mark
+  vftasks_set_min_data(this->chan, 6);
+
+  // install channel hooks
+  vftasks_install_chan_hooks(this->chan,
+                             suspendWriter,
+                             resumeWriter,
+                             testPassingHighWaterMarkWithRun_suspendReader,
+                             testPassingHighWaterMarkWithRun_resumeReader);
+
+  // initialize flag and add it to the channel
+  flag = false;
+  vftasks_set_chan_info(this->chan, &flag);
+
+  EXEC_ON_WORKER_THREAD(testPassingHighWaterMarkWithRun_read, this->rport);
+
+  // write a run of tokens
+  token = vftasks_acquire_room_n(this->wport, 8, &count);
+  CPPUNIT_ASSERT(count == 8);
+  for (int i = 0; i < count; ++i)
+    vftasks_put_int32(vftasks_token_in_run(this->chan, token, i), 0, i);
+
+  // verify that reader hasn't resumed yet
+  CPPUNIT_ASSERT(!flag);
+
+  // release the run at once, moving the tail past the high-water mark; this should
+  // cause the reader to resume
+  vftasks_release_data_n(this->wport, token, count);
+
+  // verify that reader has resumed
+  CPPUNIT_ASSERT(flag);
+}
+
+#define NUM_BLOCKING_ITEMS 10000  // number of items passed with the blocking hooks
+
+static WORKER_PROTO(passItemsWithBlockingHooks_write, arg)
+{
+  WPORT_FROM_VOID(wport, arg);
+
+  // write the items; the writer blocks whenever the channel is full
+  for (int i = 0; i < NUM_BLOCKING_ITEMS; ++i) vftasks_write_int32(wport, i);
+
+  // resume the reader for the last items, which may not reach the high-water mark
+  vftasks_flush_data(wport);
+
+  // exit writer thread
+  return THREAD_EXIT_SUCCESS;
+}
+
+/* Pass items from a writer thread to the reader through a small channel with the
+ * blocking hooks, so that either side blocks time and again, and verify that all
+ * items arrive in order.
+ */
+void StreamTest::passItemsWithBlockingHooks(int spin_limit)
+{
+  thread_t writer;  // writer thread
+
+  CREATE_CHAN(4, 8) WITH_WPORT WITH_RPORT;
+
+  // set low- and high-water marks, and install the blocking hooks
+  vftasks_set_min_room(this->chan, 2);
+  vftasks_set_min_data(this->chan, 3);
+  vftasks_install_default_blocking_hooks(this->chan, spin_limit);
+
+  CPPUNIT_ASSERT(THREAD_CREATE(writer, passItemsWithBlockingHooks_write,
+                               this->wport) == 0);
+
+  // read the items; the reader blocks whenever the channel is empty
+  for (int i = 0; i < NUM_BLOCKING_ITEMS; ++i)
+    CPPUNIT_ASSERT_EQUAL(i, (int)vftasks_read_int32(this->rport));
+
+  THREAD_JOIN(writer);
+}
+
+void StreamTest::testBlockingHooks()
+{
+  this->passItemsWithBlockingHooks(0);
+}
+
+void StreamTest::testSpinningBeforeBlocking()
+{
+  this->passItemsWithBlockingHooks(100);
+}
+
+static WORKER_PROTO(testResumingBlockedReaderByFlushing_read, arg)
+{
+  RPORT_FROM_VOID(rport, arg);
+
+  // read a token; this should cause the reader to block until it is resumed
+  vftasks_read_int32(rport);
+
+  // exit reader thread
+  return THREAD_EXIT_SUCCESS;
+}
+
+void StreamTest::testResumingBlockedReaderByFlushing()
+{
+  thread_t reader;  // reader thread
+
+  CREATE_CHAN(16, 8) WITH_WPORT WITH_RPORT;
+
+  // set high-water mark, defer the publication of tokens, and install the
+  // blocking hooks
+  vftasks_set_min_data(this->chan, 8);
+  vftasks_set_publication_interval(this->chan, 8);
+  vftasks_install_default_blocking_hooks(this->chan, 0);
+
+  CPPUNIT_ASSERT(THREAD_CREATE(reader, testResumingBlockedReaderByFlushing_read,
+                               this->rport) == 0);
+
+  // give the reader the opportunity to block; the written token is not published
+  // until the flush, so the reader blocks even if it starts late
+  for (int i = 0; i < 100; ++i) THREAD_YIELD();
+
+  // write a single token, below the high-water mark, and flush it; the join only
+  // returns once the flush has published the token and resumed the reader
+  vftasks_write_int32(this->wport, 1);
+  vftasks_flush_data(this->wport);
+  THREAD_JOIN(reader);
+}
+
 // register fixture
 CPPUNIT_TEST_SUITE_REGISTRATION(StreamTest);
@@ -38,6 +38,9 @@ class StreamTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testMaximizingHighWaterMark);
   CPPUNIT_TEST(testSettingHighWaterMarkTooHigh);
   CPPUNIT_TEST(testSettingHighWaterMarkWayTooHigh);
+  CPPUNIT_TEST(testInitialPublicationInterval);
+  CPPUNIT_TEST(testSettingPublicationInterval);
+  CPPUNIT_TEST(testSettingPublicationIntervalTooHigh);
 
   CPPUNIT_TEST(testInitialApplicationSpecificData);
   CPPUNIT_TEST(testSettingApplicationSpecificData);
@@ -74,6 +77,11 @@ class StreamTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testAcquiringDataAfterFillingAndReading);
   CPPUNIT_TEST(testAcquiringDataAfterWritingAndEmptying);
   CPPUNIT_TEST(testAcquiringDataAfterFillingAndEmptying);
+  CPPUNIT_TEST(testAcquiringRoomRuns);
+  CPPUNIT_TEST(testAcquiringDataRuns);
+  CPPUNIT_TEST(testDeferringPublication);
+  CPPUNIT_TEST(testPublishingWhenFull);
+  CPPUNIT_TEST(testFlushingDeferredData);
 
   CPPUNIT_TEST(testSharedMemorySupport);
   CPPUNIT_TEST(testSharedMemoryMode);
@@ -99,6 +107,12 @@ class StreamTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testPassingLowWaterMark);
   CPPUNIT_TEST(testHittingHighWaterMark);
   CPPUNIT_TEST(testPassingHighWaterMark);
+  CPPUNIT_TEST(testPassingLowWaterMarkWithRun);
+  CPPUNIT_TEST(testPassingHighWaterMarkWithRun);
+
+  CPPUNIT_TEST(testBlockingHooks);
+  CPPUNIT_TEST(testSpinningBeforeBlocking);
+  CPPUNIT_TEST(testResumingBlockedReaderByFlushing);
 
   CPPUNIT_TEST_SUITE_END();  // StreamTest
 
@@ -141,6 +155,9 @@ public:
   void testMaximizingHighWaterMark();
   void testSettingHighWaterMarkTooHigh();
   void testSettingHighWaterMarkWayTooHigh();
+  void testInitialPublicationInterval();
+  void testSettingPublicationInterval();
+  void testSettingPublicationIntervalTooHigh();
 
   void testInitialApplicationSpecificData();
   void testSettingApplicationSpecificData();
@@ -177,6 +194,11 @@ public:
   void testAcquiringDataAfterFillingAndReading();
   void testAcquiringDataAfterWritingAndEmptying();
   void testAcquiringDataAfterFillingAndEmptying();
+  void testAcquiringRoomRuns();
+  void testAcquiringDataRuns();
+  void testDeferringPublication();
+  void testPublishingWhenFull();
+  void testFlushingDeferredData();
 
   void testSharedMemorySupport();
   void testSharedMemoryMode();
@@ -202,8 +224,16 @@ public:
   void testPassingLowWaterMark();
   void testHittingHighWaterMark();
   void testPassingHighWaterMark();
+  void testPassingLowWaterMarkWithRun();
+  void testPassingHighWaterMarkWithRun();
+
+  void testBlockingHooks();
+  void testSpinningBeforeBlocking();
+  void testResumingBlockedReaderByFlushing();
 
 private:
+  void passItemsWithBlockingHooks(int spin_limit);
+
   vftasks_malloc_t *mem_mgr;  // pointer to a memory manager
   vftasks_chan_t *chan;       // pointer to a channel
   vftasks_wport_t *wport;     // pointer to a write port
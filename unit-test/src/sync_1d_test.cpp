@@ -3,6 +3,7 @@
 extern "C"
 {
 #include <stdlib.h> /* malloc / free */
+#include <string.h> /* strcmp / strncmp / strstr / strlen */
 #include "platform.h"
 }
 
@@ -14,6 +15,20 @@ typedef struct
   int index; /* iteration in which the thread is waiting */
 } args_t;
 
+typedef struct
+{
+  vftasks_1d_sync_mgr_t *mgr;
+  int thread;      /* index of the thread */
+  int block_size;  /* number of consecutive iterations executed by a thread */
+  int dist;        /* dependency distance */
+  int tile;        /* number of iterations synchronized at once, or 0 to
+                      synchronize every iteration */
+  int *data;       /* array of LOOP_SIZE elements */
+} loop_args_t;
+
+#define NUM_THREADS 4
+#define LOOP_SIZE 1000
+
 static semaphore_t sem;
 static volatile int set = 0;
 
@@ -41,6 +56,51 @@ static WORKER_PROTO(waitAndSet, raw_args)
   return NULL;
 }
 
+/* Worker function that executes the iterations of a thread in the loop
+ *   for (i = dist; i < LOOP_SIZE; i++) data[i] += data[i - dist];
+ * partitioned in blocks over NUM_THREADS threads, optionally synchronized per tile
+ * of iterations within a block.
+ */
+static WORKER_PROTO(runLoop, raw_args)
+{
+  loop_args_t *args = (loop_args_t *)raw_args;
+  int i;
+
+  for (i = args->thread * args->block_size;
+       i < LOOP_SIZE;
+       i += NUM_THREADS * args->block_size - args->block_size)
+  {
+    int end = i + args->block_size;
+
+    if (end > LOOP_SIZE) end = LOOP_SIZE;
+
+    if (args->tile > 0)
+    {
+      while (i < end)
+      {
+        int tile_end = i + args->tile < end ? i + args->tile : end;
+        int j;
+
+        vftasks_wait_1d_range(args->mgr, i, tile_end);
+        for (j = i; j < tile_end; j++)
+          if (j >= args->dist) args->data[j] += args->data[j - args->dist];
+        vftasks_signal_1d_range(args->mgr, i, tile_end);
+        i = tile_end;
+      }
+      continue;
+    }
+
+    for (; i < end; i++)
+    {
+      vftasks_wait_1d(args->mgr, i);
+      if (i >= args->dist) args->data[i] += args->data[i - args->dist];
+      vftasks_signal_1d(args->mgr, i);
+    }
+  }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
 /* Thread safe function to read the global.
  * This is used in the main thread to check whether the correct signal has arrived
  * in the waiting thread.
@@ -92,13 +152,13 @@ void Sync1dTest::testCreateManager()
  * +-------------------------------+
  *
  */
-void Sync1dTest::testSync(int dist, int index)
+void Sync1dTest::testSync(int dist, int index, const vftasks_1d_sync_attr_t *attr)
 {
   int i;
   args_t args;
   thread_t thread;
 
-  this->sync_mgr = vftasks_create_1d_sync_mgr(2, dist);
+  this->sync_mgr = vftasks_create_1d_sync_mgr_with_attr(2, dist, attr);
 
   /* wait in a separate thread, otherwise the main thread will lock up */
   args.mgr = this->sync_mgr;
@@ -154,5 +214,260 @@ void Sync1dTest::testDist3()
   this->testSync(3, 3);
 }
 
+void Sync1dTest::testSpinMode()
+{
+  vftasks_1d_sync_attr_t attr;
+  int dist, index;
+
+  vftasks_init_1d_sync_attr(&attr);
+  attr.mode = VFTASKS_SYNC_SPIN;
+
+  for (dist = 1; dist <= 3; dist++)
+  {
+    for (index = 1; index <= 3; index++)
+    {
+      if (dist > 1 || index > 1)
+      {
+        this->tearDown();
+        this->setUp();
+      }
+      this->testSync(dist, index, &attr);
+    }
+  }
+}
+
+void Sync1dTest::testSpinModePark()
+{
+  vftasks_1d_sync_attr_t attr;
+
+  /* the waiting thread blocks almost immediately */
+  vftasks_init_1d_sync_attr(&attr);
+  attr.mode = VFTASKS_SYNC_SPIN;
+  attr.spin_limit = 1;
+
+  this->testSync(1, 3, &attr);
+  this->tearDown();
+  this->setUp();
+  this->testSync(3, 3, &attr);
+}
+
+/* Run a partitioned loop with a given dependency distance and distribution, in both
+ * synchronization modes, and compare the result with that of a sequential run.
+ */
+void Sync1dTest::testLoop(int dist, int block_size, vftasks_1d_sync_attr_t *attr, int tile,
+                          int num_runs)
+{
+  int data[LOOP_SIZE];
+  int expected[LOOP_SIZE];
+  loop_args_t args[NUM_THREADS];
+  thread_t threads[NUM_THREADS];
+  int mode, run, i, t;
+
+  for (i = 0; i < LOOP_SIZE; i++) expected[i] = i;
+  for (i = dist; i < LOOP_SIZE; i++) expected[i] += expected[i - dist];
+
+  for (mode = VFTASKS_SYNC_SEMAPHORE; mode <= VFTASKS_SYNC_SPIN; mode++)
+  {
+    attr->mode = mode;
+    this->sync_mgr = vftasks_create_1d_sync_mgr_with_attr(NUM_THREADS, dist, attr);
+    CPPUNIT_ASSERT(this->sync_mgr != NULL);
+
+    /* later runs reuse the manager */
+    for (run = 0; run < num_runs; run++)
+    {
+      if (run > 0) CPPUNIT_ASSERT(vftasks_reset_1d_sync_mgr(this->sync_mgr) == 0);
+
+      for (i = 0; i < LOOP_SIZE; i++) data[i] = i;
+
+      for (t = 0; t < NUM_THREADS; t++)
+      {
+        args[t].mgr = this->sync_mgr;
+        args[t].thread = t;
+        args[t].block_size = block_size;
+        args[t].dist = dist;
+        args[t].tile = tile;
+        args[t].data = data;
+        CPPUNIT_ASSERT(THREAD_CREATE(threads[t], runLoop, &args[t]) == 0);
+      }
+
+      for (t = 0; t < NUM_THREADS; t++) THREAD_JOIN(threads[t]);
+
+      for (i = 0; i < LOOP_SIZE; i++) CPPUNIT_ASSERT_EQUAL(expected[i], data[i]);
+    }
+
+    vftasks_destroy_1d_sync_mgr(this->sync_mgr);
+    this->sync_mgr = NULL;
+  }
+}
+
+void Sync1dTest::testBlockCyclic()
+{
+  vftasks_1d_sync_attr_t attr;
+
+  vftasks_init_1d_sync_attr(&attr);
+  attr.distribution = VFTASKS_DIST_BLOCK_CYCLIC;
+
+  /* distances shorter than, equal to, and longer than a block */
+  attr.block_size = 16;
+  this->testLoop(1, 16, &attr);
+  this->testLoop(16, 16, &attr);
+  this->testLoop(37, 16, &attr);
+  this->testLoop(100, 16, &attr);
+
+  /* cyclic distribution as a special case */
+  attr.block_size = 1;
+  this->testLoop(3, 1, &attr);
+}
+
+void Sync1dTest::testBlock()
+{
+  vftasks_1d_sync_attr_t attr;
+  int block_size = (LOOP_SIZE + NUM_THREADS - 1) / NUM_THREADS;
+
+  vftasks_init_1d_sync_attr(&attr);
+  attr.distribution = VFTASKS_DIST_BLOCK;
+  attr.num_iterations = LOOP_SIZE;
+
+  this->testLoop(1, block_size, &attr);
+  this->testLoop(300, block_size, &attr);
+}
+
+void Sync1dTest::testRange()
+{
+  vftasks_1d_sync_attr_t attr;
+  int block_size = (LOOP_SIZE + NUM_THREADS - 1) / NUM_THREADS;
+
+  vftasks_init_1d_sync_attr(&attr);
+  attr.distribution = VFTASKS_DIST_BLOCK_CYCLIC;
+  attr.block_size = 32;
+
+  /* tiles that do and do not divide the blocks */
+  this->testLoop(1, 32, &attr, 8);
+  this->testLoop(37, 32, &attr, 8);
+  this->testLoop(37, 32, &attr, 7);
+  this->testLoop(100, 32, &attr, 32);
+
+  attr.distribution = VFTASKS_DIST_BLOCK;
+  attr.num_iterations = LOOP_SIZE;
+  this->testLoop(300, block_size, &attr, 50);
+
+  /* ranges that cross a block boundary are rejected */
+  attr.distribution = VFTASKS_DIST_BLOCK_CYCLIC;
+  attr.block_size = 32;
+  this->sync_mgr = vftasks_create_1d_sync_mgr_with_attr(NUM_THREADS, 1, &attr);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+  CPPUNIT_ASSERT(vftasks_wait_1d_range(this->sync_mgr, 16, 48) != 0);
+  CPPUNIT_ASSERT(vftasks_signal_1d_range(this->sync_mgr, 16, 48) != 0);
+  CPPUNIT_ASSERT_EQUAL(0, vftasks_wait_1d_range(this->sync_mgr, 32, 32));
+}
+
+void Sync1dTest::testReset()
+{
+  vftasks_1d_sync_attr_t attr;
+
+  vftasks_init_1d_sync_attr(&attr);
+
+  /* the last dist iterations leave signals behind, which the reset takes back */
+  this->testLoop(1, 1, &attr, 0, 3);
+  this->testLoop(37, 1, &attr, 0, 3);
+  this->testLoop(37, 1, &attr, 8, 3);
+
+  attr.distribution = VFTASKS_DIST_BLOCK_CYCLIC;
+  attr.block_size = 16;
+  this->testLoop(37, 16, &attr, 0, 3);
+}
+
+/* Run a profiled loop in both synchronization modes, and check the recorded wait
+ * statistics and their export.
+ */
+void Sync1dTest::testProfile()
+{
+  vftasks_1d_sync_attr_t attr;
+  vftasks_sync_stats_t stats;
+  int data[LOOP_SIZE];
+  loop_args_t args[NUM_THREADS];
+  thread_t threads[NUM_THREADS];
+  unsigned long num_waits;
+  const char *csv = "thread,waits,blocked,blocked_ns\n0,";
+  const char *json = "[\n  {\"thread\": 0, \"waits\": ";
+  char buf[1024];
+  int mode, len, i, t;
+
+  /* without profiling, no statistics are available */
+  this->sync_mgr = vftasks_create_1d_sync_mgr(NUM_THREADS, 1);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+  CPPUNIT_ASSERT(vftasks_get_1d_sync_stats(this->sync_mgr, 0, &stats) != 0);
+  CPPUNIT_ASSERT_EQUAL(-1, vftasks_format_1d_sync_stats(this->sync_mgr,
+                                                        VFTASKS_STATS_CSV,
+                                                        buf,
+                                                        sizeof(buf)));
+  vftasks_destroy_1d_sync_mgr(this->sync_mgr);
+  this->sync_mgr = NULL;
+
+  vftasks_init_1d_sync_attr(&attr);
+  attr.profile = 1;
+
+  for (mode = VFTASKS_SYNC_SEMAPHORE; mode <= VFTASKS_SYNC_SPIN; mode++)
+  {
+    attr.mode = mode;
+    this->sync_mgr = vftasks_create_1d_sync_mgr_with_attr(NUM_THREADS, 1, &attr);
+    CPPUNIT_ASSERT(this->sync_mgr != NULL);
+
+    for (i = 0; i < LOOP_SIZE; i++) data[i] = i;
+
+    for (t = 0; t < NUM_THREADS; t++)
+    {
+      args[t].mgr = this->sync_mgr;
+      args[t].thread = t;
+      args[t].block_size = 1;
+      args[t].dist = 1;
+      args[t].tile = 0;
+      args[t].data = data;
+      CPPUNIT_ASSERT(THREAD_CREATE(threads[t], runLoop, &args[t]) == 0);
+    }
+
+    for (t = 0; t < NUM_THREADS; t++) THREAD_JOIN(threads[t]);
+
+    /* every iteration but the first waits, in the thread that executes it */
+    num_waits = 0;
+    for (t = 0; t < NUM_THREADS; t++)
+    {
+      CPPUNIT_ASSERT(vftasks_get_1d_sync_stats(this->sync_mgr, t, &stats) == 0);
+      CPPUNIT_ASSERT(stats.num_blocked <= stats.num_waits);
+      if (stats.num_blocked == 0) CPPUNIT_ASSERT(stats.blocked_ns == 0);
+      num_waits += stats.num_waits;
+    }
+    CPPUNIT_ASSERT_EQUAL((unsigned long)LOOP_SIZE - 1, num_waits);
+    CPPUNIT_ASSERT(vftasks_get_1d_sync_stats(this->sync_mgr, NUM_THREADS, &stats) != 0);
+
+    /* the length is returned even if the text does not fit */
+    len = vftasks_format_1d_sync_stats(this->sync_mgr, VFTASKS_STATS_CSV, NULL, 0);
+    CPPUNIT_ASSERT(len > 0 && len < (int)sizeof(buf));
+    CPPUNIT_ASSERT_EQUAL(len, vftasks_format_1d_sync_stats(this->sync_mgr,
+                                                           VFTASKS_STATS_CSV,
+                                                           buf,
+                                                           16));
+    CPPUNIT_ASSERT_EQUAL((size_t)15, strlen(buf));
+
+    CPPUNIT_ASSERT_EQUAL(len, vftasks_format_1d_sync_stats(this->sync_mgr,
+                                                           VFTASKS_STATS_CSV,
+                                                           buf,
+                                                           sizeof(buf)));
+    CPPUNIT_ASSERT(strncmp(buf, csv, strlen(csv)) == 0);
+
+    len = vftasks_format_1d_sync_stats(this->sync_mgr,
+                                       VFTASKS_STATS_JSON,
+                                       buf,
+                                       sizeof(buf));
+    CPPUNIT_ASSERT(len > 0 && len < (int)sizeof(buf));
+    CPPUNIT_ASSERT(strncmp(buf, json, strlen(json)) == 0);
+    CPPUNIT_ASSERT(strstr(buf, "{\"thread\": 3,") != NULL);
+    CPPUNIT_ASSERT(strcmp(buf + len - 4, "}\n]\n") == 0);
+
+    vftasks_destroy_1d_sync_mgr(this->sync_mgr);
+    this->sync_mgr = NULL;
+  }
+}
+
 // register fixture
 CPPUNIT_TEST_SUITE_REGISTRATION(Sync1dTest);
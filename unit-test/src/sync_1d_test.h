@@ -18,6 +18,15 @@ class Sync1dTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testDist2);
   CPPUNIT_TEST(testDist3);
 
+  CPPUNIT_TEST(testSpinMode);
+  CPPUNIT_TEST(testSpinModePark);
+
+  CPPUNIT_TEST(testBlockCyclic);
+  CPPUNIT_TEST(testBlock);
+  CPPUNIT_TEST(testRange);
+  CPPUNIT_TEST(testReset);
+  CPPUNIT_TEST(testProfile);
+
   CPPUNIT_TEST_SUITE_END(); // Sync1dTest
 
 public:
@@ -27,13 +36,24 @@ public:
   void testDist2();
   void testDist3();
 
+  void testSpinMode();
+  void testSpinModePark();
+
+  void testBlockCyclic();
+  void testBlock();
+  void testRange();
+  void testReset();
+  void testProfile();
+
   Sync1dTest();
 
   void setUp();
   void tearDown();
 
 private:
-  void testSync(int dist, int index);
+  void testSync(int dist, int index, const vftasks_1d_sync_attr_t *attr = NULL);
+  void testLoop(int dist, int block_size, vftasks_1d_sync_attr_t *attr, int tile = 0,
+                int num_runs = 1);
 
   vftasks_1d_sync_mgr_t *sync_mgr;
 };
@@ -3,6 +3,7 @@
 extern "C"
 {
 #include <stdlib.h> /* malloc / free */
+#include <string.h> /* strcmp / strncmp / strstr / strlen */
 #include "platform.h"
 }
 
@@ -16,6 +17,18 @@ typedef struct
   int col; /* column iterator value in which the thread is waiting */
 } args_t;
 
+#define NUM_THREADS 4
+
+typedef struct
+{
+  vftasks_2d_sync_mgr_t *mgr;
+  int start;    /* first row executed by the thread */
+  int row_dist; /* dependency distance along the rows */
+  int col_dist; /* dependency distance along the columns */
+  int tile;     /* number of columns synchronized at once */
+  int (*data)[COLS];
+} loop_args_t;
+
 static semaphore_t sem;
 static volatile int set = 0;
 
@@ -43,6 +56,36 @@ static WORKER_PROTO(waitAndSet, raw_args)
   return NULL;
 }
 
+/* Worker function that executes every NUM_THREADS-th row of the loop nest
+ *   data[i][j] += data[i - row_dist][j - col_dist]
+ * synchronizing per tile of columns.
+ */
+static WORKER_PROTO(runTiledLoop, raw_args)
+{
+  loop_args_t *args = (loop_args_t *)raw_args;
+  int i, j, k;
+
+  for (i = args->start; i < ROWS; i += NUM_THREADS)
+  {
+    for (k = 0; k < COLS; k += args->tile)
+    {
+      int end = k + args->tile < COLS ? k + args->tile : COLS;
+
+      vftasks_wait_2d_range(args->mgr, i, k, end);
+      for (j = k; j < end; j++)
+      {
+        int x = i - args->row_dist, y = j - args->col_dist;
+
+        if (x >= 0 && x < ROWS && y >= 0 && y < COLS)
+          args->data[i][j] += args->data[x][y];
+      }
+      vftasks_signal_2d_range(args->mgr, i, k, end);
+    }
+  }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
 /* Thread safe function to read the global.
  * This is used in the main thread to check whether the correct signal has arrived
  * in the waiting thread.
@@ -416,5 +459,230 @@ void Sync2dTest::testBorderCrossing()
   this->testNoSync(ROWS/2 + 1, 1, ROWS/2, COLS/2);
 }
 
+/* Run a tiled loop nest with a given dependency over several threads and compare the
+ * result with that of a sequential run.
+ */
+void Sync2dTest::testTiledLoop(int rowDist, int colDist, int tile,
+                               const vftasks_2d_sync_attr_t *attr, int numRuns)
+{
+  static int data[ROWS][COLS];
+  static int expected[ROWS][COLS];
+  loop_args_t args[NUM_THREADS];
+  thread_t threads[NUM_THREADS];
+  int i, j, t, run;
+
+  for (i = 0; i < ROWS; i++)
+    for (j = 0; j < COLS; j++)
+      expected[i][j] = i * COLS + j;
+
+  for (i = 0; i < ROWS; i++)
+    for (j = 0; j < COLS; j++)
+      if (i - rowDist >= 0 && j - colDist >= 0 && j - colDist < COLS)
+        expected[i][j] += expected[i - rowDist][j - colDist];
+
+  this->sync_mgr =
+    vftasks_create_2d_sync_mgr_with_attr(ROWS, COLS, rowDist, colDist, attr);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+
+  /* later runs reuse the manager */
+  for (run = 0; run < numRuns; run++)
+  {
+    if (run > 0) CPPUNIT_ASSERT(vftasks_reset_2d_sync_mgr(this->sync_mgr) == 0);
+
+    for (i = 0; i < ROWS; i++)
+      for (j = 0; j < COLS; j++)
+        data[i][j] = i * COLS + j;
+
+    for (t = 0; t < NUM_THREADS; t++)
+    {
+      args[t].mgr = this->sync_mgr;
+      args[t].start = t;
+      args[t].row_dist = rowDist;
+      args[t].col_dist = colDist;
+      args[t].tile = tile;
+      args[t].data = data;
+      CPPUNIT_ASSERT(THREAD_CREATE(threads[t], runTiledLoop, &args[t]) == 0);
+    }
+
+    for (t = 0; t < NUM_THREADS; t++) THREAD_JOIN(threads[t]);
+
+    for (i = 0; i < ROWS; i++)
+      for (j = 0; j < COLS; j++)
+        CPPUNIT_ASSERT_EQUAL(expected[i][j], data[i][j]);
+  }
+
+  vftasks_destroy_2d_sync_mgr(this->sync_mgr);
+  this->sync_mgr = NULL;
+}
+
+void Sync2dTest::testRange()
+{
+  /* dependencies on the previous row, from either side */
+  this->testTiledLoop(1, 0, 8);
+  this->testTiledLoop(1, -1, 8);
+  this->testTiledLoop(1, 1, 8);
+  this->testTiledLoop(2, -3, 5);
+
+  /* dependencies within a row, partly inside the tiles */
+  this->testTiledLoop(0, 3, 8);
+
+  /* a single tile per row */
+  this->testTiledLoop(1, -1, COLS);
+}
+
+void Sync2dTest::testSpacing()
+{
+  vftasks_2d_sync_attr_t attr;
+  vftasks_2d_sync_mgr_t *sync_mgr;
+
+  vftasks_init_2d_sync_attr(&attr);
+  CPPUNIT_ASSERT(attr.spacing == VFTASKS_SYNC_SPACING);
+
+  /* packed semaphores */
+  attr.spacing = 0;
+  this->testTiledLoop(1, -1, 1, &attr);
+
+  /* semaphores further apart than a cache line */
+  attr.spacing = 2 * VFTASKS_SYNC_SPACING;
+  this->testTiledLoop(1, -1, 1, &attr);
+
+  /* the spacing must be a power of two */
+  attr.spacing = 96;
+  sync_mgr = vftasks_create_2d_sync_mgr_with_attr(ROWS, COLS, 1, 0, &attr);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+}
+
+void Sync2dTest::testSpinMode()
+{
+  vftasks_2d_sync_attr_t attr;
+  vftasks_2d_sync_mgr_t *sync_mgr;
+
+  vftasks_init_2d_sync_attr(&attr);
+  CPPUNIT_ASSERT(attr.mode == VFTASKS_SYNC_SEMAPHORE);
+
+  /* a ring of progress counters far smaller than the number of rows */
+  attr.mode = VFTASKS_SYNC_SPIN;
+  attr.num_threads = NUM_THREADS;
+  this->testTiledLoop(1, 0, 1, &attr);
+  this->testTiledLoop(1, -1, 8, &attr);
+  this->testTiledLoop(2, -3, 5, &attr);
+  this->testTiledLoop(0, 3, 8, &attr);
+  this->testTiledLoop(3, 1, COLS, &attr);
+
+  /* waiting threads park almost immediately */
+  attr.spin_limit = 1;
+  this->testTiledLoop(1, -1, 1, &attr);
+
+  /* the number of threads must be given */
+  attr.num_threads = 0;
+  sync_mgr = vftasks_create_2d_sync_mgr_with_attr(ROWS, COLS, 1, 0, &attr);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+}
+
+void Sync2dTest::testReset()
+{
+  vftasks_2d_sync_attr_t attr;
+
+  /* semaphore mode */
+  this->testTiledLoop(1, -1, 1, NULL, 3);
+  this->testTiledLoop(2, 3, 8, NULL, 3);
+
+  /* spin mode, where the ring of progress counters is restored */
+  vftasks_init_2d_sync_attr(&attr);
+  attr.mode = VFTASKS_SYNC_SPIN;
+  attr.num_threads = NUM_THREADS;
+  this->testTiledLoop(1, -1, 1, &attr, 3);
+  this->testTiledLoop(2, 3, 8, &attr, 3);
+}
+
+/* Run a profiled loop nest in both synchronization modes, and check the recorded
+ * wait statistics and their export.
+ */
+void Sync2dTest::testProfile()
+{
+  static int data[ROWS][COLS];
+  vftasks_2d_sync_attr_t attr;
+  vftasks_sync_stats_t stats;
+  loop_args_t args[NUM_THREADS];
+  thread_t threads[NUM_THREADS];
+  const char *json = "[\n  {\"row\": 0, \"thread\": 0, \"waits\": 0, \"blocked\": 0, ";
+  char *buf;
+  int mode, len, i, j, t;
+
+  /* without profiling, no statistics are available */
+  this->sync_mgr = vftasks_create_2d_sync_mgr(ROWS, COLS, 1, 0);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+  CPPUNIT_ASSERT(vftasks_get_2d_sync_stats(this->sync_mgr, 1, &stats) != 0);
+  CPPUNIT_ASSERT_EQUAL(-1, vftasks_format_2d_sync_stats(this->sync_mgr,
+                                                        VFTASKS_STATS_JSON,
+                                                        NULL,
+                                                        0));
+  vftasks_destroy_2d_sync_mgr(this->sync_mgr);
+  this->sync_mgr = NULL;
+
+  vftasks_init_2d_sync_attr(&attr);
+  attr.num_threads = NUM_THREADS;
+  attr.profile = 1;
+
+  for (mode = VFTASKS_SYNC_SEMAPHORE; mode <= VFTASKS_SYNC_SPIN; mode++)
+  {
+    attr.mode = mode;
+    this->sync_mgr = vftasks_create_2d_sync_mgr_with_attr(ROWS, COLS, 1, 0, &attr);
+    CPPUNIT_ASSERT(this->sync_mgr != NULL);
+
+    for (i = 0; i < ROWS; i++)
+      for (j = 0; j < COLS; j++)
+        data[i][j] = i * COLS + j;
+
+    for (t = 0; t < NUM_THREADS; t++)
+    {
+      args[t].mgr = this->sync_mgr;
+      args[t].start = t;
+      args[t].row_dist = 1;
+      args[t].col_dist = 0;
+      args[t].tile = 4;
+      args[t].data = data;
+      CPPUNIT_ASSERT(THREAD_CREATE(threads[t], runTiledLoop, &args[t]) == 0);
+    }
+
+    for (t = 0; t < NUM_THREADS; t++) THREAD_JOIN(threads[t]);
+
+    /* the first row depends on none, the others wait for the row above */
+    for (i = 0; i < ROWS; i++)
+    {
+      CPPUNIT_ASSERT(vftasks_get_2d_sync_stats(this->sync_mgr, i, &stats) == 0);
+      CPPUNIT_ASSERT(i == 0 ? stats.num_waits == 0 : stats.num_waits > 0);
+      CPPUNIT_ASSERT(stats.num_blocked <= stats.num_waits);
+      if (stats.num_blocked == 0) CPPUNIT_ASSERT(stats.blocked_ns == 0);
+    }
+    CPPUNIT_ASSERT(vftasks_get_2d_sync_stats(this->sync_mgr, ROWS, &stats) != 0);
+
+    /* a buffer of the right size is allocated after asking for the length */
+    len = vftasks_format_2d_sync_stats(this->sync_mgr, VFTASKS_STATS_JSON, NULL, 0);
+    CPPUNIT_ASSERT(len > 0);
+    buf = (char *)malloc(len + 1);
+    CPPUNIT_ASSERT(buf != NULL);
+    CPPUNIT_ASSERT_EQUAL(len, vftasks_format_2d_sync_stats(this->sync_mgr,
+                                                           VFTASKS_STATS_JSON,
+                                                           buf,
+                                                           len + 1));
+    CPPUNIT_ASSERT_EQUAL((size_t)len, strlen(buf));
+    CPPUNIT_ASSERT(strncmp(buf, json, strlen(json)) == 0);
+    CPPUNIT_ASSERT(strstr(buf, "{\"row\": 31, \"thread\": 3,") != NULL);
+    CPPUNIT_ASSERT(strcmp(buf + len - 4, "}\n]\n") == 0);
+
+    /* the CSV text is shorter, and fits in the same buffer */
+    CPPUNIT_ASSERT(vftasks_format_2d_sync_stats(this->sync_mgr,
+                                                VFTASKS_STATS_CSV,
+                                                buf,
+                                                len + 1) < len);
+    CPPUNIT_ASSERT(strncmp(buf, "row,thread,waits,blocked,blocked_ns\n0,0,0,0,0\n", 46) == 0);
+    free(buf);
+
+    vftasks_destroy_2d_sync_mgr(this->sync_mgr);
+    this->sync_mgr = NULL;
+  }
+}
+
 // register fixture
 CPPUNIT_TEST_SUITE_REGISTRATION(Sync2dTest);
@@ -20,6 +20,12 @@ class Sync2dTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testDiagonal);
   CPPUNIT_TEST(testBorderCrossing);
 
+  CPPUNIT_TEST(testRange);
+  CPPUNIT_TEST(testSpacing);
+  CPPUNIT_TEST(testSpinMode);
+  CPPUNIT_TEST(testReset);
+  CPPUNIT_TEST(testProfile);
+
   CPPUNIT_TEST_SUITE_END(); // Sync2dTest
 
 public:
@@ -31,6 +37,12 @@ public:
   void testDiagonal();
   void testBorderCrossing();
 
+  void testRange();
+  void testSpacing();
+  void testSpinMode();
+  void testReset();
+  void testProfile();
+
   Sync2dTest();
 
   void setUp();
@@ -39,6 +51,8 @@ public:
 private:
   void testSync(int rowDist, int colDist, int row, int col);
   void testNoSync(int rowDist, int colDist, int row, int col);
+  void testTiledLoop(int rowDist, int colDist, int tile,
+                     const vftasks_2d_sync_attr_t *attr = NULL, int numRuns = 1);
 
   vftasks_2d_sync_mgr_t *sync_mgr;
 };
@@ -0,0 +1,298 @@
+#include "sync_cross_test.h"
+
+extern "C"
+{
+#include "platform.h"
+}
+
+#define NUM_PRODUCERS 3
+#define NUM_CONSUMERS 2
+#define LOOP_SIZE 1000
+#define BLOCK_SIZE 8
+
+typedef struct
+{
+  vftasks_cross_sync_mgr_t *mgr;
+  int index;  /* consuming iteration that the thread executes */
+} args_t;
+
+typedef struct
+{
+  vftasks_cross_sync_mgr_t *mgr;
+  int thread;      /* index of the thread */
+  int block_size;  /* number of consecutive iterations executed by a thread */
+  int num_threads; /* number of threads executing the loop */
+  int dist;        /* dependency distance */
+  int tile;        /* number of iterations synchronized at once, or 0 to
+                      synchronize every iteration */
+  int *a;          /* array of LOOP_SIZE elements produced by the first loop */
+  int *b;          /* array of LOOP_SIZE elements produced by the second loop */
+} loop_args_t;
+
+static semaphore_t sem;
+static volatile int set = 0;
+
+#define ASSERT_AND_CLEAN(mgr,ref)               \
+  {                                             \
+    CPPUNIT_ASSERT(mgr ref);                    \
+    if (mgr != NULL)                            \
+      vftasks_destroy_cross_sync_mgr(mgr);      \
+  }
+
+/* Worker function that waits in a consuming iteration and then sets a global.
+ */
+static WORKER_PROTO(waitAndSet, raw_args)
+{
+  args_t *args = (args_t *)raw_args;
+
+  vftasks_wait_cross(args->mgr, args->index);
+
+  set = 1;
+  SEMAPHORE_POST(sem);
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+/* Worker function that executes the iterations of a thread in the loop
+ *   for (i = 0; i < LOOP_SIZE; i++) a[i] = i * i;
+ * partitioned in blocks over the producing threads.
+ */
+static WORKER_PROTO(produce, raw_args)
+{
+  loop_args_t *args = (loop_args_t *)raw_args;
+  int start, i, end;
+
+  for (start = args->thread * args->block_size;
+       start < LOOP_SIZE;
+       start += args->num_threads * args->block_size)
+  {
+    end = start + args->block_size < LOOP_SIZE ? start + args->block_size : LOOP_SIZE;
+
+    for (i = start; i < end; i++)
+    {
+      args->a[i] = i * i;
+      if (args->tile == 0) vftasks_signal_cross(args->mgr, i);
+    }
+
+    if (args->tile != 0) vftasks_signal_cross_range(args->mgr, start, end);
+  }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+/* Worker function that executes the iterations of a thread in the loop
+ *   for (j = 0; j < LOOP_SIZE; j++) b[j] = j >= dist ? a[j - dist] + 1 : 0;
+ * partitioned in tiles over the consuming threads, which synchronize per iteration
+ * or per tile.
+ */
+static WORKER_PROTO(consume, raw_args)
+{
+  loop_args_t *args = (loop_args_t *)raw_args;
+  int tile = args->tile != 0 ? args->tile : 1;
+  int start, j, end;
+
+  for (start = args->thread * tile; start < LOOP_SIZE; start += args->num_threads * tile)
+  {
+    end = start + tile < LOOP_SIZE ? start + tile : LOOP_SIZE;
+
+    if (args->tile != 0) vftasks_wait_cross_range(args->mgr, start, end);
+
+    for (j = start; j < end; j++)
+    {
+      if (args->tile == 0) vftasks_wait_cross(args->mgr, j);
+      args->b[j] = j >= args->dist ? args->a[j - args->dist] + 1 : 0;
+    }
+  }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+SyncCrossTest::SyncCrossTest()
+{
+  this->sync_mgr = NULL;
+}
+
+void SyncCrossTest::setUp()
+{
+}
+
+void SyncCrossTest::tearDown()
+{
+  if (this->sync_mgr != NULL)
+    vftasks_destroy_cross_sync_mgr(this->sync_mgr);
+  this->sync_mgr = NULL;
+}
+
+void SyncCrossTest::testCreateManager()
+{
+  this->sync_mgr = vftasks_create_cross_sync_mgr(NUM_PRODUCERS, 1, NULL);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+}
+
+void SyncCrossTest::testCreateManagerBoundaries()
+{
+  vftasks_cross_sync_mgr_t *sync_mgr;
+  vftasks_1d_sync_attr_t attr;
+
+  /* any distance will do, as the loops are distinct */
+  sync_mgr = vftasks_create_cross_sync_mgr(1, 0, NULL);
+  ASSERT_AND_CLEAN(sync_mgr, != NULL);
+  sync_mgr = vftasks_create_cross_sync_mgr(1, -5, NULL);
+  ASSERT_AND_CLEAN(sync_mgr, != NULL);
+
+  sync_mgr = vftasks_create_cross_sync_mgr(0, 1, NULL);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+
+  vftasks_init_1d_sync_attr(&attr);
+  attr.distribution = VFTASKS_DIST_BLOCK;
+  sync_mgr = vftasks_create_cross_sync_mgr(NUM_PRODUCERS, 1, &attr);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+  attr.num_iterations = LOOP_SIZE;
+  sync_mgr = vftasks_create_cross_sync_mgr(NUM_PRODUCERS, 1, &attr);
+  ASSERT_AND_CLEAN(sync_mgr, != NULL);
+
+  vftasks_init_1d_sync_attr(&attr);
+  attr.distribution = VFTASKS_DIST_BLOCK_CYCLIC;
+  attr.block_size = 0;
+  sync_mgr = vftasks_create_cross_sync_mgr(NUM_PRODUCERS, 1, &attr);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+}
+
+void SyncCrossTest::testWaitSignal()
+{
+  vftasks_1d_sync_attr_t attr;
+  thread_t thread;
+  args_t args;
+
+  vftasks_init_1d_sync_attr(&attr);
+  attr.num_iterations = LOOP_SIZE;
+  this->sync_mgr = vftasks_create_cross_sync_mgr(2, 3, &attr);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+
+  /* consuming iterations without a producing iteration do not wait */
+  CPPUNIT_ASSERT(vftasks_wait_cross(this->sync_mgr, 2) == 0);
+  CPPUNIT_ASSERT(vftasks_wait_cross(this->sync_mgr, LOOP_SIZE + 3) == 0);
+
+  /* consuming iteration 10 waits for producing iteration 7, executed by thread 1
+     after iterations 1, 3, and 5 */
+  CPPUNIT_ASSERT(SEMAPHORE_CREATE(sem, 0, 1) == 0);
+  set = 0;
+  args.mgr = this->sync_mgr;
+  args.index = 10;
+  CPPUNIT_ASSERT(THREAD_CREATE(thread, waitAndSet, &args) == 0);
+
+  CPPUNIT_ASSERT(vftasks_signal_cross(this->sync_mgr, 1) == 0);
+  CPPUNIT_ASSERT(vftasks_signal_cross(this->sync_mgr, 3) == 0);
+  CPPUNIT_ASSERT(vftasks_signal_cross(this->sync_mgr, 5) == 0);
+  CPPUNIT_ASSERT(vftasks_signal_cross(this->sync_mgr, 8) == 0);
+  CPPUNIT_ASSERT(SEMAPHORE_TIMEDWAIT(sem, 100000000) != 0);
+  CPPUNIT_ASSERT_EQUAL(0, (int)set);
+
+  CPPUNIT_ASSERT(vftasks_signal_cross(this->sync_mgr, 7) == 0);
+  SEMAPHORE_WAIT(sem);
+  CPPUNIT_ASSERT_EQUAL(1, (int)set);
+
+  THREAD_JOIN(thread);
+  SEMAPHORE_DESTROY(sem);
+}
+
+/* Run a producing loop and a consuming loop concurrently, each on threads of its
+ * own, and check the result of the consuming loop.
+ */
+void SyncCrossTest::testLoops(int distribution, int dist, int tile, int num_runs)
+{
+  static int a[LOOP_SIZE];
+  static int b[LOOP_SIZE];
+  vftasks_1d_sync_attr_t attr;
+  loop_args_t args[NUM_PRODUCERS + NUM_CONSUMERS];
+  thread_t threads[NUM_PRODUCERS + NUM_CONSUMERS];
+  int i, t, run, block_size;
+
+  vftasks_init_1d_sync_attr(&attr);
+  attr.distribution = distribution;
+  attr.block_size = BLOCK_SIZE;
+  attr.num_iterations = LOOP_SIZE;
+  this->sync_mgr = vftasks_create_cross_sync_mgr(NUM_PRODUCERS, dist, &attr);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+
+  switch (distribution)
+  {
+  case VFTASKS_DIST_BLOCK_CYCLIC:
+    block_size = BLOCK_SIZE;
+    break;
+  case VFTASKS_DIST_BLOCK:
+    block_size = (LOOP_SIZE + NUM_PRODUCERS - 1) / NUM_PRODUCERS;
+    break;
+  default:
+    block_size = 1;
+  }
+
+  /* later runs reuse the manager */
+  for (run = 0; run < num_runs; run++)
+  {
+    if (run > 0) CPPUNIT_ASSERT(vftasks_reset_cross_sync_mgr(this->sync_mgr) == 0);
+
+    for (i = 0; i < LOOP_SIZE; i++)
+    {
+      a[i] = -1;
+      b[i] = -1;
+    }
+
+    /* start the consumers first, so that they have to wait */
+    for (t = 0; t < NUM_PRODUCERS + NUM_CONSUMERS; t++)
+    {
+      args[t].mgr = this->sync_mgr;
+      args[t].dist = dist;
+      args[t].tile = tile;
+      args[t].a = a;
+      args[t].b = b;
+    }
+
+    for (t = 0; t < NUM_CONSUMERS; t++)
+    {
+      args[t].thread = t;
+      args[t].num_threads = NUM_CONSUMERS;
+      args[t].block_size = 0;
+      CPPUNIT_ASSERT(THREAD_CREATE(threads[t], consume, &args[t]) == 0);
+    }
+
+    for (t = NUM_CONSUMERS; t < NUM_PRODUCERS + NUM_CONSUMERS; t++)
+    {
+      args[t].thread = t - NUM_CONSUMERS;
+      args[t].num_threads = NUM_PRODUCERS;
+      args[t].block_size = block_size;
+      CPPUNIT_ASSERT(THREAD_CREATE(threads[t], produce, &args[t]) == 0);
+    }
+
+    for (t = 0; t < NUM_PRODUCERS + NUM_CONSUMERS; t++) THREAD_JOIN(threads[t]);
+
+    for (i = 0; i < LOOP_SIZE; i++)
+      CPPUNIT_ASSERT_EQUAL(i >= dist ? (i - dist) * (i - dist) + 1 : 0, b[i]);
+  }
+
+  this->tearDown();
+}
+
+void SyncCrossTest::testPipeline()
+{
+  this->testLoops(VFTASKS_DIST_CYCLIC, 1, 0);
+  this->testLoops(VFTASKS_DIST_CYCLIC, 0, 0);
+  this->testLoops(VFTASKS_DIST_BLOCK_CYCLIC, 5, 0);
+  this->testLoops(VFTASKS_DIST_BLOCK, 17, 0);
+}
+
+void SyncCrossTest::testPipelineRange()
+{
+  this->testLoops(VFTASKS_DIST_CYCLIC, 1, 16);
+  this->testLoops(VFTASKS_DIST_BLOCK_CYCLIC, 5, 7);
+  this->testLoops(VFTASKS_DIST_BLOCK, 17, 64);
+}
+
+void SyncCrossTest::testReset()
+{
+  this->testLoops(VFTASKS_DIST_BLOCK_CYCLIC, 3, 0, 3);
+  this->testLoops(VFTASKS_DIST_CYCLIC, 3, 16, 3);
+}
+
+// register fixture
+CPPUNIT_TEST_SUITE_REGISTRATION(SyncCrossTest);
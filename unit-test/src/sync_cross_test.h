@@ -0,0 +1,43 @@
+#ifndef SYNC_CROSS_TEST_H
+#define SYNC_CROSS_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+extern "C"
+{
+#include <vftasks.h>
+}
+
+class SyncCrossTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(SyncCrossTest);
+
+  CPPUNIT_TEST(testCreateManager);
+  CPPUNIT_TEST(testCreateManagerBoundaries);
+  CPPUNIT_TEST(testWaitSignal);
+  CPPUNIT_TEST(testPipeline);
+  CPPUNIT_TEST(testPipelineRange);
+  CPPUNIT_TEST(testReset);
+
+  CPPUNIT_TEST_SUITE_END(); // SyncCrossTest
+
+public:
+  void testCreateManager();
+  void testCreateManagerBoundaries();
+  void testWaitSignal();
+  void testPipeline();
+  void testPipelineRange();
+  void testReset();
+
+  SyncCrossTest();
+
+  void setUp();
+  void tearDown();
+
+private:
+  void testLoops(int distribution, int dist, int tile, int num_runs = 1);
+
+  vftasks_cross_sync_mgr_t *sync_mgr;
+};
+
+#endif // SYNC_CROSS_TEST_H
@@ -0,0 +1,237 @@
+#include "sync_nd_test.h"
+
+extern "C"
+{
+#include "platform.h"
+}
+
+#define DIM 12
+#define NUM_THREADS 4
+
+typedef struct
+{
+  vftasks_nd_sync_mgr_t *mgr;
+  int start;                    /* first outer iteration executed by the thread */
+  int num_dists;                /* number of dependencies */
+  const int (*dists)[3];        /* distance vectors */
+  int (*data)[DIM][DIM];
+} loop_args_t;
+
+#define ASSERT_AND_CLEAN(mgr,ref)               \
+  {                                             \
+    CPPUNIT_ASSERT(mgr ref);                    \
+    if (mgr != NULL)                            \
+      vftasks_destroy_nd_sync_mgr(mgr);         \
+  }
+
+/* Add the values at the given distances to an element of a 3D array.
+ */
+static void update(int (*data)[DIM][DIM], int num_dists, const int (*dists)[3],
+                   const int *index)
+{
+  int d, k, source[3];
+
+  for (d = 0; d < num_dists; d++)
+  {
+    for (k = 0; k < 3; k++)
+    {
+      source[k] = index[k] - dists[d][k];
+      if (source[k] < 0 || source[k] >= DIM) break;
+    }
+
+    if (k == 3)
+      data[index[0]][index[1]][index[2]] += data[source[0]][source[1]][source[2]];
+  }
+}
+
+/* Worker function that executes every NUM_THREADS-th outer iteration of a 3D
+ * stencil.
+ */
+static WORKER_PROTO(runStencil, raw_args)
+{
+  loop_args_t *args = (loop_args_t *)raw_args;
+  int index[3];
+
+  for (index[0] = args->start; index[0] < DIM; index[0] += NUM_THREADS)
+    for (index[1] = 0; index[1] < DIM; index[1]++)
+      for (index[2] = 0; index[2] < DIM; index[2]++)
+      {
+        vftasks_wait_nd(args->mgr, index);
+        update(args->data, args->num_dists, args->dists, index);
+        vftasks_signal_nd(args->mgr, index);
+      }
+
+  return THREAD_EXIT_SUCCESS;
+}
+
+SyncNdTest::SyncNdTest()
+{
+  this->sync_mgr = NULL;
+}
+
+void SyncNdTest::setUp()
+{
+}
+
+void SyncNdTest::tearDown()
+{
+  if (this->sync_mgr != NULL)
+    vftasks_destroy_nd_sync_mgr(this->sync_mgr);
+  this->sync_mgr = NULL;
+}
+
+void SyncNdTest::testCreateManager()
+{
+  int dims[3] = {DIM, DIM, DIM};
+  int dists[2][3] = {{1, 0, 0}, {0, 1, -1}};
+
+  this->sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 2, &dists[0][0]);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+}
+
+void SyncNdTest::testCreateManagerBoundaries()
+{
+  vftasks_nd_sync_mgr_t *sync_mgr;
+  int dims[3] = {DIM, DIM, DIM};
+  int dists[3];
+
+  /* no dependencies at all */
+  sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 0, NULL);
+  ASSERT_AND_CLEAN(sync_mgr, != NULL);
+
+  dists[0] = DIM - 1; dists[1] = -(DIM - 1); dists[2] = DIM - 1;
+  sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 1, dists);
+  ASSERT_AND_CLEAN(sync_mgr, != NULL);
+
+  /* distances must be smaller than the dimensions */
+  dists[0] = DIM; dists[1] = 0; dists[2] = 0;
+  sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 1, dists);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+  dists[0] = 1; dists[1] = 0; dists[2] = -DIM;
+  sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 1, dists);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+
+  /* within an outer iteration, iterations cannot depend on themselves or on later
+     iterations */
+  dists[0] = 0; dists[1] = 0; dists[2] = 0;
+  sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 1, dists);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+  dists[0] = 0; dists[1] = -1; dists[2] = 1;
+  sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 1, dists);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+
+  /* dimensions must not be empty */
+  dims[1] = 0;
+  sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 0, NULL);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+  sync_mgr = vftasks_create_nd_sync_mgr(0, dims, 0, NULL);
+  ASSERT_AND_CLEAN(sync_mgr, == NULL);
+}
+
+void SyncNdTest::testPruning()
+{
+  int dims[3] = {DIM, DIM, DIM};
+  int dists[5][3] = {{1, 0, 0}, {1, 0, 1}, {1, 0, 0}, {0, 1, 0}, {1, -1, 0}};
+  int diverging[2][3] = {{1, 0, 1}, {1, 0, -1}};
+  int chained[5][3] = {{2, 0, 0}, {3, 0, 1}, {2, 1, 0}, {2, 0, -1}, {1, 0, 0}};
+
+  /* (1, 0, 1) and the duplicate are covered by (1, 0, 0), and (0, 1, 0) by the
+     order of execution; (1, -1, 0) reaches later into the outer iteration */
+  this->sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 5, &dists[0][0]);
+  CPPUNIT_ASSERT_EQUAL(2, vftasks_get_nd_sync_num_waits(this->sync_mgr));
+  this->tearDown();
+
+  /* at the boundaries, each of these has a source that the other does not */
+  this->sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 2, &diverging[0][0]);
+  CPPUNIT_ASSERT_EQUAL(2, vftasks_get_nd_sync_num_waits(this->sync_mgr));
+  this->tearDown();
+
+  /* (2, 0, 0), (3, 0, 1), and (2, 1, 0) are covered by a chain of (1, 0, 0) and
+     the order of execution, across outer iterations; (2, 0, -1) is not, as it
+     reaches later into the outer iteration */
+  this->sync_mgr = vftasks_create_nd_sync_mgr(3, dims, 5, &chained[0][0]);
+  CPPUNIT_ASSERT_EQUAL(2, vftasks_get_nd_sync_num_waits(this->sync_mgr));
+  this->tearDown();
+
+  this->testStencil(5, &chained[0][0]);
+}
+
+/* Run a 3D stencil with given dependencies over several threads and compare the
+ * result with that of a sequential run.
+ */
+void SyncNdTest::testStencil(int num_dists, const int *dists, int num_runs)
+{
+  static int data[DIM][DIM][DIM];
+  static int expected[DIM][DIM][DIM];
+  int dims[3] = {DIM, DIM, DIM};
+  loop_args_t args[NUM_THREADS];
+  thread_t threads[NUM_THREADS];
+  int index[3], t, run;
+
+  for (index[0] = 0; index[0] < DIM; index[0]++)
+    for (index[1] = 0; index[1] < DIM; index[1]++)
+      for (index[2] = 0; index[2] < DIM; index[2]++)
+        expected[index[0]][index[1]][index[2]] = index[0] + index[1] + index[2];
+
+  for (index[0] = 0; index[0] < DIM; index[0]++)
+    for (index[1] = 0; index[1] < DIM; index[1]++)
+      for (index[2] = 0; index[2] < DIM; index[2]++)
+        update(expected, num_dists, (const int (*)[3])dists, index);
+
+  this->sync_mgr = vftasks_create_nd_sync_mgr(3, dims, num_dists, dists);
+  CPPUNIT_ASSERT(this->sync_mgr != NULL);
+
+  /* later runs reuse the manager */
+  for (run = 0; run < num_runs; run++)
+  {
+    if (run > 0) CPPUNIT_ASSERT(vftasks_reset_nd_sync_mgr(this->sync_mgr) == 0);
+
+    for (index[0] = 0; index[0] < DIM; index[0]++)
+      for (index[1] = 0; index[1] < DIM; index[1]++)
+        for (index[2] = 0; index[2] < DIM; index[2]++)
+          data[index[0]][index[1]][index[2]] = index[0] + index[1] + index[2];
+
+    for (t = 0; t < NUM_THREADS; t++)
+    {
+      args[t].mgr = this->sync_mgr;
+      args[t].start = t;
+      args[t].num_dists = num_dists;
+      args[t].dists = (const int (*)[3])dists;
+      args[t].data = data;
+      CPPUNIT_ASSERT(THREAD_CREATE(threads[t], runStencil, &args[t]) == 0);
+    }
+
+    for (t = 0; t < NUM_THREADS; t++) THREAD_JOIN(threads[t]);
+
+    for (index[0] = 0; index[0] < DIM; index[0]++)
+      for (index[1] = 0; index[1] < DIM; index[1]++)
+        for (index[2] = 0; index[2] < DIM; index[2]++)
+          CPPUNIT_ASSERT_EQUAL(expected[index[0]][index[1]][index[2]],
+                               data[index[0]][index[1]][index[2]]);
+  }
+
+  this->tearDown();
+}
+
+void SyncNdTest::testLoop()
+{
+  int seven_point[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+  int skewed[4][3] = {{1, 0, 1}, {1, 0, -1}, {1, -1, 0}, {2, 1, 1}};
+  int inner[2][3] = {{0, 1, 1}, {0, 0, 2}};
+  int far[3][3] = {{3, -2, 1}, {1, 2, -3}, {0, 1, -1}};
+
+  this->testStencil(3, &seven_point[0][0]);
+  this->testStencil(4, &skewed[0][0]);
+  this->testStencil(2, &inner[0][0]);
+  this->testStencil(3, &far[0][0]);
+}
+
+void SyncNdTest::testReset()
+{
+  int seven_point[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+  this->testStencil(3, &seven_point[0][0], 3);
+}
+
+// register fixture
+CPPUNIT_TEST_SUITE_REGISTRATION(SyncNdTest);
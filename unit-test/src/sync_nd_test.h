@@ -0,0 +1,41 @@
+#ifndef SYNC_ND_TEST_H
+#define SYNC_ND_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+extern "C"
+{
+#include <vftasks.h>
+}
+
+class SyncNdTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(SyncNdTest);
+
+  CPPUNIT_TEST(testCreateManager);
+  CPPUNIT_TEST(testCreateManagerBoundaries);
+  CPPUNIT_TEST(testPruning);
+  CPPUNIT_TEST(testLoop);
+  CPPUNIT_TEST(testReset);
+
+  CPPUNIT_TEST_SUITE_END(); // SyncNdTest
+
+public:
+  void testCreateManager();
+  void testCreateManagerBoundaries();
+  void testPruning();
+  void testLoop();
+  void testReset();
+
+  SyncNdTest();
+
+  void setUp();
+  void tearDown();
+
+private:
+  void testStencil(int num_dists, const int *dists, int num_runs = 1);
+
+  vftasks_nd_sync_mgr_t *sync_mgr;
+};
+
+#endif // SYNC_ND_TEST_H
@@ -19,10 +19,73 @@ static void square(void *raw_args)
   arg->result = arg->val * arg->val;
 }
 
+// a timed task that counts its executions
+static void tick(void *raw_args)
+{
+  int *count = (int *)raw_args;
+
+  ATOMIC_FETCH_ADD(count, 1);
+}
+
+// spin until a counter reaches a given value or a timeout expires
+static bool waitForCount(int *count, int value, uint64_t timeout_ns)
+{
+  uint64_t start;
+
+  vftasks_timer_start(&start);
+  while (ATOMIC_LOAD_ACQUIRE(count) < value)
+  {
+    if (vftasks_timer_stop(&start) > timeout_ns) return false;
+  }
+
+  return true;
+}
+
+// a task that keeps its worker busy until released
+static void hold(void *raw_args)
+{
+  int *released = (int *)raw_args;
+
+  while (!ATOMIC_LOAD_ACQUIRE(released));
+}
+
+// the arena-taking equivalent of hold
+static void holdWithArena(void *raw_args, vftasks_arena_t *arena)
+{
+  hold(raw_args);
+}
+
+// spin until a worker reaches a given state or a timeout expires
+static bool waitForState(vftasks_pool_t *pool, int index, int state)
+{
+  vftasks_worker_snapshot_t snapshot[2];
+  uint64_t start;
+
+  vftasks_timer_start(&start);
+  do
+  {
+    CPPUNIT_ASSERT(vftasks_get_pool_snapshot(pool, snapshot) == 0);
+    if (snapshot[index].state == state) return true;
+  }
+  while (vftasks_timer_stop(&start) < 2000000000);
+
+  return false;
+}
+
+// spin for a given number of nanoseconds
+static void spin(uint64_t duration_ns)
+{
+  uint64_t start;
+
+  vftasks_timer_start(&start);
+  while (vftasks_timer_stop(&start) < duration_ns);
+}
+
 void TasksTest::setUp()
 {
   this->pool = NULL;
   this->square_args = NULL;
+  this->arena_args = NULL;
   this->loop_args = NULL;
   this->inner_loop_args = NULL;
   this->outer_loop_args = NULL;
@@ -35,6 +98,8 @@ void TasksTest::tearDown()
     vftasks_destroy_pool(this->pool);
   if (this->square_args != NULL)
     free(this->square_args);
+  if (this->arena_args != NULL)
+    free(this->arena_args);
   if (this->loop_args != NULL)
     free(this->loop_args);
   if (this->inner_loop_args != NULL)
@@ -79,6 +144,30 @@ void TasksTest::testDestroyPool()
   vftasks_destroy_pool(pool);
 }
 
+void TasksTest::testCreatePoolWithAttr()
+{
+  vftasks_pool_attr_t attr;
+  vftasks_pool_stats_t stats;
+
+  vftasks_init_pool_attr(&attr);
+  attr.stack_size = 256 * 1024;
+  attr.name = "taskstest-pool";
+  this->pool = vftasks_create_pool_with_attr(4, this->busy_wait, &attr);
+  CPPUNIT_ASSERT(this->pool != NULL);
+
+  CPPUNIT_ASSERT(vftasks_get_pool_stats(this->pool, &stats) == 0);
+  CPPUNIT_ASSERT(stats.num_workers == 4);
+  CPPUNIT_ASSERT(stats.stack_memory == 4 * attr.stack_size);
+  CPPUNIT_ASSERT(stats.worker_memory > 0);
+
+  // the workers are operational
+  this->square_args = (square_args_t *)malloc(sizeof(square_args_t));
+  this->square_args->val = 5;
+  CPPUNIT_ASSERT(vftasks_submit(this->pool, square, this->square_args, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  CPPUNIT_ASSERT(this->square_args->result == 25);
+}
+
 void TasksTest::testSubmitEmptyTask()
 {
   this->pool = createPool(1);
@@ -315,5 +404,342 @@ void TasksTest::testSubmitGetNestedLoopInvalidSubWorkers()
   CPPUNIT_ASSERT(submitGetNestedLoop(N_PARTITIONS+1, 0) != 0);
 }
 
+// A task that fills two scratch buffers taken from the worker's arena.
+static void scratch(void *raw_args, vftasks_arena_t *arena)
+{
+  int i;
+  arena_args_t *args = (arena_args_t *)raw_args;
+  char *buf;
+
+  vftasks_set_arena_persistent(arena, args->persistent);
+
+  args->first = vftasks_worker_alloc(arena, args->size);
+  for (i = 0, buf = (char *)args->first; i < args->size; i++)
+    buf[i] = (char)i;
+
+  args->last = vftasks_worker_alloc(arena, args->size);
+  for (i = 0, buf = (char *)args->last; i < args->size; i++)
+    buf[i] = (char)i;
+}
+
+void TasksTest::testArenaTask()
+{
+  vftasks_pool_stats_t stats;
+
+  this->arena_args = (arena_args_t *)calloc(1, sizeof(arena_args_t));
+  this->arena_args->size = 1000;
+  this->pool = createPool(1);
+
+  CPPUNIT_ASSERT(vftasks_submit_arena_task(this->pool, scratch, this->arena_args, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  CPPUNIT_ASSERT(this->arena_args->first != NULL);
+  CPPUNIT_ASSERT(this->arena_args->last != NULL);
+  CPPUNIT_ASSERT(this->arena_args->first != this->arena_args->last);
+
+  CPPUNIT_ASSERT(vftasks_get_pool_stats(this->pool, &stats) == 0);
+  CPPUNIT_ASSERT(stats.num_workers == 1);
+  CPPUNIT_ASSERT(stats.arena_high_water >= 2000);
+  CPPUNIT_ASSERT(stats.arena_reserved >= stats.arena_high_water);
+}
+
+void TasksTest::testArenaReset()
+{
+  void *first;
+  vftasks_pool_stats_t stats;
+
+  this->arena_args = (arena_args_t *)calloc(1, sizeof(arena_args_t));
+  this->arena_args->size = 100000;  // larger than a single arena block
+  this->pool = createPool(1);
+
+  CPPUNIT_ASSERT(vftasks_submit_arena_task(this->pool, scratch, this->arena_args, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  first = this->arena_args->first;
+  CPPUNIT_ASSERT(vftasks_get_pool_stats(this->pool, &stats) == 0);
+
+  // the arena was reset, so the second task reuses the same memory
+  CPPUNIT_ASSERT(vftasks_submit_arena_task(this->pool, scratch, this->arena_args, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  CPPUNIT_ASSERT(this->arena_args->first == first);
+  CPPUNIT_ASSERT(vftasks_get_pool_stats(this->pool, &stats) == 0);
+  CPPUNIT_ASSERT(stats.arena_high_water == 200000);
+}
+
+void TasksTest::testArenaPersistent()
+{
+  void *last;
+
+  this->arena_args = (arena_args_t *)calloc(1, sizeof(arena_args_t));
+  this->arena_args->size = 64;
+  this->arena_args->persistent = 1;
+  this->pool = createPool(1);
+
+  CPPUNIT_ASSERT(vftasks_submit_arena_task(this->pool, scratch, this->arena_args, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  last = this->arena_args->last;
+
+  // the allocations of the first task are retained
+  CPPUNIT_ASSERT(vftasks_submit_arena_task(this->pool, scratch, this->arena_args, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  CPPUNIT_ASSERT(this->arena_args->first != NULL);
+  CPPUNIT_ASSERT((char *)this->arena_args->first >= (char *)last + 64);
+}
+
+void TasksTest::testCoalesceTinyTasks()
+{
+  vftasks_pool_attr_t attr;
+  vftasks_pool_stats_t stats;
+  int i;
+
+  this->square_args = (square_args_t *)malloc(sizeof(square_args_t));
+
+  vftasks_init_pool_attr(&attr);
+  attr.coalesce_ns = 1000000;
+  this->pool = vftasks_create_pool_with_attr(1, this->busy_wait, &attr);
+  CPPUNIT_ASSERT(this->pool != NULL);
+
+  // once profiled, the task is executed inline, with the same results
+  for (i = 0; i < 16; ++i)
+  {
+    this->square_args->val = i;
+    CPPUNIT_ASSERT(vftasks_submit_independent(this->pool, square,
+                                              this->square_args) == 0);
+    CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+    CPPUNIT_ASSERT(this->square_args->result == i * i);
+  }
+
+  CPPUNIT_ASSERT(vftasks_get_pool_stats(this->pool, &stats) == 0);
+  CPPUNIT_ASSERT(stats.tasks_submitted == 16);
+  CPPUNIT_ASSERT(stats.tasks_inlined > 0);
+  CPPUNIT_ASSERT(stats.tasks_inlined <= 16 - 4);
+
+  // tasks that may depend on the submitter are always dispatched
+  for (i = 0; i < 16; ++i)
+  {
+    CPPUNIT_ASSERT(vftasks_submit(this->pool, square, this->square_args, 0) == 0);
+    CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  }
+
+  CPPUNIT_ASSERT(vftasks_get_pool_stats(this->pool, &stats) == 0);
+  CPPUNIT_ASSERT(stats.tasks_submitted == 32);
+  CPPUNIT_ASSERT(stats.tasks_inlined <= 16 - 4);
+}
+
+void TasksTest::testCoalesceDisabled()
+{
+  vftasks_pool_stats_t stats;
+  int i;
+
+  this->square_args = (square_args_t *)malloc(sizeof(square_args_t));
+  this->pool = createPool(1);
+
+  // by default, every task is dispatched to a worker
+  for (i = 0; i < 16; ++i)
+  {
+    this->square_args->val = i;
+    CPPUNIT_ASSERT(vftasks_submit(this->pool, square, this->square_args, 0) == 0);
+    CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  }
+
+  CPPUNIT_ASSERT(vftasks_get_pool_stats(this->pool, &stats) == 0);
+  CPPUNIT_ASSERT(stats.tasks_submitted == 16);
+  CPPUNIT_ASSERT(stats.tasks_inlined == 0);
+}
+
+void TasksTest::testSubmitAfter()
+{
+  int count = 0;
+  uint64_t start;
+
+  this->pool = createPool(2);
+
+  vftasks_timer_start(&start);
+  CPPUNIT_ASSERT(vftasks_submit_after(this->pool, 20000000, tick, &count) == 0);
+  CPPUNIT_ASSERT(waitForCount(&count, 1, 2000000000));
+
+  // the task is never executed early
+  CPPUNIT_ASSERT(vftasks_timer_stop(&start) >= 20000000);
+  spin(20000000);
+  CPPUNIT_ASSERT(ATOMIC_LOAD_ACQUIRE(&count) == 1);
+}
+
+void TasksTest::testPeriodicTimedTask()
+{
+  int count = 0;
+  vftasks_timed_task_t *timer;
+  int snapshot;
+
+  this->pool = createPool(2);
+  timer = vftasks_create_timed_task(this->pool, tick, &count);
+  CPPUNIT_ASSERT(timer != NULL);
+
+  CPPUNIT_ASSERT(vftasks_schedule_timed_task(timer, 0, 5000000) == 0);
+  CPPUNIT_ASSERT(waitForCount(&count, 3, 2000000000));
+
+  // no more executions after cancellation
+  CPPUNIT_ASSERT(vftasks_cancel_timed_task(timer) == 0);
+  snapshot = ATOMIC_LOAD_ACQUIRE(&count);
+  spin(20000000);
+  CPPUNIT_ASSERT(ATOMIC_LOAD_ACQUIRE(&count) == snapshot);
+
+  vftasks_destroy_timed_task(timer);
+}
+
+void TasksTest::testRescheduleTimedTask()
+{
+  int count = 0;
+  vftasks_timed_task_t *timer;
+
+  this->pool = createPool(1);
+  timer = vftasks_create_timed_task(this->pool, tick, &count);
+  CPPUNIT_ASSERT(timer != NULL);
+
+  // a far deadline is replaced by a near one
+  CPPUNIT_ASSERT(vftasks_schedule_timed_task(timer, 3600000000000ULL, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_schedule_timed_task(timer, 1000000, 0) == 0);
+  CPPUNIT_ASSERT(waitForCount(&count, 1, 2000000000));
+
+  // a cancelled timed task is never executed
+  CPPUNIT_ASSERT(vftasks_schedule_timed_task(timer, 10000000, 0) == 0);
+  CPPUNIT_ASSERT(vftasks_cancel_timed_task(timer) == 0);
+  spin(30000000);
+  CPPUNIT_ASSERT(ATOMIC_LOAD_ACQUIRE(&count) == 1);
+
+  vftasks_destroy_timed_task(timer);
+}
+
+void TasksTest::testTimedTaskFineTicks()
+{
+  int count = 0;
+  vftasks_pool_attr_t attr;
+  uint64_t start;
+
+  // with 10us ticks, a 50ms delay spans the higher levels of the timer wheel
+  vftasks_init_pool_attr(&attr);
+  attr.timer_tick_ns = 10000;
+  this->pool = vftasks_create_pool_with_attr(1, this->busy_wait, &attr);
+  CPPUNIT_ASSERT(this->pool != NULL);
+
+  vftasks_timer_start(&start);
+  CPPUNIT_ASSERT(vftasks_submit_after(this->pool, 50000000, tick, &count) == 0);
+  CPPUNIT_ASSERT(waitForCount(&count, 1, 2000000000));
+  CPPUNIT_ASSERT(vftasks_timer_stop(&start) >= 50000000);
+}
+
+// a timed task that tries to submit a subtask
+static void submitFromTimer(void *raw_args)
+{
+  timed_submit_args_t *args = (timed_submit_args_t *)raw_args;
+  square_args_t square_args;
+
+  square_args.val = 3;
+  args->available = vftasks_get_num_available_workers(args->pool);
+  args->submitted = vftasks_submit(args->pool, square, &square_args, 0) == 0;
+  if (args->submitted) vftasks_get(args->pool);
+  ATOMIC_FETCH_ADD(&args->count, 1);
+}
+
+void TasksTest::testTimedTaskSubmitWhileBusy()
+{
+  timed_submit_args_t args;
+  int released = 0;
+
+  this->pool = createPool(2);
+  this->square_args = (square_args_t *)malloc(sizeof(square_args_t));
+  this->square_args->val = 2;
+
+  // hand the timekeeper the first worker as its subsidiary worker once
+  CPPUNIT_ASSERT(vftasks_submit(this->pool, square, this->square_args, 1) == 0);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+
+  // keep the first worker busy; a timed task must not be able to submit to it
+  CPPUNIT_ASSERT(vftasks_submit(this->pool, hold, &released, 0) == 0);
+  args.pool = this->pool;
+  args.submitted = -1;
+  args.available = -1;
+  args.count = 0;
+  CPPUNIT_ASSERT(vftasks_submit_after(this->pool, 1000000, submitFromTimer, &args) == 0);
+  CPPUNIT_ASSERT(waitForCount(&args.count, 1, 2000000000));
+  CPPUNIT_ASSERT(args.available == 0);
+  CPPUNIT_ASSERT(args.submitted == 0);
+
+  ATOMIC_STORE_RELEASE(&released, 1);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+}
+
+void TasksTest::testPoolSnapshot()
+{
+  vftasks_worker_snapshot_t snapshot[2];
+  int released = 0;
+  int idle = this->busy_wait ? VFTASKS_WORKER_SPINNING : VFTASKS_WORKER_PARKED;
+
+  this->pool = createPool(2);
+  CPPUNIT_ASSERT(waitForState(this->pool, 0, idle));
+  CPPUNIT_ASSERT(waitForState(this->pool, 1, idle));
+
+  // the first worker picks up the task
+  CPPUNIT_ASSERT(vftasks_submit(this->pool, hold, &released, 0) == 0);
+  CPPUNIT_ASSERT(waitForState(this->pool, 0, VFTASKS_WORKER_BUSY));
+  CPPUNIT_ASSERT(vftasks_get_pool_snapshot(this->pool, snapshot) == 0);
+  CPPUNIT_ASSERT(snapshot[0].task == hold);
+  CPPUNIT_ASSERT(snapshot[0].arena_task == NULL);
+  CPPUNIT_ASSERT(snapshot[1].state == idle);
+  CPPUNIT_ASSERT(snapshot[1].task == NULL);
+
+  ATOMIC_STORE_RELEASE(&released, 1);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  CPPUNIT_ASSERT(waitForState(this->pool, 0, idle));
+
+  // a task that takes an arena is reported separately
+  released = 0;
+  CPPUNIT_ASSERT(vftasks_submit_arena_task(this->pool, holdWithArena, &released, 0) == 0);
+  CPPUNIT_ASSERT(waitForState(this->pool, 0, VFTASKS_WORKER_BUSY));
+  CPPUNIT_ASSERT(vftasks_get_pool_snapshot(this->pool, snapshot) == 0);
+  CPPUNIT_ASSERT(snapshot[0].task == NULL);
+  CPPUNIT_ASSERT(snapshot[0].arena_task == holdWithArena);
+
+  ATOMIC_STORE_RELEASE(&released, 1);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+  CPPUNIT_ASSERT(waitForState(this->pool, 0, idle));
+}
+
+void TasksTest::testSampler()
+{
+  vftasks_sampler_t *sampler;
+  unsigned long histogram[3];
+  unsigned long counts[VFTASKS_NUM_WORKER_STATES];
+  int released = 0;
+  int i;
+
+  this->pool = createPool(2);
+  sampler = vftasks_create_sampler(this->pool);
+  CPPUNIT_ASSERT(sampler != NULL);
+
+  // keep one worker busy while sampling
+  CPPUNIT_ASSERT(vftasks_submit(this->pool, hold, &released, 0) == 0);
+  CPPUNIT_ASSERT(waitForState(this->pool, 0, VFTASKS_WORKER_BUSY));
+  for (i = 0; i < 100; ++i)
+    CPPUNIT_ASSERT(vftasks_sample_pool(sampler) == 0);
+  ATOMIC_STORE_RELEASE(&released, 1);
+  CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+
+  CPPUNIT_ASSERT(vftasks_get_busy_histogram(sampler, histogram) == 0);
+  CPPUNIT_ASSERT(histogram[0] == 0);
+  CPPUNIT_ASSERT(histogram[1] + histogram[2] == 100);
+
+  CPPUNIT_ASSERT(vftasks_get_worker_state_counts(sampler, 0, counts) == 0);
+  CPPUNIT_ASSERT(counts[VFTASKS_WORKER_BUSY] == 100);
+  CPPUNIT_ASSERT(vftasks_get_worker_state_counts(sampler, 2, counts) != 0);
+
+  // resetting clears the histograms, and the next window counts on its own
+  vftasks_reset_sampler(sampler);
+  CPPUNIT_ASSERT(vftasks_get_busy_histogram(sampler, histogram) == 0);
+  CPPUNIT_ASSERT(histogram[0] + histogram[1] + histogram[2] == 0);
+  CPPUNIT_ASSERT(vftasks_sample_pool(sampler) == 0);
+  CPPUNIT_ASSERT(vftasks_get_worker_state_counts(sampler, 0, counts) == 0);
+  CPPUNIT_ASSERT(counts[0] + counts[1] + counts[2] == 1);
+
+  vftasks_destroy_sampler(sampler);
+}
+
 // register fixture
 CPPUNIT_TEST_SUITE_REGISTRATION(TasksTest);
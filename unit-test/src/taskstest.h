@@ -15,6 +15,14 @@ typedef struct
   int result;
 } square_args_t;
 
+typedef struct
+{
+  int size;
+  int persistent;
+  void *first;
+  void *last;
+} arena_args_t;
+
 typedef struct
 {
   int start;
@@ -36,6 +44,14 @@ typedef struct
   int stride;
 } inner_loop_args_t;
 
+typedef struct
+{
+  vftasks_pool_t *pool;
+  int submitted;
+  int available;
+  int count;
+} timed_submit_args_t;
+
 class TasksTest : public CppUnit::TestFixture
 {
   CPPUNIT_TEST_SUITE(TasksTest);
@@ -45,6 +61,7 @@ class TasksTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testCreatePool1);
   CPPUNIT_TEST(testCreatePool4);
   CPPUNIT_TEST(testDestroyPool);
+  CPPUNIT_TEST(testCreatePoolWithAttr);
 
   CPPUNIT_TEST(testSubmitEmptyTask);
   CPPUNIT_TEST(testSubmit);
@@ -60,6 +77,19 @@ class TasksTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testSubmitGetNestedLoop);
   CPPUNIT_TEST(testSubmitGetNestedLoopInvalidSubWorkers);
 
+  CPPUNIT_TEST(testArenaTask);
+  CPPUNIT_TEST(testArenaReset);
+  CPPUNIT_TEST(testArenaPersistent);
+  CPPUNIT_TEST(testCoalesceTinyTasks);
+  CPPUNIT_TEST(testCoalesceDisabled);
+  CPPUNIT_TEST(testSubmitAfter);
+  CPPUNIT_TEST(testPeriodicTimedTask);
+  CPPUNIT_TEST(testRescheduleTimedTask);
+  CPPUNIT_TEST(testTimedTaskFineTicks);
+  CPPUNIT_TEST(testTimedTaskSubmitWhileBusy);
+  CPPUNIT_TEST(testPoolSnapshot);
+  CPPUNIT_TEST(testSampler);
+
   CPPUNIT_TEST_SUITE_END();  // TasksTest
 
 public:
@@ -68,6 +98,7 @@ public:
   void testCreatePool1();
   void testCreatePool4();
   void testDestroyPool();
+  void testCreatePoolWithAttr();
 
   void testSubmitEmptyTask();
   void testSubmit();
@@ -83,6 +114,22 @@ public:
   void testSubmitGetNestedLoop();
   void testSubmitGetNestedLoopInvalidSubWorkers();
 
+  void testArenaTask();
+  void testArenaReset();
+  void testArenaPersistent();
+
+  void testCoalesceTinyTasks();
+  void testCoalesceDisabled();
+
+  void testSubmitAfter();
+  void testPeriodicTimedTask();
+  void testRescheduleTimedTask();
+  void testTimedTaskFineTicks();
+  void testTimedTaskSubmitWhileBusy();
+
+  void testPoolSnapshot();
+  void testSampler();
+
   void setUp();
   void tearDown();
 
@@ -97,6 +144,7 @@ private:
 
   vftasks_pool_t *pool;  // pointer to a worker-thread pool
   square_args_t *square_args;
+  arena_args_t *arena_args;
   loop_args_t *loop_args;
   inner_loop_args_t *inner_loop_args;
   outer_loop_args_t *outer_loop_args;
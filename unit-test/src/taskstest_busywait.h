@@ -14,6 +14,7 @@ class TasksTestBusyWait : public TasksTest
   CPPUNIT_TEST(testCreatePool1);
   CPPUNIT_TEST(testCreatePool4);
   CPPUNIT_TEST(testDestroyPool);
+  CPPUNIT_TEST(testCreatePoolWithAttr);
 
   CPPUNIT_TEST(testSubmitEmptyTask);
   CPPUNIT_TEST(testSubmit);
@@ -29,6 +30,18 @@ class TasksTestBusyWait : public TasksTest
   CPPUNIT_TEST(testSubmitGetNestedLoop);
   CPPUNIT_TEST(testSubmitGetNestedLoopInvalidSubWorkers);
 
+  CPPUNIT_TEST(testArenaTask);
+  CPPUNIT_TEST(testArenaReset);
+  CPPUNIT_TEST(testArenaPersistent);
+  CPPUNIT_TEST(testCoalesceTinyTasks);
+  CPPUNIT_TEST(testCoalesceDisabled);
+  CPPUNIT_TEST(testSubmitAfter);
+  CPPUNIT_TEST(testPeriodicTimedTask);
+  CPPUNIT_TEST(testRescheduleTimedTask);
+  CPPUNIT_TEST(testTimedTaskFineTicks);
+  CPPUNIT_TEST(testPoolSnapshot);
+  CPPUNIT_TEST(testSampler);
+
   CPPUNIT_TEST_SUITE_END();  // TasksTestBusyWait
 
 public:
@@ -0,0 +1,177 @@
+#include "wavefronttest.h"
+
+extern "C"
+{
+#include "platform.h"
+}
+
+#define ROWS 40
+#define COLS 36
+#define NUM_WORKERS 3
+
+typedef struct
+{
+  int dist_x;
+  int dist_y;
+  int (*data)[COLS];
+} loop_ctx_t;
+
+static int data[ROWS][COLS];
+static int expected[ROWS][COLS];
+
+// a loop body that adds to every element the element at the dependency distance
+static void body(void *raw_ctx, int x_begin, int x_end, int y_begin, int y_end)
+{
+  loop_ctx_t *ctx = (loop_ctx_t *)raw_ctx;
+  int i, j;
+
+  for (i = x_begin; i < x_end; i++)
+    for (j = y_begin; j < y_end; j++)
+    {
+      int x = i - ctx->dist_x, y = j - ctx->dist_y;
+
+      if (x >= 0 && y >= 0 && y < COLS)
+        ctx->data[i][j] += ctx->data[x][y];
+    }
+}
+
+// a task that keeps its worker busy until released
+static void hold(void *raw_args)
+{
+  int *released = (int *)raw_args;
+
+  while (!ATOMIC_LOAD_ACQUIRE(released));
+}
+
+void WavefrontTest::setUp()
+{
+  this->pool = vftasks_create_pool(NUM_WORKERS, 0);
+  CPPUNIT_ASSERT(this->pool != NULL);
+}
+
+void WavefrontTest::tearDown()
+{
+  vftasks_destroy_pool(this->pool);
+}
+
+// run a loop nest as a wavefront and compare the result with that of a sequential run
+void WavefrontTest::testLoop(int distX, int distY, int tileX, int tileY)
+{
+  loop_ctx_t ctx;
+  int i, j;
+
+  for (i = 0; i < ROWS; i++)
+    for (j = 0; j < COLS; j++)
+      data[i][j] = expected[i][j] = i * COLS + j;
+
+  ctx.dist_x = distX;
+  ctx.dist_y = distY;
+  ctx.data = expected;
+  body(&ctx, 0, ROWS, 0, COLS);
+
+  ctx.data = data;
+  CPPUNIT_ASSERT(vftasks_wavefront_2d(this->pool, ROWS, COLS, distX, distY,
+                                      tileX, tileY, body, &ctx) == 0);
+
+  for (i = 0; i < ROWS; i++)
+    for (j = 0; j < COLS; j++)
+      CPPUNIT_ASSERT_EQUAL(expected[i][j], data[i][j]);
+}
+
+void WavefrontTest::testWavefront()
+{
+  CPPUNIT_ASSERT_EQUAL(NUM_WORKERS, vftasks_get_num_available_workers(this->pool));
+
+  // dependencies from either side of the previous rows
+  this->testLoop(1, -1, 4, 4);
+  this->testLoop(1, 1, 4, 4);
+  this->testLoop(2, -3, 3, 5);
+  this->testLoop(1, -4, 7, 4);
+
+  // dependencies within rows and columns
+  this->testLoop(1, 0, 8, 6);
+  this->testLoop(0, 2, 5, 9);
+
+  // tiles that do not divide the iteration space, or that cover all of it
+  this->testLoop(3, 2, 11, 13);
+  this->testLoop(1, -1, ROWS, COLS);
+  this->testLoop(1, -1, 1, 1);
+
+  // no dependencies at all
+  this->testLoop(0, 0, 8, 8);
+
+  // all workers have been returned
+  CPPUNIT_ASSERT_EQUAL(NUM_WORKERS, vftasks_get_num_available_workers(this->pool));
+}
+
+void WavefrontTest::testNoWorkers()
+{
+  int released = 0;
+  int k;
+
+  // keep all workers busy
+  for (k = 0; k < NUM_WORKERS; k++)
+    CPPUNIT_ASSERT(vftasks_submit(this->pool, hold, &released, 0) == 0);
+  CPPUNIT_ASSERT_EQUAL(0, vftasks_get_num_available_workers(this->pool));
+
+  // the calling thread executes all tiles
+  this->testLoop(1, -1, 4, 4);
+
+  ATOMIC_STORE_RELEASE(&released, 1);
+  for (k = 0; k < NUM_WORKERS; k++)
+    CPPUNIT_ASSERT(vftasks_get(this->pool) == 0);
+}
+
+void WavefrontTest::testCoalescingPool()
+{
+  vftasks_pool_attr_t attr;
+  loop_ctx_t ctx;
+  int k;
+
+  // the workers wait for the calling thread, so they are never executed inline,
+  // however short they are observed to be
+  vftasks_destroy_pool(this->pool);
+  vftasks_init_pool_attr(&attr);
+  attr.coalesce_ns = 1000000000;
+  this->pool = vftasks_create_pool_with_attr(1, 0, &attr);
+  CPPUNIT_ASSERT(this->pool != NULL);
+
+  ctx.dist_x = 1;
+  ctx.dist_y = 1;
+  ctx.data = data;
+  for (k = 0; k < 8; k++)
+    CPPUNIT_ASSERT(vftasks_wavefront_2d(this->pool, 8, 8, 1, 1, 2, 2,
+                                        body, &ctx) == 0);
+}
+
+void WavefrontTest::testInvalidArguments()
+{
+  loop_ctx_t ctx;
+
+  ctx.dist_x = 0;
+  ctx.dist_y = 0;
+  ctx.data = data;
+
+  // dependencies on later iterations
+  CPPUNIT_ASSERT(vftasks_wavefront_2d(this->pool, ROWS, COLS, -1, 0, 4, 4,
+                                      body, &ctx) != 0);
+  CPPUNIT_ASSERT(vftasks_wavefront_2d(this->pool, ROWS, COLS, 0, -1, 4, 4,
+                                      body, &ctx) != 0);
+
+  // tiles smaller than the distances
+  CPPUNIT_ASSERT(vftasks_wavefront_2d(this->pool, ROWS, COLS, 2, 0, 1, 4,
+                                      body, &ctx) != 0);
+  CPPUNIT_ASSERT(vftasks_wavefront_2d(this->pool, ROWS, COLS, 1, -5, 4, 4,
+                                      body, &ctx) != 0);
+
+  // no body
+  CPPUNIT_ASSERT(vftasks_wavefront_2d(this->pool, ROWS, COLS, 1, 0, 4, 4,
+                                      NULL, &ctx) != 0);
+
+  // an empty iteration space takes no tiles
+  CPPUNIT_ASSERT(vftasks_wavefront_2d(this->pool, 0, COLS, 1, 0, 4, 4,
+                                      body, &ctx) == 0);
+}
+
+// register fixture
+CPPUNIT_TEST_SUITE_REGISTRATION(WavefrontTest);
@@ -0,0 +1,37 @@
+#ifndef WAVEFRONTTEST_H
+#define WAVEFRONTTEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+extern "C"
+{
+#include <vftasks.h>
+}
+
+class WavefrontTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(WavefrontTest);
+
+  CPPUNIT_TEST(testWavefront);
+  CPPUNIT_TEST(testNoWorkers);
+  CPPUNIT_TEST(testCoalescingPool);
+  CPPUNIT_TEST(testInvalidArguments);
+
+  CPPUNIT_TEST_SUITE_END(); // WavefrontTest
+
+public:
+  void testWavefront();
+  void testNoWorkers();
+  void testCoalescingPool();
+  void testInvalidArguments();
+
+  void setUp();
+  void tearDown();
+
+private:
+  void testLoop(int distX, int distY, int tileX, int tileY);
+
+  vftasks_pool_t *pool;
+};
+
+#endif // WAVEFRONTTEST_H